@@ -0,0 +1,53 @@
+/*
+ * Adaptive Sampling Interval Implementation
+ */
+
+#include "AdaptiveInterval.h"
+
+// Constructor
+AdaptiveInterval::AdaptiveInterval()
+  : m_interval(ADAPTIVE_MIN_INTERVAL_MS),
+    m_lastTime(0),
+    m_nextTime(0),
+    m_rate(0.0f),
+    m_rateVariance(0.0f) {
+}
+
+// Estimate how fast readings drift and pick the next period so that roughly
+// ADAPTIVE_TARGET_CHANGE deadbands of change happen between samples
+void AdaptiveInterval::update(float change, uint32_t currentTime) {
+  const uint32_t elapsed = currentTime - m_lastTime;
+  m_lastTime = currentTime;
+
+  if (!isfinite(change)) {
+    // Sensor failed or came back - sample again as soon as allowed
+    m_interval = ADAPTIVE_MIN_INTERVAL_MS;
+    m_nextTime = currentTime + m_interval;
+    return;
+  }
+
+  if (elapsed > 0) {
+    const float rate = change * 1000.0f / elapsed;
+
+    // Incremental EWMA mean/variance (West 1979)
+    const float diff = rate - m_rate;
+    m_rate += ADAPTIVE_SMOOTHING * diff;
+    m_rateVariance = (1.0f - ADAPTIVE_SMOOTHING) * (m_rateVariance + ADAPTIVE_SMOOTHING * diff * diff);
+  }
+
+  // Noisy channels are treated as changing faster (mean + 2 sigma)
+  const float effectiveRate = m_rate + 2.0f * sqrtf(m_rateVariance);
+
+  uint32_t target = ADAPTIVE_MAX_INTERVAL_MS;
+  if (effectiveRate > 0.0f) {
+    const float ms = ADAPTIVE_TARGET_CHANGE * 1000.0f / effectiveRate;
+    if (ms < ADAPTIVE_MAX_INTERVAL_MS) {
+      target = (uint32_t)ms;
+    }
+  }
+
+  // Shrink immediately, grow at most 2x per sample to ride out short lulls
+  m_interval = min(target, m_interval * 2);
+  m_interval = constrain(m_interval, ADAPTIVE_MIN_INTERVAL_MS, ADAPTIVE_MAX_INTERVAL_MS);
+  m_nextTime = currentTime + m_interval;
+}
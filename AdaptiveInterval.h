@@ -0,0 +1,58 @@
+/*
+ * Adaptive Sampling Interval for ESP32 Weather Station
+ * Shortens the measurement period while a sensor's readings change quickly
+ * or noisily, and stretches it while the weather is flat
+ */
+
+#ifndef ADAPTIVE_INTERVAL_H
+#define ADAPTIVE_INTERVAL_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+class AdaptiveInterval {
+public:
+  // Constructor - starts at the shortest interval
+  AdaptiveInterval();
+
+  // True once the current interval has elapsed
+  inline bool isDue(uint32_t currentTime) const {
+    return (int32_t)(currentTime - m_nextTime) >= 0;
+  }
+
+  // Feed change since previous sample (in deadband units, Inf = sensor failed)
+  // and schedule the next sample
+  void update(float change, uint32_t currentTime);
+
+  // Current measurement period (milliseconds)
+  inline uint32_t getInterval() const {
+    return m_interval;
+  }
+
+  // millis() of next sample
+  inline uint32_t getNextTime() const {
+    return m_nextTime;
+  }
+
+private:
+  uint32_t m_interval;
+  uint32_t m_lastTime;
+  uint32_t m_nextTime;
+
+  // EWMA of rate of change (deadbands per second) and its variance
+  float m_rate;
+  float m_rateVariance;
+};
+
+// Change of one channel in deadband units (Inf if it appeared or vanished)
+inline float channelChange(float from, float to, float deadband) {
+  if (isfinite(from) != isfinite(to)) {
+    return INFINITY;
+  }
+  if (!isfinite(to)) {
+    return 0.0f;
+  }
+  return fabsf(to - from) / deadband;
+}
+
+#endif // ADAPTIVE_INTERVAL_H
@@ -0,0 +1,137 @@
+/*
+ * Anomaly Detector Implementation
+ */
+
+#include "AnomalyDetector.h"
+
+// MAD -> standard deviation for normally distributed noise
+constexpr float MAD_SCALE = 1.4826f;
+
+// Median of a small array (reorders it)
+static float median(float* values, uint8_t count) {
+  std::nth_element(values, values + count / 2, values + count);
+  return values[count / 2];
+}
+
+// Constructor
+AnomalyDetector::AnomalyDetector(const AnomalyLimits& limits)
+  : m_limits(limits),
+    m_window{},
+    m_windowHead(0),
+    m_windowCount(0),
+    m_samples(0),
+    m_mean(0.0f),
+    m_variance(0.0f),
+    m_lastValue(NAN),
+    m_lastChangeTime(0),
+    m_stuck(false),
+    m_rangeCount(0),
+    m_spikeCount(0),
+    m_stuckCount(0) {
+}
+
+// Robust z-score of value against the window
+bool AnomalyDetector::isSpike(float value) const {
+  if (!m_limits.spikes || m_windowCount < ANOMALY_WINDOW) {
+    return false;
+  }
+
+  float scratch[ANOMALY_WINDOW];
+  memcpy(scratch, m_window, sizeof(scratch));
+  const float center = median(scratch, ANOMALY_WINDOW);
+
+  for (uint8_t i = 0; i < ANOMALY_WINDOW; i++) {
+    scratch[i] = fabsf(m_window[i] - center);
+  }
+  const float spread = max(MAD_SCALE * median(scratch, ANOMALY_WINDOW), m_limits.minSpread);
+
+  return fabsf(value - center) > ANOMALY_SPIKE_THRESHOLD * spread;
+}
+
+// Check one sample
+uint8_t AnomalyDetector::check(float& value, uint32_t now) {
+  if (!isfinite(value)) {
+    return ANOMALY_NONE;
+  }
+
+  if (value < m_limits.min || value > m_limits.max) {
+    m_rangeCount++;
+    value = NAN;
+    return ANOMALY_RANGE;
+  }
+
+  uint8_t flags = ANOMALY_NONE;
+
+  if (isSpike(value)) {
+    flags |= ANOMALY_SPIKE;
+    m_spikeCount++;
+  }
+
+  m_window[m_windowHead] = value;
+  m_windowHead = (m_windowHead + 1) % ANOMALY_WINDOW;
+  if (m_windowCount < ANOMALY_WINDOW) {
+    m_windowCount++;
+  }
+
+  // Welford - exact running mean/variance, exponentially weighted after N samples
+  if (!(flags & ANOMALY_SPIKE)) {
+    if (m_samples < ANOMALY_STATS_SAMPLES) {
+      m_samples++;
+    }
+    const float weight = 1.0f / m_samples;
+    const float delta = value - m_mean;
+    m_mean += weight * delta;
+    m_variance = (1.0f - weight) * (m_variance + weight * delta * delta);
+  }
+
+  // Stuck - identical value for too long (sensor rails are legitimate)
+  if (value != m_lastValue) {
+    m_lastValue = value;
+    m_lastChangeTime = now;
+    m_stuck = false;
+  } else if (m_limits.stuckMs > 0 && now - m_lastChangeTime >= m_limits.stuckMs &&
+             value > m_limits.min && value < m_limits.max) {
+    // Count episodes, not samples
+    if (!m_stuck) {
+      m_stuck = true;
+      m_stuckCount++;
+    }
+    flags |= ANOMALY_STUCK;
+  }
+
+  if (flags & ANOMALY_SPIKE) {
+    value = NAN;
+  }
+
+  return flags;
+}
+
+// Serialize statistics
+void AnomalyDetector::writeJSON(JsonWriter& json, const char* key) const {
+  json.beginObject(key);
+  json.addFloat("mean", m_samples > 0 ? m_mean : NAN, 3);
+  json.addFloat("stddev", m_samples > 1 ? sqrtf(m_variance) : NAN, 3);
+  json.addUInt("ranges", m_rangeCount);
+  json.addUInt("spikes", m_spikeCount);
+  json.addUInt("stuck", m_stuckCount);
+  json.endObject();
+}
+
+// Serialize flags of one channel
+void writeAnomalyJSON(JsonWriter& json, const char* key, uint8_t flags) {
+  if (flags == ANOMALY_NONE) {
+    return;
+  }
+
+  json.beginArray(key);
+  if (flags & ANOMALY_RANGE) {
+    json.addString(nullptr, "range");
+  }
+  if (flags & ANOMALY_SPIKE) {
+    json.addString(nullptr, "spike");
+  }
+  if (flags & ANOMALY_STUCK) {
+    json.addString(nullptr, "stuck");
+  }
+  json.endArray();
+}
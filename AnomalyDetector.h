@@ -0,0 +1,78 @@
+/*
+ * Anomaly Detector for ESP32 Weather Station
+ * Streaming per-channel fault detection in constant memory, O(1) per sample:
+ * - range: outside the sensor's physical range (value rejected)
+ * - spike: robust z-score (median / MAD of the last ANOMALY_WINDOW samples)
+ *   above ANOMALY_SPIKE_THRESHOLD (value rejected). Spikes still enter the
+ *   window, so a genuine step change is accepted after ~half a window
+ * - stuck: value unchanged for stuckMs (value kept, flagged)
+ * Welford running mean/variance (exponentially weighted once
+ * ANOMALY_STATS_SAMPLES is reached) is kept for reporting.
+ */
+
+#ifndef ANOMALY_DETECTOR_H
+#define ANOMALY_DETECTOR_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "JsonWriter.h"
+
+// Anomaly flags of one channel sample
+enum AnomalyFlag : uint8_t {
+  ANOMALY_NONE = 0,
+  ANOMALY_RANGE = 0x01,
+  ANOMALY_SPIKE = 0x02,
+  ANOMALY_STUCK = 0x04
+};
+
+// Per-channel detection limits
+struct AnomalyLimits {
+  float min;        // Physical range (rails do not count as stuck)
+  float max;
+  float minSpread;  // Floor for the MAD-based spread (sensor resolution/noise)
+  bool spikes;      // Spike test enabled
+  uint32_t stuckMs; // 0 = stuck test disabled
+};
+
+class AnomalyDetector {
+public:
+  // Constructor
+  explicit AnomalyDetector(const AnomalyLimits& limits);
+
+  // Check sample, returns AnomalyFlag bits
+  // Rejected samples (range/spike) are replaced by NAN
+  uint8_t check(float& value, uint32_t now);
+
+  // Serialize running statistics and flag counters
+  void writeJSON(JsonWriter& json, const char* key) const;
+
+private:
+  AnomalyLimits m_limits;
+
+  // Recent in-range samples (ring)
+  float m_window[ANOMALY_WINDOW];
+  uint8_t m_windowHead;
+  uint8_t m_windowCount;
+
+  // Welford running statistics
+  uint32_t m_samples;
+  float m_mean;
+  float m_variance;
+
+  // Stuck detection
+  float m_lastValue;
+  uint32_t m_lastChangeTime;
+  bool m_stuck;
+
+  // Flag counters (false-positive rate = count / samples on a clean trace)
+  uint32_t m_rangeCount;
+  uint32_t m_spikeCount;
+  uint32_t m_stuckCount;
+
+  bool isSpike(float value) const;
+};
+
+// Serialize flags of one channel as "key": ["range", "spike", "stuck"] (nothing if clear)
+void writeAnomalyJSON(JsonWriter& json, const char* key, uint8_t flags);
+
+#endif // ANOMALY_DETECTOR_H
@@ -0,0 +1,320 @@
+/*
+ * BH1750 Driver Implementation
+ */
+
+#include "Bh1750Sensor.h"
+
+// BH1750 opcodes
+constexpr uint8_t BH1750_ONE_TIME_HIGH_RES = 0x20;    // 1 lx per count at MTreg 69
+constexpr uint8_t BH1750_ONE_TIME_HIGH_RES_2 = 0x21;  // 0.5 lx per count at MTreg 69
+constexpr uint8_t BH1750_ONE_TIME_LOW_RES = 0x23;     // 4 lx steps
+constexpr uint8_t BH1750_MTREG_HIGH_BITS = 0x40;      // 01000_MT[7:5]
+constexpr uint8_t BH1750_MTREG_LOW_BITS = 0x60;       // 011_MT[4:0]
+
+constexpr uint8_t BH1750_MTREG_DEFAULT = 69;
+constexpr uint16_t BH1750_HIGH_RES_TIME_MS = 180;     // Max conversion time at MTreg 69 (scales with MTreg)
+constexpr uint16_t BH1750_LOW_RES_TIME_MS = 24;
+constexpr float BH1750_COUNTS_PER_LUX = 1.2f;         // Datasheet typical measurement accuracy
+
+// Measurement range: mode and measurement time (longer = more sensitive)
+struct LightRange {
+  uint8_t opcode;
+  uint8_t mtreg;
+};
+
+// Ordered from most to least sensitive
+static constexpr LightRange LIGHT_RANGES[] = {
+  { BH1750_ONE_TIME_HIGH_RES_2, 254 },  // 0.11 lx, 7.4 klux, 663 ms
+  { BH1750_ONE_TIME_HIGH_RES_2, 69 },   // 0.42 lx, 27 klux, 180 ms
+  { BH1750_ONE_TIME_HIGH_RES, 69 },     // 0.83 lx, 55 klux, 180 ms
+  { BH1750_ONE_TIME_HIGH_RES, 31 },     // 1.85 lx, 122 klux, 81 ms
+};
+
+constexpr uint8_t LIGHT_RANGE_COUNT = sizeof(LIGHT_RANGES) / sizeof(LIGHT_RANGES[0]);
+constexpr uint8_t LIGHT_RANGE_WIDEST = LIGHT_RANGE_COUNT - 1;
+
+// Lux per count
+static constexpr float rangeResolution(const LightRange& range) {
+  return (range.opcode == BH1750_ONE_TIME_HIGH_RES_2 ? 0.5f : 1.0f) / BH1750_COUNTS_PER_LUX *
+         BH1750_MTREG_DEFAULT / range.mtreg;
+}
+
+// Lux at full scale
+static constexpr float rangeFullScale(const LightRange& range) {
+  return UINT16_MAX * rangeResolution(range);
+}
+
+// Worst-case conversion time
+static constexpr uint32_t rangeConversionMs(const LightRange& range) {
+  return ((uint32_t)BH1750_HIGH_RES_TIME_MS * range.mtreg + BH1750_MTREG_DEFAULT - 1) / BH1750_MTREG_DEFAULT;
+}
+
+// Constructor
+Bh1750Sensor::Bh1750Sensor()
+  : m_range(LIGHT_RANGE_WIDEST),
+    m_mtreg(0),
+    m_converting(false),
+    m_conversionStart(0) {
+}
+
+// Initialize BH1750 on I2C Bus #2
+bool Bh1750Sensor::begin() {
+  // Initialize I2C Bus #2 with custom pins (separate bus for isolation)
+  i2cBus2.begin(I2C2_SDA_PIN, I2C2_SCL_PIN);
+  i2cBus2.setClock(I2C_CLOCK_SPEED);
+
+  #if DEBUG_SERIAL_ENABLED
+  Serial.printf("[I2C] Bus #2 init: SDA=%d, SCL=%d @ %dkHz\n",
+                I2C2_SDA_PIN, I2C2_SCL_PIN, I2C_CLOCK_SPEED / 1000);
+  #endif
+
+  // MTreg survives a bus recovery - start from a known value
+  m_mtreg = 0;
+  m_converting = false;
+
+  if (!writeMtreg(BH1750_MTREG_DEFAULT) || !writeCommand(BH1750_ONE_TIME_LOW_RES)) {
+    // Always show sensor errors
+    Serial.println("[ERROR] BH1750 not found at 0x23");
+    return false;
+  }
+
+  // One quick low-resolution reading picks the starting range
+  // (only blocking wait of the driver - begin() and recovery only)
+  delay(BH1750_LOW_RES_TIME_MS);
+
+  uint16_t raw;
+  if (!readResult(raw)) {
+    Serial.println("[ERROR] BH1750 not responding");
+    return false;
+  }
+
+  m_raw.lightLevel = raw / BH1750_COUNTS_PER_LUX;
+  m_range = LIGHT_RANGE_WIDEST;
+  m_range = selectRange(raw, m_raw.lightLevel);
+
+  #if DEBUG_SERIAL_ENABLED
+  Serial.printf("[I2C] BH1750 ready (%.0f lux, range %.0f lux)\n", m_raw.lightLevel, getRangeLux());
+  #endif
+
+  return true;
+}
+
+// Recover BH1750: clear Bus #2, re-init it and re-probe the sensor
+bool Bh1750Sensor::recover() {
+  // Bus #2 may carry BME280s - while one of them still answers the bus is
+  // not stuck, so only the BH1750 is re-initialized
+  const bool busAlive = SENSOR_BME280_ENABLED && BME280_SCAN_BUS2 &&
+                        (probeI2CDevice(i2cBus2, BME_I2C_ADDR) || probeI2CDevice(i2cBus2, BME_I2C_ADDR_ALT));
+
+  if (!busAlive && !clearI2CBus(i2cBus2, I2C2_SDA_PIN, I2C2_SCL_PIN)) {
+    Serial.println("[ERROR] Bus #2 still stuck after clear");
+  }
+
+  return begin();
+}
+
+// Trigger a conversion unless one is still running
+bool Bh1750Sensor::start() {
+  if (m_converting && getConversionTime() == 0 && !fetch()) {
+    return false;
+  }
+  return m_converting || trigger();
+}
+
+// Remaining conversion time of the current range
+uint32_t Bh1750Sensor::getConversionTime() const {
+  if (!m_converting) {
+    return 0;
+  }
+  const uint32_t elapsed = millis() - m_conversionStart;
+  const uint32_t total = rangeConversionMs(LIGHT_RANGES[m_range]);
+  return elapsed < total ? total - elapsed : 0;
+}
+
+// Read the conversion if it has finished
+bool Bh1750Sensor::collect(Channels& channels) {
+  if (m_converting && getConversionTime() == 0 && !fetch()) {
+    return false;
+  }
+
+  channels = m_raw;
+  return validate(channels);
+}
+
+// Fetch the result and pick the range the next conversion runs in
+bool Bh1750Sensor::fetch() {
+  m_converting = false;
+
+  uint16_t raw;
+  if (!readResult(raw)) {
+    return false;
+  }
+
+  // Saturated below the widest range is only a lower bound - keep the previous reading
+  const float lux = raw * getResolution();
+  if (raw < UINT16_MAX || m_range == LIGHT_RANGE_WIDEST) {
+    m_raw.lightLevel = lux;
+  }
+
+  m_range = selectRange(raw, lux);
+  return true;
+}
+
+// Most sensitive range keeping the reading below BH1750_RANGE_DOWN_FRACTION of full scale
+// - taken at once when it is more sensitive, or when the reading is near full scale
+uint8_t Bh1750Sensor::selectRange(uint16_t raw, float lux) const {
+  if (raw == UINT16_MAX) {
+    return LIGHT_RANGE_WIDEST;
+  }
+
+  uint8_t fit = LIGHT_RANGE_WIDEST;
+  for (uint8_t i = 0; i < LIGHT_RANGE_WIDEST; i++) {
+    if (lux < BH1750_RANGE_DOWN_FRACTION * rangeFullScale(LIGHT_RANGES[i])) {
+      fit = i;
+      break;
+    }
+  }
+
+  if (raw >= BH1750_RANGE_UP_FRACTION * UINT16_MAX) {
+    return fit;  // Always less sensitive than the current range here
+  }
+  return min(fit, m_range);
+}
+
+// Start one-time conversion (sensor powers down after it)
+bool Bh1750Sensor::trigger() {
+  const LightRange& range = LIGHT_RANGES[m_range];
+
+  if (!writeMtreg(range.mtreg) || !writeCommand(range.opcode)) {
+    return false;
+  }
+
+  m_converting = true;
+  m_conversionStart = millis();
+  return true;
+}
+
+// MTreg is written in two halves
+bool Bh1750Sensor::writeMtreg(uint8_t mtreg) {
+  if (mtreg == m_mtreg) {
+    return true;
+  }
+
+  if (!writeCommand(BH1750_MTREG_HIGH_BITS | (mtreg >> 5)) ||
+      !writeCommand(BH1750_MTREG_LOW_BITS | (mtreg & 0x1F))) {
+    m_mtreg = 0;
+    return false;
+  }
+
+  m_mtreg = mtreg;
+  return true;
+}
+
+// Send a single opcode
+bool Bh1750Sensor::writeCommand(uint8_t opcode) {
+  i2cBus2.beginTransmission(BH1750_I2C_ADDR);
+  i2cBus2.write(opcode);
+  return i2cBus2.endTransmission() == 0;
+}
+
+// Read big-endian result
+bool Bh1750Sensor::readResult(uint16_t& raw) {
+  if (i2cBus2.requestFrom(BH1750_I2C_ADDR, (uint8_t)2) != 2) {
+    return false;
+  }
+
+  raw = (uint16_t)(i2cBus2.read() << 8);
+  raw |= (uint8_t)i2cBus2.read();
+  return true;
+}
+
+// Full scale of the current range
+float Bh1750Sensor::getRangeLux() const {
+  return rangeFullScale(LIGHT_RANGES[m_range]);
+}
+
+// Resolution of the current range
+float Bh1750Sensor::getResolution() const {
+  return rangeResolution(LIGHT_RANGES[m_range]);
+}
+
+// Mark channels as unavailable
+void Bh1750Sensor::clear(Channels& channels) {
+  channels.lightLevel = NAN;
+}
+
+// Check if BH1750 reading is valid
+bool Bh1750Sensor::validate(const Channels& channels) {
+  return isfinite(channels.lightLevel) && channels.lightLevel >= 0.0f;
+}
+
+// Light spans 5 decades - deadband is relative with an absolute floor for darkness
+float Bh1750Sensor::change(const Channels& from, const Channels& to) {
+  const float deadband = max(fabsf(from.lightLevel) * ADAPTIVE_DEADBAND_LIGHT, ADAPTIVE_DEADBAND_LIGHT_MIN);
+  return channelChange(from.lightLevel, to.lightLevel, deadband);
+}
+
+// Add BH1750 light sensor data
+void Bh1750Sensor::writeJSON(const Channels& channels, JsonWriter& json) {
+  json.addFloat("light", channels.lightLevel);
+}
+
+// Add light level as line protocol field
+void Bh1750Sensor::writeLine(const Channels& channels, LineWriter& line) {
+  line.addFloat("light", channels.lightLevel);
+}
+
+// Map JSON key to channel
+float Bh1750Sensor::Channels::* Bh1750Sensor::findChannel(const char* name) {
+  return strcmp(name, "light") == 0 ? &Channels::lightLevel : nullptr;
+}
+
+// Feed high-rate sample into channel filter
+void Bh1750Sensor::Filters::push(const Channels& channels) {
+  lightLevel.push(channels.lightLevel);
+}
+
+// Publish decimated channel value
+void Bh1750Sensor::Filters::decimate(Channels& channels) {
+  channels.lightLevel = lightLevel.decimate();
+}
+
+// Full scale of the widest range is saturated (direct sun beyond ~120 klux)
+static const AnomalyLimits LIGHT_LIMITS = {
+  0.0f, (UINT16_MAX - 1) * rangeResolution(LIGHT_RANGES[LIGHT_RANGE_WIDEST]), 1.0f, false, 0
+};
+
+// Detector with BH1750 limits
+Bh1750Sensor::Detectors::Detectors()
+  : lightLevel(LIGHT_LIMITS) {
+}
+
+// Check sample, saturated readings become NAN
+void Bh1750Sensor::Detectors::check(Channels& channels, Anomalies& anomalies, uint32_t now) {
+  anomalies.lightLevelFlags = lightLevel.check(channels.lightLevel, now);
+}
+
+// Serialize detector statistics
+void Bh1750Sensor::Detectors::writeJSON(JsonWriter& json) const {
+  lightLevel.writeJSON(json, "light");
+}
+
+// Add flagged BH1750 channel
+void Bh1750Sensor::writeAnomalyJSON(const Anomalies& anomalies, JsonWriter& json) {
+  ::writeAnomalyJSON(json, "light", anomalies.lightLevelFlags);
+}
+
+// Add BH1750 as a single raw sensor element
+void Bh1750Sensor::writeRawJSON(JsonWriter& json) const {
+  json.beginObject();
+  json.addString("type", NAME);
+  json.addUInt("bus", 2);
+  json.addUInt("address", BH1750_I2C_ADDR);
+  json.addBool("online", m_state.online);
+  json.addUInt("recoveries", m_state.recoveryCount);
+  writeJSON(m_raw, json);
+  json.addUInt("rangeLux", (uint32_t)getRangeLux());
+  json.addFloat("resolution", getResolution(), 3);
+  json.addUInt("mtreg", LIGHT_RANGES[m_range].mtreg);
+  json.endObject();
+}
@@ -0,0 +1,146 @@
+/*
+ * BH1750 Driver for ESP32 Weather Station
+ * Ambient light on I2C Bus #2, auto-ranging over 0.11 lux - 120 klux
+ * start() triggers a one-time conversion, collect() reads it once finished.
+ * SensorManager schedules the collect for getConversionTime() after the
+ * start, so a read never waits for the conversion and is never a sweep old
+ */
+
+#ifndef BH1750_SENSOR_H
+#define BH1750_SENSOR_H
+
+#include "Config.h"
+#include "I2CRecovery.h"
+#include "JsonWriter.h"
+#include "LineWriter.h"
+#include "FilterPipeline.h"
+#include "AdaptiveInterval.h"
+#include "AnomalyDetector.h"
+
+class Bh1750Sensor {
+public:
+  static constexpr bool ENABLED = SENSOR_BH1750_ENABLED;
+  static constexpr const char* NAME = "BH1750";
+
+  // Channels contributed to SensorData
+  struct Channels {
+    float lightLevel = NAN;  // lux
+  };
+
+  // Per-channel filters for high-rate sampling mode
+  struct Filters {
+    FilterPipeline lightLevel{10.0f};  // 0.1 lux
+
+    void push(const Channels& channels);
+    void decimate(Channels& channels);
+  };
+
+  // Anomaly flags contributed to SensorData (AnomalyFlag bits)
+  struct Anomalies {
+    uint8_t lightLevelFlags = ANOMALY_NONE;
+
+    inline uint8_t any() const {
+      return lightLevelFlags;
+    }
+  };
+
+  // Anomaly detector (saturation only - light legitimately jumps and sits still)
+  struct Detectors {
+    AnomalyDetector lightLevel;
+
+    Detectors();
+    void check(Channels& channels, Anomalies& anomalies, uint32_t now);
+    void writeJSON(JsonWriter& json) const;
+  };
+
+  // Constructor
+  Bh1750Sensor();
+
+  // Initialize I2C Bus #2 and probe sensor
+  bool begin();
+
+  // Clear Bus #2 (unless a BME280 still answers on it), re-init it and re-probe sensor
+  bool recover();
+
+  // Read phase 1: trigger a one-time conversion in the range the last reading
+  // calls for (a finished one nobody collected is fetched first)
+  bool start();
+
+  // Time until the conversion in flight has finished (ms)
+  uint32_t getConversionTime() const;
+
+  // Read phase 2: fetch the finished conversion and pick the next range from
+  // it. Returns the previous reading while still converting
+  bool collect(Channels& channels);
+
+  // Mark channels as unavailable
+  static void clear(Channels& channels);
+
+  // Light level must be a finite number
+  static bool validate(const Channels& channels);
+
+  // Channel change in deadband units (adaptive sampling)
+  static float change(const Channels& from, const Channels& to);
+
+  // Serialize channels into API response
+  static void writeJSON(const Channels& channels, JsonWriter& json);
+
+  // Append channel as line protocol field (uploader)
+  static void writeLine(const Channels& channels, LineWriter& line);
+
+  // Channel field by its JSON key (nullptr if unknown) - chart queries
+  static float Channels::* findChannel(const char* name);
+
+  // Serialize flagged channel into API response
+  static void writeAnomalyJSON(const Anomalies& anomalies, JsonWriter& json);
+
+  // Serialize sensor with its last raw value, range and resolution
+  void writeRawJSON(JsonWriter& json) const;
+
+  // Full scale of the current range (lux)
+  float getRangeLux() const;
+
+  // Lux per count of the current range
+  float getResolution() const;
+
+  // Recovery state
+  inline BusState& state() {
+    return m_state;
+  }
+
+  inline const BusState& state() const {
+    return m_state;
+  }
+
+private:
+  BusState m_state;
+  Channels m_raw;          // Last finished reading (published until the next one)
+
+  // Auto-ranging
+  uint8_t m_range;         // Index into the range table (0 = most sensitive)
+  uint8_t m_mtreg;         // MTreg value in the sensor (0 = unknown)
+
+  // One-time conversion in flight
+  bool m_converting;
+  uint32_t m_conversionStart;
+
+  // Set measurement time register (skipped if already set)
+  bool writeMtreg(uint8_t mtreg);
+
+  // Write a single opcode
+  bool writeCommand(uint8_t opcode);
+
+  // Read the 16-bit result of the last conversion
+  bool readResult(uint16_t& raw);
+
+  // Start a one-time conversion in the current range
+  bool trigger();
+
+  // Read the finished conversion into m_raw and select the next range
+  bool fetch();
+
+  // Range for the next conversion after a reading of the current range
+  uint8_t selectRange(uint16_t raw, float lux) const;
+};
+
+#endif // BH1750_SENSOR_H
@@ -0,0 +1,461 @@
+/*
+ * BME280/BMP280 Driver Implementation
+ */
+
+#include "Bme280Sensor.h"
+
+// BME280 registers used directly (library only offers blocking forced reads
+// and fixed settings - sampling profiles are written here)
+constexpr uint8_t BME280_REG_CTRL_HUM = 0xF2;
+constexpr uint8_t BME280_REG_STATUS = 0xF3;
+constexpr uint8_t BME280_REG_CTRL_MEAS = 0xF4;
+constexpr uint8_t BME280_REG_CONFIG = 0xF5;
+constexpr uint8_t BME280_STATUS_MEASURING = 0x08;
+
+// ctrl_meas mode bits [1:0]
+constexpr uint8_t BME280_MODE_SLEEP = 0x00;
+constexpr uint8_t BME280_MODE_FORCED = 0x01;
+constexpr uint8_t BME280_MODE_NORMAL = 0x03;
+
+// Candidate (bus, address) slots probed during discovery
+struct Bme280Candidate {
+  uint8_t busNumber;
+  uint8_t address;
+};
+
+static constexpr Bme280Candidate BME280_CANDIDATES[] = {
+  { 1, BME_I2C_ADDR },
+  { 1, BME_I2C_ADDR_ALT },
+  { 2, BME_I2C_ADDR },
+  { 2, BME_I2C_ADDR_ALT },
+};
+
+// Constructor
+Bme280Sensor::Bme280Sensor()
+  : m_instanceCount(0),
+    m_startTime(0),
+    m_ctrlMeas(0),
+    m_ctrlHum(0),
+    m_config(0),
+    m_conversionTimeoutMs(BME280_CONVERSION_TIMEOUT_MS),
+    m_conversionMs(0) {
+}
+
+// Initialize I2C bus(es) and discover BME280/BMP280 sensors
+bool Bme280Sensor::begin() {
+  // Initialize I2C Bus #1 with custom pins
+  i2cBus1.begin(I2C1_SDA_PIN, I2C1_SCL_PIN);
+  i2cBus1.setClock(I2C_CLOCK_SPEED);
+
+  #if DEBUG_SERIAL_ENABLED
+  Serial.printf("[I2C] Bus #1 init: SDA=%d, SCL=%d @ %dkHz\n",
+                I2C1_SDA_PIN, I2C1_SCL_PIN, I2C_CLOCK_SPEED / 1000);
+  #endif
+
+  if (BME280_SCAN_BUS2) {
+    // Bus #2 may already be running for the BH1750 - begin() keeps it as is
+    i2cBus2.begin(I2C2_SDA_PIN, I2C2_SCL_PIN);
+    i2cBus2.setClock(I2C_CLOCK_SPEED);
+  }
+
+  m_instanceCount = 0;
+
+  for (const Bme280Candidate& candidate : BME280_CANDIDATES) {
+    if (m_instanceCount >= BME280_MAX_INSTANCES) {
+      break;
+    }
+    if (candidate.busNumber == 2 && !BME280_SCAN_BUS2) {
+      continue;
+    }
+
+    Instance& instance = m_instances[m_instanceCount];
+    instance.wire = (candidate.busNumber == 1) ? &i2cBus1 : &i2cBus2;
+    instance.busNumber = candidate.busNumber;
+    instance.address = candidate.address;
+    instance.state = BusState();
+    instance.raw = Channels();
+
+    // Skip empty slots quickly - only an ACKing address is initialized
+    if (!probeI2CDevice(*instance.wire, instance.address)) {
+      continue;
+    }
+
+    if (beginInstance(instance)) {
+      markOnline(instance.state);
+      m_instanceCount++;
+
+      #if DEBUG_SERIAL_ENABLED
+      Serial.printf("[I2C] BME280 ready on bus #%d at 0x%02X\n",
+                    instance.busNumber, instance.address);
+      #endif
+    }
+  }
+
+  if (m_instanceCount == 0) {
+    // Always show sensor errors
+    Serial.println("[ERROR] No BME280 found at 0x76/0x77");
+    return false;
+  }
+
+  return true;
+}
+
+// Recover BME280 array: clear bus(es), re-init them and rediscover sensors
+bool Bme280Sensor::recover() {
+  if (!clearI2CBus(i2cBus1, I2C1_SDA_PIN, I2C1_SCL_PIN)) {
+    Serial.println("[ERROR] Bus #1 still stuck after clear");
+  }
+
+  // Bus #2 is shared with the BH1750 - only clear it if it carries a BME280
+  for (uint8_t i = 0; i < m_instanceCount; i++) {
+    if (m_instances[i].busNumber == 2) {
+      if (!clearI2CBus(i2cBus2, I2C2_SDA_PIN, I2C2_SCL_PIN)) {
+        Serial.println("[ERROR] Bus #2 still stuck after clear");
+      }
+      break;
+    }
+  }
+
+  return begin();
+}
+
+// Derive register values from the profile and reconfigure online sensors
+void Bme280Sensor::applyProfile(const SamplingProfile& profile) {
+  m_ctrlMeas = (profile.osrsTemperature << 5) | (profile.osrsPressure << 2);
+  m_ctrlHum = profile.osrsHumidity;
+  m_config = (profile.standby << 5) | (profile.filter << 2);
+
+  // x16 pressure needs up to ~46 ms - wait for the worst case, never less than the configured timeout
+  const uint32_t worstCaseMs = (SamplingProfiles::getConversionTimeUs(profile, true) + 999) / 1000;
+  m_conversionTimeoutMs = max<uint32_t>(worstCaseMs + 2, BME280_CONVERSION_TIMEOUT_MS);
+  m_conversionMs = worstCaseMs;
+
+  for (uint8_t i = 0; i < m_instanceCount; i++) {
+    Instance& instance = m_instances[i];
+    if (instance.state.online && !configureInstance(instance)) {
+      recordFailure(instance.state, millis());
+    }
+  }
+}
+
+// Trigger forced measurement on all sensors so conversions run in parallel
+bool Bme280Sensor::start() {
+  const uint32_t currentTime = millis();
+  bool anyPending = false;
+
+  m_startTime = currentTime;
+
+  for (uint8_t i = 0; i < m_instanceCount; i++) {
+    Instance& instance = m_instances[i];
+
+    // Re-probe a single failed sensor without disturbing the rest of its bus
+    if (isRetryDue(instance.state, currentTime)) {
+      if (probeI2CDevice(*instance.wire, instance.address) && beginInstance(instance)) {
+        markOnline(instance.state);
+        instance.state.recoveryCount++;
+      } else {
+        scheduleRetry(instance.state, currentTime);
+      }
+    }
+
+    instance.measurementPending = false;
+    if (!instance.state.online) {
+      continue;
+    }
+
+    TwoWire& wire = *instance.wire;
+    wire.beginTransmission(instance.address);
+    #if !HIGH_RATE_SAMPLING_ENABLED
+    wire.write(BME280_REG_CTRL_MEAS);
+    wire.write(m_ctrlMeas | BME280_MODE_FORCED);
+    #endif
+
+    if (wire.endTransmission() == 0) {
+      instance.measurementPending = true;
+      anyPending = true;
+    } else {
+      recordFailure(instance.state, currentTime);
+      instance.raw = Channels();
+    }
+  }
+
+  return anyPending;
+}
+
+// Remaining worst-case conversion time since start()
+uint32_t Bme280Sensor::getConversionTime() const {
+  #if HIGH_RATE_SAMPLING_ENABLED
+  return 0;
+  #else
+  const uint32_t elapsed = millis() - m_startTime;
+  return elapsed < m_conversionMs ? m_conversionMs - elapsed : 0;
+  #endif
+}
+
+// Read every finished sensor and fuse the results
+bool Bme280Sensor::collect(Channels& channels) {
+  float temperatures[BME280_MAX_INSTANCES];
+  float humidities[BME280_MAX_INSTANCES];
+  float pressures[BME280_MAX_INSTANCES];
+  uint8_t count = 0;
+
+  for (uint8_t i = 0; i < m_instanceCount; i++) {
+    Instance& instance = m_instances[i];
+
+    if (!instance.measurementPending) {
+      continue;
+    }
+    instance.measurementPending = false;
+
+    #if HIGH_RATE_SAMPLING_ENABLED
+    const bool ready = true;  // Data registers are shadowed - always consistent
+    #else
+    const bool ready = waitForConversion(instance);
+    #endif
+
+    if (ready) {
+      instance.raw.temperature = instance.bme.readTemperature();
+      instance.raw.humidity = instance.bme.readHumidity();
+      instance.raw.pressure = instance.bme.readPressure();
+    } else {
+      instance.raw = Channels();
+    }
+
+    if (!validate(instance.raw)) {
+      recordFailure(instance.state, millis());
+      continue;
+    }
+
+    markOnline(instance.state);
+    temperatures[count] = instance.raw.temperature;
+    humidities[count] = instance.raw.humidity;
+    pressures[count] = instance.raw.pressure;
+    count++;
+  }
+
+  channels.temperature = fuse(temperatures, count, BME280_FUSION_MAX_DEV_TEMPERATURE);
+  channels.humidity = fuse(humidities, count, BME280_FUSION_MAX_DEV_HUMIDITY);
+  channels.pressure = fuse(pressures, count, BME280_FUSION_MAX_DEV_PRESSURE);
+
+  return validate(channels);
+}
+
+// Mark channels as unavailable
+void Bme280Sensor::clear(Channels& channels) {
+  channels.temperature = NAN;
+  channels.humidity = NAN;
+  channels.pressure = NAN;
+}
+
+// Check if BME280 readings are valid (temperature and pressure are critical)
+bool Bme280Sensor::validate(const Channels& channels) {
+  // Note: Humidity might be NaN on BMP280 (lacks humidity sensor)
+  // This is acceptable and doesn't affect overall validity
+  return isfinite(channels.temperature) && isfinite(channels.pressure);
+}
+
+// Largest channel change in deadband units
+float Bme280Sensor::change(const Channels& from, const Channels& to) {
+  return max(channelChange(from.temperature, to.temperature, ADAPTIVE_DEADBAND_TEMPERATURE),
+             max(channelChange(from.humidity, to.humidity, ADAPTIVE_DEADBAND_HUMIDITY),
+                 channelChange(from.pressure, to.pressure, ADAPTIVE_DEADBAND_PRESSURE)));
+}
+
+// Add BME280 sensor data (temperature, humidity, pressure)
+void Bme280Sensor::writeJSON(const Channels& channels, JsonWriter& json) {
+  json.addFloat("temperature", channels.temperature);
+  json.addFloat("humidity", channels.humidity);  // null on BMP280 variant
+  json.addFloat("pressure", channels.pressure);
+}
+
+// Add fused channels as line protocol fields (NaN channels are omitted)
+void Bme280Sensor::writeLine(const Channels& channels, LineWriter& line) {
+  line.addFloat("temperature", channels.temperature);
+  line.addFloat("humidity", channels.humidity);
+  line.addFloat("pressure", channels.pressure);
+}
+
+// Map JSON key to fused channel
+float Bme280Sensor::Channels::* Bme280Sensor::findChannel(const char* name) {
+  if (strcmp(name, "temperature") == 0) {
+    return &Channels::temperature;
+  }
+  if (strcmp(name, "humidity") == 0) {
+    return &Channels::humidity;
+  }
+  if (strcmp(name, "pressure") == 0) {
+    return &Channels::pressure;
+  }
+  return nullptr;
+}
+
+// Add one element per discovered sensor with its unfused values
+void Bme280Sensor::writeRawJSON(JsonWriter& json) const {
+  for (uint8_t i = 0; i < m_instanceCount; i++) {
+    const Instance& instance = m_instances[i];
+
+    json.beginObject();
+    json.addString("type", NAME);
+    json.addUInt("bus", instance.busNumber);
+    json.addUInt("address", instance.address);
+    json.addBool("online", instance.state.online);
+    json.addUInt("recoveries", instance.state.recoveryCount);
+    writeJSON(instance.raw, json);
+    json.endObject();
+  }
+}
+
+// Feed fused high-rate sample into channel filters
+void Bme280Sensor::Filters::push(const Channels& channels) {
+  temperature.push(channels.temperature);
+  humidity.push(channels.humidity);
+  pressure.push(channels.pressure);
+}
+
+// Publish decimated channel values
+void Bme280Sensor::Filters::decimate(Channels& channels) {
+  channels.temperature = temperature.decimate();
+  channels.humidity = humidity.decimate();
+  channels.pressure = pressure.decimate();
+}
+
+// Physical ranges (datasheet operating range) and detection settings
+static const AnomalyLimits TEMPERATURE_LIMITS = {
+  -40.0f, 85.0f, ANOMALY_MIN_SPREAD_TEMPERATURE, true, ANOMALY_STUCK_MS
+};
+static const AnomalyLimits HUMIDITY_LIMITS = {
+  0.0f, 100.0f, ANOMALY_MIN_SPREAD_HUMIDITY, true, ANOMALY_STUCK_MS
+};
+static const AnomalyLimits PRESSURE_LIMITS = {
+  30000.0f, 110000.0f, ANOMALY_MIN_SPREAD_PRESSURE, true, ANOMALY_STUCK_MS
+};
+
+// Detectors with BME280 channel limits
+Bme280Sensor::Detectors::Detectors()
+  : temperature(TEMPERATURE_LIMITS),
+    humidity(HUMIDITY_LIMITS),
+    pressure(PRESSURE_LIMITS) {
+}
+
+// Check fused sample, rejected channels become NAN
+void Bme280Sensor::Detectors::check(Channels& channels, Anomalies& anomalies, uint32_t now) {
+  anomalies.temperatureFlags = temperature.check(channels.temperature, now);
+  anomalies.humidityFlags = humidity.check(channels.humidity, now);
+  anomalies.pressureFlags = pressure.check(channels.pressure, now);
+}
+
+// Serialize detector statistics per channel
+void Bme280Sensor::Detectors::writeJSON(JsonWriter& json) const {
+  temperature.writeJSON(json, "temperature");
+  humidity.writeJSON(json, "humidity");
+  pressure.writeJSON(json, "pressure");
+}
+
+// Add flagged BME280 channels
+void Bme280Sensor::writeAnomalyJSON(const Anomalies& anomalies, JsonWriter& json) {
+  ::writeAnomalyJSON(json, "temperature", anomalies.temperatureFlags);
+  ::writeAnomalyJSON(json, "humidity", anomalies.humidityFlags);
+  ::writeAnomalyJSON(json, "pressure", anomalies.pressureFlags);
+}
+
+// Probe and configure a single sensor
+bool Bme280Sensor::beginInstance(Instance& instance) {
+  if (!instance.bme.begin(instance.address, instance.wire)) {
+    return false;
+  }
+
+  return configureInstance(instance);
+}
+
+// Sleep first (config is only reliably written in sleep mode), then ctrl_hum,
+// config and ctrl_meas. High-rate sampling free-runs in normal mode with the
+// profile's standby; otherwise the sensor sleeps until start() forces a conversion
+bool Bme280Sensor::configureInstance(Instance& instance) {
+  #if HIGH_RATE_SAMPLING_ENABLED
+  const uint8_t mode = BME280_MODE_NORMAL;
+  #else
+  const uint8_t mode = BME280_MODE_SLEEP;
+  #endif
+
+  const uint8_t writes[][2] = {
+    { BME280_REG_CTRL_MEAS, (uint8_t)(m_ctrlMeas | BME280_MODE_SLEEP) },
+    { BME280_REG_CTRL_HUM, m_ctrlHum },
+    { BME280_REG_CONFIG, m_config },
+    { BME280_REG_CTRL_MEAS, (uint8_t)(m_ctrlMeas | mode) }
+  };
+
+  TwoWire& wire = *instance.wire;
+  for (const auto& write : writes) {
+    wire.beginTransmission(instance.address);
+    wire.write(write[0]);
+    wire.write(write[1]);
+    if (wire.endTransmission() != 0) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Poll status register until the conversion has finished or timed out
+// (polled at least once - a collect scheduled behind a slower sensor comes late)
+bool Bme280Sensor::waitForConversion(const Instance& instance) const {
+  TwoWire& wire = *instance.wire;
+
+  for (;;) {
+    wire.beginTransmission(instance.address);
+    wire.write(BME280_REG_STATUS);
+    if (wire.endTransmission(false) != 0 || wire.requestFrom(instance.address, (uint8_t)1) != 1) {
+      return false;
+    }
+
+    if ((wire.read() & BME280_STATUS_MEASURING) == 0) {
+      return true;
+    }
+    if (millis() - m_startTime >= m_conversionTimeoutMs) {
+      return false;
+    }
+
+    // Conversion takes 5-48 ms depending on the profile - yield instead of hammering the bus
+    delay(1);
+  }
+}
+
+// Robust fusion: median, then average of readings close to it
+// A single sun-heated or glitching sensor is outvoted when 3+ sensors agree
+float Bme280Sensor::fuse(const float* values, uint8_t count, float maxDeviation) {
+  float sorted[BME280_MAX_INSTANCES];
+  uint8_t n = 0;
+
+  // Insertion sort of finite values (N <= 4)
+  for (uint8_t i = 0; i < count; i++) {
+    if (!isfinite(values[i])) {
+      continue;
+    }
+
+    uint8_t j = n++;
+    while (j > 0 && sorted[j - 1] > values[i]) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = values[i];
+  }
+
+  if (n == 0) {
+    return NAN;
+  }
+
+  const float median = (n % 2) ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) * 0.5f;
+
+  float sum = 0.0f;
+  uint8_t inliers = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    if (fabsf(sorted[i] - median) <= maxDeviation) {
+      sum += sorted[i];
+      inliers++;
+    }
+  }
+
+  // Two sensors disagreeing by more than 2x the limit - fall back to median
+  return inliers > 0 ? sum / inliers : median;
+}
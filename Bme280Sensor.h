@@ -0,0 +1,174 @@
+/*
+ * BME280/BMP280 Driver for ESP32 Weather Station
+ * Temperature, humidity and pressure from an array of BME280s
+ * discovered at runtime on I2C Bus #1 (and optionally Bus #2)
+ * Readings are fused with median-based outlier rejection
+ */
+
+#ifndef BME280_SENSOR_H
+#define BME280_SENSOR_H
+
+#include <Adafruit_Sensor.h>
+#include <Adafruit_BME280.h>
+#include "Config.h"
+#include "I2CRecovery.h"
+#include "JsonWriter.h"
+#include "LineWriter.h"
+#include "FilterPipeline.h"
+#include "AdaptiveInterval.h"
+#include "AnomalyDetector.h"
+#include "SamplingProfiles.h"
+
+class Bme280Sensor {
+public:
+  static constexpr bool ENABLED = SENSOR_BME280_ENABLED;
+  static constexpr const char* NAME = "BME280";
+
+  // Channels contributed to SensorData
+  struct Channels {
+    float temperature = NAN;  // °C
+    float humidity = NAN;     // %RH (NaN on BMP280 - no humidity sensor)
+    float pressure = NAN;     // Pa
+  };
+
+  // Per-channel filters for high-rate sampling mode
+  struct Filters {
+    FilterPipeline temperature{100.0f};  // 0.01 °C
+    FilterPipeline humidity{100.0f};     // 0.01 %RH
+    FilterPipeline pressure{10.0f};      // 0.1 Pa
+
+    void push(const Channels& channels);
+    void decimate(Channels& channels);
+  };
+
+  // Per-channel anomaly flags contributed to SensorData (AnomalyFlag bits)
+  struct Anomalies {
+    uint8_t temperatureFlags = ANOMALY_NONE;
+    uint8_t humidityFlags = ANOMALY_NONE;
+    uint8_t pressureFlags = ANOMALY_NONE;
+
+    inline uint8_t any() const {
+      return temperatureFlags | humidityFlags | pressureFlags;
+    }
+  };
+
+  // Per-channel anomaly detectors (fused values)
+  struct Detectors {
+    AnomalyDetector temperature;
+    AnomalyDetector humidity;
+    AnomalyDetector pressure;
+
+    Detectors();
+    void check(Channels& channels, Anomalies& anomalies, uint32_t now);
+    void writeJSON(JsonWriter& json) const;
+  };
+
+  // Single physical sensor of the array
+  struct Instance {
+    Adafruit_BME280 bme;
+    TwoWire* wire = nullptr;
+    uint8_t busNumber = 0;
+    uint8_t address = 0;
+    bool measurementPending = false;
+    BusState state;
+    Channels raw;             // Last unfused reading
+  };
+
+  // Constructor
+  Bme280Sensor();
+
+  // Initialize I2C bus(es) and discover all responding sensors
+  bool begin();
+
+  // Clear buses, re-init them and rediscover sensors
+  bool recover();
+
+  // Use oversampling / IIR / standby of a profile for every sensor
+  // (online sensors are reconfigured right away, others when discovered)
+  // Must be called once before begin()
+  void applyProfile(const SamplingProfile& profile);
+
+  // Read phase 1: trigger forced conversion on every sensor at once
+  // (normal mode: sensors free-run, only check they still answer)
+  bool start();
+
+  // Time until the conversions triggered by start() have finished (ms,
+  // worst case of the profile - 0 in normal mode)
+  uint32_t getConversionTime() const;
+
+  // Read phase 2: wait for conversions, read every sensor and fuse
+  // (normal mode: read latest conversion without waiting)
+  bool collect(Channels& channels);
+
+  // Mark channels as unavailable
+  static void clear(Channels& channels);
+
+  // Temperature and pressure are critical, humidity is optional
+  static bool validate(const Channels& channels);
+
+  // Largest channel change in deadband units (adaptive sampling)
+  static float change(const Channels& from, const Channels& to);
+
+  // Serialize fused channels into API response
+  static void writeJSON(const Channels& channels, JsonWriter& json);
+
+  // Append fused channels as line protocol fields (uploader)
+  static void writeLine(const Channels& channels, LineWriter& line);
+
+  // Channel field by its JSON key (nullptr if unknown) - chart queries
+  static float Channels::* findChannel(const char* name);
+
+  // Serialize flagged channels into API response
+  static void writeAnomalyJSON(const Anomalies& anomalies, JsonWriter& json);
+
+  // Serialize every discovered sensor with its raw values
+  void writeRawJSON(JsonWriter& json) const;
+
+  // Number of discovered sensors
+  inline uint8_t getInstanceCount() const {
+    return m_instanceCount;
+  }
+
+  // Get discovered sensor (index < getInstanceCount())
+  inline const Instance& getInstance(uint8_t index) const {
+    return m_instances[index];
+  }
+
+  // Recovery state (online while at least one sensor answers)
+  inline BusState& state() {
+    return m_state;
+  }
+
+  inline const BusState& state() const {
+    return m_state;
+  }
+
+private:
+  Instance m_instances[BME280_MAX_INSTANCES];
+  uint8_t m_instanceCount;
+  BusState m_state;
+
+  // millis() when the current conversion was triggered
+  uint32_t m_startTime;
+
+  // Register values of the active sampling profile
+  uint8_t m_ctrlMeas;   // osrs_t / osrs_p, mode bits cleared
+  uint8_t m_ctrlHum;
+  uint8_t m_config;
+  uint32_t m_conversionTimeoutMs;
+  uint32_t m_conversionMs;  // Worst-case forced conversion of the profile
+
+  // Probe and configure a single sensor
+  bool beginInstance(Instance& instance);
+
+  // Write profile registers (ctrl_hum takes effect with the ctrl_meas write)
+  bool configureInstance(Instance& instance);
+
+  // Wait until a triggered conversion has finished
+  bool waitForConversion(const Instance& instance) const;
+
+  // Median of finite values, then mean of values within maxDeviation of it
+  static float fuse(const float* values, uint8_t count, float maxDeviation);
+};
+
+#endif // BME280_SENSOR_H
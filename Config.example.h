@@ -31,6 +31,19 @@ constexpr uint16_t WIFI_CONNECT_DELAY_MS = 7000;
 constexpr uint8_t I2C1_SDA_PIN = 19;
 constexpr uint8_t I2C1_SCL_PIN = 21;
 constexpr uint8_t BME_I2C_ADDR = 0x76;
+constexpr uint8_t BME_I2C_ADDR_ALT = 0x77;   // Second BME280 (SDO pulled high)
+
+// BME280 array - every address is probed on Bus #1 (and Bus #2 if enabled)
+// Readings of all responding sensors are fused into one published value
+constexpr bool BME280_SCAN_BUS2 = true;           // Also look for BME280s on Bus #2
+constexpr uint8_t BME280_MAX_INSTANCES = 4;        // 2 addresses x 2 buses
+constexpr uint16_t BME280_CONVERSION_TIMEOUT_MS = 50;
+
+// Fusion outlier rejection - readings further than this from the median are
+// dropped before averaging (needs 3+ sensors to outvote a bad one)
+constexpr float BME280_FUSION_MAX_DEV_TEMPERATURE = 1.5f;  // °C
+constexpr float BME280_FUSION_MAX_DEV_HUMIDITY = 5.0f;     // %RH
+constexpr float BME280_FUSION_MAX_DEV_PRESSURE = 150.0f;   // Pa
 
 // ============================================================================
 // I2C Bus #2 - BH1750 Configuration
@@ -39,15 +52,60 @@ constexpr uint8_t I2C2_SDA_PIN = 27;
 constexpr uint8_t I2C2_SCL_PIN = 26;
 constexpr uint8_t BH1750_I2C_ADDR = 0x23;
 
+// Auto-ranging - step to a less sensitive range when a reading passes this
+// fraction of full scale, pick the most sensitive range that holds the reading
+// below BH1750_RANGE_DOWN_FRACTION of its full scale (gap = hysteresis)
+constexpr float BH1750_RANGE_UP_FRACTION = 0.9f;
+constexpr float BH1750_RANGE_DOWN_FRACTION = 0.45f;
+
 // ============================================================================
 // I2C Common Configuration
 // ============================================================================
 constexpr uint32_t I2C_CLOCK_SPEED = 100000;  // 100 kHz (Standard Mode, power saving)
 
+// ============================================================================
+// I2C Bus Recovery Configuration
+// ============================================================================
+constexpr uint8_t I2C_RECOVERY_FAILURE_THRESHOLD = 2;      // Consecutive failed reads before recovery
+constexpr uint8_t I2C_RECOVERY_CLOCK_PULSES = 9;           // SCL pulses to release a stuck SDA line
+constexpr uint8_t I2C_RECOVERY_HALF_PERIOD_US = 5;         // SCL half period during bus clear (~100 kHz)
+constexpr uint32_t I2C_RECOVERY_INITIAL_BACKOFF_MS = 1000; // First retry delay after a failed recovery
+constexpr uint32_t I2C_RECOVERY_MAX_BACKOFF_MS = 60000;    // Retry delay cap (doubles until reached)
+
 // ============================================================================
 // Measurement Configuration
 // ============================================================================
-constexpr uint32_t MEASUREMENT_INTERVAL_MS = 5000;  // 5 seconds between readings
+// Sampling profile (BME280 oversampling, IIR filter, standby + measurement interval)
+// used until another one is selected over /api/v1/sampling (persisted in NVS):
+// "low-power" (x1, 60 s), "balanced" (x2, 5 s), "high-precision" (x16 pressure, IIR 4, 10 s),
+// "high-rate" (x1, 1 s)
+constexpr const char* SAMPLING_DEFAULT_PROFILE = "balanced";
+
+// High-rate sampling - sensors are sampled internally at HIGH_RATE_SAMPLE_INTERVAL_MS
+// (BME280 in normal mode) and filtered per channel: median-of-3 spike rejection,
+// boxcar decimation to the profile interval, then EMA. Only the decimated
+// value is published, so the API cadence is unchanged.
+#define HIGH_RATE_SAMPLING_ENABLED false
+constexpr uint32_t HIGH_RATE_SAMPLE_INTERVAL_MS = 200;  // 5 Hz internal rate
+constexpr uint8_t HIGH_RATE_EMA_SHIFT = 2;              // EMA alpha = 1/2^shift
+
+// Adaptive sampling - each sensor's period is stretched while readings are
+// flat and shortened during fast or noisy changes (fronts, sunrise).
+// Data is published only when a channel moves by more than its deadband,
+// or every ADAPTIVE_MAX_INTERVAL_MS as a heartbeat.
+// Not combinable with HIGH_RATE_SAMPLING_ENABLED.
+#define ADAPTIVE_SAMPLING_ENABLED false
+constexpr uint32_t ADAPTIVE_MIN_INTERVAL_MS = 1000;
+constexpr uint32_t ADAPTIVE_MAX_INTERVAL_MS = 60000;
+constexpr float ADAPTIVE_TARGET_CHANGE = 0.5f;   // Deadbands of change expected per sample
+constexpr float ADAPTIVE_SMOOTHING = 0.3f;       // EWMA weight of newest rate estimate
+
+// Publish deadbands (change that counts as an event)
+constexpr float ADAPTIVE_DEADBAND_TEMPERATURE = 0.1f;  // °C
+constexpr float ADAPTIVE_DEADBAND_HUMIDITY = 0.5f;     // %RH
+constexpr float ADAPTIVE_DEADBAND_PRESSURE = 10.0f;    // Pa
+constexpr float ADAPTIVE_DEADBAND_LIGHT = 0.05f;       // Relative (5%)
+constexpr float ADAPTIVE_DEADBAND_LIGHT_MIN = 1.0f;    // lux (floor in darkness)
 
 // ============================================================================
 // Serial Communication
@@ -59,7 +117,155 @@ constexpr uint16_t SERIAL_INIT_TIMEOUT_MS = 2000;
 // HTTP Server Configuration
 // ============================================================================
 constexpr uint16_t HTTP_SERVER_PORT = 80;
-constexpr uint16_t JSON_BUFFER_SIZE = 200;
+constexpr uint16_t RESPONSE_ARENA_SIZE = 4096;  // Static buffer shared by all JSON responses
+constexpr uint16_t HTTP_REQUEST_BUFFER_SIZE = 2048;  // Static buffer for request line, headers and form body
+constexpr uint32_t HTTP_CLIENT_TIMEOUT_MS = 1000;    // Request must arrive / response must drain within this
+constexpr uint8_t HTTP_MAX_ROUTES = 24;
+constexpr uint8_t HTTP_MAX_ARGS = 8;                 // Query and form arguments kept per request
+
+// Credentials for state-changing API calls (HTTP basic auth - plain HTTP, trusted LAN only)
+constexpr const char* API_USERNAME = "admin";
+constexpr const char* API_PASSWORD = "CHANGE_ME";
+
+// Heap accounting per route (/api/v1/system/heap)
+#define HEAP_MONITOR_ENABLED true
+constexpr uint8_t HEAP_MONITOR_MAX_ROUTES = 16;
+
+// Count every allocation a handler makes (ESP-IDF heap hooks - needs
+// CONFIG_HEAP_USE_HOOKS in the sdkconfig, otherwise the counts read null)
+#define HEAP_MONITOR_ALLOC_HOOKS false
+
+// ============================================================================
+// Upload Configuration (batched push to a time-series backend)
+// ============================================================================
+#define UPLOAD_ENABLED false
+// InfluxDB 2.x write endpoint - precision must be seconds
+constexpr const char* UPLOAD_URL = "http://192.168.1.10:8086/api/v2/write?org=home&bucket=weather&precision=s";
+constexpr const char* UPLOAD_TOKEN = "";                // API token (empty = no Authorization header)
+constexpr const char* UPLOAD_MEASUREMENT = "weather";
+constexpr const char* UPLOAD_STATION = "esp32";         // Value of the station tag
+constexpr uint16_t UPLOAD_BATCH_SIZE = 12;              // Samples per request (1 min at 5 s)
+constexpr uint32_t UPLOAD_FLUSH_INTERVAL_MS = 60000;    // Send a partial batch once its oldest sample waited this long
+constexpr uint16_t UPLOAD_BACKLOG_SIZE = 720;           // Samples kept during outages (1 h at 5 s, ~32 bytes each)
+constexpr uint32_t UPLOAD_DRAIN_INTERVAL_MS = 1000;     // Minimum gap between batches (backlog drain rate)
+constexpr uint32_t UPLOAD_RETRY_MIN_MS = 5000;          // Backoff after a failed request...
+constexpr uint32_t UPLOAD_RETRY_MAX_MS = 300000;        // ...doubling up to 5 minutes
+constexpr uint16_t UPLOAD_TIMEOUT_MS = 5000;            // Connect / response timeout
+constexpr uint16_t UPLOAD_BUFFER_SIZE = 2048;           // Request body (~120 bytes per sample)
+constexpr uint32_t UPLOAD_TASK_STACK_SIZE = 6144;
+
+// ============================================================================
+// MQTT Configuration (built-in publisher, no bridge needed)
+// ============================================================================
+#define MQTT_ENABLED false
+#define MQTT_PER_CHANNEL_TOPICS false  // true: <prefix>/<channel> per value, false: JSON on <prefix>/state
+constexpr const char* MQTT_HOST = "192.168.1.10";
+constexpr uint16_t MQTT_PORT = 1883;
+constexpr const char* MQTT_CLIENT_ID = "weather-station";
+constexpr const char* MQTT_USERNAME = "";              // Empty = anonymous
+constexpr const char* MQTT_PASSWORD = "";
+constexpr const char* MQTT_TOPIC_PREFIX = "weather/esp32";  // Last will on <prefix>/status
+constexpr uint8_t MQTT_QOS = 1;                         // 0 or 1
+constexpr bool MQTT_RETAIN = true;
+constexpr uint8_t MQTT_QUEUE_SIZE = 16;                 // Outbound messages (oldest dropped when full)
+constexpr uint8_t MQTT_TOPIC_SIZE = 64;
+constexpr uint16_t MQTT_PAYLOAD_SIZE = 256;
+constexpr uint16_t MQTT_KEEPALIVE_S = 60;
+constexpr uint32_t MQTT_CONNECT_TIMEOUT_MS = 5000;
+constexpr uint32_t MQTT_ACK_TIMEOUT_MS = 5000;          // No PUBACK within this = broker stalled, reconnect
+constexpr uint32_t MQTT_RETRY_MIN_MS = 2000;            // Reconnect backoff...
+constexpr uint32_t MQTT_RETRY_MAX_MS = 120000;          // ...doubling up to 2 minutes
+constexpr uint32_t MQTT_POLL_INTERVAL_MS = 20;          // Acknowledgement polling in the MQTT task
+constexpr uint32_t MQTT_TASK_STACK_SIZE = 4096;
+
+// ============================================================================
+// Gateway Configuration (peer stations merged into /api/v1/stations)
+// ============================================================================
+#define GATEWAY_ENABLED false
+constexpr const char* GATEWAY_STATION_NAME = "local";  // This station in the merged list
+constexpr const char* GATEWAY_PEERS[] = {              // Peer stations as IPv4[:port]
+  "192.168.1.21",
+  "192.168.1.22",
+};
+constexpr uint32_t GATEWAY_POLL_INTERVAL_MS = 10000;   // Poll cycle over all peers
+constexpr uint32_t GATEWAY_PEER_TIMEOUT_MS = 2000;     // Deadline per peer (connect + response)
+constexpr uint8_t GATEWAY_MAX_CONCURRENT = 6;          // Sockets open at once (lwIP pool is shared with HTTP/MQTT)
+constexpr uint16_t GATEWAY_RESPONSE_SIZE = 1024;       // Receive buffer per concurrent poll
+constexpr uint16_t GATEWAY_PEER_BODY_SIZE = 768;       // Cached /api/v1/sensors body per peer
+constexpr uint32_t GATEWAY_TASK_STACK_SIZE = 4096;
+
+// ============================================================================
+// Time Configuration (SNTP - UTC timestamps for readings and history)
+// ============================================================================
+#define TIME_SYNC_ENABLED true
+constexpr const char* TIME_NTP_SERVER = "pool.ntp.org";
+constexpr uint16_t TIME_NTP_PORT = 123;
+constexpr uint32_t TIME_SYNC_INTERVAL_MS = 900000;      // Resync every 15 min (drift is measured between syncs)
+constexpr uint32_t TIME_SYNC_RETRY_MS = 30000;          // After a failed query or while WiFi is down
+constexpr uint32_t TIME_SYNC_TIMEOUT_MS = 2000;         // Reply deadline
+constexpr uint32_t TIME_STEP_THRESHOLD_MS = 500;        // Larger errors step the clock, smaller ones are slewed
+constexpr uint32_t TIME_MAX_SLEW_PPM = 500;             // Slew rate limit
+constexpr uint32_t TIME_MAX_DRIFT_PPM = 500;            // Drift estimates beyond this are rejected (bad sample)
+constexpr uint32_t TIME_SYNC_TASK_STACK_SIZE = 3072;
+
+// ============================================================================
+// Anomaly Detection Configuration
+// ============================================================================
+constexpr uint8_t ANOMALY_WINDOW = 9;                 // Samples in median/MAD window
+constexpr float ANOMALY_SPIKE_THRESHOLD = 6.0f;       // Robust z-score (x MAD sigma)
+constexpr uint32_t ANOMALY_STATS_SAMPLES = 720;       // Welford window (1 h at 5 s)
+constexpr uint32_t ANOMALY_STUCK_MS = 3600000;        // Unchanged this long = stuck (1 h)
+constexpr float ANOMALY_MIN_SPREAD_TEMPERATURE = 0.2f;  // °C
+constexpr float ANOMALY_MIN_SPREAD_HUMIDITY = 1.0f;     // %RH
+constexpr float ANOMALY_MIN_SPREAD_PRESSURE = 30.0f;    // Pa
+
+// ============================================================================
+// Pressure Trend & Forecast Configuration
+// ============================================================================
+constexpr float STATION_ALTITUDE_M = 0.0f;              // For sea-level pressure (Zambretti)
+constexpr uint32_t PRESSURE_TREND_BUCKET_MS = 300000;   // One averaged point per 5 minutes
+constexpr uint8_t PRESSURE_TREND_BUCKETS = 72;          // 6 h window (3 h = half)
+constexpr uint8_t PRESSURE_TREND_MIN_BUCKETS = 12;      // 1 h of history before a tendency is reported
+
+// ============================================================================
+// Sample History & Chart Configuration
+// ============================================================================
+constexpr uint32_t HISTORY_INTERVAL_MS = 60000;   // One record per minute
+constexpr uint16_t HISTORY_CAPACITY = 1440;       // 24 h (20 bytes each, ~28 KB RAM)
+constexpr uint16_t CHART_DEFAULT_POINTS = 120;    // /api/v1/chart without ?points=
+constexpr uint16_t CHART_MAX_POINTS = 150;        // Upper bound of ?points= (fits RESPONSE_ARENA_SIZE)
+
+// ============================================================================
+// Scheduler Configuration
+// ============================================================================
+constexpr uint32_t SCHEDULER_TICK_MS = 10;          // Timer wheel resolution
+constexpr uint32_t SCHEDULER_WHEEL_SLOTS = 64;      // Power of two (64 x 10ms = 640ms per revolution)
+constexpr uint8_t SCHEDULER_MAX_JOBS = 8;
+constexpr uint32_t SCHEDULER_IDLE_WINDOW_MS = 10000;  // CPU idle percentage averaging window
+constexpr uint32_t HTTP_POLL_INTERVAL_MS = 10;      // HttpServer::handleClient() cadence
+constexpr uint32_t WIFI_CHECK_INTERVAL_MS = 10000;  // WiFi link check / reconnect
+
+// ============================================================================
+// Watchdog & Loop Latency Guard Configuration
+// ============================================================================
+#define TASK_WATCHDOG_ENABLED true
+constexpr uint32_t TASK_WATCHDOG_TIMEOUT_MS = 15000;  // loop() must finish within this or the ESP32 resets
+constexpr uint32_t LOOP_STAGE_BUDGET_MS = 100;        // Stage longer than this counts as a stall
+
+// ============================================================================
+// Event Journal Configuration
+// ============================================================================
+constexpr uint16_t EVENT_LOG_CAPACITY = 128;        // Events kept in RTC RAM (16 bytes each)
+constexpr uint16_t EVENT_JSON_MAX_EVENTS = 32;      // Events per /api/v1/events response
+
+// ============================================================================
+// I2C Trace Configuration
+// ============================================================================
+// Record every I2C transaction (µs timestamps) from boot into RAM for host-side
+// replay - download from /api/v1/debug/trace. Recording stops when the buffer
+// is full (~10 min at the default profile)
+#define I2C_TRACE_ENABLED false
+constexpr uint32_t I2C_TRACE_BUFFER_SIZE = 16384;
 
 // ============================================================================
 // Debug Configuration
@@ -79,9 +285,15 @@ constexpr uint16_t LED_BLINK_SENSOR_ERROR_OFF = 300;
 constexpr uint16_t LED_BLINK_CRITICAL_ERROR_ON = 50; // Very fast blink for critical ESP error
 constexpr uint16_t LED_BLINK_CRITICAL_ERROR_OFF = 50;
 
+// Pattern sequencer (runs from an esp_timer, independent of loop())
+constexpr uint16_t LED_TICK_MS = 10;          // Sequencer resolution
+constexpr uint8_t LED_PATTERN_BLINKS = 3;     // Blinks per error when several are active
+constexpr uint16_t LED_PATTERN_GAP_MS = 1000; // Dark gap between error patterns
+
 // ============================================================================
 // Error Types Enumeration
 // ============================================================================
+// Several errors can be active at once (see ErrorIndicator::raiseError)
 enum class ErrorType : uint8_t {
   NONE = 0,           // No error - system OK
   WIFI_ERROR = 1,     // WiFi connection failed
@@ -89,24 +301,4 @@ enum class ErrorType : uint8_t {
   CRITICAL_ERROR = 3  // Critical system error
 };
 
-// ============================================================================
-// Sensor Data Structure
-// ============================================================================
-struct SensorData {
-  float temperature = 0.0f;
-  float humidity = 0.0f;
-  float pressure = 0.0f;
-  float lightLevel = 0.0f;
-  bool isValid = false;
-
-  // Constructor
-  SensorData() = default;
-
-  // Copy constructor
-  SensorData(const SensorData&) = default;
-
-  // Assignment operator
-  SensorData& operator=(const SensorData&) = default;
-};
-
 #endif // CONFIG_H
@@ -0,0 +1,173 @@
+/*
+ * Derived Metrics Implementation
+ */
+
+#include "DerivedMetrics.h"
+
+constexpr float LN2 = 0.69314718f;
+constexpr float SQRT2 = 1.41421356f;
+
+// Magnus coefficients (dew point) and Bolton saturation vapour pressure
+constexpr float DEW_A = 17.27f;
+constexpr float DEW_B = 237.7f;
+constexpr float SVP_A = 17.67f;
+constexpr float SVP_B = 243.5f;
+
+// x = m * 2^e with m in [sqrt(0.5), sqrt(2)), ln(m) = 2 atanh(s), s = (m-1)/(m+1)
+// |s| < 0.172, so the atanh series truncated after s^7 is off by < 2e-7
+float fastLog(float x) {
+  if (!(x > 0.0f) || isinf(x)) {
+    return x == 0.0f ? -INFINITY : (isinf(x) ? x : NAN);
+  }
+
+  uint32_t bits;
+  memcpy(&bits, &x, sizeof(bits));
+
+  // Subnormals are outside any sensor range - treat as smallest normal
+  int32_t exponent = (int32_t)((bits >> 23) & 0xFF) - 127;
+  if (exponent == -127) {
+    return -87.3365f;
+  }
+
+  bits = (bits & 0x007FFFFF) | 0x3F800000;
+  float m;
+  memcpy(&m, &bits, sizeof(m));
+  if (m >= SQRT2) {
+    m *= 0.5f;
+    exponent++;
+  }
+
+  const float s = (m - 1.0f) / (m + 1.0f);
+  const float s2 = s * s;
+  const float series = s * (2.0f + s2 * (2.0f / 3.0f + s2 * (2.0f / 5.0f + s2 * (2.0f / 7.0f))));
+
+  return exponent * LN2 + series;
+}
+
+// e^x = 2^n * e^r with n = round(x / ln2), |r| <= ln2 / 2
+// Taylor series to r^6: truncation error < 2.5e-8 relative
+float fastExp(float x) {
+  if (isnan(x)) {
+    return x;
+  }
+  if (x > 88.0f) {
+    return INFINITY;
+  }
+  if (x < -87.0f) {
+    return 0.0f;
+  }
+
+  const float n = floorf(x * (1.0f / LN2) + 0.5f);
+  const float r = x - n * LN2;
+  const float poly = 1.0f + r * (1.0f + r * (0.5f + r * (1.0f / 6.0f + r * (1.0f / 24.0f +
+                     r * (1.0f / 120.0f + r * (1.0f / 720.0f))))));
+
+  const uint32_t scaleBits = (uint32_t)((int32_t)n + 127) << 23;
+  float scale;
+  memcpy(&scale, &scaleBits, sizeof(scale));
+
+  return poly * scale;
+}
+
+// Constructor
+DerivedMetrics::DerivedMetrics()
+  : dewPoint(NAN),
+    feelsLike(NAN),
+    absoluteHumidity(NAN),
+    comfort(ComfortLevel::UNKNOWN) {
+}
+
+// Recompute all metrics
+void DerivedMetrics::compute(float temperature, float humidity) {
+  dewPoint = NAN;
+  feelsLike = NAN;
+  absoluteHumidity = NAN;
+  comfort = ComfortLevel::UNKNOWN;
+
+  if (!isfinite(temperature)) {
+    return;
+  }
+
+  const bool hasHumidity = isfinite(humidity) && humidity > 0.0f;
+
+  // Feels like - heat index above 27 °C, fixed 2 °C below 10 °C
+  feelsLike = temperature;
+  if (hasHumidity && temperature >= 27.0f) {
+    const float t = temperature;
+    const float h = humidity;
+    feelsLike = -8.78469475556f + 1.61139411f * t + 2.33854883889f * h +
+                -0.14611605f * t * h + -0.012308094f * t * t +
+                -0.0164248277778f * h * h + 0.002211732f * t * t * h +
+                0.00072546f * t * h * h + -0.000003582f * t * t * h * h;
+  } else if (temperature <= 10.0f) {
+    feelsLike = temperature - 2.0f;
+  }
+
+  if (!hasHumidity) {
+    if (temperature < 15.0f) {
+      comfort = ComfortLevel::COLD;
+    } else if (temperature > 25.0f) {
+      comfort = ComfortLevel::HOT;
+    } else {
+      comfort = ComfortLevel::OK;
+    }
+    return;
+  }
+
+  // Dew point (Magnus)
+  const float alpha = (DEW_A * temperature) / (DEW_B + temperature) + fastLog(humidity / 100.0f);
+  dewPoint = (DEW_B * alpha) / (DEW_A - alpha);
+
+  // Absolute humidity from saturation vapour pressure (hPa)
+  const float saturation = 6.112f * fastExp((SVP_A * temperature) / (temperature + SVP_B));
+  absoluteHumidity = (saturation * humidity * 2.1674f) / (273.15f + temperature);
+
+  // Comfort
+  if (temperature >= 20.0f && temperature <= 26.0f && humidity >= 40.0f && humidity <= 60.0f) {
+    comfort = ComfortLevel::COMFORTABLE;
+  } else if (temperature < 15.0f) {
+    comfort = ComfortLevel::COLD;
+  } else if (temperature > 30.0f) {
+    comfort = ComfortLevel::HOT;
+  } else if (humidity < 30.0f) {
+    comfort = ComfortLevel::DRY;
+  } else if (humidity > 70.0f) {
+    comfort = ComfortLevel::HUMID;
+  } else {
+    comfort = ComfortLevel::MODERATE;
+  }
+}
+
+// Serialize as API fields
+void DerivedMetrics::writeJSON(JsonWriter& json) const {
+  json.addFloat("dewPoint", dewPoint);
+  json.addFloat("feelsLike", feelsLike);
+  json.addFloat("absHumidity", absoluteHumidity);
+  if (comfort == ComfortLevel::UNKNOWN) {
+    json.addNull("comfort");
+  } else {
+    json.addString("comfort", getComfortName(comfort));
+  }
+}
+
+// Comfort level API name
+const char* DerivedMetrics::getComfortName(ComfortLevel level) {
+  switch (level) {
+    case ComfortLevel::COMFORTABLE:
+      return "comfortable";
+    case ComfortLevel::COLD:
+      return "cold";
+    case ComfortLevel::HOT:
+      return "hot";
+    case ComfortLevel::DRY:
+      return "dry";
+    case ComfortLevel::HUMID:
+      return "humid";
+    case ComfortLevel::MODERATE:
+      return "moderate";
+    case ComfortLevel::OK:
+      return "ok";
+    default:
+      return "unknown";
+  }
+}
@@ -15,18 +15,63 @@
 #include <WiFi.h>
 #include "Config.h"
 #include "SensorManager.h"
+#include "SampleHistory.h"
 #include "WebServerManager.h"
 #include "ErrorIndicator.h"
+#include "EventLog.h"
+#include "LoopGuard.h"
+#include "Scheduler.h"
+#include "TimeSync.h"
+#if UPLOAD_ENABLED
+#include "Uploader.h"
+#endif
+#if MQTT_ENABLED
+#include "MqttPublisher.h"
+#endif
+#if GATEWAY_ENABLED
+#include "StationGateway.h"
+#endif
 
 // ============================================================================
 // Global Objects
 // ============================================================================
 SensorManager sensorManager;
-WebServerManager webServerManager(sensorManager);
+SampleHistory sampleHistory;
+LoopGuard loopGuard;
+Scheduler scheduler;
+WebServerManager webServerManager(sensorManager, sampleHistory, loopGuard, scheduler);
 ErrorIndicator errorIndicator;
+#if UPLOAD_ENABLED
+Uploader uploader;
+#endif
+#if MQTT_ENABLED
+MqttPublisher mqttPublisher;
+#endif
+#if GATEWAY_ENABLED
+StationGateway stationGateway;
+#endif
 
-// Timing
-uint32_t lastMeasurementTime = 0;
+// ============================================================================
+// Scheduled Jobs (run from loop() by the scheduler)
+// ============================================================================
+void pollHttp(uint32_t now);
+void sampleSensors(uint32_t now);
+void measureSensors(uint32_t now);
+void collectSensors(uint32_t now);
+void publishReadings(uint32_t now);
+void checkWiFi(uint32_t now);
+
+TimerJob httpJob("http", pollHttp, HTTP_POLL_INTERVAL_MS);
+#if HIGH_RATE_SAMPLING_ENABLED
+TimerJob sampleJob("sample", sampleSensors, HIGH_RATE_SAMPLE_INTERVAL_MS);
+#endif
+TimerJob measureJob("measure", measureSensors);  // Re-armed at the next read time
+TimerJob collectJob("collect", collectSensors);  // Armed for when the conversions end
+TimerJob publishJob("publish", publishReadings); // Armed when a read published data
+TimerJob wifiJob("wifi", checkWiFi, WIFI_CHECK_INTERVAL_MS);
+
+// millis() when the WiFi link was first seen down (0 = connected)
+uint32_t wifiDownSince = 0;
 
 // ============================================================================
 // Setup Function
@@ -46,6 +91,11 @@ void setup() {
   Serial.println("╚════════════════════════════════════════╝");
   #endif
 
+  // -------------------------------------------------------------------------
+  // Event Journal Initialization (survives soft resets)
+  // -------------------------------------------------------------------------
+  eventLog.begin();
+
   // -------------------------------------------------------------------------
   // LED Error Indicator Initialization
   // -------------------------------------------------------------------------
@@ -58,6 +108,17 @@ void setup() {
   Serial.printf("[WiFi] Connecting to '%s'", WIFI_SSID);
   #endif
 
+  // Journal link changes and update the LED right away (runs in the WiFi event task)
+  WiFi.onEvent([](WiFiEvent_t event, WiFiEventInfo_t info) {
+    if (event == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+      eventLog.log(EventCode::WIFI_CONNECTED, WiFi.RSSI());
+      scheduler.trigger(wifiJob);
+    } else if (event == ARDUINO_EVENT_WIFI_STA_DISCONNECTED) {
+      eventLog.log(EventCode::WIFI_DISCONNECTED, info.wifi_sta_disconnected.reason);
+      scheduler.trigger(wifiJob);
+    }
+  });
+
   WiFi.mode(WIFI_STA);
   WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
 
@@ -84,7 +145,7 @@ void setup() {
     WiFi.setSleep(false);
   } else {
     // WiFi connection failed - set error indicator
-    errorIndicator.setError(ErrorType::WIFI_ERROR);
+    errorIndicator.raiseError(ErrorType::WIFI_ERROR);
 
     // Always show WiFi errors
     Serial.println("[WARN] WiFi connection failed");
@@ -98,42 +159,23 @@ void setup() {
   Serial.println("[I2C] Initializing sensors...");
   #endif
 
-  if (!sensorManager.begin()) {
-    // Sensor initialization failed - set critical error and prepare for restart
-    errorIndicator.setError(ErrorType::CRITICAL_ERROR);
-
-    // Always show critical errors
-    Serial.println("\n[CRITICAL] Sensor initialization failed!");
-    Serial.println("[CRITICAL] Auto-restart in 60 seconds...");
-
-    // Blink LED very fast for 60 seconds, then auto-restart
-    const uint32_t startTime = millis();
-    const uint32_t restartDelay = 60000; // 60 seconds
+  // Persisted sampling profile first - drivers are configured with it
+  samplingProfiles.begin();
+  const bool sensorsReady = sensorManager.begin();
 
-    while (millis() - startTime < restartDelay) {
-      errorIndicator.update();
+  if (!sensorsReady) {
+    // Sensor initialization failed - keep running, SensorManager recovers
+    // the failed bus in place with backoff instead of rebooting the system
+    errorIndicator.raiseError(ErrorType::SENSOR_ERROR);
 
-      // Always print countdown for critical errors
-      static uint32_t lastPrint = 0;
-      if (millis() - lastPrint >= 10000) {
-        lastPrint = millis();
-        uint32_t remaining = (restartDelay - (millis() - startTime)) / 1000;
-        Serial.printf("[CRITICAL] Restarting in %lu seconds...\n", remaining);
-      }
-
-      delay(10);
-    }
-
-    // Always show restart message for critical errors
-    Serial.println("[CRITICAL] Restarting now...\n");
-    Serial.flush();
-
-    // Perform system restart
-    ESP.restart();
+    // Always show sensor errors
+    Serial.println("[ERROR] Sensor initialization failed - recovery scheduled");
   }
 
   #if DEBUG_SERIAL_ENABLED
-  Serial.println("[I2C] All sensors ready");
+  if (sensorsReady) {
+    Serial.println("[I2C] All sensors ready");
+  }
   #endif
 
   // -------------------------------------------------------------------------
@@ -141,22 +183,76 @@ void setup() {
   // -------------------------------------------------------------------------
   webServerManager.begin();
 
+  #if TIME_SYNC_ENABLED
+  webServerManager.addJSONRoute("/api/v1/system/time", [](JsonWriter& json) {
+    timeSync.writeJSON(json);
+  });
+  #endif
+
+  #if UPLOAD_ENABLED
+  webServerManager.addJSONRoute("/api/v1/system/uploader", [](JsonWriter& json) {
+    uploader.writeJSON(json);
+  });
+  #endif
+
+  #if MQTT_ENABLED
+  webServerManager.addJSONRoute("/api/v1/system/mqtt", [](JsonWriter& json) {
+    mqttPublisher.writeJSON(json);
+  });
+  #endif
+
+  #if GATEWAY_ENABLED
+  webServerManager.addBufferRoute("/api/v1/stations", [](const WebServerManager::JsonSender& send) {
+    stationGateway.serve(send);
+  });
+  #endif
+
   #if DEBUG_SERIAL_ENABLED
   Serial.printf("[HTTP] Server started on port %d\n", HTTP_SERVER_PORT);
   #endif
 
+  // -------------------------------------------------------------------------
+  // Time Sync, Uploader, MQTT & Gateway (own tasks - network I/O never runs in loop())
+  // -------------------------------------------------------------------------
+  #if TIME_SYNC_ENABLED
+  timeSync.begin();
+  #endif
+  #if UPLOAD_ENABLED
+  uploader.begin();
+  #endif
+  #if MQTT_ENABLED
+  mqttPublisher.begin();
+  #endif
+  #if GATEWAY_ENABLED
+  stationGateway.begin();
+  #endif
+
+  // -------------------------------------------------------------------------
+  // Scheduler Jobs
+  // -------------------------------------------------------------------------
+  scheduler.begin();
+
+  const uint32_t startTime = millis();
+  scheduler.addJob(httpJob, startTime);
+  #if HIGH_RATE_SAMPLING_ENABLED
+  scheduler.addJob(sampleJob, startTime);
+  #endif
+  scheduler.addJob(measureJob, startTime);
+  scheduler.addJob(collectJob);  // Armed by measureSensors()
+  scheduler.addJob(publishJob);  // Armed by collectSensors()
+  scheduler.addJob(wifiJob, startTime + WIFI_CHECK_INTERVAL_MS);
+
+  // -------------------------------------------------------------------------
+  // Watchdog & Loop Guard (armed last - setup() may block on WiFi)
+  // -------------------------------------------------------------------------
+  loopGuard.begin();
+
   // -------------------------------------------------------------------------
   // System Ready - Final Error State Check
   // -------------------------------------------------------------------------
-  // If we reached here, sensors initialized successfully
-  // Now determine final system state based on WiFi status
-  if (WiFi.status() != WL_CONNECTED) {
-    // Sensors OK but WiFi failed - set WiFi error
-    errorIndicator.setError(ErrorType::WIFI_ERROR);
-  } else {
-    // All systems operational - clear error state
-    errorIndicator.setError(ErrorType::NONE);
-  }
+  // Sensor and WiFi errors are tracked independently - the LED shows both
+  errorIndicator.setError(ErrorType::SENSOR_ERROR, !sensorsReady);
+  errorIndicator.setError(ErrorType::WIFI_ERROR, WiFi.status() != WL_CONNECTED);
 
   #if DEBUG_SERIAL_ENABLED
   Serial.println("\n╔════════════════════════════════════════╗");
@@ -176,39 +272,117 @@ void setup() {
 // Main Loop
 // ============================================================================
 void loop() {
-  // Update LED error indicator based on current error state
-  errorIndicator.update();
+  // Sleep until the next job deadline (or a trigger from another task)
+  scheduler.waitForNext();
+
+  loopGuard.beginIteration();
+  scheduler.runDue();
+
+  // Close last stage and feed the task watchdog
+  loopGuard.endIteration();
+}
+
+// ============================================================================
+// Job Implementations
+// ============================================================================
 
-  // Handle incoming HTTP client requests
+// Handle incoming HTTP client requests
+void pollHttp(uint32_t now) {
+  loopGuard.enterStage(LoopStage::HANDLE_CLIENT);
   webServerManager.handleClient();
 
-  const uint32_t currentTime = millis();
-
-  // Periodic sensor readings based on configured interval (5 seconds)
-  if (currentTime - lastMeasurementTime >= MEASUREMENT_INTERVAL_MS) {
-    lastMeasurementTime = currentTime;
-
-    // Trigger sensor reading (BME280 + BH1750)
-    sensorManager.readSensors();
-
-    // Monitor sensor health and update error status accordingly
-    const SensorData& data = sensorManager.getSensorData();
-
-    if (!data.isValid && errorIndicator.getCurrentError() == ErrorType::NONE) {
-      // Sensors were working but now returning invalid data
-      errorIndicator.setError(ErrorType::SENSOR_ERROR);
-    } else if (data.isValid && errorIndicator.getCurrentError() == ErrorType::SENSOR_ERROR) {
-      // Sensors recovered from error state - update status
-      if (WiFi.status() == WL_CONNECTED) {
-        // Both sensors and WiFi are OK
-        errorIndicator.setError(ErrorType::NONE);
-      } else {
-        // Sensors OK but WiFi still down
-        errorIndicator.setError(ErrorType::WIFI_ERROR);
-      }
-    }
+  // Profile selected over the API - read right away instead of at the old interval
+  // (unless a read is already converting)
+  if (sensorManager.isProfileChanged() && !collectJob.scheduled) {
+    scheduler.schedule(measureJob, now);
+  }
+}
+
+#if HIGH_RATE_SAMPLING_ENABLED
+// Internal high-rate sampling into filter pipelines (not published)
+void sampleSensors(uint32_t now) {
+  (void)now;
+  loopGuard.enterStage(LoopStage::SAMPLE_SENSORS);
+  sensorManager.sampleSensors();
+}
+#endif
+
+// Periodic sensor readings (fixed 5 second interval, or per-sensor adaptive):
+// trigger the conversions, collected by collectSensors() once they finished
+void measureSensors(uint32_t now) {
+  (void)now;
+  loopGuard.enterStage(LoopStage::READ_SENSORS);
+  const uint32_t conversionMs = sensorManager.startSensors();
+  scheduler.schedule(collectJob, millis() + conversionMs);
+}
+
+// Collect the readings triggered by measureSensors()
+void collectSensors(uint32_t now) {
+  loopGuard.enterStage(LoopStage::READ_SENSORS);
+
+  // Health checks only run when readSensors() published new data
+  if (sensorManager.readSensors()) {
+    scheduler.schedule(publishJob, now);
+  }
+
+  scheduler.schedule(measureJob, sensorManager.getNextReadTime(millis()));
+}
+
+// Health checks and serial output for newly published data
+void publishReadings(uint32_t now) {
+  (void)now;
+  loopGuard.enterStage(LoopStage::PUBLISH);
+
+  // Monitor sensor health and update error status accordingly
+  const SensorData& data = sensorManager.getSensorData();
+
+  // Journal validity transitions only (not every invalid reading)
+  if (data.isValid == errorIndicator.hasError(ErrorType::SENSOR_ERROR)) {
+    eventLog.log(data.isValid ? EventCode::SENSOR_VALID : EventCode::SENSOR_INVALID);
+  }
+
+  errorIndicator.setError(ErrorType::SENSOR_ERROR, !data.isValid);
+
+  // Stamped with the acquisition time (TimeSync maps it to UTC on output)
+  const uint32_t sampleTime = sensorManager.getSampleTime();
+
+  // Chart history (one record per HISTORY_INTERVAL_MS)
+  sampleHistory.record(data, sampleTime);
+
+  #if UPLOAD_ENABLED
+  // Copy into the upload backlog (sent in batches by the upload task)
+  uploader.enqueue(data, sensorManager.getSequence(), sampleTime);
+  #endif
+
+  #if MQTT_ENABLED
+  // Queue MQTT messages (coalesced per topic while the broker is behind)
+  mqttPublisher.publish(data, sensorManager.getSequence());
+  #endif
+
+  #if GATEWAY_ENABLED
+  // Own entry of the merged /api/v1/stations document
+  stationGateway.updateLocal(data, sensorManager.getSequence());
+  #endif
+
+  // Output sensor readings to serial monitor (debug mode only)
+  sensorManager.printToSerial();
+}
 
-    // Output sensor readings to serial monitor (debug mode only)
-    sensorManager.printToSerial();
+// WiFi link state -> LED (periodic, and on every WiFi event). A link that
+// stayed down for a whole check interval gets an explicit reconnect - the
+// core's auto-reconnect stops retrying after some disconnect reasons
+void checkWiFi(uint32_t now) {
+  loopGuard.enterStage(LoopStage::WIFI_CHECK);
+
+  const bool connected = WiFi.status() == WL_CONNECTED;
+  errorIndicator.setError(ErrorType::WIFI_ERROR, !connected);
+
+  if (connected) {
+    wifiDownSince = 0;
+  } else if (wifiDownSince == 0) {
+    wifiDownSince = now;
+  } else if (now - wifiDownSince >= WIFI_CHECK_INTERVAL_MS) {
+    WiFi.reconnect();
+    wifiDownSince = now;
   }
 }
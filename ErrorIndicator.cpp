@@ -6,76 +6,48 @@
 
 // Constructor
 ErrorIndicator::ErrorIndicator()
-  : m_currentError(ErrorType::NONE),
-    m_ledState(false),
-    m_lastToggleTime(0) {
+  : m_activeErrors(0),
+    m_timer(nullptr),
+    m_ledState(false) {
 }
 
-// Initialize LED pin
+// Initialize LED pin and start periodic pattern timer
 void ErrorIndicator::begin() {
   pinMode(LED_PIN, OUTPUT);
   setLED(false);
-}
 
-// Set current error state
-void ErrorIndicator::setError(ErrorType error) {
-  if (m_currentError != error) {
-    m_currentError = error;
-    m_lastToggleTime = millis();
-    setLED(false);
+  const esp_timer_create_args_t timerArgs = {
+    .callback = &ErrorIndicator::onTimer,
+    .arg = this,
+    .dispatch_method = ESP_TIMER_TASK,
+    .name = "led",
+    .skip_unhandled_events = true
+  };
+
+  if (esp_timer_create(&timerArgs, &m_timer) != ESP_OK ||
+      esp_timer_start_periodic(m_timer, LED_TICK_MS * 1000ULL) != ESP_OK) {
+    // Always show critical errors
+    Serial.println("[ERROR] LED timer could not be started");
   }
 }
 
-// Update LED state based on current error
-void ErrorIndicator::update() {
-  const uint32_t currentTime = millis();
-
-  switch (m_currentError) {
-    case ErrorType::NONE: {
-      // Normal operation: LED off (energy saving)
-      // No action needed, LED stays off
-      break;
-    }
-
-    case ErrorType::WIFI_ERROR:
-    case ErrorType::SENSOR_ERROR:
-    case ErrorType::CRITICAL_ERROR: {
-      // Error blinking patterns
-      const uint16_t duration = m_ledState ? getOnDuration() : getOffDuration();
-
-      if (currentTime - m_lastToggleTime >= duration) {
-        m_lastToggleTime = currentTime;
-        setLED(!m_ledState);
-      }
-      break;
-    }
-  }
+// Add error to active set
+void ErrorIndicator::raiseError(ErrorType error) {
+  m_activeErrors.fetch_or(errorBit(error));
 }
 
-// Get ON duration for current error
-uint16_t ErrorIndicator::getOnDuration() const {
-  switch (m_currentError) {
-    case ErrorType::WIFI_ERROR:
-      return LED_BLINK_WIFI_ERROR_ON;
-    case ErrorType::SENSOR_ERROR:
-      return LED_BLINK_SENSOR_ERROR_ON;
-    case ErrorType::CRITICAL_ERROR:
-      return LED_BLINK_CRITICAL_ERROR_ON;
-    default:
-      return 0;
-  }
+// Remove error from active set
+void ErrorIndicator::clearError(ErrorType error) {
+  m_activeErrors.fetch_and((uint8_t)~errorBit(error));
 }
 
-// Get OFF duration for current error
-uint16_t ErrorIndicator::getOffDuration() const {
-  switch (m_currentError) {
-    case ErrorType::WIFI_ERROR:
-      return LED_BLINK_WIFI_ERROR_OFF;
-    case ErrorType::SENSOR_ERROR:
-      return LED_BLINK_SENSOR_ERROR_OFF;
-    case ErrorType::CRITICAL_ERROR:
-      return LED_BLINK_CRITICAL_ERROR_OFF;
-    default:
-      return 0;
+// Runs every LED_TICK_MS in the esp_timer task, so blink timing does not
+// depend on how long handleClient() or a sensor read blocks loop()
+void ErrorIndicator::onTimer(void* arg) {
+  ErrorIndicator* self = static_cast<ErrorIndicator*>(arg);
+
+  const bool state = self->m_sequencer.tick(millis(), self->m_activeErrors.load());
+  if (state != self->m_ledState) {
+    self->setLED(state);
   }
 }
@@ -1,46 +1,56 @@
 /*
  * Error Indicator Manager for ESP32 Weather Station
  * Controls built-in LED to signal different system states
+ * LED patterns are driven by an esp_timer callback, independent of loop()
  */
 
 #ifndef ERROR_INDICATOR_H
 #define ERROR_INDICATOR_H
 
 #include <Arduino.h>
+#include <atomic>
+#include <esp_timer.h>
 #include "Config.h"
+#include "LedSequencer.h"
 
 class ErrorIndicator {
 public:
   // Constructor
   ErrorIndicator();
 
-  // Initialize LED pin
+  // Initialize LED pin and start pattern timer
   void begin();
 
-  // Set current error state
-  void setError(ErrorType error);
+  // Add/remove an error from the active set (several can be active at once)
+  void raiseError(ErrorType error);
+  void clearError(ErrorType error);
 
-  // Update LED state (call in loop)
-  void update();
+  // Convenience: raise or clear depending on condition
+  inline void setError(ErrorType error, bool active) {
+    active ? raiseError(error) : clearError(error);
+  }
+
+  // Check if an error is active
+  inline bool hasError(ErrorType error) const {
+    return (m_activeErrors.load() & errorBit(error)) != 0;
+  }
 
-  // Get current error type
-  inline ErrorType getCurrentError() const {
-    return m_currentError;
+  // Get active error mask (bit n-1 = ErrorType n)
+  inline uint8_t getActiveErrors() const {
+    return m_activeErrors.load();
   }
 
 private:
-  // Current error state
-  ErrorType m_currentError;
+  // Active errors - written by loop(), read by timer callback
+  std::atomic<uint8_t> m_activeErrors;
 
-  // LED state tracking
+  // Pattern timer and sequencer (only touched from timer callback)
+  esp_timer_handle_t m_timer;
+  LedSequencer m_sequencer;
   bool m_ledState;
-  uint32_t m_lastToggleTime;
-
-  // Get ON duration for current error
-  uint16_t getOnDuration() const;
 
-  // Get OFF duration for current error
-  uint16_t getOffDuration() const;
+  // Timer callback - advances pattern and drives LED
+  static void onTimer(void* arg);
 
   // Set LED state
   inline void setLED(bool state) {
@@ -0,0 +1,140 @@
+/*
+ * Event Journal Implementation
+ */
+
+#include "EventLog.h"
+#include <esp_system.h>
+
+// Journal header + ring, persisted in RTC RAM that is not cleared on reset
+struct EventJournal {
+  uint32_t magic;
+  uint32_t nextSequence;
+  uint16_t bootCount;
+  EventRecord records[EVENT_LOG_CAPACITY];
+};
+
+constexpr uint32_t EVENT_JOURNAL_MAGIC = 0x45564A31;  // "EVJ1"
+
+static RTC_NOINIT_ATTR EventJournal s_journal;
+static portMUX_TYPE s_journalLock = portMUX_INITIALIZER_UNLOCKED;
+
+EventLog eventLog;
+
+// Validate persisted journal, reset it if RAM content is garbage
+void EventLog::begin() {
+  const esp_reset_reason_t reason = esp_reset_reason();
+
+  // RTC RAM is random after power-on/brownout - trust it only with a valid header
+  if (reason == ESP_RST_POWERON || reason == ESP_RST_BROWNOUT ||
+      s_journal.magic != EVENT_JOURNAL_MAGIC || s_journal.nextSequence == 0) {
+    memset(&s_journal, 0, sizeof(s_journal));
+    s_journal.magic = EVENT_JOURNAL_MAGIC;
+    s_journal.nextSequence = 1;
+  }
+
+  s_journal.bootCount++;
+  log(EventCode::BOOT, reason, s_journal.bootCount);
+}
+
+// Reserve slot and copy record under spinlock (no formatting, no allocation)
+void EventLog::log(EventCode code, int32_t arg0, int32_t arg1) {
+  const uint32_t timestamp = millis();
+
+  portENTER_CRITICAL_SAFE(&s_journalLock);
+  const uint32_t sequence = s_journal.nextSequence++;
+  EventRecord& record = s_journal.records[sequence % EVENT_LOG_CAPACITY];
+  record.sequence = sequence;
+  record.timestamp = timestamp;
+  record.code = (uint16_t)code;
+  record.boot = s_journal.bootCount;
+  record.arg0 = (int16_t)constrain(arg0, INT16_MIN, INT16_MAX);
+  record.arg1 = (int16_t)constrain(arg1, INT16_MIN, INT16_MAX);
+  portEXIT_CRITICAL_SAFE(&s_journalLock);
+}
+
+// Write events newer than 'since' as JSON array elements
+void EventLog::writeJSON(JsonWriter& json, uint32_t since, uint16_t maxEvents) const {
+  const uint32_t next = getNextSequence();
+
+  // Oldest sequence still in the ring (older ones were overwritten)
+  const uint32_t oldest = next > EVENT_LOG_CAPACITY ? next - EVENT_LOG_CAPACITY : 1;
+  uint32_t sequence = max(since + 1, oldest);
+  uint16_t written = 0;
+
+  for (; sequence < next && written < maxEvents; sequence++) {
+    // Copy under lock - a concurrent writer may be reusing the slot
+    EventRecord record;
+    portENTER_CRITICAL_SAFE(&s_journalLock);
+    record = s_journal.records[sequence % EVENT_LOG_CAPACITY];
+    portEXIT_CRITICAL_SAFE(&s_journalLock);
+
+    if (record.sequence != sequence) {
+      continue;  // Overwritten while reading
+    }
+
+    json.beginObject();
+    json.addUInt("seq", record.sequence);
+    json.addUInt("boot", record.boot);
+    json.addUInt("t", record.timestamp);
+    json.addString("code", getCodeName(record.code));
+    json.addInt("arg0", record.arg0);
+    json.addInt("arg1", record.arg1);
+    json.endObject();
+    written++;
+  }
+}
+
+// Sequence number of next event
+uint32_t EventLog::getNextSequence() const {
+  portENTER_CRITICAL_SAFE(&s_journalLock);
+  const uint32_t next = s_journal.nextSequence;
+  portEXIT_CRITICAL_SAFE(&s_journalLock);
+  return next;
+}
+
+// Boot count
+uint16_t EventLog::getBootCount() const {
+  return s_journal.bootCount;
+}
+
+// Short name of an event code
+const char* EventLog::getCodeName(uint16_t code) {
+  switch ((EventCode)code) {
+    case EventCode::BOOT:
+      return "boot";
+    case EventCode::WIFI_CONNECTED:
+      return "wifi_connected";
+    case EventCode::WIFI_DISCONNECTED:
+      return "wifi_disconnected";
+    case EventCode::SENSOR_INVALID:
+      return "sensor_invalid";
+    case EventCode::SENSOR_VALID:
+      return "sensor_valid";
+    case EventCode::SENSOR_OFFLINE:
+      return "sensor_offline";
+    case EventCode::SENSOR_RECOVERED:
+      return "sensor_recovered";
+    case EventCode::SENSOR_RECOVERY_FAILED:
+      return "sensor_recovery_failed";
+    case EventCode::SAMPLING_PROFILE_CHANGED:
+      return "sampling_profile_changed";
+    case EventCode::LOOP_STALL:
+      return "loop_stall";
+    case EventCode::WATCHDOG_RESET:
+      return "watchdog_reset";
+    case EventCode::UPLOAD_FAILED:
+      return "upload_failed";
+    case EventCode::UPLOAD_RESUMED:
+      return "upload_resumed";
+    case EventCode::MQTT_CONNECTED:
+      return "mqtt_connected";
+    case EventCode::MQTT_DISCONNECTED:
+      return "mqtt_disconnected";
+    case EventCode::TIME_SYNCED:
+      return "time_synced";
+    case EventCode::TIME_STEPPED:
+      return "time_stepped";
+    default:
+      return "unknown";
+  }
+}
@@ -0,0 +1,71 @@
+/*
+ * Event Journal for ESP32 Weather Station
+ * Fixed-size binary ring of system events (timestamp, code, two args)
+ * Kept in RTC no-init RAM so it survives soft resets and watchdog resets
+ * Logging is a few stores inside a spinlock - safe from any task, no formatting
+ */
+
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "JsonWriter.h"
+
+// Event codes (stable values - they are persisted across resets)
+enum class EventCode : uint16_t {
+  BOOT = 1,                   // arg0 = reset reason, arg1 = boot count
+  WIFI_CONNECTED = 10,        // arg0 = RSSI (dBm)
+  WIFI_DISCONNECTED = 11,     // arg0 = disconnect reason
+  SENSOR_INVALID = 20,        // Published data became invalid
+  SENSOR_VALID = 21,          // Published data valid again
+  SENSOR_OFFLINE = 22,        // arg0 = sensor index, arg1 = failed reads
+  SENSOR_RECOVERED = 23,      // arg0 = sensor index, arg1 = recovery count
+  SENSOR_RECOVERY_FAILED = 24,// arg0 = sensor index, arg1 = next retry delay (s, rounded up)
+  SAMPLING_PROFILE_CHANGED = 25, // arg0 = profile index
+  LOOP_STALL = 30,            // arg0 = loop stage, arg1 = duration (ms)
+  WATCHDOG_RESET = 31,        // arg0 = loop stage running when watchdog fired
+  UPLOAD_FAILED = 40,         // arg0 = HTTP status or client error, arg1 = queued samples
+  UPLOAD_RESUMED = 41,        // arg0 = queued samples to drain
+  MQTT_CONNECTED = 50,        // arg0 = connection count
+  MQTT_DISCONNECTED = 51,     // arg0 = reason (<0 client side, >0 CONNACK code)
+  TIME_SYNCED = 60,           // First SNTP sync, arg0 = stratum, arg1 = round trip (ms)
+  TIME_STEPPED = 61           // arg0 = step (s), arg1 = ms remainder (same sign) - error too large to slew
+                              // Beyond 9.1 h: arg0 = minutes, arg1 = TIME_STEP_MINUTES_FLAG + seconds
+};
+
+// Single journal record (16 bytes)
+struct EventRecord {
+  uint32_t sequence;   // Monotonic across resets (0 = empty slot)
+  uint32_t timestamp;  // millis() at log time
+  uint16_t code;       // EventCode
+  uint16_t boot;       // Boot count at log time
+  int16_t arg0;
+  int16_t arg1;
+};
+
+class EventLog {
+public:
+  // Validate persisted journal (or reset it after power-on) and log BOOT
+  void begin();
+
+  // Append event - callable from any task or timer callback
+  void log(EventCode code, int32_t arg0 = 0, int32_t arg1 = 0);
+
+  // Write events with sequence > since (oldest first, at most maxEvents)
+  void writeJSON(JsonWriter& json, uint32_t since, uint16_t maxEvents) const;
+
+  // Sequence number the next event will get
+  uint32_t getNextSequence() const;
+
+  // Boot count (increments on every reset that keeps RTC RAM)
+  uint16_t getBootCount() const;
+
+  // Short name of an event code
+  static const char* getCodeName(uint16_t code);
+};
+
+// Global journal (modules log without holding a reference)
+extern EventLog eventLog;
+
+#endif // EVENT_LOG_H
@@ -0,0 +1,75 @@
+/*
+ * Streaming Filter Pipeline Implementation
+ */
+
+#include "FilterPipeline.h"
+
+// Extra fractional bits kept in the EMA state
+constexpr uint8_t EMA_FRACTION_BITS = 8;
+
+// Constructor
+FilterPipeline::FilterPipeline(float scale)
+  : m_scale(scale) {
+  reset();
+}
+
+// Feed one sample through the spike filter into the decimator
+void FilterPipeline::push(float sample) {
+  if (!isfinite(sample)) {
+    return;
+  }
+
+  m_window[m_windowIndex] = (int32_t)lroundf(sample * m_scale);
+  m_windowIndex = (m_windowIndex + 1) % 3;
+  if (m_windowCount < 3) {
+    m_windowCount++;
+  }
+
+  // Median of the last 3 samples drops single-sample spikes
+  // (window not full yet - pass the newest sample through)
+  int32_t filtered;
+  if (m_windowCount < 3) {
+    filtered = m_window[(m_windowIndex + 2) % 3];
+  } else {
+    const int32_t a = m_window[0];
+    const int32_t b = m_window[1];
+    const int32_t c = m_window[2];
+    filtered = max(min(a, b), min(max(a, b), c));
+  }
+
+  m_accumulator += filtered;
+  m_accumulatorCount++;
+}
+
+// Average samples since last call, smooth with EMA and convert back
+float FilterPipeline::decimate() {
+  if (m_accumulatorCount == 0) {
+    return NAN;
+  }
+
+  // Multiply rather than shift - the accumulator is negative below zero
+  const int64_t average = m_accumulator * (1LL << EMA_FRACTION_BITS) / m_accumulatorCount;
+  m_accumulator = 0;
+  m_accumulatorCount = 0;
+
+  if (m_emaValid) {
+    // ema += (x - ema) * 2^-shift
+    m_ema += (average - m_ema) >> HIGH_RATE_EMA_SHIFT;
+  } else {
+    m_ema = average;
+    m_emaValid = true;
+  }
+
+  return (float)m_ema / (float)(1 << EMA_FRACTION_BITS) / m_scale;
+}
+
+// Forget all history
+void FilterPipeline::reset() {
+  m_window[0] = m_window[1] = m_window[2] = 0;
+  m_windowCount = 0;
+  m_windowIndex = 0;
+  m_accumulator = 0;
+  m_accumulatorCount = 0;
+  m_ema = 0;
+  m_emaValid = false;
+}
@@ -0,0 +1,45 @@
+/*
+ * Streaming Filter Pipeline for ESP32 Weather Station
+ * Fixed-point per-channel chain used in high-rate sampling mode:
+ * median-of-3 spike rejection -> boxcar decimator -> EMA
+ */
+
+#ifndef FILTER_PIPELINE_H
+#define FILTER_PIPELINE_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+class FilterPipeline {
+public:
+  // Constructor - scale converts a sample to fixed point (e.g. 100 = 0.01 units)
+  explicit FilterPipeline(float scale);
+
+  // Feed one high-rate sample (non-finite samples are ignored)
+  void push(float sample);
+
+  // Dump boxcar accumulator into the EMA and return the filtered value
+  // Returns NaN if no sample arrived since the last call
+  float decimate();
+
+  // Forget all history
+  void reset();
+
+private:
+  float m_scale;
+
+  // Median-of-3 window
+  int32_t m_window[3];
+  uint8_t m_windowCount;
+  uint8_t m_windowIndex;
+
+  // Boxcar (accumulate-and-dump) decimator
+  int64_t m_accumulator;
+  uint16_t m_accumulatorCount;
+
+  // EMA state with 8 extra fractional bits
+  int64_t m_ema;
+  bool m_emaValid;
+};
+
+#endif // FILTER_PIPELINE_H
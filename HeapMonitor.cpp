@@ -0,0 +1,142 @@
+/*
+ * Heap Monitor Implementation
+ */
+
+#include "HeapMonitor.h"
+#include <esp_heap_caps.h>
+
+#if HEAP_MONITOR_ENABLED && HEAP_MONITOR_ALLOC_HOOKS
+// Allocations of the task running the current handler, counted by the hook
+static volatile bool s_counting = false;
+static TaskHandle_t s_requestTask = nullptr;
+static uint32_t s_allocations = 0;
+static uint32_t s_allocatedBytes = 0;
+
+// Heap allocation hook (CONFIG_HEAP_USE_HOOKS) - called for every
+// allocation of any task, so it only counts and returns
+void IRAM_ATTR esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+  (void)caps;
+  if (s_counting && ptr && xTaskGetCurrentTaskHandle() == s_requestTask) {
+    s_allocations++;
+    s_allocatedBytes += size;
+  }
+}
+#endif
+
+// Constructor
+HeapMonitor::HeapMonitor()
+  : m_routeCount(0),
+    m_startBlocks(0),
+    m_startBytes(0),
+    m_startFree(0),
+    m_minFreeBefore(0),
+    m_windowOpen(false) {
+}
+
+// Register route
+uint8_t HeapMonitor::registerRoute(const char* path) {
+  if (m_routeCount >= HEAP_MONITOR_MAX_ROUTES) {
+    return HEAP_MONITOR_MAX_ROUTES - 1;
+  }
+
+  m_routes[m_routeCount].path = path;
+  return m_routeCount++;
+}
+
+// Snapshot allocated blocks/bytes before handler, open the local minimum
+// free size window (high-water mark) and start counting allocations
+void HeapMonitor::beginRequest() {
+  #if HEAP_MONITOR_ENABLED
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+
+  m_startBlocks = info.allocated_blocks;
+  m_startBytes = info.total_allocated_bytes;
+  m_startFree = info.total_free_bytes;
+  m_minFreeBefore = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+  m_windowOpen = heap_caps_monitor_local_minimum_free_size_start() == ESP_OK;
+
+  #if HEAP_MONITOR_ALLOC_HOOKS
+  s_allocations = 0;
+  s_allocatedBytes = 0;
+  s_requestTask = xTaskGetCurrentTaskHandle();
+  s_counting = true;
+  #endif
+  #endif
+}
+
+// Account the handler's allocations and high-water mark, and what it left
+// allocated (net deltas track retained memory and fragmentation)
+void HeapMonitor::endRequest(uint8_t route) {
+  #if HEAP_MONITOR_ENABLED
+  #if HEAP_MONITOR_ALLOC_HOOKS
+  s_counting = false;
+  #endif
+
+  RouteHeapStats& stats = m_routes[route];
+  if (m_windowOpen) {
+    const uint32_t localMinFree = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    heap_caps_monitor_local_minimum_free_size_stop();
+    m_windowOpen = false;
+    if (localMinFree < m_startFree) {
+      stats.peakBytes = max(stats.peakBytes, m_startFree - localMinFree);
+    }
+  }
+
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+  const int32_t bytes = (int32_t)(info.total_allocated_bytes - m_startBytes);
+
+  stats.requests++;
+  #if HEAP_MONITOR_ALLOC_HOOKS
+  stats.allocations += s_allocations;
+  stats.allocatedBytes += s_allocatedBytes;
+  #endif
+  stats.netBlocks += (int32_t)(info.allocated_blocks - m_startBlocks);
+  stats.netBytes += bytes;
+  stats.maxRequestBytes = max(stats.maxRequestBytes, bytes);
+  stats.minLargestFree = min(stats.minLargestFree, (uint32_t)info.largest_free_block);
+  #endif
+}
+
+// Serialize heap state
+void HeapMonitor::writeJSON(JsonWriter& json) const {
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, MALLOC_CAP_8BIT);
+
+  // Inside a handler's window the reported minimum is the local one
+  const uint32_t minFree = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+
+  json.addUInt("free", info.total_free_bytes);
+  json.addUInt("minFree", m_windowOpen ? min(m_minFreeBefore, minFree) : minFree);
+  json.addUInt("largestFree", info.largest_free_block);
+  json.addUInt("allocatedBlocks", info.allocated_blocks);
+  json.addUInt("freeBlocks", info.free_blocks);
+
+  json.beginArray("routes");
+  for (uint8_t i = 0; i < m_routeCount; i++) {
+    const RouteHeapStats& stats = m_routes[i];
+
+    json.beginObject();
+    json.addString("path", stats.path);
+    json.addUInt("requests", stats.requests);
+    #if HEAP_MONITOR_ENABLED && HEAP_MONITOR_ALLOC_HOOKS
+    json.addUInt("allocations", stats.allocations);
+    json.addUInt64("allocatedBytes", stats.allocatedBytes);
+    #else
+    json.addNull("allocations");
+    json.addNull("allocatedBytes");
+    #endif
+    json.addUInt("peakBytes", stats.peakBytes);
+    json.addInt("netBlocks", stats.netBlocks);
+    json.addInt("netBytes", stats.netBytes);
+    json.addInt("maxRequestBytes", stats.maxRequestBytes);
+    if (stats.requests > 0) {
+      json.addUInt("minLargestFree", stats.minLargestFree);
+    } else {
+      json.addNull("minLargestFree");
+    }
+    json.endObject();
+  }
+  json.endArray();
+}
@@ -0,0 +1,62 @@
+/*
+ * Heap Monitor for ESP32 Weather Station
+ * Per-route heap accounting for HTTP handlers: requests, allocations made
+ * (count and bytes, from the heap allocation hook), in-request high-water
+ * mark, net allocated blocks/bytes left behind, worst request and smallest
+ * largest-free-block (fragmentation), plus global free / minimum free /
+ * largest block
+ */
+
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "JsonWriter.h"
+
+// Heap counters of a single route
+struct RouteHeapStats {
+  const char* path = nullptr;
+  uint32_t requests = 0;
+  uint32_t allocations = 0;       // Allocations made by the handler (HEAP_MONITOR_ALLOC_HOOKS)
+  uint64_t allocatedBytes = 0;    // Bytes requested by them
+  uint32_t peakBytes = 0;         // Largest drop of free heap below its level at request start
+  int32_t netBlocks = 0;          // Sum of allocated-block deltas
+  int32_t netBytes = 0;           // Sum of allocated-byte deltas
+  int32_t maxRequestBytes = 0;    // Largest single-request byte delta
+  uint32_t minLargestFree = UINT32_MAX;  // Smallest largest-free-block seen after request
+};
+
+class HeapMonitor {
+public:
+  // Constructor
+  HeapMonitor();
+
+  // Register route, returns its id (routes beyond capacity share the last slot)
+  uint8_t registerRoute(const char* path);
+
+  // Snapshot heap before a handler runs
+  void beginRequest();
+
+  // Account heap change of the handler to route
+  void endRequest(uint8_t route);
+
+  // Serialize global heap state and per-route counters
+  void writeJSON(JsonWriter& json) const;
+
+private:
+  RouteHeapStats m_routes[HEAP_MONITOR_MAX_ROUTES];
+  uint8_t m_routeCount;
+
+  // Snapshot taken by beginRequest()
+  uint32_t m_startBlocks;
+  uint32_t m_startBytes;
+  uint32_t m_startFree;
+
+  // Lifetime minimum free heap before the local minimum window opened
+  // (the window replaces it until endRequest())
+  uint32_t m_minFreeBefore;
+  bool m_windowOpen;
+};
+
+#endif // HEAP_MONITOR_H
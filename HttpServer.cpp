@@ -0,0 +1,363 @@
+/*
+ * HTTP Server Implementation
+ */
+
+#include "HttpServer.h"
+#include <lwip/sockets.h>
+#include <ctype.h>
+#include <errno.h>
+
+// Request buffer (requests are served one at a time from loop(), so a single
+// buffer holds the request line, headers and form body of the current one)
+static char s_request[HTTP_REQUEST_BUFFER_SIZE];
+
+static_assert(HTTP_REQUEST_BUFFER_SIZE >= 512, "Request buffer must hold a browser's request headers");
+
+// Reason phrase of the status codes the station sends
+static const char* getReason(int code) {
+  switch (code) {
+    case 200: return "OK";
+    case 304: return "Not Modified";
+    case 400: return "Bad Request";
+    case 401: return "Unauthorized";
+    case 404: return "Not Found";
+    case 413: return "Payload Too Large";
+    case 431: return "Request Header Fields Too Large";
+    case 500: return "Internal Server Error";
+    default: return "Error";
+  }
+}
+
+// Decode %xx and '+' in place
+static void urlDecode(char* text) {
+  char* out = text;
+  for (const char* in = text; *in; in++) {
+    if (*in == '%' && isxdigit((unsigned char)in[1]) && isxdigit((unsigned char)in[2])) {
+      const char hex[3] = { in[1], in[2], 0 };
+      *out++ = (char)strtol(hex, nullptr, 16);
+      in += 2;
+    } else {
+      *out++ = *in == '+' ? ' ' : *in;
+    }
+  }
+  *out = 0;
+}
+
+// Constructor
+HttpServer::HttpServer(uint16_t port)
+  : m_port(port),
+    m_listenFd(-1),
+    m_clientFd(-1),
+    m_requests(0),
+    m_routeCount(0),
+    m_method(HttpMethod::GET),
+    m_path(""),
+    m_argCount(0),
+    m_ifNoneMatch(""),
+    m_authorization("") {
+}
+
+// Non-blocking listen socket, polled by handleClient()
+void HttpServer::begin() {
+  m_listenFd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (m_listenFd < 0) {
+    Serial.println("HTTP server: no socket available");
+    return;
+  }
+  const int one = 1;
+  setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(m_port);
+  address.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(m_listenFd, (const sockaddr*)&address, sizeof(address)) != 0 || listen(m_listenFd, 4) != 0) {
+    Serial.printf("HTTP server: cannot listen on port %u\n", m_port);
+    close(m_listenFd);
+    m_listenFd = -1;
+    return;
+  }
+  fcntl(m_listenFd, F_SETFL, fcntl(m_listenFd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+// Register route
+bool HttpServer::on(const char* path, Handler handler) {
+  if (m_routeCount >= HTTP_MAX_ROUTES) {
+    Serial.printf("HTTP server: route table full, %s not served\n", path);
+    return false;
+  }
+  m_routes[m_routeCount++] = { path, handler };
+  return true;
+}
+
+// Register handler for unmatched paths
+void HttpServer::onNotFound(Handler handler) {
+  m_notFound = handler;
+}
+
+// Accept, parse, dispatch and close one connection
+void HttpServer::handleClient() {
+  if (m_listenFd < 0) {
+    return;
+  }
+  m_clientFd = accept(m_listenFd, nullptr, nullptr);
+  if (m_clientFd < 0) {
+    return;
+  }
+  fcntl(m_clientFd, F_SETFL, fcntl(m_clientFd, F_GETFL, 0) | O_NONBLOCK);
+
+  const int status = readRequest();
+  if (status == 0) {
+    m_requests++;
+    uint8_t route = 0;
+    while (route < m_routeCount && strcmp(m_routes[route].path, m_path) != 0) {
+      route++;
+    }
+    if (route < m_routeCount) {
+      m_routes[route].handler();
+    } else if (m_notFound) {
+      m_notFound();
+    } else {
+      send(404, "text/plain", "404: Not Found");
+    }
+  } else if (status > 0) {
+    send(status, "text/plain", getReason(status));
+
+    // Unread input would make close() reset the connection before the
+    // client has read the error - discard what already arrived
+    for (uint8_t i = 0; i < 8 && recv(m_clientFd, s_request, sizeof(s_request), 0) > 0; i++) {
+    }
+  }
+
+  close(m_clientFd);
+  m_clientFd = -1;
+}
+
+// Wait for the client socket
+bool HttpServer::waitClient(bool write, uint32_t deadline) const {
+  const int32_t remaining = (int32_t)(deadline - millis());
+  if (remaining <= 0) {
+    return false;
+  }
+  fd_set set;
+  FD_ZERO(&set);
+  FD_SET(m_clientFd, &set);
+  timeval timeout = { remaining / 1000, (remaining % 1000) * 1000 };
+  return select(m_clientFd + 1, write ? nullptr : &set, write ? &set : nullptr, nullptr, &timeout) > 0;
+}
+
+// Split arguments
+void HttpServer::parseArgs(char* text) {
+  char* save = nullptr;
+  for (char* pair = strtok_r(text, "&", &save); pair && m_argCount < HTTP_MAX_ARGS;
+       pair = strtok_r(nullptr, "&", &save)) {
+    char* value = strchr(pair, '=');
+    if (value) {
+      *value++ = 0;
+      urlDecode(value);
+    } else {
+      value = pair + strlen(pair);
+    }
+    urlDecode(pair);
+    m_args[m_argCount++] = { pair, value };
+  }
+}
+
+// Read the header block (and a form body behind it) into s_request
+int HttpServer::readRequest() {
+  m_method = HttpMethod::GET;
+  m_path = "";
+  m_argCount = 0;
+  m_ifNoneMatch = "";
+  m_authorization = "";
+
+  const uint32_t deadline = millis() + HTTP_CLIENT_TIMEOUT_MS;
+  size_t length = 0;
+  char* end = nullptr;
+  while (!end) {
+    if (length >= sizeof(s_request) - 1) {
+      return 431;
+    }
+    const int count = recv(m_clientFd, s_request + length, sizeof(s_request) - 1 - length, 0);
+    if (count > 0) {
+      length += count;
+      s_request[length] = 0;
+      end = strstr(s_request, "\r\n\r\n");
+    } else if (count == 0 || (errno != EAGAIN && errno != EWOULDBLOCK) || !waitClient(false, deadline)) {
+      return -1;
+    }
+  }
+  *end = 0;
+  char* body = end + 4;
+
+  // Request line
+  char* save = nullptr;
+  const char* method = strtok_r(s_request, " ", &save);
+  char* target = strtok_r(nullptr, " ", &save);
+  strtok_r(nullptr, "\r\n", &save);  // HTTP version
+  if (!method || !target) {
+    return 400;
+  }
+  m_method = !strcmp(method, "GET") ? HttpMethod::GET
+             : !strcmp(method, "POST") ? HttpMethod::POST
+             : !strcmp(method, "HEAD") ? HttpMethod::HEAD
+             : HttpMethod::OTHER;
+
+  // Header lines (only the ones the routes use are kept)
+  size_t contentLength = 0;
+  bool form = false;
+  for (char* line = strtok_r(nullptr, "\r\n", &save); line; line = strtok_r(nullptr, "\r\n", &save)) {
+    char* value = strchr(line, ':');
+    if (!value) {
+      continue;
+    }
+    *value++ = 0;
+    while (*value == ' ') {
+      value++;
+    }
+    if (!strcasecmp(line, "If-None-Match")) {
+      m_ifNoneMatch = value;
+    } else if (!strcasecmp(line, "Authorization")) {
+      m_authorization = value;
+    } else if (!strcasecmp(line, "Content-Length")) {
+      contentLength = strtoul(value, nullptr, 10);
+    } else if (!strcasecmp(line, "Content-Type")) {
+      form = strstr(value, "application/x-www-form-urlencoded") != nullptr;
+    }
+  }
+
+  // Path and query
+  char* query = strchr(target, '?');
+  if (query) {
+    *query++ = 0;
+    parseArgs(query);
+  }
+  m_path = target;
+
+  // Form body, behind the header block in the same buffer
+  if (contentLength > (size_t)(s_request + sizeof(s_request) - 1 - body)) {
+    return 413;
+  }
+  size_t received = length - (body - s_request);
+  while (received < contentLength) {
+    const int count = recv(m_clientFd, body + received, contentLength - received, 0);
+    if (count > 0) {
+      received += count;
+    } else if (count == 0 || (errno != EAGAIN && errno != EWOULDBLOCK) || !waitClient(false, deadline)) {
+      return -1;
+    }
+  }
+  body[contentLength] = 0;
+  if (form && m_method == HttpMethod::POST) {
+    parseArgs(body);
+  }
+  return 0;
+}
+
+// Argument lookup
+bool HttpServer::hasArg(const char* name) const {
+  for (uint8_t i = 0; i < m_argCount; i++) {
+    if (!strcmp(m_args[i].name, name)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+const char* HttpServer::arg(const char* name) const {
+  for (uint8_t i = 0; i < m_argCount; i++) {
+    if (!strcmp(m_args[i].name, name)) {
+      return m_args[i].value;
+    }
+  }
+  return "";
+}
+
+// Kept request headers
+const char* HttpServer::header(const char* name) const {
+  if (!strcasecmp(name, "If-None-Match")) {
+    return m_ifNoneMatch;
+  }
+  if (!strcasecmp(name, "Authorization")) {
+    return m_authorization;
+  }
+  return "";
+}
+
+// "Basic <base64 user:password>", decoded on the stack
+bool HttpServer::authenticate(const char* username, const char* password) const {
+  if (strncmp(m_authorization, "Basic ", 6) != 0) {
+    return false;
+  }
+  static const char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  char decoded[96];
+  size_t length = 0;
+  uint32_t bits = 0;
+  int count = 0;
+  for (const char* in = m_authorization + 6; *in && *in != '='; in++) {
+    const char* position = strchr(ALPHABET, *in);
+    if (!position || length >= sizeof(decoded) - 1) {
+      return false;
+    }
+    bits = (bits << 6) | (uint32_t)(position - ALPHABET);
+    count += 6;
+    if (count >= 8) {
+      count -= 8;
+      decoded[length++] = (char)((bits >> count) & 0xFF);
+    }
+  }
+  decoded[length] = 0;
+
+  char expected[96];
+  snprintf(expected, sizeof(expected), "%s:%s", username, password);
+  return strcmp(decoded, expected) == 0;
+}
+
+// Basic auth challenge
+void HttpServer::requestAuthentication() {
+  send(401, "text/plain", (const uint8_t*)"", 0, "WWW-Authenticate: Basic realm=\"Login Required\"\r\n");
+}
+
+// Status line, headers and body from fixed buffers
+void HttpServer::send(int code, const char* contentType, const uint8_t* body, size_t length,
+                      const char* extraHeaders) {
+  char header[256];
+  int headerLength;
+  if (contentType) {
+    headerLength = snprintf(header, sizeof(header),
+                            "HTTP/1.1 %d %s\r\n"
+                            "Content-Type: %s\r\n"
+                            "Content-Length: %u\r\n"
+                            "%s"
+                            "Connection: close\r\n\r\n",
+                            code, getReason(code), contentType, (unsigned)length, extraHeaders);
+  } else {
+    headerLength = snprintf(header, sizeof(header),
+                            "HTTP/1.1 %d %s\r\n"
+                            "%s"
+                            "Connection: close\r\n\r\n",
+                            code, getReason(code), extraHeaders);
+    length = 0;
+  }
+
+  if (writeAll((const uint8_t*)header, min<size_t>(headerLength, sizeof(header) - 1))
+      && m_method != HttpMethod::HEAD) {
+    writeAll(body, length);
+  }
+}
+
+// Send in as many pieces as the socket buffer takes (gives up when the
+// client stops reading for HTTP_CLIENT_TIMEOUT_MS)
+bool HttpServer::writeAll(const uint8_t* data, size_t length) {
+  size_t written = 0;
+  while (written < length) {
+    const int count = ::send(m_clientFd, data + written, length - written, MSG_NOSIGNAL);
+    if (count > 0) {
+      written += count;
+    } else if (count == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)
+               || !waitClient(true, millis() + HTTP_CLIENT_TIMEOUT_MS)) {
+      return false;
+    }
+  }
+  return true;
+}
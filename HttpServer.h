@@ -0,0 +1,114 @@
+/*
+ * HTTP Server for ESP32 Weather Station
+ * Replaces the core's WebServer, which builds a String for the URI and for
+ * every header and argument of each request. Connections are accepted from
+ * a raw lwIP socket, one per handleClient() (Connection: close), and the
+ * request is read into one static buffer and parsed in place: request line,
+ * query and urlencoded form arguments, If-None-Match and Authorization.
+ * Responses are written straight to the socket - no heap on either path.
+ */
+
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include <Arduino.h>
+#include <functional>
+#include "Config.h"
+
+enum class HttpMethod : uint8_t {
+  GET,
+  HEAD,
+  POST,
+  OTHER
+};
+
+class HttpServer {
+public:
+  using Handler = std::function<void()>;
+
+  // Constructor
+  explicit HttpServer(uint16_t port);
+
+  // Start listening on all interfaces
+  void begin();
+
+  // Route an exact path, any method (false beyond HTTP_MAX_ROUTES)
+  bool on(const char* path, Handler handler);
+  void onNotFound(Handler handler);
+
+  // Serve one pending connection, if any (call in loop)
+  void handleClient();
+
+  // Current request - strings point into the request buffer and stay
+  // valid until the handler returns ("" when absent)
+  HttpMethod method() const {
+    return m_method;
+  }
+  const char* path() const {
+    return m_path;
+  }
+  bool hasArg(const char* name) const;
+  const char* arg(const char* name) const;
+  const char* header(const char* name) const;
+
+  // HTTP basic auth against the Authorization header
+  bool authenticate(const char* username, const char* password) const;
+
+  // 401 with a basic auth challenge
+  void requestAuthentication();
+
+  // Complete response (extraHeaders: header lines, each ending in "\r\n";
+  // contentType nullptr: no entity headers, e.g. for a 304)
+  void send(int code, const char* contentType, const uint8_t* body, size_t length, const char* extraHeaders = "");
+  void send(int code, const char* contentType, const char* text) {
+    send(code, contentType, (const uint8_t*)text, strlen(text));
+  }
+
+  // Requests parsed and dispatched
+  uint32_t getRequests() const {
+    return m_requests;
+  }
+
+private:
+  struct Route {
+    const char* path;
+    Handler handler;
+  };
+
+  struct Pair {
+    const char* name;
+    const char* value;
+  };
+
+  uint16_t m_port;
+  int m_listenFd;
+  int m_clientFd;
+  uint32_t m_requests;
+
+  Route m_routes[HTTP_MAX_ROUTES];
+  uint8_t m_routeCount;
+  Handler m_notFound;
+
+  // Current request (pointers into the static request buffer)
+  HttpMethod m_method;
+  const char* m_path;
+  Pair m_args[HTTP_MAX_ARGS];
+  uint8_t m_argCount;
+  const char* m_ifNoneMatch;
+  const char* m_authorization;
+
+  // Read and parse the request - 0 when complete, else the status to answer
+  // with (-1: client gone or too slow, nothing is sent)
+  int readRequest();
+
+  // Wait until the client socket is readable/writable or the deadline passes
+  bool waitClient(bool write, uint32_t deadline) const;
+
+  // Split "a=1&b=2" into m_args, decoded in place
+  void parseArgs(char* text);
+
+  // Write all of data to the client socket
+  bool writeAll(const uint8_t* data, size_t length);
+};
+
+#endif // HTTP_SERVER_H
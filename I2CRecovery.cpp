@@ -0,0 +1,42 @@
+/*
+ * I2C Bus Recovery Implementation
+ */
+
+#include "I2CRecovery.h"
+
+// Bus clear (NXP UM10204 3.1.16): pulse SCL until the slave releases SDA,
+// then generate a STOP condition so every device returns to idle
+bool clearI2CBus(TwoWire& wire, uint8_t sdaPin, uint8_t sclPin) {
+  // Detach pins from the I2C peripheral so they can be driven as GPIO
+  wire.end();
+
+  pinMode(sdaPin, INPUT_PULLUP);
+  pinMode(sclPin, OUTPUT_OPEN_DRAIN);
+  digitalWrite(sclPin, HIGH);
+  delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+
+  // A slave holding SDA low is mid-byte - clock out the remaining bits
+  for (uint8_t i = 0; i < I2C_RECOVERY_CLOCK_PULSES && digitalRead(sdaPin) == LOW; i++) {
+    digitalWrite(sclPin, LOW);
+    delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+    digitalWrite(sclPin, HIGH);
+    delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+  }
+
+  // STOP condition: SDA rises while SCL is high
+  pinMode(sdaPin, OUTPUT_OPEN_DRAIN);
+  digitalWrite(sclPin, LOW);
+  delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+  digitalWrite(sdaPin, LOW);
+  delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+  digitalWrite(sclPin, HIGH);
+  delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+  digitalWrite(sdaPin, HIGH);
+  delayMicroseconds(I2C_RECOVERY_HALF_PERIOD_US);
+
+  // Release both lines and check the bus is idle (both high)
+  pinMode(sdaPin, INPUT_PULLUP);
+  pinMode(sclPin, INPUT_PULLUP);
+
+  return digitalRead(sdaPin) == HIGH && digitalRead(sclPin) == HIGH;
+}
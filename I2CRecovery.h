@@ -0,0 +1,69 @@
+/*
+ * I2C Bus Recovery for ESP32 Weather Station
+ * Per-sensor recovery state and bus clear procedure
+ */
+
+#ifndef I2C_RECOVERY_H
+#define I2C_RECOVERY_H
+
+#include <Wire.h>
+#include "Config.h"
+#include "I2CTrace.h"
+
+// Recovery state of a single sensor and its I2C bus
+struct BusState {
+  bool online = false;               // Sensor answered on its last probe/read
+  bool measurementPending = false;   // Conversion started, waiting for collect
+  uint8_t failureCount = 0;          // Consecutive failed reads
+  uint32_t retryDelayMs = I2C_RECOVERY_INITIAL_BACKOFF_MS;
+  uint32_t nextRetryTime = 0;        // millis() of next recovery attempt
+  uint32_t recoveryCount = 0;        // Successful in-place recoveries
+};
+
+// Sensor answered - reset failure counter and backoff
+inline void markOnline(BusState& state) {
+  state.online = true;
+  state.failureCount = 0;
+  state.retryDelayMs = I2C_RECOVERY_INITIAL_BACKOFF_MS;
+}
+
+// Sensor failed a read - take it offline after repeated failures
+// First recovery attempt is due immediately
+inline void recordFailure(BusState& state, uint32_t currentTime) {
+  if (++state.failureCount >= I2C_RECOVERY_FAILURE_THRESHOLD) {
+    state.online = false;
+    state.nextRetryTime = currentTime;
+    state.retryDelayMs = I2C_RECOVERY_INITIAL_BACKOFF_MS;
+  }
+}
+
+// Recovery failed - schedule next attempt with capped exponential backoff
+inline void scheduleRetry(BusState& state, uint32_t currentTime) {
+  state.online = false;
+  state.nextRetryTime = currentTime + state.retryDelayMs;
+  state.retryDelayMs = min(state.retryDelayMs * 2, I2C_RECOVERY_MAX_BACKOFF_MS);
+}
+
+// Time until the scheduled attempt in whole seconds, rounded up (journaled
+// as a 16-bit argument, which cannot hold the capped backoff in ms)
+inline uint32_t retryDelaySeconds(const BusState& state, uint32_t currentTime) {
+  return (state.nextRetryTime - currentTime + 999) / 1000;
+}
+
+// Offline sensor whose backoff has expired
+inline bool isRetryDue(const BusState& state, uint32_t currentTime) {
+  return !state.online && (int32_t)(currentTime - state.nextRetryTime) >= 0;
+}
+
+// Clock out a stuck slave and generate a STOP condition (bus clear)
+// Detaches the bus from the I2C peripheral - call wire.begin() afterwards
+// Returns true if both lines are released (bus idle)
+bool clearI2CBus(TwoWire& wire, uint8_t sdaPin, uint8_t sclPin);
+
+// Check that a device ACKs its address
+inline bool probeI2CDevice(TwoWire& wire, uint8_t address) {
+  wire.beginTransmission(address);
+  return wire.endTransmission() == 0;
+}
+
+#endif // I2C_RECOVERY_H
@@ -0,0 +1,236 @@
+/*
+ * I2C Transaction Trace Implementation
+ */
+
+#include "I2CTrace.h"
+#include "Varint.h"
+
+#if I2C_TRACE_ENABLED
+
+static const uint8_t TRACE_MAGIC[4] = { 'I', '2', 'C', 'T' };
+
+I2CTrace i2cTrace;
+TracedWire i2cBus1(0);
+TracedWire i2cBus2(1);
+
+// Constructor
+I2CTrace::I2CTrace()
+  : m_length(0),
+    m_lastMicros(0),
+    m_transactions(0),
+    m_dropped(0),
+    m_replay(nullptr),
+    m_replayLength(0),
+    m_replayOffset(0),
+    m_replayMicros(0),
+    m_divergences(0) {
+}
+
+// Encode record, append it only if it fits - once full, recording stops for good
+// (a trace with a hole in it could not be replayed past the hole)
+void I2CTrace::record(uint8_t flags, uint8_t address, uint8_t result, const uint8_t* data, uint8_t length) {
+  const uint32_t now = micros();
+
+  if (m_length == 0) {
+    memcpy(m_buffer, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    m_buffer[4] = I2C_TRACE_VERSION;
+    m_buffer[5] = m_buffer[6] = m_buffer[7] = 0;
+    memcpy(m_buffer + 8, &now, sizeof(now));
+    m_length = I2C_TRACE_HEADER_SIZE;
+    m_lastMicros = now;
+  }
+
+  uint8_t encoded[4 + VARINT_MAX_SIZE + I2C_TRACE_MAX_PAYLOAD];
+  size_t size = 0;
+
+  encoded[size++] = flags;
+  size += writeVarint(encoded + size, now - m_lastMicros);
+  encoded[size++] = address;
+  encoded[size++] = result;
+  encoded[size++] = length;
+  memcpy(encoded + size, data, length);
+  size += length;
+
+  if (m_dropped > 0 || m_length + size > sizeof(m_buffer)) {
+    m_dropped++;
+    return;
+  }
+
+  memcpy(m_buffer + m_length, encoded, size);
+  m_length += size;
+  m_lastMicros = now;
+  m_transactions++;
+}
+
+// Validate header and rewind to the first record
+bool I2CTrace::beginReplay(const uint8_t* trace, size_t length) {
+  if (length < I2C_TRACE_HEADER_SIZE || memcmp(trace, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0 ||
+      trace[4] != I2C_TRACE_VERSION) {
+    return false;
+  }
+
+  m_replay = trace;
+  m_replayLength = length;
+  m_replayOffset = I2C_TRACE_HEADER_SIZE;
+  memcpy(&m_replayMicros, trace + 8, sizeof(m_replayMicros));
+  m_transactions = 0;
+  m_divergences = 0;
+  return true;
+}
+
+// Decode next record, advance the replay clock by its delta
+bool I2CTrace::next(uint8_t& flags, uint8_t& address, uint8_t& result, const uint8_t*& data, uint8_t& length) {
+  size_t offset = m_replayOffset;
+  if (!m_replay || offset >= m_replayLength) {
+    return false;
+  }
+
+  flags = m_replay[offset++];
+  uint32_t delta;
+  if (!readVarint(m_replay, m_replayLength, offset, delta) || offset + 3 > m_replayLength) {
+    return false;
+  }
+  address = m_replay[offset++];
+  result = m_replay[offset++];
+  length = m_replay[offset++];
+  if (offset + length > m_replayLength) {
+    return false;
+  }
+  data = m_replay + offset;
+
+  m_replayOffset = offset + length;
+  m_replayMicros += delta;
+  m_transactions++;
+  return true;
+}
+
+// Count a replayed transaction that did not match the trace
+void I2CTrace::recordDivergence() {
+  m_divergences++;
+}
+
+// Recording / replay state
+void I2CTrace::writeJSON(JsonWriter& json) const {
+  json.addString("mode", isReplaying() ? "replay" : "record");
+  json.addUInt("bytes", isReplaying() ? m_replayOffset : m_length);
+  json.addUInt("capacity", isReplaying() ? m_replayLength : sizeof(m_buffer));
+  json.addUInt("transactions", m_transactions);
+  json.addBool("full", m_dropped > 0);
+  json.addUInt("dropped", m_dropped);
+  json.addUInt("divergences", m_divergences);
+}
+
+// Constructor
+TracedWire::TracedWire(uint8_t busNumber)
+  : TwoWire(busNumber),
+    m_flags(busNumber == 0 ? 0 : I2C_TRACE_BUS2),
+    m_address(0),
+    m_txLength(0),
+    m_txTruncated(false),
+    m_rxLength(0),
+    m_rxOffset(0) {
+}
+
+// Start a write - written bytes are captured until endTransmission()
+void TracedWire::beginTransmission(uint16_t address) {
+  m_address = address;
+  m_txLength = 0;
+  m_txTruncated = false;
+
+  if (!i2cTrace.isReplaying()) {
+    TwoWire::beginTransmission(address);
+  }
+}
+
+// Buffer writes all go through here (TwoWire::write(data, length) loops over write(uint8_t))
+size_t TracedWire::write(uint8_t data) {
+  if (m_txLength < sizeof(m_tx)) {
+    m_tx[m_txLength++] = data;
+  } else {
+    m_txTruncated = true;
+  }
+
+  return i2cTrace.isReplaying() ? 1 : TwoWire::write(data);
+}
+
+// Send (or compare against the trace) and record the result code
+uint8_t TracedWire::endTransmission(bool sendStop) {
+  if (i2cTrace.isReplaying()) {
+    uint8_t flags, address, result, length;
+    const uint8_t* data;
+
+    if (!i2cTrace.next(flags, address, result, data, length)) {
+      i2cTrace.recordDivergence();
+      return 4;  // Other error - trace exhausted
+    }
+    if ((flags & (I2C_TRACE_READ | I2C_TRACE_BUS2)) != m_flags || address != m_address ||
+        length != m_txLength || memcmp(data, m_tx, length) != 0) {
+      i2cTrace.recordDivergence();
+    }
+    return result;
+  }
+
+  const uint8_t result = TwoWire::endTransmission(sendStop);
+  i2cTrace.record(m_flags | (m_txTruncated ? I2C_TRACE_TRUNCATED : 0), m_address, result, m_tx, m_txLength);
+  return result;
+}
+
+uint8_t TracedWire::endTransmission() {
+  return endTransmission(true);
+}
+
+// Read into the local buffer (recorded), callers consume it through read()
+size_t TracedWire::requestFrom(uint16_t address, size_t length, bool sendStop) {
+  m_rxLength = 0;
+  m_rxOffset = 0;
+  const uint8_t requested = length > 255 ? 255 : length;
+
+  if (i2cTrace.isReplaying()) {
+    uint8_t flags, recordedAddress, recordedRequested, count;
+    const uint8_t* data;
+
+    if (!i2cTrace.next(flags, recordedAddress, recordedRequested, data, count) ||
+        (flags & (I2C_TRACE_READ | I2C_TRACE_BUS2)) != (m_flags | I2C_TRACE_READ) ||
+        recordedAddress != address || recordedRequested != requested) {
+      i2cTrace.recordDivergence();
+      return 0;
+    }
+    memcpy(m_rx, data, count);
+    m_rxLength = count;
+    return count;
+  }
+
+  const size_t received = TwoWire::requestFrom(address, length, sendStop);
+  while (m_rxLength < sizeof(m_rx) && TwoWire::available() > 0) {
+    m_rx[m_rxLength++] = TwoWire::read();
+  }
+
+  const uint8_t flags = m_flags | I2C_TRACE_READ | (received > m_rxLength ? I2C_TRACE_TRUNCATED : 0);
+  i2cTrace.record(flags, address, requested, m_rx, m_rxLength);
+  return received;
+}
+
+size_t TracedWire::requestFrom(uint16_t address, size_t length) {
+  return requestFrom(address, length, true);
+}
+
+// Captured bytes first, then whatever did not fit (truncated reads, recording only)
+int TracedWire::available() {
+  return (m_rxLength - m_rxOffset) + (i2cTrace.isReplaying() ? 0 : TwoWire::available());
+}
+
+int TracedWire::read() {
+  if (m_rxOffset < m_rxLength) {
+    return m_rx[m_rxOffset++];
+  }
+  return i2cTrace.isReplaying() ? -1 : TwoWire::read();
+}
+
+int TracedWire::peek() {
+  if (m_rxOffset < m_rxLength) {
+    return m_rx[m_rxOffset];
+  }
+  return i2cTrace.isReplaying() ? -1 : TwoWire::peek();
+}
+
+#endif
@@ -0,0 +1,145 @@
+/*
+ * I2C Transaction Trace for ESP32 Weather Station
+ * TracedWire is a TwoWire that logs every transaction (address, written
+ * bytes + result, or read bytes) with a µs timestamp delta into a
+ * compact binary trace kept in RAM from boot until the buffer is full
+ * (replays need the init and calibration reads). /api/v1/debug/trace
+ * downloads it.
+ *
+ * The same class replays a trace on host builds: transactions are answered
+ * from the trace in order and written bytes are compared against it, so
+ * SensorManager runs on field data deterministically and any change in the
+ * firmware's bus traffic shows up as a divergence.
+ *
+ * Trace format (little endian):
+ *   header  "I2CT", u8 version, u8 reserved[3], u32 micros() at start
+ *   record  u8 flags (bit0 read, bit1 bus 2, bit2 truncated), varint µs since
+ *           previous record, u8 address, u8 result (write: endTransmission
+ *           code, read: bytes requested), u8 length, length bytes
+ */
+
+#ifndef I2C_TRACE_H
+#define I2C_TRACE_H
+
+#include <Wire.h>
+#include "Config.h"
+#include "JsonWriter.h"
+
+#if I2C_TRACE_ENABLED
+
+constexpr uint8_t I2C_TRACE_VERSION = 1;
+constexpr uint8_t I2C_TRACE_HEADER_SIZE = 12;
+constexpr uint8_t I2C_TRACE_MAX_PAYLOAD = 32;  // Bytes kept per transaction (longer ones are truncated)
+
+// Record flags
+constexpr uint8_t I2C_TRACE_READ = 0x01;
+constexpr uint8_t I2C_TRACE_BUS2 = 0x02;
+constexpr uint8_t I2C_TRACE_TRUNCATED = 0x04;
+
+class I2CTrace {
+public:
+  // Constructor - starts recording (header written with the first record)
+  I2CTrace();
+
+  // Append a transaction (recording mode, stops silently when full)
+  void record(uint8_t flags, uint8_t address, uint8_t result, const uint8_t* data, uint8_t length);
+
+  // Switch to replay of a recorded trace (host builds)
+  // Returns false if the header is invalid
+  bool beginReplay(const uint8_t* trace, size_t length);
+
+  // Next recorded transaction (replay mode). Returns false at the end of the trace
+  bool next(uint8_t& flags, uint8_t& address, uint8_t& result, const uint8_t*& data, uint8_t& length);
+
+  inline bool isReplaying() const {
+    return m_replay != nullptr;
+  }
+
+  // micros() of the last replayed transaction - the host clock jumps forward to it
+  // (and advances by delays in between) so driver timeouts replay as recorded
+  inline uint32_t getReplayMicros() const {
+    return m_replayMicros;
+  }
+
+  // Replayed write that differed from the trace / transaction of another kind
+  void recordDivergence();
+
+  inline uint32_t getDivergences() const {
+    return m_divergences;
+  }
+
+  // Recorded trace (header + records)
+  inline const uint8_t* getData() const {
+    return m_buffer;
+  }
+
+  inline size_t getLength() const {
+    return m_length;
+  }
+
+  // Serialize recording / replay state
+  void writeJSON(JsonWriter& json) const;
+
+private:
+  uint8_t m_buffer[I2C_TRACE_BUFFER_SIZE];
+  size_t m_length;
+  uint32_t m_lastMicros;
+  uint32_t m_transactions;
+  uint32_t m_dropped;      // Transactions not recorded because the buffer was full
+
+  // Replay state
+  const uint8_t* m_replay;
+  size_t m_replayLength;
+  size_t m_replayOffset;
+  uint32_t m_replayMicros;
+  uint32_t m_divergences;
+};
+
+// I2C bus that records (or replays) every transaction through i2cTrace
+class TracedWire : public TwoWire {
+public:
+  TracedWire(uint8_t busNumber);
+
+  using TwoWire::beginTransmission;
+  using TwoWire::endTransmission;
+  using TwoWire::requestFrom;
+  using TwoWire::write;
+
+  void beginTransmission(uint16_t address) override;
+  uint8_t endTransmission(bool sendStop) override;
+  uint8_t endTransmission() override;
+  size_t requestFrom(uint16_t address, size_t length, bool sendStop) override;
+  size_t requestFrom(uint16_t address, size_t length) override;
+  size_t write(uint8_t data) override;
+  int available() override;
+  int read() override;
+  int peek() override;
+
+private:
+  uint8_t m_flags;        // I2C_TRACE_BUS2 for the second bus
+  uint8_t m_address;
+  uint8_t m_tx[I2C_TRACE_MAX_PAYLOAD];
+  uint8_t m_txLength;
+  bool m_txTruncated;
+
+  // Bytes of the last requestFrom() (served by read())
+  uint8_t m_rx[I2C_TRACE_MAX_PAYLOAD];
+  uint8_t m_rxLength;
+  uint8_t m_rxOffset;
+};
+
+extern I2CTrace i2cTrace;
+
+// Buses used by all drivers (Wire / Wire1 with recording)
+extern TracedWire i2cBus1;
+extern TracedWire i2cBus2;
+
+#else
+
+// Buses used by all drivers
+inline TwoWire& i2cBus1 = Wire;
+inline TwoWire& i2cBus2 = Wire1;
+
+#endif
+
+#endif // I2C_TRACE_H
@@ -0,0 +1,142 @@
+/*
+ * JSON Writer Implementation
+ */
+
+#include "JsonWriter.h"
+#include <stdarg.h>
+
+// Constructor
+JsonWriter::JsonWriter(char* buffer, size_t bufferSize)
+  : m_buffer(buffer),
+    m_size(bufferSize),
+    m_offset(0),
+    m_overflow(false),
+    m_hasElement(0),
+    m_depth(0) {
+  if (m_size > 0) {
+    m_buffer[0] = '\0';
+  }
+}
+
+// Start object
+void JsonWriter::beginObject(const char* key) {
+  writeKey(key);
+  append("{");
+  m_depth++;
+  m_hasElement &= ~(1UL << m_depth);
+}
+
+// Close object
+void JsonWriter::endObject() {
+  append("}");
+  m_depth--;
+}
+
+// Start array
+void JsonWriter::beginArray(const char* key) {
+  writeKey(key);
+  append("[");
+  m_depth++;
+  m_hasElement &= ~(1UL << m_depth);
+}
+
+// Close array
+void JsonWriter::endArray() {
+  append("]");
+  m_depth--;
+}
+
+// Add float (null if NaN/Inf - JSON has no representation for them)
+void JsonWriter::addFloat(const char* key, float value, uint8_t decimals) {
+  writeKey(key);
+  if (isfinite(value)) {
+    append("%.*f", decimals, value);
+  } else {
+    append("null");
+  }
+}
+
+// Add signed integer
+void JsonWriter::addInt(const char* key, int32_t value) {
+  writeKey(key);
+  append("%ld", (long)value);
+}
+
+// Add unsigned integer
+void JsonWriter::addUInt(const char* key, uint32_t value) {
+  writeKey(key);
+  append("%lu", (unsigned long)value);
+}
+
+void JsonWriter::addUInt64(const char* key, uint64_t value) {
+  writeKey(key);
+  append("%llu", (unsigned long long)value);
+}
+
+// Add boolean
+void JsonWriter::addBool(const char* key, bool value) {
+  writeKey(key);
+  append(value ? "true" : "false");
+}
+
+// Add string (values are firmware constants - quotes and backslashes are escaped only)
+void JsonWriter::addString(const char* key, const char* value) {
+  writeKey(key);
+  append("\"");
+  for (const char* c = value; *c; c++) {
+    if (*c == '"' || *c == '\\') {
+      append("\\%c", *c);
+    } else {
+      append("%c", *c);
+    }
+  }
+  append("\"");
+}
+
+// Add null
+void JsonWriter::addNull(const char* key) {
+  writeKey(key);
+  append("null");
+}
+
+// Add pre-rendered JSON value
+void JsonWriter::addRaw(const char* key, const char* json) {
+  writeKey(key);
+  append("%s", json);
+}
+
+// Write comma separator (if needed) and key
+void JsonWriter::writeKey(const char* key) {
+  if (m_depth > 0) {
+    const uint32_t bit = 1UL << m_depth;
+    if (m_hasElement & bit) {
+      append(",");
+    }
+    m_hasElement |= bit;
+  }
+
+  if (key) {
+    append("\"%s\":", key);
+  }
+}
+
+// Append formatted text at current offset
+void JsonWriter::append(const char* format, ...) {
+  if (m_overflow) {
+    return;
+  }
+
+  va_list args;
+  va_start(args, format);
+  const int written = vsnprintf(m_buffer + m_offset, m_size - m_offset, format, args);
+  va_end(args);
+
+  if (written < 0 || m_offset + written >= m_size) {
+    // Keep only what fitted, never point past the buffer
+    m_overflow = true;
+    m_offset = m_size > 0 ? m_size - 1 : 0;
+    return;
+  }
+
+  m_offset += written;
+}
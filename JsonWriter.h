@@ -0,0 +1,62 @@
+/*
+ * JSON Writer for ESP32 Weather Station
+ * Builds JSON into a caller-provided buffer with snprintf (no heap usage)
+ * Non-finite numbers are written as null, output is truncated safely
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <Arduino.h>
+
+class JsonWriter {
+public:
+  // Constructor - buffer is always kept NUL-terminated
+  JsonWriter(char* buffer, size_t bufferSize);
+
+  // Objects and arrays (key is nullptr inside arrays and for the root)
+  void beginObject(const char* key = nullptr);
+  void endObject();
+  void beginArray(const char* key = nullptr);
+  void endArray();
+
+  // Values (key is nullptr inside arrays)
+  void addFloat(const char* key, float value, uint8_t decimals = 2);
+  void addInt(const char* key, int32_t value);
+  void addUInt(const char* key, uint32_t value);
+  void addUInt64(const char* key, uint64_t value);
+  void addBool(const char* key, bool value);
+  void addString(const char* key, const char* value);
+  void addNull(const char* key);
+
+  // Insert pre-rendered JSON value verbatim
+  void addRaw(const char* key, const char* json);
+
+  // Number of characters written (excluding NUL)
+  inline size_t length() const {
+    return m_offset;
+  }
+
+  // True if output did not fit into the buffer
+  inline bool overflowed() const {
+    return m_overflow;
+  }
+
+private:
+  char* m_buffer;
+  size_t m_size;
+  size_t m_offset;
+  bool m_overflow;
+
+  // One bit per nesting level: set once the level has its first element
+  uint32_t m_hasElement;
+  uint8_t m_depth;
+
+  // Write separator and "key": prefix for next element
+  void writeKey(const char* key);
+
+  // Append formatted text, clamping on overflow
+  void append(const char* format, ...);
+};
+
+#endif // JSON_WRITER_H
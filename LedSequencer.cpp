@@ -0,0 +1,112 @@
+/*
+ * LED Pattern Sequencer Implementation
+ */
+
+#include "LedSequencer.h"
+
+// Highest ErrorType value (patterns are cycled in enum order)
+constexpr uint8_t ERROR_TYPE_COUNT = (uint8_t)ErrorType::CRITICAL_ERROR;
+
+// Constructor
+LedSequencer::LedSequencer()
+  : m_shownError(ErrorType::NONE),
+    m_blinkCount(0),
+    m_phaseOn(false),
+    m_phaseEnd(0) {
+}
+
+// Advance pattern and return LED state
+bool LedSequencer::tick(uint32_t currentTime, uint8_t activeErrors) {
+  if (activeErrors == 0) {
+    // Normal operation: LED off (energy saving)
+    m_shownError = ErrorType::NONE;
+    m_phaseOn = false;
+    return false;
+  }
+
+  // Shown error was cleared (or idle) - switch right away
+  if ((activeErrors & errorBit(m_shownError)) == 0) {
+    startNext(currentTime, activeErrors);
+    return m_phaseOn;
+  }
+
+  if ((int32_t)(currentTime - m_phaseEnd) < 0) {
+    return m_phaseOn;
+  }
+
+  // Fell behind by more than a phase (e.g. timer starved) - resync instead of
+  // replaying missed phases as a burst
+  if (currentTime - m_phaseEnd > getOnDuration(m_shownError) + getOffDuration(m_shownError)) {
+    m_phaseEnd = currentTime;
+  }
+
+  const bool multipleErrors = (activeErrors & (activeErrors - 1)) != 0;
+
+  if (m_phaseOn) {
+    // ON -> OFF (last blink of a burst is followed by the gap)
+    m_phaseOn = false;
+    m_blinkCount++;
+
+    if (multipleErrors && m_blinkCount >= LED_PATTERN_BLINKS) {
+      m_phaseEnd += LED_PATTERN_GAP_MS;
+    } else {
+      m_phaseEnd += getOffDuration(m_shownError);
+    }
+  } else if (multipleErrors && m_blinkCount >= LED_PATTERN_BLINKS) {
+    // Burst and gap done - show next active error
+    startNext(m_phaseEnd, activeErrors);
+  } else {
+    // OFF -> ON
+    m_phaseOn = true;
+    m_phaseEnd += getOnDuration(m_shownError);
+  }
+
+  return m_phaseOn;
+}
+
+// Start pattern of next active error (cyclic, in enum order)
+void LedSequencer::startNext(uint32_t startTime, uint8_t activeErrors) {
+  uint8_t index = (uint8_t)m_shownError;
+
+  for (uint8_t i = 0; i < ERROR_TYPE_COUNT; i++) {
+    index = index % ERROR_TYPE_COUNT + 1;
+    const ErrorType candidate = (ErrorType)index;
+
+    if (activeErrors & errorBit(candidate)) {
+      m_shownError = candidate;
+      break;
+    }
+  }
+
+  m_blinkCount = 0;
+  m_phaseOn = true;
+  m_phaseEnd = startTime + getOnDuration(m_shownError);
+}
+
+// Get ON duration for an error
+uint16_t LedSequencer::getOnDuration(ErrorType error) {
+  switch (error) {
+    case ErrorType::WIFI_ERROR:
+      return LED_BLINK_WIFI_ERROR_ON;
+    case ErrorType::SENSOR_ERROR:
+      return LED_BLINK_SENSOR_ERROR_ON;
+    case ErrorType::CRITICAL_ERROR:
+      return LED_BLINK_CRITICAL_ERROR_ON;
+    default:
+      return 0;
+  }
+}
+
+// Get OFF duration for an error
+uint16_t LedSequencer::getOffDuration(ErrorType error) {
+  switch (error) {
+    case ErrorType::WIFI_ERROR:
+      return LED_BLINK_WIFI_ERROR_OFF;
+    case ErrorType::SENSOR_ERROR:
+      return LED_BLINK_SENSOR_ERROR_OFF;
+    case ErrorType::CRITICAL_ERROR:
+      return LED_BLINK_CRITICAL_ERROR_OFF;
+    default:
+      return 0;
+  }
+}
@@ -0,0 +1,43 @@
+/*
+ * LED Pattern Sequencer for ESP32 Weather Station
+ * Pure timing logic (no hardware access) - decides LED state for a set of
+ * active errors. A single error blinks continuously with its own pattern;
+ * several errors are shown one after another, LED_PATTERN_BLINKS blinks
+ * each, separated by a dark gap.
+ */
+
+#ifndef LED_SEQUENCER_H
+#define LED_SEQUENCER_H
+
+#include <Arduino.h>
+#include "Config.h"
+
+// Bit of an error type in an active-error mask (NONE has no bit)
+inline uint8_t errorBit(ErrorType error) {
+  return error == ErrorType::NONE ? 0 : (uint8_t)(1 << ((uint8_t)error - 1));
+}
+
+class LedSequencer {
+public:
+  // Constructor
+  LedSequencer();
+
+  // Advance to currentTime for the given active-error mask
+  // Returns desired LED state
+  bool tick(uint32_t currentTime, uint8_t activeErrors);
+
+private:
+  ErrorType m_shownError;   // Error whose pattern is playing (NONE = idle)
+  uint8_t m_blinkCount;     // Completed blinks of current burst
+  bool m_phaseOn;           // LED on in current phase
+  uint32_t m_phaseEnd;      // millis() when current phase ends
+
+  // Start pattern of the next active error after m_shownError
+  void startNext(uint32_t startTime, uint8_t activeErrors);
+
+  // Get ON/OFF duration for an error
+  static uint16_t getOnDuration(ErrorType error);
+  static uint16_t getOffDuration(ErrorType error);
+};
+
+#endif // LED_SEQUENCER_H
@@ -0,0 +1,89 @@
+/*
+ * Line Protocol Writer Implementation
+ */
+
+#include "LineWriter.h"
+#include <stdarg.h>
+
+// Constructor
+LineWriter::LineWriter(char* buffer, size_t bufferSize)
+  : m_buffer(buffer),
+    m_size(bufferSize),
+    m_offset(0),
+    m_overflow(false),
+    m_hasField(false) {
+  if (m_size > 0) {
+    m_buffer[0] = '\0';
+  }
+}
+
+// Measurement and tags
+void LineWriter::beginLine(const char* series) {
+  append("%s ", series);
+  m_hasField = false;
+}
+
+// Add float field (omitted if NaN/Inf - line protocol has no null)
+void LineWriter::addFloat(const char* key, float value, uint8_t decimals) {
+  if (!isfinite(value)) {
+    return;
+  }
+  writeKey(key);
+  append("%.*f", decimals, value);
+}
+
+// Add integer field
+void LineWriter::addInt(const char* key, int32_t value) {
+  writeKey(key);
+  append("%ldi", (long)value);
+}
+
+// Add boolean field
+void LineWriter::addBool(const char* key, bool value) {
+  writeKey(key);
+  append(value ? "true" : "false");
+}
+
+// Timestamp and newline
+void LineWriter::endLine(uint32_t timestamp) {
+  append(" %lu\n", (unsigned long)timestamp);
+}
+
+// Cut output back to an earlier length (clears overflow)
+void LineWriter::rewind(size_t offset) {
+  if (offset < m_size) {
+    m_offset = offset;
+    m_buffer[m_offset] = '\0';
+    m_overflow = false;
+  }
+}
+
+// Write comma separator (if needed) and key
+void LineWriter::writeKey(const char* key) {
+  if (m_hasField) {
+    append(",");
+  }
+  m_hasField = true;
+  append("%s=", key);
+}
+
+// Append formatted text at current offset
+void LineWriter::append(const char* format, ...) {
+  if (m_overflow) {
+    return;
+  }
+
+  va_list args;
+  va_start(args, format);
+  const int written = vsnprintf(m_buffer + m_offset, m_size - m_offset, format, args);
+  va_end(args);
+
+  if (written < 0 || m_offset + written >= m_size) {
+    // Keep only what fitted, never point past the buffer
+    m_overflow = true;
+    m_offset = m_size > 0 ? m_size - 1 : 0;
+    return;
+  }
+
+  m_offset += written;
+}
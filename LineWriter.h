@@ -0,0 +1,55 @@
+/*
+ * Line Protocol Writer for ESP32 Weather Station
+ * Builds InfluxDB line protocol into a caller-provided buffer (no heap usage)
+ * Non-finite fields are omitted, a line that does not fit can be rewound
+ */
+
+#ifndef LINE_WRITER_H
+#define LINE_WRITER_H
+
+#include <Arduino.h>
+
+class LineWriter {
+public:
+  // Constructor - buffer is always kept NUL-terminated
+  LineWriter(char* buffer, size_t bufferSize);
+
+  // Start a line with measurement and pre-formatted tag set ("weather,station=x")
+  void beginLine(const char* series);
+
+  // Fields (a line needs at least one written field)
+  void addFloat(const char* key, float value, uint8_t decimals = 2);
+  void addInt(const char* key, int32_t value);
+  void addBool(const char* key, bool value);
+
+  // Terminate line with a timestamp in seconds
+  void endLine(uint32_t timestamp);
+
+  // Drop everything written after length() returned offset
+  void rewind(size_t offset);
+
+  // Number of characters written (excluding NUL)
+  inline size_t length() const {
+    return m_offset;
+  }
+
+  // True if output did not fit into the buffer
+  inline bool overflowed() const {
+    return m_overflow;
+  }
+
+private:
+  char* m_buffer;
+  size_t m_size;
+  size_t m_offset;
+  bool m_overflow;
+  bool m_hasField;
+
+  // Write separator and key= prefix for next field
+  void writeKey(const char* key);
+
+  // Append formatted text, clamping on overflow
+  void append(const char* format, ...);
+};
+
+#endif // LINE_WRITER_H
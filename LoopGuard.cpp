@@ -0,0 +1,163 @@
+/*
+ * Loop Latency Guard Implementation
+ */
+
+#include "LoopGuard.h"
+#include "EventLog.h"
+#include <esp_system.h>
+#include <esp_task_wdt.h>
+
+constexpr uint8_t STAGE_COUNT = (uint8_t)LoopStage::COUNT;
+
+// Stall statistics, persisted in RTC RAM across soft/watchdog resets
+struct LoopStats {
+  uint32_t magic;
+  uint8_t runningStage;                  // Stage active right now (read after reset)
+  uint8_t lastWatchdogStage;             // Stage blamed for last watchdog reset
+  uint32_t iterations;                   // Since boot (not persisted meaningfully)
+  uint32_t worstIterationUs;
+  uint32_t stalls[STAGE_COUNT];
+  uint32_t worstUs[STAGE_COUNT];
+  uint32_t watchdogResets[STAGE_COUNT];
+};
+
+constexpr uint32_t LOOP_STATS_MAGIC = 0x4C504731;  // "LPG1"
+
+static RTC_NOINIT_ATTR LoopStats s_stats;
+
+// Constructor
+LoopGuard::LoopGuard()
+  : m_stage(LoopStage::IDLE),
+    m_stageStart(0),
+    m_iterationStart(0) {
+}
+
+// Restore stats and arm watchdog
+void LoopGuard::begin() {
+  const esp_reset_reason_t reason = esp_reset_reason();
+
+  if (reason == ESP_RST_POWERON || reason == ESP_RST_BROWNOUT ||
+      s_stats.magic != LOOP_STATS_MAGIC || s_stats.runningStage >= STAGE_COUNT) {
+    memset(&s_stats, 0, sizeof(s_stats));
+    s_stats.magic = LOOP_STATS_MAGIC;
+  }
+
+  // Stage that was running when the watchdog fired
+  if (reason == ESP_RST_TASK_WDT || reason == ESP_RST_INT_WDT) {
+    s_stats.lastWatchdogStage = s_stats.runningStage;
+    s_stats.watchdogResets[s_stats.runningStage]++;
+    eventLog.log(EventCode::WATCHDOG_RESET, s_stats.runningStage);
+
+    // Always show watchdog resets
+    Serial.printf("[WARN] Watchdog reset during '%s'\n",
+                  getStageName((LoopStage)s_stats.runningStage));
+  }
+
+  s_stats.runningStage = (uint8_t)LoopStage::IDLE;
+  s_stats.iterations = 0;
+
+  #if TASK_WATCHDOG_ENABLED
+  // Arduino core already initialized the TWDT - apply our timeout and
+  // subscribe the loop task (panic => reset)
+  const esp_task_wdt_config_t config = {
+    .timeout_ms = TASK_WATCHDOG_TIMEOUT_MS,
+    .idle_core_mask = 0,
+    .trigger_panic = true
+  };
+
+  if (esp_task_wdt_reconfigure(&config) != ESP_OK) {
+    esp_task_wdt_init(&config);
+  }
+  esp_task_wdt_add(nullptr);
+  #endif
+
+  m_iterationStart = micros();
+  m_stageStart = m_iterationStart;
+}
+
+// Switch to next stage
+void LoopGuard::enterStage(LoopStage stage) {
+  const uint32_t now = micros();
+
+  closeStage(now);
+  m_stage = stage;
+  m_stageStart = now;
+  s_stats.runningStage = (uint8_t)stage;
+}
+
+// Finish iteration and feed watchdog
+void LoopGuard::endIteration() {
+  const uint32_t now = micros();
+
+  closeStage(now);
+  m_stage = LoopStage::IDLE;
+  m_stageStart = now;
+  s_stats.runningStage = (uint8_t)LoopStage::IDLE;
+
+  s_stats.iterations++;
+  s_stats.worstIterationUs = max(s_stats.worstIterationUs, now - m_iterationStart);
+  m_iterationStart = now;
+
+  #if TASK_WATCHDOG_ENABLED
+  esp_task_wdt_reset();
+  #endif
+}
+
+// Account running stage, count a stall if it went over budget
+void LoopGuard::closeStage(uint32_t now) {
+  if (m_stage == LoopStage::IDLE) {
+    return;
+  }
+
+  const uint8_t index = (uint8_t)m_stage;
+  const uint32_t duration = now - m_stageStart;
+
+  if (duration > s_stats.worstUs[index]) {
+    s_stats.worstUs[index] = duration;
+  }
+
+  if (duration > LOOP_STAGE_BUDGET_MS * 1000UL) {
+    s_stats.stalls[index]++;
+    eventLog.log(EventCode::LOOP_STALL, index, duration / 1000);
+  }
+}
+
+// Serialize stall statistics
+void LoopGuard::writeJSON(JsonWriter& json) const {
+  json.addUInt("budgetMs", LOOP_STAGE_BUDGET_MS);
+  json.addUInt("watchdogMs", TASK_WATCHDOG_ENABLED ? TASK_WATCHDOG_TIMEOUT_MS : 0);
+  json.addUInt("iterations", s_stats.iterations);
+  json.addUInt("worstIterationUs", s_stats.worstIterationUs);
+  json.addString("lastWatchdogStage", getStageName((LoopStage)s_stats.lastWatchdogStage));
+
+  json.beginArray("stages");
+  for (uint8_t i = 1; i < STAGE_COUNT; i++) {
+    json.beginObject();
+    json.addString("stage", getStageName((LoopStage)i));
+    json.addUInt("stalls", s_stats.stalls[i]);
+    json.addUInt("worstUs", s_stats.worstUs[i]);
+    json.addUInt("watchdogResets", s_stats.watchdogResets[i]);
+    json.endObject();
+  }
+  json.endArray();
+}
+
+// Short name of a stage
+const char* LoopGuard::getStageName(LoopStage stage) {
+  switch (stage) {
+    case LoopStage::IDLE:
+      return "idle";
+    case LoopStage::HANDLE_CLIENT:
+      return "handleClient";
+    case LoopStage::SAMPLE_SENSORS:
+      return "sampleSensors";
+    case LoopStage::READ_SENSORS:
+      return "readSensors";
+    case LoopStage::PUBLISH:
+      return "publish";
+    case LoopStage::WIFI_CHECK:
+      return "wifiCheck";
+    default:
+      return "unknown";
+  }
+}
@@ -0,0 +1,60 @@
+/*
+ * Loop Latency Guard for ESP32 Weather Station
+ * Feeds the task watchdog and times each stage of loop(). A stage that runs
+ * over budget is counted as a stall against that stage. The running stage is
+ * mirrored in RTC RAM, so a watchdog reset is attributed to the stage that hung.
+ */
+
+#ifndef LOOP_GUARD_H
+#define LOOP_GUARD_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "JsonWriter.h"
+
+// Stages of loop() (stable values - persisted across resets)
+enum class LoopStage : uint8_t {
+  IDLE = 0,
+  HANDLE_CLIENT = 1,
+  SAMPLE_SENSORS = 2,
+  READ_SENSORS = 3,
+  PUBLISH = 4,
+  WIFI_CHECK = 5,
+  COUNT
+};
+
+class LoopGuard {
+public:
+  // Constructor
+  LoopGuard();
+
+  // Restore persisted stats, attribute a watchdog reset and arm the watchdog
+  void begin();
+
+  // Mark start of a busy iteration (idle wait excluded from iteration time)
+  inline void beginIteration() {
+    m_iterationStart = micros();
+  }
+
+  // Close the running stage and start timing the next one
+  void enterStage(LoopStage stage);
+
+  // Close the last stage and feed the watchdog (call at end of loop())
+  void endIteration();
+
+  // Serialize stall statistics
+  void writeJSON(JsonWriter& json) const;
+
+  // Short name of a stage
+  static const char* getStageName(LoopStage stage);
+
+private:
+  LoopStage m_stage;
+  uint32_t m_stageStart;      // micros() when current stage started
+  uint32_t m_iterationStart;  // micros() when current iteration started
+
+  // Account duration of the running stage
+  void closeStage(uint32_t now);
+};
+
+#endif // LOOP_GUARD_H
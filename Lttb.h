@@ -0,0 +1,126 @@
+/*
+ * Largest-Triangle-Three-Buckets Downsampling for ESP32 Weather Station
+ * Reduces a time series to at most N points that keep its visual shape.
+ * Runs as a stream over indexed storage with constant memory: every bucket
+ * is read twice (once averaged as the next bucket's point C, once to pick
+ * the point forming the largest triangle with A and C), nothing is copied.
+ * Bucket bounds are integer, so they are exact (a floating-point bucket
+ * width puts some of them one point short).
+ */
+
+#ifndef LTTB_H
+#define LTTB_H
+
+#include <Arduino.h>
+
+// Downsample points [0, count) to at most 'threshold' points
+// read(i, x, y) loads point i and returns false for gaps (NaN values)
+// - gaps are left out of averages and selection, never emitted
+// emit(i, x, y) receives selected points in order
+// x is a non-decreasing integer (e.g. ms relative to the first point)
+template <typename Reader, typename Emitter>
+void lttbDownsample(uint32_t count, uint32_t threshold, Reader&& read, Emitter&& emit) {
+  uint32_t x;
+  float y;
+
+  // Nothing to drop
+  if (threshold >= count) {
+    for (uint32_t i = 0; i < count; i++) {
+      if (read(i, x, y)) {
+        emit(i, x, y);
+      }
+    }
+    return;
+  }
+
+  // Too few points for triangles: the first valid point, and the last one for 2
+  if (threshold < 3) {
+    uint32_t first = 0;
+    while (threshold > 0 && first < count && !read(first, x, y)) {
+      first++;
+    }
+    if (threshold == 0 || first == count) {
+      return;
+    }
+    emit(first, x, y);
+    for (uint32_t i = count - 1; threshold == 2 && i > first; i--) {
+      if (read(i, x, y)) {
+        emit(i, x, y);
+        break;
+      }
+    }
+    return;
+  }
+
+  // Bucket b covers [bucketStart(b), bucketStart(b + 1)) of the inner points
+  const uint32_t buckets = threshold - 2;
+  auto bucketStart = [count, buckets](uint32_t bucket) {
+    return (uint32_t)((uint64_t)bucket * (count - 2) / buckets) + 1;
+  };
+
+  // First point is always kept
+  uint32_t ax = 0;
+  float ay = 0.0f;
+  bool haveA = read(0, ax, ay);
+  if (haveA) {
+    emit(0, ax, ay);
+  }
+
+  for (uint32_t bucket = 0; bucket < buckets; bucket++) {
+    const uint32_t start = bucketStart(bucket);
+    const uint32_t end = bucketStart(bucket + 1);
+
+    // Point C: average of the next bucket (last point for the final bucket)
+    const uint32_t nextEnd = bucket + 1 < buckets ? bucketStart(bucket + 2) : count;
+    uint64_t sumX = 0;
+    float sumY = 0.0f;
+    uint32_t valid = 0;
+    for (uint32_t i = end; i < nextEnd; i++) {
+      if (read(i, x, y)) {
+        sumX += x;
+        sumY += y;
+        valid++;
+      }
+    }
+
+    // Pick the point of this bucket forming the largest triangle with A and C
+    float bestArea = -1.0f;
+    uint32_t bestIndex = 0;
+    uint32_t bestX = 0;
+    float bestY = 0.0f;
+
+    for (uint32_t i = start; i < end; i++) {
+      if (!read(i, x, y)) {
+        continue;
+      }
+
+      float area = 0.0f;
+      if (haveA && valid > 0) {
+        const float cx = (float)sumX / valid - ax;
+        const float cy = sumY / valid - ay;
+        const float px = (float)x - ax;
+        area = fabsf(px * cy - cx * (y - ay));
+      }
+      if (area > bestArea) {
+        bestArea = area;
+        bestIndex = i;
+        bestX = x;
+        bestY = y;
+      }
+    }
+
+    if (bestArea >= 0.0f) {
+      emit(bestIndex, bestX, bestY);
+      ax = bestX;
+      ay = bestY;
+      haveA = true;
+    }
+  }
+
+  // Last point is always kept
+  if (read(count - 1, x, y)) {
+    emit(count - 1, x, y);
+  }
+}
+
+#endif // LTTB_H
@@ -0,0 +1,451 @@
+/*
+ * MQTT Publisher Implementation
+ */
+
+#include "MqttPublisher.h"
+#include "LineWriter.h"
+#include "EventLog.h"
+
+static_assert(MQTT_QOS <= 1, "Only QoS 0 and 1 are supported");
+
+// MQTT 3.1.1 control packet types (upper nibble of the fixed header)
+constexpr uint8_t MQTT_CONNECT = 0x10;
+constexpr uint8_t MQTT_PUBLISH = 0x30;
+constexpr uint8_t MQTT_PINGREQ = 0xC0;
+constexpr uint8_t MQTT_TYPE_CONNACK = 2;
+constexpr uint8_t MQTT_TYPE_PUBACK = 4;
+constexpr uint8_t MQTT_TYPE_PINGRESP = 13;
+
+// Disconnect reasons journaled with MQTT_DISCONNECTED (CONNACK codes are positive)
+constexpr int32_t MQTT_REASON_CLOSED = -1;
+constexpr int32_t MQTT_REASON_PROTOCOL = -2;
+constexpr int32_t MQTT_REASON_ACK_TIMEOUT = -3;
+constexpr int32_t MQTT_REASON_PING_TIMEOUT = -4;
+constexpr int32_t MQTT_REASON_WRITE = -5;
+
+// Outgoing packet buffer (MQTT task only)
+static uint8_t s_packet[MQTT_TOPIC_SIZE + MQTT_PAYLOAD_SIZE + 16];
+
+// Append remaining length (variable byte integer), returns bytes written
+static size_t putLength(uint8_t* buffer, size_t length) {
+  size_t count = 0;
+  do {
+    uint8_t byte = length % 128;
+    length /= 128;
+    buffer[count++] = length > 0 ? byte | 0x80 : byte;
+  } while (length > 0);
+  return count;
+}
+
+// Append length-prefixed UTF-8 string, returns bytes written
+static size_t putString(uint8_t* buffer, const char* text) {
+  const size_t length = strlen(text);
+  buffer[0] = length >> 8;
+  buffer[1] = length & 0xFF;
+  memcpy(buffer + 2, text, length);
+  return length + 2;
+}
+
+// Constructor
+MqttPublisher::MqttPublisher()
+  : m_head(0),
+    m_tail(0),
+    m_lock(portMUX_INITIALIZER_UNLOCKED),
+    m_task(nullptr),
+    m_connected(false),
+    m_nextConnect(0),
+    m_retryDelay(MQTT_RETRY_MIN_MS),
+    m_lastSend(0),
+    m_pingSentAt(0),
+    m_connack(-1),
+    m_inflight{},
+    m_inflightActive(false),
+    m_packetId(0),
+    m_inflightSentAt(0),
+    m_rxLength(0),
+    m_published(0),
+    m_coalesced(0),
+    m_dropped(0),
+    m_reconnects(0),
+    m_retransmits(0),
+    m_lastLatencyMs(0),
+    m_maxLatencyMs(0),
+    m_totalLatencyMs(0) {
+}
+
+// Start MQTT task
+void MqttPublisher::begin() {
+  // Core 0 (with the WiFi stack) - loop() keeps core 1 for sampling and HTTP
+  if (xTaskCreatePinnedToCore(taskEntry, "mqtt", MQTT_TASK_STACK_SIZE, this, 1, &m_task, 0) != pdPASS) {
+    // Always show configuration errors
+    Serial.println("[ERROR] MQTT task could not be started");
+    m_task = nullptr;
+  }
+}
+
+// Format readings into outbound messages
+void MqttPublisher::publish(const SensorData& data, uint32_t sequence) {
+  char topic[MQTT_TOPIC_SIZE];
+  char payload[MQTT_PAYLOAD_SIZE];
+
+  #if MQTT_PER_CHANNEL_TOPICS
+  // Channel fields come from the registry's line protocol hook ("name=value,...")
+  LineWriter line(payload, sizeof(payload));
+  SensorRegistry::writeLine(data, line);
+
+  char* save = nullptr;
+  for (char* field = strtok_r(payload, ",", &save); field; field = strtok_r(nullptr, ",", &save)) {
+    char* value = strchr(field, '=');
+    if (!value) {
+      continue;
+    }
+    *value++ = '\0';
+    snprintf(topic, sizeof(topic), "%s/%s", MQTT_TOPIC_PREFIX, field);
+    enqueue(topic, value, strlen(value));
+  }
+
+  snprintf(topic, sizeof(topic), "%s/valid", MQTT_TOPIC_PREFIX);
+  enqueue(topic, data.isValid ? "true" : "false", data.isValid ? 4 : 5);
+  #else
+  // One compact JSON document per measurement (same fields as /api/v1/sensors)
+  JsonWriter json(payload, sizeof(payload));
+  json.beginObject();
+  SensorRegistry::writeJSON(data, json);
+  json.addBool("valid", data.isValid);
+  json.addUInt("seq", sequence);
+  json.endObject();
+
+  snprintf(topic, sizeof(topic), "%s/state", MQTT_TOPIC_PREFIX);
+  enqueue(topic, payload, json.length());
+  #endif
+}
+
+// Serialize publisher state
+void MqttPublisher::writeJSON(JsonWriter& json) const {
+  portENTER_CRITICAL(&m_lock);
+  const uint32_t queued = m_tail - m_head;
+  portEXIT_CRITICAL(&m_lock);
+
+  json.addBool("connected", m_connected);
+  json.addUInt("queued", queued);
+  json.addUInt("capacity", MQTT_QUEUE_SIZE);
+  json.addBool("inflight", m_inflightActive);
+  json.addUInt("published", m_published);
+  json.addUInt("coalesced", m_coalesced);
+  json.addUInt("dropped", m_dropped);
+  json.addUInt("reconnects", m_reconnects);
+  json.addUInt("retransmits", m_retransmits);
+
+  json.beginObject("latencyMs");
+  json.addUInt("last", m_lastLatencyMs);
+  json.addUInt("max", m_maxLatencyMs);
+  json.addUInt("avg", m_published ? (uint32_t)(m_totalLatencyMs / m_published) : 0);
+  json.endObject();
+}
+
+// Queue message - replaces a queued message for the same topic, drops oldest when full
+void MqttPublisher::enqueue(const char* topic, const char* payload, size_t length) {
+  length = min(length, sizeof(Message::payload));
+
+  portENTER_CRITICAL(&m_lock);
+  Message* message = nullptr;
+
+  for (uint32_t i = m_head; i != m_tail; i++) {
+    Message& queued = m_queue[i % MQTT_QUEUE_SIZE];
+    if (strcmp(queued.topic, topic) == 0) {
+      message = &queued;  // Broker is behind - only the newest value matters
+      m_coalesced++;
+      break;
+    }
+  }
+
+  if (!message) {
+    if (m_tail - m_head >= MQTT_QUEUE_SIZE) {
+      m_head++;
+      m_dropped++;
+    }
+    message = &m_queue[m_tail++ % MQTT_QUEUE_SIZE];
+    strlcpy(message->topic, topic, sizeof(message->topic));
+    message->queuedAt = millis();
+  }
+
+  memcpy(message->payload, payload, length);
+  message->length = length;
+  portEXIT_CRITICAL(&m_lock);
+
+  if (m_task) {
+    xTaskNotifyGive(m_task);
+  }
+}
+
+// Pop oldest message
+bool MqttPublisher::dequeue(Message& message) {
+  portENTER_CRITICAL(&m_lock);
+  const bool available = m_head != m_tail;
+  if (available) {
+    message = m_queue[m_head++ % MQTT_QUEUE_SIZE];
+  }
+  portEXIT_CRITICAL(&m_lock);
+  return available;
+}
+
+// FreeRTOS entry point
+void MqttPublisher::taskEntry(void* parameter) {
+  static_cast<MqttPublisher*>(parameter)->run();
+}
+
+// Connect when possible, then service the connection
+void MqttPublisher::run() {
+  for (;;) {
+    const uint32_t now = millis();
+
+    if (m_connected) {
+      service(now);
+    } else if (WiFi.status() == WL_CONNECTED && (int32_t)(now - m_nextConnect) >= 0) {
+      if (!connect(now)) {
+        disconnect(now, m_connack > 0 ? m_connack : MQTT_REASON_CLOSED);
+      }
+    }
+
+    // Incoming acknowledgements are polled, new messages wake the task at once
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MQTT_POLL_INTERVAL_MS));
+  }
+}
+
+// Open TCP connection and run the CONNECT / CONNACK handshake
+bool MqttPublisher::connect(uint32_t now) {
+  char willTopic[MQTT_TOPIC_SIZE];
+  snprintf(willTopic, sizeof(willTopic), "%s/status", MQTT_TOPIC_PREFIX);
+
+  const bool hasUser = MQTT_USERNAME[0] != '\0';
+  const bool hasPassword = hasUser && MQTT_PASSWORD[0] != '\0';
+  const size_t bodyLength = 10 + 2 + strlen(MQTT_CLIENT_ID) + 2 + strlen(willTopic) + 2 + 7 +
+                            (hasUser ? 2 + strlen(MQTT_USERNAME) : 0) +
+                            (hasPassword ? 2 + strlen(MQTT_PASSWORD) : 0);
+
+  if (bodyLength + 5 > sizeof(s_packet)) {
+    // Always show configuration errors
+    Serial.println("[ERROR] MQTT client id / credentials too long");
+    return false;
+  }
+
+  if (!m_client.connect(MQTT_HOST, MQTT_PORT, MQTT_CONNECT_TIMEOUT_MS)) {
+    return false;
+  }
+  m_client.setNoDelay(true);
+
+  // Clean session, retained "offline" last will on <prefix>/status
+  size_t length = 0;
+  s_packet[length++] = MQTT_CONNECT;
+  length += putLength(s_packet + length, bodyLength);
+  length += putString(s_packet + length, "MQTT");
+  s_packet[length++] = 4;  // Protocol level 3.1.1
+  s_packet[length++] = 0x02 | 0x04 | 0x20 | (hasUser ? 0x80 : 0) | (hasPassword ? 0x40 : 0);
+  s_packet[length++] = MQTT_KEEPALIVE_S >> 8;
+  s_packet[length++] = MQTT_KEEPALIVE_S & 0xFF;
+  length += putString(s_packet + length, MQTT_CLIENT_ID);
+  length += putString(s_packet + length, willTopic);
+  length += putString(s_packet + length, "offline");
+  if (hasUser) {
+    length += putString(s_packet + length, MQTT_USERNAME);
+  }
+  if (hasPassword) {
+    length += putString(s_packet + length, MQTT_PASSWORD);
+  }
+
+  m_connack = -1;
+  m_rxLength = 0;
+  if (!sendPacket(s_packet, length)) {
+    m_client.stop();
+    return false;
+  }
+
+  // Wait for CONNACK (this task only - loop() is not involved)
+  while (m_connack < 0 && millis() - now < MQTT_CONNECT_TIMEOUT_MS) {
+    if (!receive()) {
+      break;
+    }
+    vTaskDelay(pdMS_TO_TICKS(MQTT_POLL_INTERVAL_MS));
+  }
+
+  if (m_connack != 0) {
+    m_client.stop();
+    return false;
+  }
+
+  m_connected = true;
+  m_retryDelay = MQTT_RETRY_MIN_MS;
+  m_pingSentAt = 0;
+  m_reconnects++;
+  eventLog.log(EventCode::MQTT_CONNECTED, m_reconnects);
+
+  #if DEBUG_SERIAL_ENABLED
+  Serial.printf("[MQTT] Connected to %s:%u\n", MQTT_HOST, MQTT_PORT);
+  #endif
+
+  // Replace the last will with a retained "online" (QoS 0, no acknowledgement)
+  length = 0;
+  s_packet[length++] = MQTT_PUBLISH | 0x01;
+  length += putLength(s_packet + length, 2 + strlen(willTopic) + 6);
+  length += putString(s_packet + length, willTopic);
+  memcpy(s_packet + length, "online", 6);
+  length += 6;
+  sendPacket(s_packet, length);
+
+  // Message that was not acknowledged before the connection dropped
+  if (m_inflightActive) {
+    m_retransmits++;
+    m_inflightSentAt = millis();
+    if (!sendPublish(true)) {
+      disconnect(millis(), MQTT_REASON_WRITE);
+    }
+  }
+
+  return true;
+}
+
+// Drop connection and back off
+void MqttPublisher::disconnect(uint32_t now, int32_t reason) {
+  if (m_connected) {
+    m_connected = false;
+    eventLog.log(EventCode::MQTT_DISCONNECTED, reason);
+
+    #if DEBUG_SERIAL_ENABLED
+    Serial.printf("[MQTT] Disconnected (%ld)\n", (long)reason);
+    #endif
+  }
+
+  m_client.stop();
+  m_rxLength = 0;
+  m_pingSentAt = 0;
+  m_nextConnect = now + m_retryDelay;
+  m_retryDelay = min(m_retryDelay * 2, MQTT_RETRY_MAX_MS);
+}
+
+// Send queued messages and enforce acknowledgement / keep-alive timeouts
+void MqttPublisher::service(uint32_t now) {
+  if (!receive()) {
+    disconnect(now, MQTT_REASON_PROTOCOL);
+    return;
+  }
+
+  if (!m_client.connected()) {
+    disconnect(now, MQTT_REASON_CLOSED);
+    return;
+  }
+
+  if (m_inflightActive) {
+    // Broker stalled - reconnect, the message is resent with DUP
+    if (now - m_inflightSentAt >= MQTT_ACK_TIMEOUT_MS) {
+      disconnect(now, MQTT_REASON_ACK_TIMEOUT);
+      return;
+    }
+  } else {
+    // QoS 0 drains the queue, QoS 1 keeps one message in flight
+    while (!m_inflightActive && dequeue(m_inflight)) {
+      m_packetId = m_packetId == UINT16_MAX ? 1 : m_packetId + 1;
+      m_inflightActive = true;
+      m_inflightSentAt = now;
+
+      if (!sendPublish(false)) {
+        disconnect(now, MQTT_REASON_WRITE);
+        return;
+      }
+
+      if (MQTT_QOS == 0) {
+        complete();
+      }
+    }
+  }
+
+  // Keep-alive: PINGREQ after half the interval without traffic
+  if (m_pingSentAt) {
+    if (now - m_pingSentAt >= MQTT_KEEPALIVE_S * 1000UL) {
+      disconnect(now, MQTT_REASON_PING_TIMEOUT);
+    }
+  } else if (now - m_lastSend >= MQTT_KEEPALIVE_S * 500UL) {
+    const uint8_t ping[] = {MQTT_PINGREQ, 0};
+    m_pingSentAt = now ? now : 1;
+    if (!sendPacket(ping, sizeof(ping))) {
+      disconnect(now, MQTT_REASON_WRITE);
+    }
+  }
+}
+
+// Serialize in-flight message as PUBLISH
+bool MqttPublisher::sendPublish(bool duplicate) {
+  const size_t topicLength = strlen(m_inflight.topic);
+  const size_t bodyLength = 2 + topicLength + (MQTT_QOS ? 2 : 0) + m_inflight.length;
+
+  size_t length = 0;
+  s_packet[length++] = MQTT_PUBLISH | (duplicate && MQTT_QOS ? 0x08 : 0) | (MQTT_QOS << 1) | (MQTT_RETAIN ? 0x01 : 0);
+  length += putLength(s_packet + length, bodyLength);
+  length += putString(s_packet + length, m_inflight.topic);
+  if (MQTT_QOS) {
+    s_packet[length++] = m_packetId >> 8;
+    s_packet[length++] = m_packetId & 0xFF;
+  }
+  memcpy(s_packet + length, m_inflight.payload, m_inflight.length);
+  length += m_inflight.length;
+
+  return sendPacket(s_packet, length);
+}
+
+// Parse complete packets from the socket (all expected ones are 2-4 bytes)
+bool MqttPublisher::receive() {
+  while (m_client.available() > 0) {
+    const int count = m_client.read(m_rx + m_rxLength, sizeof(m_rx) - m_rxLength);
+    if (count <= 0) {
+      break;
+    }
+    m_rxLength += count;
+
+    while (m_rxLength >= 2) {
+      // No subscriptions - anything longer than an acknowledgement is unexpected
+      if ((m_rx[1] & 0x80) || m_rx[1] + 2u > sizeof(m_rx)) {
+        return false;
+      }
+
+      const uint8_t size = m_rx[1] + 2;
+      if (m_rxLength < size) {
+        break;
+      }
+
+      const uint8_t type = m_rx[0] >> 4;
+      if (type == MQTT_TYPE_CONNACK && size == 4) {
+        m_connack = m_rx[3];
+      } else if (type == MQTT_TYPE_PUBACK && size == 4) {
+        const uint16_t packetId = (m_rx[2] << 8) | m_rx[3];
+        if (m_inflightActive && packetId == m_packetId) {
+          complete();
+        }
+      } else if (type == MQTT_TYPE_PINGRESP) {
+        m_pingSentAt = 0;
+      }
+
+      m_rxLength -= size;
+      memmove(m_rx, m_rx + size, m_rxLength);
+    }
+  }
+  return true;
+}
+
+// In-flight message delivered
+void MqttPublisher::complete() {
+  const uint32_t latency = millis() - m_inflight.queuedAt;
+
+  m_inflightActive = false;
+  m_published++;
+  m_lastLatencyMs = latency;
+  m_maxLatencyMs = max(m_maxLatencyMs, latency);
+  m_totalLatencyMs += latency;
+}
+
+// Write whole packet
+bool MqttPublisher::sendPacket(const uint8_t* packet, size_t length) {
+  if (m_client.write(packet, length) != length) {
+    return false;
+  }
+  m_lastSend = millis();
+  return true;
+}
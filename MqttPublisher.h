@@ -0,0 +1,114 @@
+/*
+ * MQTT Publisher for ESP32 Weather Station
+ * Minimal MQTT 3.1.1 client (QoS 0/1, retained state, last will) running in
+ * its own FreeRTOS task. loop() only puts messages into a bounded outbound
+ * queue: a newer reading replaces a still-queued message for the same topic
+ * (coalescing), and when the queue is full the oldest message is dropped and
+ * counted, so a slow or stalled broker never blocks sampling.
+ * One QoS 1 message is in flight at a time - it is resent with DUP after a
+ * reconnect until the broker acknowledges it.
+ */
+
+#ifndef MQTT_PUBLISHER_H
+#define MQTT_PUBLISHER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "Config.h"
+#include "SensorManager.h"
+#include "JsonWriter.h"
+
+class MqttPublisher {
+public:
+  // Constructor
+  MqttPublisher();
+
+  // Start the MQTT task (call from setup())
+  void begin();
+
+  // Queue published readings (loop task, never blocks on the network)
+  // One JSON payload on <prefix>/state, or one topic per channel
+  void publish(const SensorData& data, uint32_t sequence);
+
+  // Serialize connection, queue and latency statistics
+  void writeJSON(JsonWriter& json) const;
+
+private:
+  // Outbound message (fixed size - no heap)
+  struct Message {
+    char topic[MQTT_TOPIC_SIZE];
+    char payload[MQTT_PAYLOAD_SIZE];
+    uint16_t length;
+    uint32_t queuedAt;  // millis() of the first enqueue (kept when coalesced)
+  };
+
+  // Outbound queue ring - m_head/m_tail are running counters
+  Message m_queue[MQTT_QUEUE_SIZE];
+  uint32_t m_head;
+  uint32_t m_tail;
+  mutable portMUX_TYPE m_lock;
+
+  // MQTT task and its connection (touched by the MQTT task only)
+  TaskHandle_t m_task;
+  WiFiClient m_client;
+  bool m_connected;
+  uint32_t m_nextConnect;
+  uint32_t m_retryDelay;
+  uint32_t m_lastSend;       // Last outbound packet (keep-alive)
+  uint32_t m_pingSentAt;     // 0 = no PINGREQ outstanding
+  int16_t m_connack;         // CONNACK return code (-1 = not received yet)
+
+  // Message awaiting PUBACK (QoS 1)
+  Message m_inflight;
+  bool m_inflightActive;
+  uint16_t m_packetId;
+  uint32_t m_inflightSentAt;
+
+  // Partially received packet
+  uint8_t m_rx[8];
+  uint8_t m_rxLength;
+
+  // Statistics
+  uint32_t m_published;
+  uint32_t m_coalesced;
+  uint32_t m_dropped;
+  uint32_t m_reconnects;
+  uint32_t m_retransmits;
+  uint32_t m_lastLatencyMs;
+  uint32_t m_maxLatencyMs;
+  uint64_t m_totalLatencyMs;
+
+  // Queue message (coalesce by topic, drop oldest when full)
+  void enqueue(const char* topic, const char* payload, size_t length);
+
+  // Take the oldest queued message - false if queue is empty
+  bool dequeue(Message& message);
+
+  // Task body
+  static void taskEntry(void* parameter);
+  void run();
+
+  // Connect, send CONNECT and wait for CONNACK
+  bool connect(uint32_t now);
+
+  // Close connection and schedule reconnect with backoff
+  void disconnect(uint32_t now, int32_t reason);
+
+  // Send in-flight message as PUBLISH
+  bool sendPublish(bool duplicate);
+
+  // Send queued messages, check acknowledgement and keep-alive timeouts
+  void service(uint32_t now);
+
+  // Read and handle complete incoming packets (CONNACK, PUBACK, PINGRESP)
+  // Returns false on a packet this client cannot handle
+  bool receive();
+
+  // Message delivered - update latency statistics
+  void complete();
+
+  // Write packet in one call (one TCP segment with no-delay)
+  bool sendPacket(const uint8_t* packet, size_t length);
+};
+
+#endif // MQTT_PUBLISHER_H
@@ -0,0 +1,279 @@
+/*
+ * Pressure Trend & Forecast Implementation
+ */
+
+#include "PressureTrend.h"
+
+constexpr uint8_t WINDOW_3H = PRESSURE_TREND_BUCKETS / 2;
+constexpr float BUCKETS_PER_3H = 3.0f * 3600000.0f / PRESSURE_TREND_BUCKET_MS;
+
+// Tendency thresholds (Pa per 3 h)
+constexpr float TENDENCY_STEADY_PA = 10.0f;
+constexpr float TENDENCY_SLOW_PA = 160.0f;
+constexpr float TENDENCY_NORMAL_PA = 360.0f;
+constexpr float TENDENCY_QUICK_PA = 600.0f;
+
+// Zambretti (Negretti & Zambra, beteljuice table form) - sea-level range 950..1050 hPa
+constexpr float ZAMBRETTI_BOTTOM_HPA = 950.0f;
+constexpr float ZAMBRETTI_TOP_HPA = 1050.0f;
+constexpr uint8_t ZAMBRETTI_STEPS = 22;
+
+static const uint8_t ZAMBRETTI_RISING[ZAMBRETTI_STEPS] = {
+  25, 25, 25, 24, 24, 19, 16, 12, 11, 9, 8, 6, 5, 2, 1, 1, 0, 0, 0, 0, 0, 0
+};
+static const uint8_t ZAMBRETTI_STEADY[ZAMBRETTI_STEPS] = {
+  25, 25, 25, 25, 25, 25, 23, 23, 22, 18, 15, 13, 10, 4, 1, 1, 0, 0, 0, 0, 0, 0
+};
+static const uint8_t ZAMBRETTI_FALLING[ZAMBRETTI_STEPS] = {
+  25, 25, 25, 25, 25, 25, 25, 25, 23, 23, 21, 20, 17, 14, 7, 3, 1, 1, 1, 0, 0, 0
+};
+
+static const char* const ZAMBRETTI_TEXT[26] = {
+  "Settled fine", "Fine weather", "Becoming fine", "Fine, becoming less settled",
+  "Fine, possible showers", "Fairly fine, improving", "Fairly fine, possible showers early",
+  "Fairly fine, showery later", "Showery early, improving", "Changeable, mending",
+  "Fairly fine, showers likely", "Rather unsettled, clearing later", "Unsettled, probably improving",
+  "Showery, bright intervals", "Showery, becoming less settled", "Changeable, some rain",
+  "Unsettled, short fine intervals", "Unsettled, rain later", "Unsettled, some rain",
+  "Mostly very unsettled", "Occasional rain, worsening", "Rain at times, very unsettled",
+  "Rain at frequent intervals", "Rain, very unsettled", "Stormy, may improve", "Stormy, much rain"
+};
+
+// ============================================================================
+// Window
+// ============================================================================
+
+void PressureTrend::Window::reset() {
+  count = 0;
+  sumY = 0;
+  sumXY = 0;
+}
+
+// Append y; when full, drop the oldest value (evicted) and shift x down by one
+void PressureTrend::Window::push(int32_t y, int32_t evicted) {
+  if (count == capacity) {
+    sumY -= evicted;
+    sumXY -= sumY;
+    count--;
+  }
+
+  sumXY += (int64_t)count * y;
+  sumY += y;
+  count++;
+}
+
+// Least-squares slope: (n Sxy - Sx Sy) / (n Sxx - Sx²)
+float PressureTrend::Window::slope() const {
+  const int64_t n = count;
+  const int64_t sumX = n * (n - 1) / 2;
+  const int64_t sumXX = (n - 1) * n * (2 * n - 1) / 6;
+  const int64_t denominator = n * sumXX - sumX * sumX;
+
+  if (n < 2 || denominator == 0) {
+    return NAN;
+  }
+
+  return (float)(n * sumXY - sumX * sumY) / (float)denominator;
+}
+
+// ============================================================================
+// PressureTrend
+// ============================================================================
+
+// Constructor
+PressureTrend::PressureTrend() {
+  m_window3h.capacity = WINDOW_3H;
+  m_window6h.capacity = PRESSURE_TREND_BUCKETS;
+  reset();
+}
+
+// Drop all history
+void PressureTrend::reset() {
+  memset(m_buckets, 0, sizeof(m_buckets));
+  m_head = 0;
+  m_count = 0;
+  m_window3h.reset();
+  m_window6h.reset();
+
+  m_started = false;
+  m_bucketStart = 0;
+  m_bucketSum = 0;
+  m_bucketSamples = 0;
+  m_lastBucket = 0;
+
+  m_seaLevelPressure = NAN;
+  m_change3h = NAN;
+  m_change6h = NAN;
+  m_tendency = PressureTendency::UNKNOWN;
+  m_zambretti = -1;
+}
+
+// Store bucket average, feed both windows
+void PressureTrend::pushBucket(int32_t value) {
+  // Values leaving each window (only used once that window is full)
+  const int32_t evicted6h = m_buckets[m_head];
+  const int32_t evicted3h = m_count >= WINDOW_3H ?
+                            m_buckets[(m_head + m_count - WINDOW_3H) % PRESSURE_TREND_BUCKETS] : 0;
+
+  m_window3h.push(value, evicted3h);
+  m_window6h.push(value, evicted6h);
+
+  if (m_count == PRESSURE_TREND_BUCKETS) {
+    m_buckets[m_head] = value;
+    m_head = (m_head + 1) % PRESSURE_TREND_BUCKETS;
+  } else {
+    m_buckets[(m_head + m_count) % PRESSURE_TREND_BUCKETS] = value;
+    m_count++;
+  }
+
+  m_lastBucket = value;
+}
+
+// Close current bucket (empty buckets repeat the last average)
+void PressureTrend::closeBucket() {
+  if (m_bucketSamples > 0) {
+    pushBucket((int32_t)(m_bucketSum / m_bucketSamples));
+  } else if (m_count > 0) {
+    pushBucket(m_lastBucket);
+  }
+
+  m_bucketSum = 0;
+  m_bucketSamples = 0;
+}
+
+// Add published sample, refresh tendency and forecast
+void PressureTrend::update(float pressure, float temperature, uint32_t now) {
+  if (!isfinite(pressure)) {
+    return;
+  }
+
+  if (!m_started) {
+    m_started = true;
+    m_bucketStart = now;
+  }
+
+  // A gap longer than the whole window invalidates the history
+  if (now - m_bucketStart >= PRESSURE_TREND_BUCKETS * PRESSURE_TREND_BUCKET_MS) {
+    reset();
+    m_started = true;
+    m_bucketStart = now;
+  }
+
+  while (now - m_bucketStart >= PRESSURE_TREND_BUCKET_MS) {
+    closeBucket();
+    m_bucketStart += PRESSURE_TREND_BUCKET_MS;
+  }
+
+  m_bucketSum += lroundf(pressure * 10.0f);
+  m_bucketSamples++;
+
+  // Changes over 3 h extrapolated from the fitted slopes (0.1 Pa -> Pa)
+  if (m_window3h.count >= PRESSURE_TREND_MIN_BUCKETS) {
+    m_change3h = m_window3h.slope() * BUCKETS_PER_3H / 10.0f;
+  }
+  if (m_window6h.count > WINDOW_3H) {
+    m_change6h = m_window6h.slope() * BUCKETS_PER_3H / 10.0f;
+  }
+
+  if (!isfinite(m_change3h)) {
+    return;
+  }
+
+  // Tendency class
+  const float magnitude = fabsf(m_change3h);
+  if (magnitude < TENDENCY_STEADY_PA) {
+    m_tendency = PressureTendency::STEADY;
+  } else if (m_change3h < 0) {
+    m_tendency = magnitude < TENDENCY_SLOW_PA ? PressureTendency::FALLING_SLOWLY :
+                 magnitude < TENDENCY_NORMAL_PA ? PressureTendency::FALLING :
+                 magnitude < TENDENCY_QUICK_PA ? PressureTendency::FALLING_QUICKLY :
+                 PressureTendency::FALLING_RAPIDLY;
+  } else {
+    m_tendency = magnitude < TENDENCY_SLOW_PA ? PressureTendency::RISING_SLOWLY :
+                 magnitude < TENDENCY_NORMAL_PA ? PressureTendency::RISING :
+                 magnitude < TENDENCY_QUICK_PA ? PressureTendency::RISING_QUICKLY :
+                 PressureTendency::RISING_RAPIDLY;
+  }
+
+  // Sea-level pressure (barometric formula, station temperature)
+  const float reference = isfinite(temperature) ? temperature : 15.0f;
+  const float lapse = 0.0065f * STATION_ALTITUDE_M;
+  m_seaLevelPressure = pressure * powf(1.0f - lapse / (reference + lapse + 273.15f), -5.257f);
+
+  // Zambretti: pressure band x direction (steady below 1.6 hPa / 3 h)
+  float hpa = constrain(m_seaLevelPressure / 100.0f, ZAMBRETTI_BOTTOM_HPA, ZAMBRETTI_TOP_HPA - 1.0f);
+  const uint8_t step = (uint8_t)((hpa - ZAMBRETTI_BOTTOM_HPA) /
+                                 ((ZAMBRETTI_TOP_HPA - ZAMBRETTI_BOTTOM_HPA) / ZAMBRETTI_STEPS));
+
+  if (m_change3h <= -TENDENCY_SLOW_PA) {
+    m_zambretti = ZAMBRETTI_FALLING[step];
+  } else if (m_change3h >= TENDENCY_SLOW_PA) {
+    m_zambretti = ZAMBRETTI_RISING[step];
+  } else {
+    m_zambretti = ZAMBRETTI_STEADY[step];
+  }
+}
+
+// Forecast text
+const char* PressureTrend::getForecastText() const {
+  return m_zambretti < 0 ? nullptr : ZAMBRETTI_TEXT[m_zambretti];
+}
+
+// Serialize summary for sensor API
+void PressureTrend::writeSummaryJSON(JsonWriter& json) const {
+  if (m_tendency == PressureTendency::UNKNOWN) {
+    json.addNull("pressureTrend");
+    json.addNull("forecast");
+    return;
+  }
+
+  json.addString("pressureTrend", getTendencyName(m_tendency));
+  json.addString("forecast", getForecastText());
+}
+
+// Serialize full trend details
+void PressureTrend::writeJSON(JsonWriter& json) const {
+  json.addUInt("windowMinutes", getWindowMinutes());
+  json.addUInt("bucketMinutes", PRESSURE_TREND_BUCKET_MS / 60000);
+  json.addFloat("seaLevelPressure", m_seaLevelPressure);
+  json.addFloat("change3h", m_change3h);
+  json.addFloat("change6h", m_change6h);
+
+  if (m_tendency == PressureTendency::UNKNOWN) {
+    json.addNull("tendency");
+    json.addNull("zambretti");
+    json.addNull("forecast");
+    return;
+  }
+
+  const char letter[2] = { getZambrettiLetter(), '\0' };
+  json.addString("tendency", getTendencyName(m_tendency));
+  json.addString("zambretti", letter);
+  json.addString("forecast", getForecastText());
+}
+
+// Tendency API name
+const char* PressureTrend::getTendencyName(PressureTendency tendency) {
+  switch (tendency) {
+    case PressureTendency::FALLING_RAPIDLY:
+      return "falling_rapidly";
+    case PressureTendency::FALLING_QUICKLY:
+      return "falling_quickly";
+    case PressureTendency::FALLING:
+      return "falling";
+    case PressureTendency::FALLING_SLOWLY:
+      return "falling_slowly";
+    case PressureTendency::STEADY:
+      return "steady";
+    case PressureTendency::RISING_SLOWLY:
+      return "rising_slowly";
+    case PressureTendency::RISING:
+      return "rising";
+    case PressureTendency::RISING_QUICKLY:
+      return "rising_quickly";
+    case PressureTendency::RISING_RAPIDLY:
+      return "rising_rapidly";
+    default:
+      return "unknown";
+  }
+}
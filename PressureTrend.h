@@ -0,0 +1,117 @@
+/*
+ * Pressure Trend & Forecast for ESP32 Weather Station
+ * Keeps a fixed 6 h window of pressure averages (one per bucket) and fits
+ * least-squares lines over the last 3 h and 6 h. The sums are updated
+ * incrementally in O(1) per bucket with exact integer arithmetic (0.1 Pa
+ * units, x = bucket index), so they never drift. The 3 h change gives the
+ * tendency class and, with sea-level pressure, a Zambretti forecast.
+ */
+
+#ifndef PRESSURE_TREND_H
+#define PRESSURE_TREND_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "JsonWriter.h"
+
+static_assert(PRESSURE_TREND_BUCKETS % 2 == 0 && PRESSURE_TREND_BUCKETS <= 254,
+              "PRESSURE_TREND_BUCKETS must be even and fit the 3 h/6 h windows in uint8_t");
+
+// Pressure tendency over 3 h (WMO-style classes)
+enum class PressureTendency : uint8_t {
+  UNKNOWN = 0,        // Not enough history yet
+  FALLING_RAPIDLY,    // > 6 hPa / 3 h
+  FALLING_QUICKLY,    // 3.6 - 6 hPa / 3 h
+  FALLING,            // 1.6 - 3.5 hPa / 3 h
+  FALLING_SLOWLY,     // 0.1 - 1.5 hPa / 3 h
+  STEADY,
+  RISING_SLOWLY,
+  RISING,
+  RISING_QUICKLY,
+  RISING_RAPIDLY
+};
+
+class PressureTrend {
+public:
+  // Constructor
+  PressureTrend();
+
+  // Add published pressure (Pa) and temperature (°C, for sea-level reduction)
+  void update(float pressure, float temperature, uint32_t now);
+
+  // Estimated pressure change over 3 h from the 3 h / 6 h fits (Pa, NAN if not ready)
+  inline float getChange3h() const {
+    return m_change3h;
+  }
+
+  inline float getChange6h() const {
+    return m_change6h;
+  }
+
+  inline PressureTendency getTendency() const {
+    return m_tendency;
+  }
+
+  // Zambretti forecast letter 'A' (settled fine) .. 'Z' (stormy), 0 if unknown
+  inline char getZambrettiLetter() const {
+    return m_zambretti < 0 ? 0 : (char)('A' + m_zambretti);
+  }
+
+  // Forecast text (nullptr if unknown)
+  const char* getForecastText() const;
+
+  // Minutes of history currently in the 6 h window
+  inline uint32_t getWindowMinutes() const {
+    return (uint32_t)m_count * (PRESSURE_TREND_BUCKET_MS / 60000);
+  }
+
+  // Serialize tendency and forecast summary (sensor API)
+  void writeSummaryJSON(JsonWriter& json) const;
+
+  // Serialize full trend details (forecast API)
+  void writeJSON(JsonWriter& json) const;
+
+  static const char* getTendencyName(PressureTendency tendency);
+
+private:
+  // Sliding least-squares fit over the newest `capacity` buckets
+  // x = 0..count-1 (oldest first), so sum(x) and sum(x²) are closed-form
+  struct Window {
+    uint8_t capacity;
+    uint8_t count;
+    int64_t sumY;
+    int64_t sumXY;
+
+    void reset();
+    void push(int32_t y, int32_t evicted);
+    float slope() const;  // y units per bucket
+  };
+
+  // Bucket averages in 0.1 Pa (ring, oldest at m_head)
+  int32_t m_buckets[PRESSURE_TREND_BUCKETS];
+  uint8_t m_head;
+  uint8_t m_count;
+
+  Window m_window3h;
+  Window m_window6h;
+
+  // Bucket being filled
+  bool m_started;
+  uint32_t m_bucketStart;
+  int64_t m_bucketSum;
+  uint16_t m_bucketSamples;
+  int32_t m_lastBucket;
+
+  // Derived (updated on every publish)
+  float m_seaLevelPressure;
+  float m_change3h;
+  float m_change6h;
+  PressureTendency m_tendency;
+  int8_t m_zambretti;  // 0..25, -1 = unknown
+
+  void reset();
+  void closeBucket();
+  void pushBucket(int32_t value);
+};
+
+#endif // PRESSURE_TREND_H
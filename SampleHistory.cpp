@@ -0,0 +1,177 @@
+/*
+ * Sample History Implementation
+ */
+
+#include "SampleHistory.h"
+#include "Lttb.h"
+#include "Varint.h"
+#include "TimeSync.h"
+
+constexpr uint8_t CHART_BINARY_VERSION = 1;
+constexpr size_t CHART_BINARY_HEADER_SIZE = 20;
+constexpr size_t CHART_BINARY_POINT_SIZE = VARINT_MAX_SIZE + sizeof(float);
+
+// Little-endian field writers for the binary chart
+static void writeLE(uint8_t* out, uint64_t value, uint8_t bytes) {
+  for (uint8_t i = 0; i < bytes; i++) {
+    out[i] = value >> (8 * i);
+  }
+}
+
+// UTC of the chart base (false before the first time sync)
+static bool chartUtcBase(uint32_t origin, uint64_t& utcMs) {
+  #if TIME_SYNC_ENABLED
+  return timeSync.toUtcMs(origin, utcMs);
+  #else
+  (void)origin;
+  (void)utcMs;
+  return false;
+  #endif
+}
+
+// Constructor
+SampleHistory::SampleHistory()
+  : m_head(0),
+    m_count(0) {
+}
+
+// Append published channels, oldest record is overwritten when full
+void SampleHistory::record(const SensorData& data, uint32_t now) {
+  if (m_count > 0 && now - at(m_count - 1).timestamp < HISTORY_INTERVAL_MS) {
+    return;
+  }
+
+  Record& record = m_records[m_head];
+  record.timestamp = now;
+  SensorRegistry::copyChannels(data, record.channels);
+
+  m_head = (m_head + 1) % HISTORY_CAPACITY;
+  if (m_count < HISTORY_CAPACITY) {
+    m_count++;
+  }
+}
+
+// Binary search over timestamps relative to the oldest record (millis() wrap safe)
+uint32_t SampleHistory::lowerBound(uint32_t time) const {
+  if (m_count == 0) {
+    return 0;
+  }
+
+  const uint32_t base = at(0).timestamp;
+  if ((int32_t)(time - base) <= 0) {
+    return 0;
+  }
+
+  const uint32_t target = time - base;
+  uint32_t low = 0;
+  uint32_t high = m_count;
+  while (low < high) {
+    const uint32_t mid = (low + high) / 2;
+    if (at(mid).timestamp - base < target) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  return low;
+}
+
+// Record positions [first, last) inside [from, to]
+void SampleHistory::findWindow(uint32_t from, uint32_t to, uint32_t& first, uint32_t& last) const {
+  first = lowerBound(from);
+  last = (int32_t)(to - from) >= 0 ? lowerBound(to + 1) : first;
+}
+
+// Downsample the window with LTTB straight into the response
+bool SampleHistory::writeChartJSON(JsonWriter& json, const char* channel, uint32_t from, uint32_t to,
+                                   uint16_t points) const {
+  const SensorRegistry::ChannelField field = SensorRegistry::findChannel(channel);
+  if (!field) {
+    return false;
+  }
+
+  uint32_t first, last;
+  findWindow(from, to, first, last);
+  const uint32_t count = last - first;
+  const uint32_t origin = count > 0 ? at(first).timestamp : from;
+
+  json.addString("channel", channel);
+  json.addUInt("from", from);
+  json.addUInt("to", to);
+  json.addUInt("intervalMs", HISTORY_INTERVAL_MS);
+  json.addUInt("samples", count);
+  json.addUInt("t0", origin);
+  uint64_t utcBase;
+  if (chartUtcBase(origin, utcBase)) {
+    json.addUInt64("utc0", utcBase);
+  } else {
+    json.addNull("utc0");
+  }
+  json.beginArray("points");
+
+  // Points carry the delta to the previous point (t0 for the first)
+  uint32_t previous = 0;
+  lttbDownsample(count, points,
+    [this, first, origin, field](uint32_t i, uint32_t& x, float& y) {
+      const Record& record = at(first + i);
+      x = record.timestamp - origin;
+      y = record.channels.*field;
+      return isfinite(y);
+    },
+    [&json, &previous](uint32_t, uint32_t x, float y) {
+      json.beginArray();
+      json.addUInt(nullptr, x - previous);
+      json.addFloat(nullptr, y);
+      json.endArray();
+      previous = x;
+    });
+
+  json.endArray();
+  return true;
+}
+
+// Same window as writeChartJSON, varint deltas and raw floats
+size_t SampleHistory::writeChartBinary(uint8_t* buffer, size_t bufferSize, const char* channel, uint32_t from,
+                                       uint32_t to, uint16_t points) const {
+  const SensorRegistry::ChannelField field = SensorRegistry::findChannel(channel);
+  if (!field || bufferSize < CHART_BINARY_HEADER_SIZE) {
+    return 0;
+  }
+
+  uint32_t first, last;
+  findWindow(from, to, first, last);
+  const uint32_t count = last - first;
+  const uint32_t origin = count > 0 ? at(first).timestamp : from;
+  uint64_t utcBase = 0;
+  const bool utcValid = chartUtcBase(origin, utcBase);
+
+  // Points beyond the buffer are dropped (the header count says how many were written)
+  size_t length = CHART_BINARY_HEADER_SIZE;
+  uint16_t written = 0;
+  uint32_t previous = 0;
+  lttbDownsample(count, points,
+    [this, first, origin, field](uint32_t i, uint32_t& x, float& y) {
+      const Record& record = at(first + i);
+      x = record.timestamp - origin;
+      y = record.channels.*field;
+      return isfinite(y);
+    },
+    [buffer, bufferSize, &length, &written, &previous](uint32_t, uint32_t x, float y) {
+      if (length + CHART_BINARY_POINT_SIZE > bufferSize) {
+        return;
+      }
+      length += writeVarint(buffer + length, x - previous);
+      memcpy(buffer + length, &y, sizeof(y));
+      length += sizeof(y);
+      written++;
+      previous = x;
+    });
+
+  buffer[0] = CHART_BINARY_VERSION;
+  buffer[1] = utcValid ? 0x01 : 0x00;
+  writeLE(buffer + 2, written, 2);
+  writeLE(buffer + 4, count, 4);
+  writeLE(buffer + 8, origin, 4);
+  writeLE(buffer + 12, utcBase, 8);
+  return length;
+}
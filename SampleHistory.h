@@ -0,0 +1,67 @@
+/*
+ * Sample History for ESP32 Weather Station
+ * Fixed RAM ring of published channel values (one record per
+ * HISTORY_INTERVAL_MS) behind /api/v1/chart. A query finds its time window
+ * by binary search and streams it through LTTB downsampling (Lttb.h), so it
+ * costs O(n) time and no memory beyond the response arena.
+ *
+ * Chart timestamps are a base (t0 in millis(), utc0 once TimeSync has a
+ * fix) plus per-point deltas - varint encoded in the binary format.
+ */
+
+#ifndef SAMPLE_HISTORY_H
+#define SAMPLE_HISTORY_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "SensorManager.h"
+#include "JsonWriter.h"
+
+class SampleHistory {
+public:
+  // Constructor
+  SampleHistory();
+
+  // Store published channels once HISTORY_INTERVAL_MS has passed since the last record
+  void record(const SensorData& data, uint32_t now);
+
+  // Write chart of one channel over [from, to] (ms since boot) with at most
+  // 'points' [dt, value] pairs. Returns false if the channel is unknown or disabled
+  bool writeChartJSON(JsonWriter& json, const char* channel, uint32_t from, uint32_t to,
+                      uint16_t points) const;
+
+  // Same chart in the binary format (little endian):
+  //   u8 version, u8 flags (bit 0: utc0 valid), u16 points, u32 samples,
+  //   u32 t0, u64 utc0, then per point: varint dt (ms), f32 value
+  // Returns the encoded length, 0 if the channel is unknown or disabled
+  size_t writeChartBinary(uint8_t* buffer, size_t bufferSize, const char* channel, uint32_t from,
+                          uint32_t to, uint16_t points) const;
+
+  // Number of stored records
+  inline uint16_t getCount() const {
+    return m_count;
+  }
+
+private:
+  struct Record {
+    uint32_t timestamp;                     // millis() at record time
+    SensorRegistry::ChannelData channels;
+  };
+
+  Record m_records[HISTORY_CAPACITY];
+  uint16_t m_head;   // Next slot to write
+  uint16_t m_count;
+
+  // Record by position (0 = oldest)
+  inline const Record& at(uint32_t position) const {
+    return m_records[(m_head + HISTORY_CAPACITY - m_count + position) % HISTORY_CAPACITY];
+  }
+
+  // First position with timestamp >= time (m_count if none)
+  uint32_t lowerBound(uint32_t time) const;
+
+  // Record positions [first, last) inside [from, to]
+  void findWindow(uint32_t from, uint32_t to, uint32_t& first, uint32_t& last) const;
+};
+
+#endif // SAMPLE_HISTORY_H
@@ -0,0 +1,159 @@
+/*
+ * Sampling Profiles Implementation
+ */
+
+#include "SamplingProfiles.h"
+#include <Preferences.h>
+#include "EventLog.h"
+
+// Profile table - "balanced" matches the former hard-coded setup (x2, filter off, 5 s)
+static const SamplingProfile PROFILES[] = {
+  // name              T  P  H  IIR t_sb interval
+  { "low-power",       1, 1, 1, 0,  5,   60000 },  // Datasheet "weather monitoring": 1/min, x1, filter off
+  { "balanced",        2, 2, 2, 0,  2,   5000 },
+  { "high-precision",  2, 5, 1, 2,  0,   10000 },  // x16 pressure, IIR 4 for low noise
+  { "high-rate",       1, 1, 1, 0,  0,   1000 }
+};
+
+constexpr const char* PREFERENCES_NAMESPACE = "sampling";
+constexpr const char* PREFERENCES_KEY = "profile";
+
+// Supply current while measuring (datasheet typical, µA) and in sleep / standby (nA)
+constexpr uint32_t CURRENT_TEMPERATURE_UA = 350;
+constexpr uint32_t CURRENT_PRESSURE_UA = 714;
+constexpr uint32_t CURRENT_HUMIDITY_UA = 340;
+constexpr uint32_t CURRENT_SLEEP_NA = 100;
+constexpr uint32_t CURRENT_STANDBY_NA = 200;
+
+// t_sb codes 0..7 in µs (normal mode)
+static const uint32_t STANDBY_US[] = { 500, 62500, 125000, 250000, 500000, 1000000, 10000, 20000 };
+
+SamplingProfiles samplingProfiles;
+
+// Oversampling code -> number of samples (0 = skipped)
+static uint32_t samples(uint8_t code) {
+  return code == 0 ? 0 : 1UL << (code - 1);
+}
+
+// Constructor
+SamplingProfiles::SamplingProfiles()
+  : m_active(find(SAMPLING_DEFAULT_PROFILE)),
+    m_revision(0) {
+  if (!m_active) {
+    m_active = &PROFILES[0];
+  }
+}
+
+// Restore persisted selection
+void SamplingProfiles::begin() {
+  Preferences preferences;
+  char name[24] = "";
+
+  if (preferences.begin(PREFERENCES_NAMESPACE, true)) {
+    preferences.getString(PREFERENCES_KEY, name, sizeof(name));
+    preferences.end();
+  }
+
+  const SamplingProfile* stored = find(name);
+  if (stored) {
+    m_active = stored;
+  }
+
+  #if DEBUG_SERIAL_ENABLED
+  Serial.printf("[Sampling] Profile '%s'%s\n", m_active->name, stored ? "" : " (default)");
+  #endif
+}
+
+// Activate profile, write NVS only when the selection changed (flash wear)
+bool SamplingProfiles::select(const char* name) {
+  const SamplingProfile* profile = find(name);
+  if (!profile) {
+    return false;
+  }
+  if (profile == m_active) {
+    return true;
+  }
+
+  Preferences preferences;
+  if (preferences.begin(PREFERENCES_NAMESPACE, false)) {
+    preferences.putString(PREFERENCES_KEY, profile->name);
+    preferences.end();
+  } else {
+    Serial.println("[ERROR] NVS unavailable - sampling profile not persisted");
+  }
+
+  m_active = profile;
+  m_revision++;
+  eventLog.log(EventCode::SAMPLING_PROFILE_CHANGED, profile - PROFILES);
+
+  return true;
+}
+
+// t_measure = 1 + 2*T + (2*P + 0.5) + (2*H + 0.5) ms typical,
+//             1.25 + 2.3*T + (2.3*P + 0.575) + (2.3*H + 0.575) ms maximum
+uint32_t SamplingProfiles::getConversionTimeUs(const SamplingProfile& profile, bool maximum) {
+  const uint32_t perSample = maximum ? 2300 : 2000;
+  const uint32_t phaseSetup = maximum ? 575 : 500;
+  const uint32_t t = samples(profile.osrsTemperature);
+  const uint32_t p = samples(profile.osrsPressure);
+  const uint32_t h = samples(profile.osrsHumidity);
+
+  return (maximum ? 1250 : 1000) + perSample * t +
+         (p ? perSample * p + phaseSetup : 0) +
+         (h ? perSample * h + phaseSetup : 0);
+}
+
+// Charge per conversion (per-phase current x typical phase time) spread over
+// the measurement period, plus sleep (forced) or standby (normal mode) current
+uint32_t SamplingProfiles::getCurrentNanoAmps(const SamplingProfile& profile) {
+  const uint32_t t = samples(profile.osrsTemperature);
+  const uint32_t p = samples(profile.osrsPressure);
+  const uint32_t h = samples(profile.osrsHumidity);
+
+  // µA x µs = pC
+  const uint64_t charge = (uint64_t)CURRENT_TEMPERATURE_UA * (1000 + 2000 * t) +
+                          (p ? (uint64_t)CURRENT_PRESSURE_UA * (2000 * p + 500) : 0) +
+                          (h ? (uint64_t)CURRENT_HUMIDITY_UA * (2000 * h + 500) : 0);
+
+  #if HIGH_RATE_SAMPLING_ENABLED
+  const uint64_t periodUs = getConversionTimeUs(profile, false) + STANDBY_US[profile.standby & 0x07];
+  const uint32_t idleNanoAmps = CURRENT_STANDBY_NA;
+  #else
+  const uint64_t periodUs = (uint64_t)profile.intervalMs * 1000;
+  const uint32_t idleNanoAmps = CURRENT_SLEEP_NA;
+  #endif
+
+  return (uint32_t)(charge * 1000 / periodUs) + idleNanoAmps;
+}
+
+// Active profile and table
+void SamplingProfiles::writeJSON(JsonWriter& json) const {
+  json.addString("active", m_active->name);
+  json.beginArray("profiles");
+
+  for (const SamplingProfile& profile : PROFILES) {
+    json.beginObject();
+    json.addString("name", profile.name);
+    json.addUInt("osrsTemperature", samples(profile.osrsTemperature));
+    json.addUInt("osrsPressure", samples(profile.osrsPressure));
+    json.addUInt("osrsHumidity", samples(profile.osrsHumidity));
+    json.addUInt("iirCoefficient", profile.filter ? 1UL << profile.filter : 0);
+    json.addUInt("intervalMs", profile.intervalMs);
+    json.addFloat("conversionMs", getConversionTimeUs(profile, false) / 1000.0f);
+    json.addFloat("conversionMaxMs", getConversionTimeUs(profile, true) / 1000.0f);
+    json.addFloat("currentUa", getCurrentNanoAmps(profile) / 1000.0f, 3);
+    json.endObject();
+  }
+
+  json.endArray();
+}
+
+// Profile by name (nullptr if unknown)
+const SamplingProfile* SamplingProfiles::find(const char* name) {
+  for (const SamplingProfile& profile : PROFILES) {
+    if (strcmp(profile.name, name) == 0) {
+      return &profile;
+    }
+  }
+  return nullptr;
+}
@@ -0,0 +1,68 @@
+/*
+ * Sampling Profiles for ESP32 Weather Station
+ * Named BME280 oversampling / IIR filter / interval sets that trade latency,
+ * noise and power. The active profile is chosen at runtime over the API,
+ * persisted in NVS (Preferences) and applied with the next measurement.
+ * Conversion time and average current are derived from the datasheet model
+ * (BME280 datasheet, section 9 / Appendix B).
+ */
+
+#ifndef SAMPLING_PROFILES_H
+#define SAMPLING_PROFILES_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "JsonWriter.h"
+
+// BME280 register settings of one profile
+struct SamplingProfile {
+  const char* name;
+  uint8_t osrsTemperature;  // Oversampling codes: 0 = skipped, 1..5 = x1..x16
+  uint8_t osrsPressure;
+  uint8_t osrsHumidity;
+  uint8_t filter;           // IIR coefficient code: 0 = off, 1..4 = 2, 4, 8, 16
+  uint8_t standby;          // t_sb code between conversions (normal mode, high-rate sampling)
+  uint32_t intervalMs;      // Measurement interval (fixed-interval and high-rate modes)
+};
+
+class SamplingProfiles {
+public:
+  // Constructor
+  SamplingProfiles();
+
+  // Load the persisted profile (SAMPLING_DEFAULT_PROFILE if none or unknown)
+  void begin();
+
+  // Activate and persist a profile by name
+  // Returns false if the name is unknown (active profile unchanged)
+  bool select(const char* name);
+
+  inline const SamplingProfile& getActive() const {
+    return *m_active;
+  }
+
+  // Incremented on every change - readers compare it to apply lazily
+  inline uint32_t getRevision() const {
+    return m_revision;
+  }
+
+  // Conversion time of one forced measurement (datasheet typical / maximum, µs)
+  static uint32_t getConversionTimeUs(const SamplingProfile& profile, bool maximum);
+
+  // Expected average supply current of one BME280 at the profile's rate (nA)
+  static uint32_t getCurrentNanoAmps(const SamplingProfile& profile);
+
+  // Serialize active profile and the profile table with timings and current
+  void writeJSON(JsonWriter& json) const;
+
+private:
+  const SamplingProfile* m_active;
+  uint32_t m_revision;
+
+  static const SamplingProfile* find(const char* name);
+};
+
+// Global profile selection (read by the sensor driver, set by the API)
+extern SamplingProfiles samplingProfiles;
+
+#endif // SAMPLING_PROFILES_H
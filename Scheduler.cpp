@@ -0,0 +1,113 @@
+/*
+ * Scheduler Implementation
+ */
+
+#include "Scheduler.h"
+
+static_assert(SCHEDULER_MAX_JOBS <= 32, "Triggered job mask holds 32 jobs");
+
+// Constructor
+Scheduler::Scheduler()
+  : m_wheel(0),
+    m_jobs{},
+    m_jobCount(0),
+    m_task(nullptr),
+    m_triggered(0),
+    m_windowStart(0),
+    m_windowIdleUs(0),
+    m_idlePermille(0) {
+}
+
+// Bind to loop task
+void Scheduler::begin() {
+  m_task = xTaskGetCurrentTaskHandle();
+  m_windowStart = micros();
+
+  // Wheel time base must match millis() before the first job is armed
+  m_wheel = TimerWheel(millis());
+}
+
+// Register job
+bool Scheduler::addJob(TimerJob& job) {
+  if (m_jobCount >= SCHEDULER_MAX_JOBS) {
+    // Always show configuration errors
+    Serial.printf("[ERROR] Scheduler full - job '%s' not added\n", job.name);
+    return false;
+  }
+
+  m_jobs[m_jobCount++] = &job;
+  return true;
+}
+
+// Request immediate run from any task
+void Scheduler::trigger(const TimerJob& job) {
+  for (uint8_t i = 0; i < m_jobCount; i++) {
+    if (m_jobs[i] == &job) {
+      m_triggered.fetch_or(1UL << i);
+      break;
+    }
+  }
+
+  if (m_task) {
+    xTaskNotifyGive(m_task);
+  }
+}
+
+// Run due jobs
+void Scheduler::runDue() {
+  const uint32_t now = millis();
+
+  // Triggered jobs are pulled forward to now
+  uint32_t triggered = m_triggered.exchange(0);
+  while (triggered) {
+    const uint8_t index = __builtin_ctz(triggered);
+    triggered &= triggered - 1;
+    m_wheel.schedule(*m_jobs[index], now);
+  }
+
+  m_wheel.advance(now);
+}
+
+// Block until next deadline, account idle time
+void Scheduler::waitForNext() {
+  const uint32_t wait = m_wheel.timeUntilNext(millis());
+  const uint32_t start = micros();
+
+  if (wait > 0) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait));
+  }
+
+  const uint32_t end = micros();
+  m_windowIdleUs += end - start;
+
+  // Close idle window
+  const uint32_t windowUs = end - m_windowStart;
+  if (windowUs >= SCHEDULER_IDLE_WINDOW_MS * 1000UL) {
+    m_idlePermille = (uint64_t)m_windowIdleUs * 1000 / windowUs;
+    m_windowStart = end;
+    m_windowIdleUs = 0;
+  }
+}
+
+// Serialize jobs and idle statistics
+void Scheduler::writeJSON(JsonWriter& json) const {
+  json.addFloat("idlePercent", m_idlePermille / 10.0f, 1);
+  json.addUInt("tickMs", SCHEDULER_TICK_MS);
+
+  json.beginArray("jobs");
+  for (uint8_t i = 0; i < m_jobCount; i++) {
+    const TimerJob& job = *m_jobs[i];
+    json.beginObject();
+    json.addString("name", job.name);
+    json.addUInt("periodMs", job.period);
+    json.addUInt("runs", job.runs);
+    json.addUInt("maxLateMs", job.maxLateness);
+    if (job.scheduled) {
+      json.addInt("dueInMs", (int32_t)(job.deadline - millis()));
+    } else {
+      json.addNull("dueInMs");
+    }
+    json.endObject();
+  }
+  json.endArray();
+}
@@ -0,0 +1,73 @@
+/*
+ * Scheduler for ESP32 Weather Station
+ * Cooperative job scheduler on top of TimerWheel. loop() runs the due jobs,
+ * then blocks on a task notification until the next deadline instead of
+ * spinning, so the CPU idles between jobs. Time spent blocked is measured
+ * as CPU idle percentage.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "Config.h"
+#include "TimerWheel.h"
+#include "JsonWriter.h"
+
+class Scheduler {
+public:
+  // Constructor
+  Scheduler();
+
+  // Bind to the calling task (call from setup())
+  void begin();
+
+  // Register job (not armed until scheduled)
+  // Returns false if SCHEDULER_MAX_JOBS is exceeded
+  bool addJob(TimerJob& job);
+
+  // Register job and arm it for an absolute deadline
+  inline bool addJob(TimerJob& job, uint32_t deadline) {
+    if (!addJob(job)) {
+      return false;
+    }
+    m_wheel.schedule(job, deadline);
+    return true;
+  }
+
+  // Re-arm job for an absolute deadline (loop task only)
+  inline void schedule(TimerJob& job, uint32_t deadline) {
+    m_wheel.schedule(job, deadline);
+  }
+
+  // Run job as soon as possible - safe from other tasks
+  void trigger(const TimerJob& job);
+
+  // Run all due jobs (and triggered ones)
+  void runDue();
+
+  // Block until the next deadline or a trigger
+  void waitForNext();
+
+  // Serialize jobs and idle statistics
+  void writeJSON(JsonWriter& json) const;
+
+private:
+  TimerWheel m_wheel;
+  TimerJob* m_jobs[SCHEDULER_MAX_JOBS];
+  uint8_t m_jobCount;
+
+  // Task running loop() (notified by trigger())
+  TaskHandle_t m_task;
+
+  // Jobs triggered from other tasks (bit = index in m_jobs)
+  std::atomic<uint32_t> m_triggered;
+
+  // CPU idle instrumentation (current window + last completed window)
+  uint32_t m_windowStart;   // micros()
+  uint32_t m_windowIdleUs;
+  uint16_t m_idlePermille;
+};
+
+#endif // SCHEDULER_H
@@ -4,143 +4,137 @@
 
 #include "SensorManager.h"
 
-// Constructor - initialize sensor objects
+// Constructor
 SensorManager::SensorManager()
-  : m_lightMeter(BH1750_I2C_ADDR) {
+  : m_derivedCycles(0),
+    m_profileRevision(0),
+    m_intervalMs(0),
+    m_sequence(0),
+    m_sampleCount(0),
+    m_lastReadTime(0),
+    m_sampleTime(0),
+    m_readStarted(false),
+    m_startSweepTime(0),
+    m_lastSweepTime(0) {
 }
 
 // Initialize all sensors
 bool SensorManager::begin() {
-  bool success = true;
+  applySamplingProfile();
+  return m_sensors.begin(millis());
+}
+
+// Apply the selected sampling profile without a reboot
+void SensorManager::applySamplingProfile() {
+  const SamplingProfile& profile = samplingProfiles.getActive();
+
+  m_sensors.get<Bme280Sensor>().applyProfile(profile);
+  m_intervalMs = profile.intervalMs;
+  m_profileRevision = samplingProfiles.getRevision();
 
-  #if SENSOR_BME280_ENABLED
-  // Initialize BME280/BMP280
-  if (!initBME280()) {
-    success = false;
-  }
-  #else
   #if DEBUG_SERIAL_ENABLED
-  Serial.println("[I2C] BME280 sensor disabled");
-  #endif
+  Serial.printf("[Sampling] Applied '%s' (%lu ms)\n", profile.name, (unsigned long)m_intervalMs);
   #endif
+}
 
-  #if SENSOR_BH1750_ENABLED
-  // Initialize BH1750
-  if (!initBH1750()) {
-    success = false;
+// Start the conversions of the next read
+uint32_t SensorManager::startSensors() {
+  if (isProfileChanged()) {
+    applySamplingProfile();
   }
+
+  const uint32_t currentTime = millis();
+  m_lastReadTime = currentTime;
+  m_readStarted = true;
+
+  #if HIGH_RATE_SAMPLING_ENABLED
+  // Published from the filters, sampled by sampleSensors()
+  return 0;
   #else
-  #if DEBUG_SERIAL_ENABLED
-  Serial.println("[I2C] BH1750 sensor disabled");
-  #endif
+  const uint32_t sweepStart = micros();
+
+  #if ADAPTIVE_SAMPLING_ENABLED
+  const uint32_t conversionMs = m_sensors.startDue(currentTime);
+  #else
+  const uint32_t conversionMs = m_sensors.start(currentTime);
   #endif
 
-  return success;
+  m_startSweepTime = micros() - sweepStart;
+  return conversionMs;
+  #endif
 }
 
-// Initialize BME280/BMP280 on I2C Bus #1
-bool SensorManager::initBME280() {
-  // Initialize I2C Bus #1 with custom pins
-  Wire.begin(I2C1_SDA_PIN, I2C1_SCL_PIN);
-  Wire.setClock(I2C_CLOCK_SPEED);
+// Read all sensors and update internal data
+bool SensorManager::readSensors() {
+  if (!m_readStarted) {
+    startSensors();
+  }
+  m_readStarted = false;
+
+  // Readings are stamped when collected, i.e. when the conversions finished
+  const uint32_t currentTime = millis();
 
-  #if DEBUG_SERIAL_ENABLED
-  Serial.printf("[I2C] Bus #1 init: SDA=%d, SCL=%d @ %dkHz\n",
-                I2C1_SDA_PIN, I2C1_SCL_PIN, I2C_CLOCK_SPEED / 1000);
+  #if HIGH_RATE_SAMPLING_ENABLED
+  // Publish boxcar average of samples since last call, smoothed by EMA
+  SensorRegistry::decimate(m_filters, m_sensorData);
+  SensorRegistry::copyAnomalies(m_sampleData, m_sensorData);
+  #else
+  const uint32_t sweepStart = micros();
+
+  #if ADAPTIVE_SAMPLING_ENABLED
+  // Collect the due sensors, publish channels that moved beyond their deadband
+  const bool published = m_sensors.collectDue(m_sampleData, m_sensorData, currentTime);
+  #else
+  // Collect every started sensor and fuse
+  m_sensors.collect(m_sensorData, currentTime);
   #endif
 
-  // Try to initialize BME280/BMP280 sensor
-  if (!m_bme.begin(BME_I2C_ADDR, &Wire)) {
-    Serial.println("[ERROR] BME280 not found at 0x76");
+  m_lastSweepTime = m_startSweepTime + (micros() - sweepStart);
+  m_sampleCount++;
+
+  #if ADAPTIVE_SAMPLING_ENABLED
+  if (!published) {
     return false;
   }
-
-  // Configure sensor for fast measurements (all x2 oversampling)
-  m_bme.setSampling(
-    Adafruit_BME280::MODE_FORCED,        // Forced mode (power saving)
-    Adafruit_BME280::SAMPLING_X2,        // Temp x2: ±0.5°C, fast
-    Adafruit_BME280::SAMPLING_X2,        // Humidity x2: ±0.5%, fast
-    Adafruit_BME280::SAMPLING_X2,        // Pressure x2: ±2 Pa, fast
-    Adafruit_BME280::FILTER_OFF,         // No IIR filter (instant response)
-    Adafruit_BME280::STANDBY_MS_1000     // Standby (unused in FORCED mode)
-  );
-
-  #if DEBUG_SERIAL_ENABLED
-  Serial.println("[I2C] BME280 ready");
+  #endif
   #endif
 
-  return true;
-}
-
-// Initialize BH1750 on I2C Bus #2
-bool SensorManager::initBH1750() {
-  // Initialize I2C Bus #2 with custom pins (separate bus for isolation)
-  Wire1.begin(I2C2_SDA_PIN, I2C2_SCL_PIN);
-  Wire1.setClock(I2C_CLOCK_SPEED);
+  // Validate all readings
+  m_sensorData.isValid = SensorRegistry::validate(m_sensorData);
 
-  #if DEBUG_SERIAL_ENABLED
-  Serial.printf("[I2C] Bus #2 init: SDA=%d, SCL=%d @ %dkHz\n",
-                I2C2_SDA_PIN, I2C2_SCL_PIN, I2C_CLOCK_SPEED / 1000);
-  #endif
+  // Derived metrics once per publish (not per API request / viewer)
+  const uint32_t cycleStart = ESP.getCycleCount();
+  m_derived.compute(m_sensorData.temperature, m_sensorData.humidity);
+  m_derivedCycles = ESP.getCycleCount() - cycleStart;
 
-  // Try to initialize BH1750 light sensor
-  if (!m_lightMeter.begin(BH1750::CONTINUOUS_HIGH_RES_MODE, BH1750_I2C_ADDR, &Wire1)) {
-    // Always show sensor errors
-    Serial.println("[ERROR] BH1750 not found at 0x23");
-    return false;
-  }
+  m_pressureTrend.update(m_sensorData.pressure, m_sensorData.temperature, currentTime);
 
-  #if DEBUG_SERIAL_ENABLED
-  Serial.println("[I2C] BH1750 ready");
-  #endif
+  m_sampleTime = currentTime;
+  m_sequence++;
 
   return true;
 }
 
-// Read all sensors and update internal data
-void SensorManager::readSensors() {
-  #if SENSOR_BME280_ENABLED
-  // Trigger forced measurement on BME280 (wakes sensor from sleep)
-  m_bme.takeForcedMeasurement();
-
-  m_sensorData.temperature = m_bme.readTemperature();
-  m_sensorData.humidity = m_bme.readHumidity();
-  m_sensorData.pressure = m_bme.readPressure();
-  #else
-  m_sensorData.temperature = NAN;
-  m_sensorData.humidity = NAN;
-  m_sensorData.pressure = NAN;
-  #endif
-
-  #if SENSOR_BH1750_ENABLED
-  m_sensorData.lightLevel = m_lightMeter.readLightLevel();
+// Deadline of next read
+uint32_t SensorManager::getNextReadTime(uint32_t currentTime) const {
+  #if ADAPTIVE_SAMPLING_ENABLED
+  return m_sensors.getNextReadTime(currentTime);
   #else
-  m_sensorData.lightLevel = NAN;
+  (void)currentTime;
+  return m_lastReadTime + m_intervalMs;
   #endif
-
-  // Validate all readings
-  validateReadings();
 }
 
-// Validate sensor readings
-void SensorManager::validateReadings() {
-  // Start with valid assumption
-  m_sensorData.isValid = true;
+// Take one high-rate sample into the filter pipelines
+void SensorManager::sampleSensors() {
+  #if HIGH_RATE_SAMPLING_ENABLED
+  const uint32_t sweepStart = micros();
 
-  #if SENSOR_BME280_ENABLED
-  // Check if BME280 readings are valid (temperature and pressure are critical)
-  if (!isfinite(m_sensorData.temperature) || !isfinite(m_sensorData.pressure)) {
-    m_sensorData.isValid = false;
-  }
-  // Note: Humidity might be NaN on BMP280 (lacks humidity sensor)
-  // This is acceptable and doesn't affect overall validity
-  #endif
+  m_sensors.read(m_sampleData, millis());
+  SensorRegistry::filter(m_sampleData, m_filters);
 
-  #if SENSOR_BH1750_ENABLED
-  // Check if BH1750 reading is valid
-  if (!isfinite(m_sensorData.lightLevel)) {
-    m_sensorData.isValid = false;
-  }
+  m_lastSweepTime = micros() - sweepStart;
+  m_sampleCount++;
   #endif
 }
 
@@ -1,51 +1,184 @@
 /*
  * Sensor Manager for ESP32 Weather Station
  * Handles BME280/BMP280 and BH1750 sensors on separate I2C buses
+ * Failed sensors are recovered in place (bus clear, re-init, re-probe)
  */
 
 #ifndef SENSOR_MANAGER_H
 #define SENSOR_MANAGER_H
 
-#include <Wire.h>
-#include <Adafruit_Sensor.h>
-#include <Adafruit_BME280.h>
-#include <BH1750.h>
 #include "Config.h"
+#include "SensorSet.h"
+#include "Bme280Sensor.h"
+#include "Bh1750Sensor.h"
+#include "JsonWriter.h"
+#include "DerivedMetrics.h"
+#include "PressureTrend.h"
+#include "SamplingProfiles.h"
+
+static_assert(!(HIGH_RATE_SAMPLING_ENABLED && ADAPTIVE_SAMPLING_ENABLED),
+              "High-rate and adaptive sampling are mutually exclusive");
+
+// Active sensor list - a new sensor only needs a driver and an entry here
+using SensorRegistry = SensorSet<Bme280Sensor, Bh1750Sensor>;
+
+// Sensor data structure (channels of all registered drivers + validity)
+using SensorData = SensorRegistry::Data;
 
 class SensorManager {
 public:
   // Constructor
   SensorManager();
 
-  // Initialize both sensors and I2C buses
+  // Initialize all enabled sensors and their I2C buses with the active sampling profile
   // Returns true if all sensors initialized successfully
+  // Sensors that fail here are retried by readSensors() with backoff
   bool begin();
 
-  // Read all sensors and update internal data
-  void readSensors();
+  // Start the conversions of the next read (phase 1 of readSensors())
+  // Returns the time until they have finished (ms) - readSensors() then
+  // collects without waiting (0 in high-rate mode)
+  uint32_t startSensors();
+
+  // Read all sensors and update internal data (starts them first unless
+  // startSensors() did)
+  // Offline sensors are recovered in place when their retry time is due
+  // In high-rate mode this publishes the decimated filter output instead
+  // In adaptive mode only due sensors are read and data is published on change
+  // Returns true if published data was updated
+  bool readSensors();
+
+  // Time at which readSensors() should be called next
+  // (sampling profile interval, or earliest adaptive sensor deadline)
+  uint32_t getNextReadTime(uint32_t currentTime) const;
+
+  // True when a different sampling profile was selected since the last read
+  // (readSensors() applies it before reading)
+  inline bool isProfileChanged() const {
+    return m_profileRevision != samplingProfiles.getRevision();
+  }
+
+  // Take one high-rate sample into the filter pipelines (high-rate mode only)
+  void sampleSensors();
 
   // Get current sensor readings (const reference to avoid copying)
   inline const SensorData& getSensorData() const {
     return m_sensorData;
   }
 
+  // Metrics derived from the published readings (dew point, comfort, ...)
+  inline const DerivedMetrics& getDerivedMetrics() const {
+    return m_derived;
+  }
+
+  // Pressure tendency and forecast from the published pressure history
+  inline const PressureTrend& getPressureTrend() const {
+    return m_pressureTrend;
+  }
+
+  // CPU cycles spent deriving metrics for the last publish
+  inline uint32_t getDerivedCycles() const {
+    return m_derivedCycles;
+  }
+
+  // Publish sequence number - incremented whenever published data changes
+  inline uint32_t getSequence() const {
+    return m_sequence;
+  }
+
+  // millis() at which the published readings were acquired
+  // (TimeSync maps it to UTC)
+  inline uint32_t getSampleTime() const {
+    return m_sampleTime;
+  }
+
+  // Number of sensor read sweeps since boot
+  inline uint32_t getSampleCount() const {
+    return m_sampleCount;
+  }
+
+  // Get a sensor driver (e.g. for its recovery state)
+  template <typename Driver>
+  inline const Driver& getSensor() const {
+    return m_sensors.get<Driver>();
+  }
+
+  // Serialize channels of enabled sensors into API response
+  inline void writeJSON(JsonWriter& json) const {
+    SensorRegistry::writeJSON(m_sensorData, json);
+  }
+
+  // Serialize anomaly flags of published channels (flagged channels only)
+  inline void writeAnomalyJSON(JsonWriter& json) const {
+    SensorRegistry::writeAnomalyJSON(m_sensorData, json);
+  }
+
+  // Serialize anomaly detector statistics per sensor and channel
+  inline void writeDetectorJSON(JsonWriter& json) const {
+    m_sensors.writeDetectorJSON(json);
+  }
+
+  // Serialize every physical sensor with its raw (unfused) values
+  inline void writeRawJSON(JsonWriter& json) const {
+    m_sensors.writeRawJSON(json);
+  }
+
+  // Serialize current per-sensor sampling interval
+  inline void writeIntervalJSON(JsonWriter& json) const {
+    m_sensors.writeIntervalJSON(json);
+  }
+
+  // Duration of the last read sweep over all sensors (microseconds)
+  inline uint32_t getLastSweepTime() const {
+    return m_lastSweepTime;
+  }
+
   // Print sensor readings to Serial (only if DEBUG_SERIAL_ENABLED)
   void printToSerial() const;
 
 private:
-  // Sensor objects
-  Adafruit_BME280 m_bme;
-  BH1750 m_lightMeter;
+  // Push the active sampling profile to the drivers
+  void applySamplingProfile();
 
-  // Current sensor readings
+  // Sensor drivers
+  SensorRegistry m_sensors;
+
+  // Current (published) sensor readings
   SensorData m_sensorData;
 
-  // Internal initialization methods
-  bool initBME280();
-  bool initBH1750();
+  // Derived metrics of m_sensorData
+  DerivedMetrics m_derived;
+  uint32_t m_derivedCycles;
+
+  // Fixed-memory pressure history (3 h / 6 h fits)
+  PressureTrend m_pressureTrend;
+
+  #if HIGH_RATE_SAMPLING_ENABLED || ADAPTIVE_SAMPLING_ENABLED
+  // Latest unpublished sample
+  SensorData m_sampleData;
+  #endif
+
+  #if HIGH_RATE_SAMPLING_ENABLED
+  // Per-channel filters
+  SensorRegistry::FilterData m_filters;
+  #endif
+
+  // Applied sampling profile
+  uint32_t m_profileRevision;
+  uint32_t m_intervalMs;
+
+  // Publish bookkeeping
+  uint32_t m_sequence;
+  uint32_t m_sampleCount;
+  uint32_t m_lastReadTime;
+  uint32_t m_sampleTime;
+
+  // Started by startSensors(), not collected yet
+  bool m_readStarted;
 
-  // Validate sensor readings
-  void validateReadings();
+  // Last read sweep duration, start and collect phase (microseconds)
+  uint32_t m_startSweepTime;
+  uint32_t m_lastSweepTime;
 };
 
 #endif // SENSOR_MANAGER_H
@@ -0,0 +1,435 @@
+/*
+ * Compile-time Sensor Registry for ESP32 Weather Station
+ * SensorSet<Drivers...> generates begin, read, recovery, validation and JSON
+ * code for every listed driver with fold expressions (no runtime dispatch)
+ *
+ * A driver provides:
+ * - ENABLED / NAME constants and a Channels struct (fields of SensorData)
+ * - Filters struct with push()/decimate() for high-rate sampling mode
+ * - Anomalies struct (flag fields of SensorData) and Detectors struct with
+ *   check()/writeJSON(), plus static writeAnomalyJSON()
+ * - begin(), recover(), start(), collect(Channels&) and getConversionTime()
+ *   (ms after start() until collect() finds the conversion finished)
+ * - static clear(), validate(), change(), writeJSON(), writeLine() and
+ *   findChannel() for its Channels
+ * - writeRawJSON() listing its physical sensors (raw, unfused values)
+ * - state() returning its BusState
+ */
+
+#ifndef SENSOR_SET_H
+#define SENSOR_SET_H
+
+#include <tuple>
+#include <type_traits>
+#include "Config.h"
+#include "I2CRecovery.h"
+#include "JsonWriter.h"
+#include "LineWriter.h"
+#include "AnomalyDetector.h"
+#include "AdaptiveInterval.h"
+#include "EventLog.h"
+
+// Sensor record - every driver contributes its channel and anomaly flag fields
+template <typename... Drivers>
+struct SensorRecord : Drivers::Channels..., Drivers::Anomalies... {
+  bool isValid = false;
+};
+
+// Channel values only (no flags) - compact record for the sample history
+template <typename... Drivers>
+struct SensorChannelSet : Drivers::Channels... {
+};
+
+// Filter state - every driver contributes its per-channel pipelines
+template <typename... Drivers>
+struct SensorFilterSet : Drivers::Filters... {
+};
+
+// Position of a driver in the registry (sensor index in event records)
+template <typename Driver, typename First, typename... Rest>
+constexpr uint8_t driverIndex() {
+  if constexpr (std::is_same<Driver, First>::value) {
+    return 0;
+  } else {
+    return 1 + driverIndex<Driver, Rest...>();
+  }
+}
+
+// Driver with its adaptive schedule
+template <typename Driver>
+struct SensorSlot {
+  Driver driver;
+  AdaptiveInterval interval;
+  typename Driver::Detectors detectors;
+  uint32_t lastPublishTime = 0;
+  bool due = false;
+};
+
+template <typename... Drivers>
+class SensorSet {
+public:
+  using Data = SensorRecord<Drivers...>;
+  using FilterData = SensorFilterSet<Drivers...>;
+  using ChannelData = SensorChannelSet<Drivers...>;
+  using ChannelField = float ChannelData::*;
+
+  // Initialize all enabled drivers
+  // Returns true if all of them answered, failed ones are scheduled for recovery
+  bool begin(uint32_t currentTime) {
+    bool success = true;
+    ((success &= beginDriver(get<Drivers>(), currentTime)), ...);
+    return success;
+  }
+
+  // Read phase 1: start the conversions of all enabled drivers (on separate
+  // buses they overlap). Returns the time until the slowest has finished (ms)
+  uint32_t start(uint32_t currentTime) {
+    uint32_t conversionMs = 0;
+    ((conversionMs = max(conversionMs, startDriver(get<Drivers>(), currentTime))), ...);
+    return conversionMs;
+  }
+
+  // Read phase 2: collect all enabled drivers. Fresh samples are checked for
+  // anomalies (rejected channels become NAN, flags are set in data)
+  void collect(Data& data, uint32_t currentTime) {
+    (collectDriver(get<Drivers>(), data, currentTime), ...);
+    (detectDriver(slot<Drivers>(), data, currentTime), ...);
+  }
+
+  // Both phases at once (conversions still running return their previous reading)
+  void read(Data& data, uint32_t currentTime) {
+    start(currentTime);
+    collect(data, currentTime);
+  }
+
+  // Adaptive phase 1: start only drivers whose adaptive interval has elapsed
+  // Returns the time until the slowest has finished (ms)
+  uint32_t startDue(uint32_t currentTime) {
+    uint32_t conversionMs = 0;
+    ((conversionMs = max(conversionMs, startAdaptive(slot<Drivers>(), currentTime))), ...);
+    return conversionMs;
+  }
+
+  // Adaptive phase 2: collect the started drivers into sample, and copy a
+  // driver's channels to published when they moved by more than one
+  // deadband (or on heartbeat). Returns true if anything was published.
+  bool collectDue(Data& sample, Data& published, uint32_t currentTime) {
+    bool event = false;
+    ((event |= collectAdaptive(slot<Drivers>(), sample, published, currentTime)), ...);
+    return event;
+  }
+
+  // Both adaptive phases at once
+  bool readAdaptive(Data& sample, Data& published, uint32_t currentTime) {
+    startDue(currentTime);
+    return collectDue(sample, published, currentTime);
+  }
+
+  // Earliest time any enabled driver is due (adaptive sampling)
+  uint32_t getNextReadTime(uint32_t currentTime) const {
+    uint32_t earliest = currentTime + ADAPTIVE_MAX_INTERVAL_MS;
+    ((earliest = earlierDue(slot<Drivers>(), earliest)), ...);
+    return earliest;
+  }
+
+  // Feed a high-rate sample of all enabled drivers into their filters
+  static void filter(const Data& data, FilterData& filters) {
+    (filterDriver<Drivers>(data, filters), ...);
+  }
+
+  // Publish decimated values of all enabled drivers
+  static void decimate(FilterData& filters, Data& data) {
+    (decimateDriver<Drivers>(filters, data), ...);
+  }
+
+  // Check readings of all enabled drivers (any anomaly flag invalidates)
+  static bool validate(const Data& data) {
+    return (validateDriver<Drivers>(data) && ...);
+  }
+
+  // Serialize channels of all enabled drivers (disabled ones are omitted)
+  static void writeJSON(const Data& data, JsonWriter& json) {
+    (writeDriverJSON<Drivers>(data, json), ...);
+  }
+
+  // Append channels of all enabled drivers as line protocol fields
+  static void writeLine(const Data& data, LineWriter& line) {
+    (writeDriverLine<Drivers>(data, line), ...);
+  }
+
+  // Copy channel values of all drivers (history record)
+  static void copyChannels(const Data& from, ChannelData& to) {
+    ((static_cast<typename Drivers::Channels&>(to) =
+        static_cast<const typename Drivers::Channels&>(from)), ...);
+  }
+
+  // Channel of an enabled driver by its JSON key (nullptr if unknown)
+  static ChannelField findChannel(const char* name) {
+    ChannelField field = nullptr;
+    ((field = field ? field : findDriverChannel<Drivers>(name)), ...);
+    return field;
+  }
+
+  // Serialize anomaly flags of all enabled drivers (flagged channels only)
+  static void writeAnomalyJSON(const Data& data, JsonWriter& json) {
+    (writeDriverAnomalyJSON<Drivers>(data, json), ...);
+  }
+
+  // Copy anomaly flags (high-rate mode publishes the latest sample's flags)
+  static void copyAnomalies(const Data& from, Data& to) {
+    ((static_cast<typename Drivers::Anomalies&>(to) =
+        static_cast<const typename Drivers::Anomalies&>(from)), ...);
+  }
+
+  // Serialize anomaly detector statistics of all enabled drivers ("NAME":{...})
+  void writeDetectorJSON(JsonWriter& json) const {
+    (writeDriverDetectors<Drivers>(slot<Drivers>(), json), ...);
+  }
+
+  // Serialize per-sensor raw values of all enabled drivers as array elements
+  void writeRawJSON(JsonWriter& json) const {
+    (writeDriverRawJSON(get<Drivers>(), json), ...);
+  }
+
+  // Serialize current sampling interval of all enabled drivers ("NAME":ms)
+  void writeIntervalJSON(JsonWriter& json) const {
+    (writeDriverInterval<Drivers>(slot<Drivers>(), json), ...);
+  }
+
+  // Access a driver by type
+  template <typename Driver>
+  inline Driver& get() {
+    return std::get<SensorSlot<Driver>>(m_slots).driver;
+  }
+
+  template <typename Driver>
+  inline const Driver& get() const {
+    return std::get<SensorSlot<Driver>>(m_slots).driver;
+  }
+
+private:
+  std::tuple<SensorSlot<Drivers>...> m_slots;
+
+  template <typename Driver>
+  inline SensorSlot<Driver>& slot() {
+    return std::get<SensorSlot<Driver>>(m_slots);
+  }
+
+  template <typename Driver>
+  inline const SensorSlot<Driver>& slot() const {
+    return std::get<SensorSlot<Driver>>(m_slots);
+  }
+
+  template <typename Driver>
+  static bool beginDriver(Driver& driver, uint32_t currentTime) {
+    if constexpr (Driver::ENABLED) {
+      if (driver.begin()) {
+        markOnline(driver.state());
+        return true;
+      }
+      scheduleRetry(driver.state(), currentTime);
+      return false;
+    } else {
+      #if DEBUG_SERIAL_ENABLED
+      Serial.printf("[I2C] %s sensor disabled\n", Driver::NAME);
+      #endif
+      return true;
+    }
+  }
+
+  template <typename Driver>
+  static uint32_t startDriver(Driver& driver, uint32_t currentTime) {
+    if constexpr (Driver::ENABLED) {
+      BusState& state = driver.state();
+
+      // Recover offline sensor in place once its backoff has expired
+      if (isRetryDue(state, currentTime)) {
+        #if DEBUG_SERIAL_ENABLED
+        Serial.printf("[I2C] Recovering %s...\n", Driver::NAME);
+        #endif
+
+        if (driver.recover()) {
+          markOnline(state);
+          state.recoveryCount++;
+          eventLog.log(EventCode::SENSOR_RECOVERED, driverIndex<Driver, Drivers...>(), state.recoveryCount);
+        } else {
+          scheduleRetry(state, currentTime);
+          eventLog.log(EventCode::SENSOR_RECOVERY_FAILED, driverIndex<Driver, Drivers...>(),
+                       retryDelaySeconds(state, currentTime));
+        }
+      }
+
+      state.measurementPending = state.online && driver.start();
+      return state.measurementPending ? driver.getConversionTime() : 0;
+    } else {
+      return 0;
+    }
+  }
+
+  template <typename Driver>
+  static void collectDriver(Driver& driver, Data& data, uint32_t currentTime) {
+    typename Driver::Channels& channels = data;
+
+    if constexpr (Driver::ENABLED) {
+      BusState& state = driver.state();
+
+      if (state.measurementPending && driver.collect(channels)) {
+        state.measurementPending = false;
+        markOnline(state);
+        return;
+      }
+
+      state.measurementPending = false;
+      if (state.online) {
+        recordFailure(state, currentTime);
+
+        if (!state.online) {
+          eventLog.log(EventCode::SENSOR_OFFLINE, driverIndex<Driver, Drivers...>(), state.failureCount);
+        }
+      }
+    }
+
+    Driver::clear(channels);
+  }
+
+  template <typename Driver>
+  static void detectDriver(SensorSlot<Driver>& slot, Data& data, uint32_t currentTime) {
+    if constexpr (Driver::ENABLED) {
+      slot.detectors.check(data, data, currentTime);
+    }
+  }
+
+  template <typename Driver>
+  static uint32_t startAdaptive(SensorSlot<Driver>& slot, uint32_t currentTime) {
+    if constexpr (Driver::ENABLED) {
+      slot.due = slot.interval.isDue(currentTime);
+      if (slot.due) {
+        return startDriver(slot.driver, currentTime);
+      }
+    }
+    return 0;
+  }
+
+  template <typename Driver>
+  static bool collectAdaptive(SensorSlot<Driver>& slot, Data& sample, Data& published,
+                              uint32_t currentTime) {
+    typename Driver::Channels& sampleChannels = sample;
+    typename Driver::Channels& publishedChannels = published;
+
+    if constexpr (Driver::ENABLED) {
+      if (!slot.due) {
+        return false;
+      }
+
+      const typename Driver::Channels previous = sampleChannels;
+      collectDriver(slot.driver, sample, currentTime);
+      detectDriver(slot, sample, currentTime);
+      slot.interval.update(Driver::change(previous, sampleChannels), currentTime);
+
+      // Publish on change event or heartbeat
+      if (Driver::change(publishedChannels, sampleChannels) >= 1.0f ||
+          currentTime - slot.lastPublishTime >= ADAPTIVE_MAX_INTERVAL_MS) {
+        publishedChannels = sampleChannels;
+        static_cast<typename Driver::Anomalies&>(published) =
+          static_cast<const typename Driver::Anomalies&>(sample);
+        slot.lastPublishTime = currentTime;
+        return true;
+      }
+      return false;
+    } else {
+      Driver::clear(publishedChannels);
+      return false;
+    }
+  }
+
+  template <typename Driver>
+  static uint32_t earlierDue(const SensorSlot<Driver>& slot, uint32_t earliest) {
+    if constexpr (Driver::ENABLED) {
+      if ((int32_t)(slot.interval.getNextTime() - earliest) < 0) {
+        return slot.interval.getNextTime();
+      }
+    }
+    return earliest;
+  }
+
+  template <typename Driver>
+  static void filterDriver(const Data& data, FilterData& filters) {
+    if constexpr (Driver::ENABLED) {
+      static_cast<typename Driver::Filters&>(filters).push(data);
+    }
+  }
+
+  template <typename Driver>
+  static void decimateDriver(FilterData& filters, Data& data) {
+    if constexpr (Driver::ENABLED) {
+      static_cast<typename Driver::Filters&>(filters).decimate(data);
+    } else {
+      Driver::clear(data);
+    }
+  }
+
+  template <typename Driver>
+  static bool validateDriver(const Data& data) {
+    if constexpr (Driver::ENABLED) {
+      return Driver::validate(data) &&
+             static_cast<const typename Driver::Anomalies&>(data).any() == ANOMALY_NONE;
+    } else {
+      return true;
+    }
+  }
+
+  template <typename Driver>
+  static void writeDriverJSON(const Data& data, JsonWriter& json) {
+    if constexpr (Driver::ENABLED) {
+      Driver::writeJSON(data, json);
+    }
+  }
+
+  template <typename Driver>
+  static void writeDriverLine(const Data& data, LineWriter& line) {
+    if constexpr (Driver::ENABLED) {
+      Driver::writeLine(data, line);
+    }
+  }
+
+  template <typename Driver>
+  static ChannelField findDriverChannel(const char* name) {
+    if constexpr (Driver::ENABLED) {
+      return Driver::findChannel(name);  // Member of a base converts to member of ChannelData
+    } else {
+      return nullptr;
+    }
+  }
+
+  template <typename Driver>
+  static void writeDriverAnomalyJSON(const Data& data, JsonWriter& json) {
+    if constexpr (Driver::ENABLED) {
+      Driver::writeAnomalyJSON(data, json);
+    }
+  }
+
+  template <typename Driver>
+  static void writeDriverDetectors(const SensorSlot<Driver>& slot, JsonWriter& json) {
+    if constexpr (Driver::ENABLED) {
+      json.beginObject(Driver::NAME);
+      slot.detectors.writeJSON(json);
+      json.endObject();
+    }
+  }
+
+  template <typename Driver>
+  static void writeDriverRawJSON(const Driver& driver, JsonWriter& json) {
+    if constexpr (Driver::ENABLED) {
+      driver.writeRawJSON(json);
+    }
+  }
+
+  template <typename Driver>
+  static void writeDriverInterval(const SensorSlot<Driver>& slot, JsonWriter& json) {
+    if constexpr (Driver::ENABLED) {
+      json.addUInt(Driver::NAME, slot.interval.getInterval());
+    }
+  }
+};
+
+#endif // SENSOR_SET_H
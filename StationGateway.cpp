@@ -0,0 +1,380 @@
+/*
+ * Station Gateway Implementation
+ */
+
+#include "StationGateway.h"
+#include <WiFi.h>
+#include <lwip/sockets.h>
+#include <errno.h>
+
+static_assert(StationGateway::PEER_COUNT > 0, "Gateway mode needs at least one peer in GATEWAY_PEERS");
+static_assert(GATEWAY_MAX_CONCURRENT > 0, "At least one concurrent poll");
+static_assert(GATEWAY_RESPONSE_SIZE > GATEWAY_PEER_BODY_SIZE + 128, "Response buffer must hold headers and body");
+
+// Constructor
+StationGateway::StationGateway()
+  : m_peers{},
+    m_slots{},
+    m_local{},
+    m_localSequence(0),
+    m_localUpdatedAt(0),
+    m_localLock(portMUX_INITIALIZER_UNLOCKED),
+    m_lengths{},
+    m_front(0),
+    m_swapLock(nullptr),
+    m_task(nullptr),
+    m_cycles(0),
+    m_lastCycleMs(0) {
+}
+
+// Parse "a.b.c.d[:port]" peer entries and start polling
+void StationGateway::begin() {
+  for (uint8_t i = 0; i < PEER_COUNT; i++) {
+    char host[16] = {};
+    const char* colon = strchr(GATEWAY_PEERS[i], ':');
+    const size_t hostLength = colon ? (size_t)(colon - GATEWAY_PEERS[i]) : strlen(GATEWAY_PEERS[i]);
+    if (hostLength < sizeof(host)) {
+      memcpy(host, GATEWAY_PEERS[i], hostLength);
+    }
+
+    m_peers[i].port = colon ? atoi(colon + 1) : 80;
+    if (inet_pton(AF_INET, host, &m_peers[i].address) != 1) {
+      // Always show configuration errors (host names are not resolved)
+      Serial.printf("[ERROR] Gateway peer '%s' is not an IPv4 address\n", GATEWAY_PEERS[i]);
+      m_peers[i].address = 0;
+    }
+  }
+
+  for (Slot& slot : m_slots) {
+    slot.peer = -1;
+    slot.fd = -1;
+  }
+
+  m_swapLock = xSemaphoreCreateMutex();
+  render();
+
+  if (xTaskCreatePinnedToCore(taskEntry, "gateway", GATEWAY_TASK_STACK_SIZE, this, 1, &m_task, 0) != pdPASS) {
+    // Always show configuration errors
+    Serial.println("[ERROR] Gateway task could not be started");
+    m_task = nullptr;
+  }
+}
+
+// Copy own readings for the next render
+void StationGateway::updateLocal(const SensorData& data, uint32_t sequence) {
+  portENTER_CRITICAL(&m_localLock);
+  m_local = data;
+  m_localSequence = sequence;
+  m_localUpdatedAt = millis();
+  portEXIT_CRITICAL(&m_localLock);
+
+  if (m_task) {
+    xTaskNotifyGive(m_task);
+  }
+}
+
+// Send front buffer - the lock keeps render() from swapping it mid-send
+void StationGateway::serve(const Sender& send) {
+  xSemaphoreTake(m_swapLock, portMAX_DELAY);
+  send(m_documents[m_front], m_lengths[m_front]);
+  xSemaphoreGive(m_swapLock);
+}
+
+// Short name of a peer status
+const char* StationGateway::getStatusName(PeerStatus status) {
+  switch (status) {
+    case PeerStatus::PENDING:
+      return "pending";
+    case PeerStatus::OK:
+      return "ok";
+    case PeerStatus::TIMEOUT:
+      return "timeout";
+    case PeerStatus::CONNECT_ERROR:
+      return "connect_error";
+    case PeerStatus::HTTP_ERROR:
+      return "http_error";
+    case PeerStatus::BAD_RESPONSE:
+      return "bad_response";
+    default:
+      return "unknown";
+  }
+}
+
+// FreeRTOS entry point
+void StationGateway::taskEntry(void* parameter) {
+  static_cast<StationGateway*>(parameter)->run();
+}
+
+// Poll cycle every GATEWAY_POLL_INTERVAL_MS, re-render on local publish in between
+void StationGateway::run() {
+  for (;;) {
+    const uint32_t cycleStart = millis();
+
+    if (WiFi.status() == WL_CONNECTED) {
+      pollPeers();
+      m_lastCycleMs = millis() - cycleStart;
+      m_cycles++;
+    }
+    render();
+
+    const uint32_t nextCycle = cycleStart + GATEWAY_POLL_INTERVAL_MS;
+    for (int32_t wait; (wait = (int32_t)(nextCycle - millis())) > 0;) {
+      if (ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait))) {
+        render();
+      }
+    }
+  }
+}
+
+// Fan out to all peers, at most GATEWAY_MAX_CONCURRENT sockets at a time
+// (lwIP has a small fixed socket pool shared with the web server)
+void StationGateway::pollPeers() {
+  uint8_t nextPeer = 0;
+
+  for (;;) {
+    uint32_t now = millis();
+    uint8_t active = 0;
+
+    for (Slot& slot : m_slots) {
+      if (slot.peer < 0 && nextPeer < PEER_COUNT) {
+        startPoll(slot, nextPeer++, now);
+      }
+      active += slot.peer >= 0;
+    }
+
+    if (active == 0) {
+      return;
+    }
+
+    // Wait for any socket to become ready, at most until the nearest deadline
+    fd_set readSet, writeSet;
+    FD_ZERO(&readSet);
+    FD_ZERO(&writeSet);
+    int maxFd = -1;
+    uint32_t waitMs = GATEWAY_PEER_TIMEOUT_MS;
+
+    for (const Slot& slot : m_slots) {
+      if (slot.peer < 0) {
+        continue;
+      }
+      FD_SET(slot.fd, slot.requestSent ? &readSet : &writeSet);
+      maxFd = max(maxFd, slot.fd);
+
+      const uint32_t elapsed = now - slot.startedAt;
+      waitMs = min(waitMs, elapsed < GATEWAY_PEER_TIMEOUT_MS ? GATEWAY_PEER_TIMEOUT_MS - elapsed : 0);
+    }
+
+    timeval timeout = {(time_t)(waitMs / 1000), (suseconds_t)((waitMs % 1000) * 1000)};
+    select(maxFd + 1, &readSet, &writeSet, nullptr, &timeout);
+
+    now = millis();
+    for (Slot& slot : m_slots) {
+      if (slot.peer >= 0) {
+        servicePoll(slot, FD_ISSET(slot.fd, &writeSet), FD_ISSET(slot.fd, &readSet), now);
+      }
+    }
+  }
+}
+
+// Non-blocking connect (completion is reported as writable by select())
+void StationGateway::startPoll(Slot& slot, uint8_t peerIndex, uint32_t now) {
+  Peer& peer = m_peers[peerIndex];
+  peer.polls++;
+
+  slot.peer = peerIndex;
+  slot.requestSent = false;
+  slot.startedAt = now;
+  slot.rxLength = 0;
+  slot.fd = peer.address ? socket(AF_INET, SOCK_STREAM, IPPROTO_TCP) : -1;
+
+  if (slot.fd < 0) {
+    finishPoll(slot, PeerStatus::CONNECT_ERROR, now);
+    return;
+  }
+
+  fcntl(slot.fd, F_SETFL, fcntl(slot.fd, F_GETFL, 0) | O_NONBLOCK);
+
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(peer.port);
+  address.sin_addr.s_addr = peer.address;
+
+  if (connect(slot.fd, (const sockaddr*)&address, sizeof(address)) < 0 && errno != EINPROGRESS) {
+    finishPoll(slot, PeerStatus::CONNECT_ERROR, now);
+  }
+}
+
+// Request once connected, then collect the response until complete or closed
+void StationGateway::servicePoll(Slot& slot, bool writable, bool readable, uint32_t now) {
+  if (!slot.requestSent && writable) {
+    int error = 0;
+    socklen_t errorLength = sizeof(error);
+    getsockopt(slot.fd, SOL_SOCKET, SO_ERROR, &error, &errorLength);
+    if (error) {
+      finishPoll(slot, PeerStatus::CONNECT_ERROR, now);
+      return;
+    }
+
+    // Fits into the empty socket buffer - sent in one call
+    char request[96];
+    const int length = snprintf(request, sizeof(request),
+                                "GET /api/v1/sensors HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n",
+                                GATEWAY_PEERS[slot.peer]);
+    if (send(slot.fd, request, length, 0) != length) {
+      finishPoll(slot, PeerStatus::CONNECT_ERROR, now);
+      return;
+    }
+    slot.requestSent = true;
+  } else if (slot.requestSent && readable) {
+    const int count = recv(slot.fd, slot.rx + slot.rxLength, sizeof(slot.rx) - 1 - slot.rxLength, 0);
+
+    if (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+      finishPoll(slot, PeerStatus::CONNECT_ERROR, now);
+      return;
+    }
+
+    if (count > 0) {
+      slot.rxLength += count;
+    }
+    slot.rx[slot.rxLength] = '\0';
+
+    const PeerStatus status = parseResponse(slot, count == 0);
+    if (status != PeerStatus::PENDING) {
+      finishPoll(slot, status, now);
+      return;
+    }
+  }
+
+  if (now - slot.startedAt >= GATEWAY_PEER_TIMEOUT_MS) {
+    finishPoll(slot, PeerStatus::TIMEOUT, now);
+  }
+}
+
+// Free slot and update peer statistics
+void StationGateway::finishPoll(Slot& slot, PeerStatus status, uint32_t now) {
+  Peer& peer = m_peers[slot.peer];
+
+  if (slot.fd >= 0) {
+    close(slot.fd);
+  }
+  slot.fd = -1;
+  slot.peer = -1;
+
+  peer.status = status;
+  const uint32_t elapsed = now - slot.startedAt;
+  peer.latencyMs = elapsed > UINT16_MAX ? UINT16_MAX : elapsed;
+
+  if (status == PeerStatus::OK) {
+    peer.lastOkAt = now;
+    peer.failures = 0;
+  } else if (peer.failures < UINT16_MAX) {
+    peer.failures++;
+  }
+}
+
+// Complete when Content-Length bytes of body arrived (or the peer closed)
+PeerStatus StationGateway::parseResponse(Slot& slot, bool closed) {
+  const char* headerEnd = strstr(slot.rx, "\r\n\r\n");
+  if (!headerEnd) {
+    return closed || slot.rxLength >= sizeof(slot.rx) - 1 ? PeerStatus::BAD_RESPONSE : PeerStatus::PENDING;
+  }
+
+  if (strncmp(slot.rx, "HTTP/1.", 7) != 0 || strncmp(slot.rx + 8, " 200", 4) != 0) {
+    return PeerStatus::HTTP_ERROR;
+  }
+
+  const char* body = headerEnd + 4;
+  const size_t received = slot.rx + slot.rxLength - body;
+  const char* lengthHeader = strcasestr(slot.rx, "\r\nContent-Length:");
+  const size_t expected = lengthHeader && lengthHeader < headerEnd ? strtoul(lengthHeader + 17, nullptr, 10) : received;
+
+  if (received < expected) {
+    return closed || slot.rxLength >= sizeof(slot.rx) - 1 ? PeerStatus::BAD_RESPONSE : PeerStatus::PENDING;
+  }
+  if (!lengthHeader && !closed) {
+    return PeerStatus::PENDING;  // No length - body ends when the peer closes
+  }
+
+  // Inserted verbatim into the merged document - must be one JSON object
+  if (expected == 0 || expected >= GATEWAY_PEER_BODY_SIZE || body[0] != '{' || body[expected - 1] != '}') {
+    return PeerStatus::BAD_RESPONSE;
+  }
+
+  Peer& peer = m_peers[slot.peer];
+  memcpy(peer.body, body, expected);
+  peer.body[expected] = '\0';
+  peer.bodyLength = expected;
+  return PeerStatus::OK;
+}
+
+// Render merged document and publish it by swapping buffers
+void StationGateway::render() {
+  const uint8_t back = m_front ^ 1;
+  const uint32_t now = millis();
+
+  SensorData local;
+  portENTER_CRITICAL(&m_localLock);
+  local = m_local;
+  const uint32_t localSequence = m_localSequence;
+  const uint32_t localUpdatedAt = m_localUpdatedAt;
+  portEXIT_CRITICAL(&m_localLock);
+
+  uint8_t online = 0;
+  for (const Peer& peer : m_peers) {
+    online += peer.status == PeerStatus::OK;
+  }
+
+  JsonWriter json(m_documents[back], RENDER_SIZE);
+  json.beginObject();
+
+  json.beginObject("gateway");
+  json.addUInt("uptime", now / 1000);
+  json.addUInt("cycles", m_cycles);
+  json.addUInt("cycleMs", m_lastCycleMs);
+  json.addUInt("peers", PEER_COUNT);
+  json.addUInt("online", online);
+  json.endObject();
+
+  json.beginArray("stations");
+
+  // Own readings first
+  json.beginObject();
+  json.addString("name", GATEWAY_STATION_NAME);
+  json.addBool("ok", localSequence > 0);
+  json.addUInt("ageMs", now - localUpdatedAt);
+  json.beginObject("data");
+  SensorRegistry::writeJSON(local, json);
+  json.addBool("valid", local.isValid);
+  json.addUInt("seq", localSequence);
+  json.endObject();
+  json.endObject();
+
+  // Peers with their last good response (kept while a peer is failing)
+  for (uint8_t i = 0; i < PEER_COUNT; i++) {
+    const Peer& peer = m_peers[i];
+
+    json.beginObject();
+    json.addString("name", GATEWAY_PEERS[i]);
+    json.addBool("ok", peer.status == PeerStatus::OK);
+    json.addString("status", getStatusName(peer.status));
+    json.addUInt("latencyMs", peer.latencyMs);
+    json.addUInt("failures", peer.failures);
+    if (peer.bodyLength) {
+      json.addUInt("ageMs", now - peer.lastOkAt);
+      json.addRaw("data", peer.body);
+    } else {
+      json.addNull("ageMs");
+      json.addNull("data");
+    }
+    json.endObject();
+  }
+
+  json.endArray();
+  json.endObject();
+
+  m_lengths[back] = json.length();
+
+  xSemaphoreTake(m_swapLock, portMAX_DELAY);
+  m_front = back;
+  xSemaphoreGive(m_swapLock);
+}
@@ -0,0 +1,126 @@
+/*
+ * Station Gateway for ESP32 Weather Station
+ * Optional role in which this station polls the /api/v1/sensors endpoint of
+ * peer stations and serves them, together with its own readings, as one
+ * merged /api/v1/stations document. Peers are polled concurrently from a
+ * separate task with non-blocking sockets and a deadline per peer, so a slow
+ * or dead peer only costs its own timeout. The merged document is rendered
+ * once per poll cycle (and on local publish) into a double buffer, so
+ * requests are served by copying bytes to the socket.
+ */
+
+#ifndef STATION_GATEWAY_H
+#define STATION_GATEWAY_H
+
+#include <Arduino.h>
+#include <functional>
+#include <iterator>
+#include "Config.h"
+#include "SensorManager.h"
+#include "JsonWriter.h"
+
+// Result of the last poll of a peer
+enum class PeerStatus : uint8_t {
+  PENDING = 0,    // Not polled yet
+  OK,
+  TIMEOUT,        // No complete response before GATEWAY_PEER_TIMEOUT_MS
+  CONNECT_ERROR,  // Refused / unreachable
+  HTTP_ERROR,     // Non-200 status
+  BAD_RESPONSE    // Malformed or larger than GATEWAY_PEER_BODY_SIZE
+};
+
+class StationGateway {
+public:
+  // Number of configured peers (GATEWAY_PEERS in Config.h)
+  static constexpr uint8_t PEER_COUNT = std::size(GATEWAY_PEERS);
+
+  // Worst-case merged document: cached bodies plus per-station metadata
+  static constexpr size_t RENDER_SIZE = (PEER_COUNT + 1) * (GATEWAY_PEER_BODY_SIZE + 192) + 128;
+
+  // Sends a pre-rendered JSON body to the current client
+  using Sender = std::function<void(const char* body, size_t length)>;
+
+  // Constructor
+  StationGateway();
+
+  // Parse peer addresses and start the polling task (call from setup())
+  void begin();
+
+  // Snapshot own published readings (loop task, triggers a re-render)
+  void updateLocal(const SensorData& data, uint32_t sequence);
+
+  // Send the current merged document (web server handler)
+  void serve(const Sender& send);
+
+  // Short name of a peer status
+  static const char* getStatusName(PeerStatus status);
+
+private:
+  // Peer address and cached latest reading
+  struct Peer {
+    uint32_t address;   // IPv4, network byte order (0 = invalid entry)
+    uint16_t port;
+    PeerStatus status;
+    uint32_t lastOkAt;        // millis() of last good response
+    uint16_t latencyMs;       // Connect to complete response, last poll
+    uint16_t failures;        // Consecutive failed polls
+    uint32_t polls;
+    uint16_t bodyLength;      // 0 = nothing cached yet
+    char body[GATEWAY_PEER_BODY_SIZE];
+  };
+
+  // Connection in progress (at most GATEWAY_MAX_CONCURRENT)
+  struct Slot {
+    int8_t peer;        // -1 = free
+    int fd;
+    bool requestSent;
+    uint32_t startedAt;
+    uint16_t rxLength;
+    char rx[GATEWAY_RESPONSE_SIZE];
+  };
+
+  Peer m_peers[PEER_COUNT];
+  Slot m_slots[GATEWAY_MAX_CONCURRENT];
+
+  // Own readings (written by loop task under m_localLock)
+  SensorData m_local;
+  uint32_t m_localSequence;
+  uint32_t m_localUpdatedAt;
+  portMUX_TYPE m_localLock;
+
+  // Double-buffered merged document - m_front is being served,
+  // the other one is rendered into and swapped in under m_swapLock
+  char m_documents[2][RENDER_SIZE];
+  size_t m_lengths[2];
+  uint8_t m_front;
+  SemaphoreHandle_t m_swapLock;
+
+  // Polling task and last cycle statistics
+  TaskHandle_t m_task;
+  uint32_t m_cycles;
+  uint32_t m_lastCycleMs;
+
+  // Task body
+  static void taskEntry(void* parameter);
+  void run();
+
+  // Poll every peer once (returns when all finished or timed out)
+  void pollPeers();
+
+  // Open non-blocking connection to peer in slot
+  void startPoll(Slot& slot, uint8_t peerIndex, uint32_t now);
+
+  // Advance slot after select() (send request / receive response)
+  void servicePoll(Slot& slot, bool writable, bool readable, uint32_t now);
+
+  // Close slot and record the outcome for its peer
+  void finishPoll(Slot& slot, PeerStatus status, uint32_t now);
+
+  // Validate response in slot and move body into the peer cache
+  PeerStatus parseResponse(Slot& slot, bool closed);
+
+  // Render merged document into the back buffer and swap it in
+  void render();
+};
+
+#endif // STATION_GATEWAY_H
@@ -0,0 +1,323 @@
+/*
+ * SNTP Time Keeping Implementation
+ */
+
+#include "TimeSync.h"
+#include <WiFi.h>
+#include <esp_timer.h>
+#include <lwip/sockets.h>
+#include <lwip/netdb.h>
+#include "EventLog.h"
+
+TimeSync timeSync;
+
+constexpr size_t NTP_PACKET_SIZE = 48;
+constexpr uint8_t NTP_CLIENT_REQUEST = 0x23;          // LI 0, version 4, mode 3 (client)
+constexpr uint32_t NTP_UNIX_OFFSET = 2208988800UL;    // Seconds from 1900 to 1970
+constexpr int64_t DRIFT_MIN_SPAN_US = 60000000LL;     // Shorter spans give noisy drift estimates
+constexpr int64_t DRIFT_MAX_CHANGE_PPB = 20000;       // Larger changes are server offset changes, not the crystal
+constexpr uint8_t DRIFT_MAX_OUTLIERS = 3;             // Consecutive outliers restart the estimate
+
+// Big-endian 32-bit field
+static uint32_t readBE32(const uint8_t* data) {
+  return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | data[3];
+}
+
+// NTP timestamp (32.32 fixed point since 1900) to µs since 1970
+// Seconds below 2^31 belong to era 1 (after 2036-02-07)
+static int64_t ntpToUnixUs(const uint8_t* data) {
+  int64_t seconds = readBE32(data);
+  if (seconds < 0x80000000LL) {
+    seconds += 0x100000000LL;
+  }
+  const uint64_t fraction = readBE32(data + 4);
+  return (seconds - NTP_UNIX_OFFSET) * 1000000LL + (int64_t)((fraction * 1000000ULL) >> 32);
+}
+
+// Journal a step in units that fit the 16-bit arguments: seconds and ms
+// remainder (same sign), beyond 9.1 h minutes and the flagged seconds remainder
+static void logStep(int32_t stepMs) {
+  const int32_t seconds = stepMs / 1000;
+  if (seconds >= INT16_MIN && seconds <= INT16_MAX) {
+    eventLog.log(EventCode::TIME_STEPPED, seconds, stepMs % 1000);
+  } else {
+    eventLog.log(EventCode::TIME_STEPPED, seconds / 60, TIME_STEP_MINUTES_FLAG + abs(seconds % 60));
+  }
+}
+
+// Constructor
+TimeSync::TimeSync()
+  : m_synced(false),
+    m_anchorMonotonic(0),
+    m_anchorUtc(0),
+    m_driftPpb(0),
+    m_slewPpb(0),
+    m_sampleMonotonic(0),
+    m_sampleUtc(0),
+    m_driftKnown(false),
+    m_driftOutliers(0),
+    m_syncs(0),
+    m_failures(0),
+    m_steps(0),
+    m_lastStepMs(0),
+    m_lastErrorUs(0),
+    m_lastRttUs(0),
+    m_stratum(0),
+    m_lock(portMUX_INITIALIZER_UNLOCKED),
+    m_task(nullptr) {
+}
+
+// Start the sync task
+void TimeSync::begin() {
+  // Core 0 (with the WiFi stack) - loop() keeps core 1 for sampling and HTTP
+  if (xTaskCreatePinnedToCore(taskEntry, "timesync", TIME_SYNC_TASK_STACK_SIZE, this, 1, &m_task, 0) != pdPASS) {
+    // Always show configuration errors
+    Serial.println("[ERROR] Time sync task could not be started");
+    m_task = nullptr;
+  }
+}
+
+// FreeRTOS entry point
+void TimeSync::taskEntry(void* parameter) {
+  static_cast<TimeSync*>(parameter)->run();
+}
+
+// Resync every TIME_SYNC_INTERVAL_MS, retry sooner after failures
+void TimeSync::run() {
+  for (;;) {
+    uint32_t wait = TIME_SYNC_RETRY_MS;
+    if (WiFi.status() == WL_CONNECTED && sync()) {
+      wait = TIME_SYNC_INTERVAL_MS;
+    }
+    vTaskDelay(pdMS_TO_TICKS(wait));
+  }
+}
+
+// One SNTP exchange. The server time is taken at the midpoint of the
+// round trip: utc = (T2 + T3) / 2 at monotonic (T1 + T4) / 2
+bool TimeSync::sync() {
+  addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_DGRAM;
+  addrinfo* address = nullptr;
+  char port[6];
+  snprintf(port, sizeof(port), "%u", TIME_NTP_PORT);
+
+  // Resolved on every sync - pool names rotate between servers
+  if (getaddrinfo(TIME_NTP_SERVER, port, &hints, &address) != 0 || !address) {
+    m_failures++;
+    return false;
+  }
+
+  const int fd = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (fd < 0) {
+    freeaddrinfo(address);
+    m_failures++;
+    return false;
+  }
+
+  // Our send time as transmit timestamp - the server echoes it as originate
+  // timestamp, which matches the reply to this request
+  uint8_t request[NTP_PACKET_SIZE] = {};
+  request[0] = NTP_CLIENT_REQUEST;
+  const int64_t sent = esp_timer_get_time();
+  for (uint8_t i = 0; i < 8; i++) {
+    request[40 + i] = (uint64_t)sent >> (56 - 8 * i);
+  }
+
+  const bool requested = sendto(fd, request, sizeof(request), 0, address->ai_addr, address->ai_addrlen) ==
+                         (int)sizeof(request);
+  freeaddrinfo(address);
+
+  uint8_t reply[NTP_PACKET_SIZE];
+  int64_t received = 0;
+  bool answered = false;
+
+  while (requested && !answered) {
+    const int64_t remaining = sent + TIME_SYNC_TIMEOUT_MS * 1000LL - esp_timer_get_time();
+    if (remaining <= 0) {
+      break;
+    }
+
+    fd_set readSet;
+    FD_ZERO(&readSet);
+    FD_SET(fd, &readSet);
+    timeval timeout = { (time_t)(remaining / 1000000), (suseconds_t)(remaining % 1000000) };
+    if (select(fd + 1, &readSet, nullptr, nullptr, &timeout) <= 0) {
+      break;
+    }
+
+    const int length = recv(fd, reply, sizeof(reply), 0);
+    received = esp_timer_get_time();
+
+    // Server mode, synchronized (stratum 1-15, no alarm), answer to our request
+    const uint8_t stratum = reply[1];
+    answered = length == (int)NTP_PACKET_SIZE && (reply[0] & 0x07) == 4 && (reply[0] >> 6) != 3 &&
+               stratum >= 1 && stratum <= 15 && memcmp(reply + 24, request + 40, 8) == 0;
+  }
+  close(fd);
+
+  if (!answered) {
+    m_failures++;
+    return false;
+  }
+
+  const int64_t serverReceive = ntpToUnixUs(reply + 32);
+  const int64_t serverTransmit = ntpToUnixUs(reply + 40);
+  const int64_t roundTrip = (received - sent) - (serverTransmit - serverReceive);
+
+  portENTER_CRITICAL(&m_lock);
+  const bool first = !m_synced;
+  const uint32_t steps = m_steps;
+  applySample((sent + received) / 2, (serverReceive + serverTransmit) / 2);
+  m_lastRttUs = roundTrip > 0 ? roundTrip : 0;
+  m_stratum = reply[1];
+  const bool stepped = m_steps != steps;
+  portEXIT_CRITICAL(&m_lock);
+
+  // Journal outside the critical section
+  if (first) {
+    eventLog.log(EventCode::TIME_SYNCED, m_stratum, m_lastRttUs / 1000);
+  } else if (stepped) {
+    logStep(m_lastStepMs);
+  }
+
+  #if DEBUG_SERIAL_ENABLED
+  Serial.printf("[Time] Synced: error %ld us, drift %ld ppb, rtt %lu us\n",
+                (long)m_lastErrorUs, (long)m_driftPpb, (unsigned long)m_lastRttUs);
+  #endif
+
+  return true;
+}
+
+// Update drift from the span since the last sample, then re-anchor where the
+// current mapping is (continuous) and slew the error out over one interval
+void TimeSync::applySample(int64_t monotonicUs, int64_t utcUs) {
+  m_syncs++;
+
+  if (!m_synced) {
+    m_anchorMonotonic = monotonicUs;
+    m_anchorUtc = utcUs;
+    m_sampleMonotonic = monotonicUs;
+    m_sampleUtc = utcUs;
+    m_synced = true;
+    return;
+  }
+
+  const int64_t mapped = mapUtc(monotonicUs);
+  const int64_t error = utcUs - mapped;
+  m_lastErrorUs = constrain(error, (int64_t)INT32_MIN, (int64_t)INT32_MAX);
+
+  if (error > TIME_STEP_THRESHOLD_MS * 1000LL || error < -(TIME_STEP_THRESHOLD_MS * 1000LL)) {
+    // Too far off to slew (server change, long outage) - jump, restart drift measurement
+    m_anchorMonotonic = monotonicUs;
+    m_anchorUtc = utcUs;
+    m_slewPpb = 0;
+    m_sampleMonotonic = monotonicUs;
+    m_sampleUtc = utcUs;
+    m_steps++;
+    // Rounded, so a step just short of a whole second is not journaled as x.999 s
+    const int64_t stepMs = (error + (error < 0 ? -500 : 500)) / 1000;
+    m_lastStepMs = constrain(stepMs, (int64_t)INT32_MIN, (int64_t)INT32_MAX);
+    return;
+  }
+
+  // Oscillator drift from two raw server samples (independent of the slew)
+  const int64_t span = monotonicUs - m_sampleMonotonic;
+  if (span >= DRIFT_MIN_SPAN_US) {
+    const int64_t measured = ((utcUs - m_sampleUtc) - span) * 1000000000LL / span;
+    const bool plausible = measured >= -(int64_t)TIME_MAX_DRIFT_PPM * 1000 &&
+                           measured <= (int64_t)TIME_MAX_DRIFT_PPM * 1000;
+    const int64_t change = measured - m_driftPpb;
+
+    if (plausible && (!m_driftKnown || (change >= -DRIFT_MAX_CHANGE_PPB && change <= DRIFT_MAX_CHANGE_PPB))) {
+      // First estimate taken as is, later ones averaged (halves NTP jitter)
+      m_driftPpb = m_driftKnown ? (m_driftPpb + (int32_t)measured) / 2 : (int32_t)measured;
+      m_driftKnown = true;
+      m_driftOutliers = 0;
+    } else if (plausible && ++m_driftOutliers >= DRIFT_MAX_OUTLIERS) {
+      // Persistent disagreement - the old estimate was wrong, measure anew
+      m_driftKnown = false;
+      m_driftOutliers = 0;
+    }
+    m_sampleMonotonic = monotonicUs;
+    m_sampleUtc = utcUs;
+  }
+
+  m_anchorMonotonic = monotonicUs;
+  m_anchorUtc = mapped;
+  const int64_t slew = error * 1000000000LL / (TIME_SYNC_INTERVAL_MS * 1000LL);
+  m_slewPpb = constrain(slew, -(int64_t)TIME_MAX_SLEW_PPM * 1000, (int64_t)TIME_MAX_SLEW_PPM * 1000);
+}
+
+// Piecewise linear mapping (slew only applies for one sync interval)
+int64_t TimeSync::mapUtc(int64_t monotonicUs) const {
+  const int64_t elapsed = monotonicUs - m_anchorMonotonic;
+  const int64_t slewed = min<int64_t>(max<int64_t>(elapsed, 0), TIME_SYNC_INTERVAL_MS * 1000LL);
+  return m_anchorUtc + elapsed + elapsed * m_driftPpb / 1000000000LL + slewed * m_slewPpb / 1000000000LL;
+}
+
+// True after the first valid reply
+bool TimeSync::isSynced() const {
+  portENTER_CRITICAL(&m_lock);
+  const bool synced = m_synced;
+  portEXIT_CRITICAL(&m_lock);
+  return synced;
+}
+
+// Map monotonic µs to UTC µs
+bool TimeSync::toUtcUs(int64_t monotonicUs, int64_t& utcUs) const {
+  portENTER_CRITICAL(&m_lock);
+  const bool synced = m_synced;
+  if (synced) {
+    utcUs = mapUtc(monotonicUs);
+  }
+  portEXIT_CRITICAL(&m_lock);
+  return synced;
+}
+
+// millis() is esp_timer_get_time() / 1000 truncated to 32 bits - widen the
+// timestamp against the current time, then map it
+bool TimeSync::toUtcMs(uint32_t timestamp, uint64_t& utcMs) const {
+  const int64_t nowMs = esp_timer_get_time() / 1000;
+  const int64_t timestampMs = nowMs - (int32_t)((uint32_t)nowMs - timestamp);
+
+  int64_t utcUs;
+  if (!toUtcUs(timestampMs * 1000, utcUs)) {
+    return false;
+  }
+  utcMs = utcUs / 1000;
+  return true;
+}
+
+// Serialize mapping state
+void TimeSync::writeJSON(JsonWriter& json) const {
+  uint64_t nowMs = 0;
+  const bool synced = toUtcMs(millis(), nowMs);
+
+  portENTER_CRITICAL(&m_lock);
+  const int32_t driftPpb = m_driftPpb;
+  const int32_t slewPpb = m_slewPpb;
+  const int32_t lastErrorUs = m_lastErrorUs;
+  const uint32_t lastRttUs = m_lastRttUs;
+  const uint32_t syncs = m_syncs;
+  const uint32_t steps = m_steps;
+  const uint8_t stratum = m_stratum;
+  portEXIT_CRITICAL(&m_lock);
+
+  json.addBool("synced", synced);
+  if (synced) {
+    json.addUInt64("utcMs", nowMs);
+  } else {
+    json.addNull("utcMs");
+  }
+  json.addString("server", TIME_NTP_SERVER);
+  json.addUInt("stratum", stratum);
+  json.addFloat("driftPpm", driftPpb / 1000.0f, 3);
+  json.addFloat("slewPpm", slewPpb / 1000.0f, 3);
+  json.addFloat("lastErrorMs", lastErrorUs / 1000.0f, 3);
+  json.addFloat("rttMs", lastRttUs / 1000.0f, 3);
+  json.addUInt("syncs", syncs);
+  json.addUInt("failures", m_failures);
+  json.addUInt("steps", steps);
+}
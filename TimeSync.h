@@ -0,0 +1,90 @@
+/*
+ * SNTP Time Keeping for ESP32 Weather Station
+ * A task on core 0 queries TIME_NTP_SERVER every TIME_SYNC_INTERVAL_MS and
+ * keeps a mapping from the monotonic clock (esp_timer, which millis() is
+ * derived from) to UTC. The mapping stays continuous across resyncs: the
+ * oscillator drift measured between syncs is corrected, the remaining error
+ * is slewed out over the next interval, and only errors beyond
+ * TIME_STEP_THRESHOLD_MS step the clock.
+ *
+ * Samples keep their millis() acquisition time and are converted on output,
+ * so readings taken before the first sync get their UTC time as well.
+ */
+
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <Arduino.h>
+#include "Config.h"
+#include "JsonWriter.h"
+
+// time_stepped journals seconds + ms remainder; beyond the 16-bit argument
+// (9.1 h) minutes, with arg1 = this flag + the seconds remainder
+constexpr int16_t TIME_STEP_MINUTES_FLAG = 1000;
+
+class TimeSync {
+public:
+  // Constructor
+  TimeSync();
+
+  // Start the sync task (call from setup())
+  void begin();
+
+  // Query the server once and update the mapping (blocks up to
+  // TIME_SYNC_TIMEOUT_MS - sync task only). Returns true on a valid reply
+  bool sync();
+
+  // A server answered at least once since boot
+  bool isSynced() const;
+
+  // UTC of a monotonic time (µs since boot, esp_timer_get_time())
+  // Returns false before the first sync
+  bool toUtcUs(int64_t monotonicUs, int64_t& utcUs) const;
+
+  // UTC milliseconds of a millis() timestamp (within 24 days of now)
+  bool toUtcMs(uint32_t timestamp, uint64_t& utcMs) const;
+
+  // Serialize mapping and sync statistics
+  void writeJSON(JsonWriter& json) const;
+
+private:
+  // Mapping: utc = anchorUtc + elapsed + elapsed * drift + min(elapsed, slewSpan) * slew
+  // (elapsed = monotonic - anchorMonotonic, rates in parts per billion)
+  bool m_synced;
+  int64_t m_anchorMonotonic;
+  int64_t m_anchorUtc;
+  int32_t m_driftPpb;
+  int32_t m_slewPpb;
+
+  // Last accepted server sample (base of the next drift measurement)
+  int64_t m_sampleMonotonic;
+  int64_t m_sampleUtc;
+  bool m_driftKnown;
+  uint8_t m_driftOutliers;    // Consecutive measurements far from m_driftPpb
+
+  // Statistics
+  uint32_t m_syncs;
+  uint32_t m_failures;
+  uint32_t m_steps;
+  int32_t m_lastStepMs;
+  int32_t m_lastErrorUs;      // Server time minus mapped time at the last sync
+  uint32_t m_lastRttUs;
+  uint8_t m_stratum;
+
+  mutable portMUX_TYPE m_lock;
+  TaskHandle_t m_task;
+
+  // Task body
+  static void taskEntry(void* parameter);
+  void run();
+
+  // Fold a server sample (UTC at a monotonic time) into the mapping
+  void applySample(int64_t monotonicUs, int64_t utcUs);
+
+  // Mapping without locking
+  int64_t mapUtc(int64_t monotonicUs) const;
+};
+
+extern TimeSync timeSync;
+
+#endif // TIME_SYNC_H
@@ -0,0 +1,146 @@
+/*
+ * Timer Wheel Implementation
+ */
+
+#include "TimerWheel.h"
+
+constexpr uint32_t WHEEL_SPAN_MS = SCHEDULER_WHEEL_SLOTS * SCHEDULER_TICK_MS;
+
+// Constructor
+TimerWheel::TimerWheel(uint32_t start)
+  : m_currentTick(0),
+    m_tickTime(start) {
+  for (uint32_t i = 0; i < SCHEDULER_WHEEL_SLOTS; i++) {
+    m_slots[i] = nullptr;
+  }
+}
+
+// Link job into the slot of its deadline tick
+void TimerWheel::schedule(TimerJob& job, uint32_t deadline) {
+  cancel(job);
+
+  // Overdue deadlines go into the current slot so the next pass picks them up
+  job.slot = slotOf(tickOf(deadline));
+  TimerJob*& head = m_slots[job.slot];
+  job.deadline = deadline;
+  job.prev = nullptr;
+  job.next = head;
+  if (head) {
+    head->prev = &job;
+  }
+  head = &job;
+  job.scheduled = true;
+}
+
+// Unlink job from its slot
+void TimerWheel::cancel(TimerJob& job) {
+  if (!job.scheduled) {
+    return;
+  }
+
+  if (job.prev) {
+    job.prev->next = job.next;
+  } else {
+    m_slots[job.slot] = job.next;
+  }
+  if (job.next) {
+    job.next->prev = job.prev;
+  }
+
+  job.prev = nullptr;
+  job.next = nullptr;
+  job.scheduled = false;
+}
+
+// Run due jobs of one slot
+// Due jobs are unlinked before any callback runs, so callbacks may freely
+// re-arm or cancel jobs (a job re-armed by an earlier callback is skipped)
+uint8_t TimerWheel::expireSlot(uint32_t slot, uint32_t now) {
+  TimerJob* due[SCHEDULER_MAX_JOBS];
+  uint8_t total = 0;
+  uint8_t count;
+
+  do {
+    count = 0;
+    for (TimerJob* job = m_slots[slot]; job && count < SCHEDULER_MAX_JOBS; job = job->next) {
+      if ((int32_t)(now - job->deadline) >= 0) {
+        due[count++] = job;
+      }
+    }
+    for (uint8_t i = 0; i < count; i++) {
+      cancel(*due[i]);
+    }
+
+    for (uint8_t i = 0; i < count; i++) {
+      TimerJob& job = *due[i];
+      if (job.scheduled) {
+        continue;
+      }
+
+      const uint32_t lateness = now - job.deadline;
+      if (lateness > job.maxLateness) {
+        job.maxLateness = lateness;
+      }
+      job.runs++;
+      total++;
+
+      job.callback(now);
+
+      // Periodic job not re-armed by its callback - keep phase, skip missed runs
+      if (job.period > 0 && !job.scheduled) {
+        uint32_t deadline = job.deadline + job.period;
+        if ((int32_t)(now - deadline) >= 0) {
+          deadline = now + job.period;
+        }
+        schedule(job, deadline);
+      }
+    }
+  } while (count == SCHEDULER_MAX_JOBS);
+
+  return total;
+}
+
+// Expire all slots between the last pass and now
+uint8_t TimerWheel::advance(uint32_t now) {
+  const uint32_t elapsed = tickOf(now) - m_currentTick;
+
+  // After a long stall every slot is visited once
+  const uint32_t visits = elapsed < SCHEDULER_WHEEL_SLOTS ? elapsed + 1 : SCHEDULER_WHEEL_SLOTS;
+
+  // Move to the new tick first, so jobs re-armed by callbacks are placed
+  // relative to it. The current tick stays open - jobs later in it are not due yet
+  m_currentTick += elapsed;
+  m_tickTime += elapsed * SCHEDULER_TICK_MS;
+
+  uint8_t count = 0;
+  for (uint32_t i = 0; i < visits; i++) {
+    count += expireSlot(slotOf(m_currentTick - (visits - 1) + i), now);
+  }
+
+  return count;
+}
+
+// Scan ahead for the first slot holding a job due within this revolution
+uint32_t TimerWheel::timeUntilNext(uint32_t now) const {
+  uint32_t earliest = WHEEL_SPAN_MS;
+
+  for (uint32_t i = 0; i < SCHEDULER_WHEEL_SLOTS; i++) {
+    for (const TimerJob* job = m_slots[slotOf(m_currentTick + i)]; job; job = job->next) {
+      const int32_t remaining = (int32_t)(job->deadline - now);
+      if (remaining <= 0) {
+        return 0;
+      }
+      if ((uint32_t)remaining < earliest) {
+        earliest = remaining;
+      }
+    }
+
+    // Slots are visited in deadline order - later slots cannot be sooner
+    const int32_t nextSlotStart = (int32_t)(m_tickTime + (i + 1) * SCHEDULER_TICK_MS - now);
+    if ((int32_t)earliest <= nextSlotStart) {
+      break;
+    }
+  }
+
+  return earliest;
+}
@@ -0,0 +1,82 @@
+/*
+ * Timer Wheel for ESP32 Weather Station
+ * Hashed timing wheel: jobs are linked into slot (deadline / tick) % slots.
+ * Insert and cancel are O(1); each expiry pass only visits the slots of the
+ * elapsed ticks. Jobs more than one revolution ahead stay in their slot and
+ * are skipped until their deadline comes around. Pure logic (no Arduino
+ * dependencies), time is passed in by the caller.
+ */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include "Config.h"
+
+static_assert((SCHEDULER_WHEEL_SLOTS & (SCHEDULER_WHEEL_SLOTS - 1)) == 0,
+              "SCHEDULER_WHEEL_SLOTS must be a power of two");
+
+// Job callback - runs in the caller of TimerWheel::advance()
+using TimerCallback = void (*)(uint32_t now);
+
+// Statically allocated job (intrusive list node)
+struct TimerJob {
+  const char* name;
+  TimerCallback callback;
+  uint32_t period;       // Re-armed with this period after running (0 = one-shot)
+  uint32_t deadline;     // Absolute time (ms)
+  TimerJob* prev;
+  TimerJob* next;
+  uint16_t slot;         // Wheel slot the job is linked into
+  bool scheduled;
+
+  // Statistics
+  uint32_t runs;
+  uint32_t maxLateness;  // Worst delay between deadline and run (ms)
+
+  TimerJob(const char* name, TimerCallback callback, uint32_t period = 0)
+    : name(name), callback(callback), period(period), deadline(0),
+      prev(nullptr), next(nullptr), slot(0), scheduled(false), runs(0), maxLateness(0) {
+  }
+};
+
+class TimerWheel {
+public:
+  // Constructor - start is the current time (ms)
+  explicit TimerWheel(uint32_t start = 0);
+
+  // Arm job for an absolute deadline (re-arms if already scheduled)
+  void schedule(TimerJob& job, uint32_t deadline);
+
+  // Disarm job (no-op if not scheduled)
+  void cancel(TimerJob& job);
+
+  // Run every job whose deadline is <= now, returns number of jobs run
+  // Periodic jobs not re-armed by their callback are re-armed with their period
+  uint8_t advance(uint32_t now);
+
+  // Milliseconds until the earliest deadline (0 = job due)
+  // Capped at one wheel revolution when no job is due sooner
+  uint32_t timeUntilNext(uint32_t now) const;
+
+private:
+  TimerJob* m_slots[SCHEDULER_WHEEL_SLOTS];
+  uint32_t m_currentTick;  // Oldest tick not fully expired yet (free-running)
+  uint32_t m_tickTime;     // Time (ms) at which m_currentTick started
+
+  // Tick a deadline falls into (overdue deadlines map to the current tick)
+  // Relative arithmetic keeps this correct across millis() wrap
+  inline uint32_t tickOf(uint32_t time) const {
+    const int32_t offset = (int32_t)(time - m_tickTime);
+    return offset < 0 ? m_currentTick : m_currentTick + offset / SCHEDULER_TICK_MS;
+  }
+
+  inline static uint32_t slotOf(uint32_t tick) {
+    return tick & (SCHEDULER_WHEEL_SLOTS - 1);
+  }
+
+  // Run due jobs of one slot
+  uint8_t expireSlot(uint32_t slot, uint32_t now);
+};
+
+#endif // TIMER_WHEEL_H
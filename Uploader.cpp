@@ -0,0 +1,362 @@
+/*
+ * Batched Uploader Implementation
+ */
+
+#include "Uploader.h"
+#include "EventLog.h"
+#include "TimeSync.h"
+
+// Request body of the upload task (one batch at a time)
+static char s_batchBuffer[UPLOAD_BUFFER_SIZE];
+
+// Days since 1970-01-01 of a civil date (proleptic Gregorian)
+static int32_t daysFromCivil(int32_t year, int32_t month, int32_t day) {
+  year -= month <= 2;
+  const int32_t era = (year >= 0 ? year : year - 399) / 400;
+  const int32_t yearOfEra = year - era * 400;
+  const int32_t dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  const int32_t dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+  return era * 146097 + dayOfEra - 719468;
+}
+
+// Parse IMF-fixdate ("Sun, 19 Oct 2026 12:00:00 GMT") into epoch seconds
+static bool parseHttpDate(const char* text, uint32_t& epoch) {
+  static const char MONTHS[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+  char month[4];
+  int day, year, hour, minute, second;
+
+  if (sscanf(text, "%*3s, %d %3s %d %d:%d:%d", &day, month, &year, &hour, &minute, &second) != 6) {
+    return false;
+  }
+
+  const char* found = strstr(MONTHS, month);
+  if (!found || strlen(month) != 3 || year < 2020) {
+    return false;
+  }
+
+  const int32_t days = daysFromCivil(year, (found - MONTHS) / 3 + 1, day);
+  epoch = (uint32_t)days * 86400UL + hour * 3600UL + minute * 60UL + second;
+  return true;
+}
+
+// Constructor
+Uploader::Uploader()
+  : m_head(0),
+    m_tail(0),
+    m_lock(portMUX_INITIALIZER_UNLOCKED),
+    m_task(nullptr),
+    m_pingUrl{},
+    m_authorization{},
+    m_clockSynced(false),
+    m_syncEpoch(0),
+    m_syncMillis(0),
+    m_nextAttempt(0),
+    m_retryDelay(UPLOAD_RETRY_MIN_MS),
+    m_failing(false),
+    m_sent(0),
+    m_batches(0),
+    m_dropped(0),
+    m_rejected(0),
+    m_failures(0),
+    m_lastStatus(0),
+    m_lastPostMs(0) {
+}
+
+// Prepare request constants and start the upload task
+void Uploader::begin() {
+  // InfluxDB answers GET /ping on the write URL's origin (used for the first clock sync)
+  const char* scheme = strstr(UPLOAD_URL, "://");
+  const char* path = scheme ? strchr(scheme + 3, '/') : nullptr;
+  const int originLength = path ? path - UPLOAD_URL : strlen(UPLOAD_URL);
+  snprintf(m_pingUrl, sizeof(m_pingUrl), "%.*s/ping", originLength, UPLOAD_URL);
+
+  if (UPLOAD_TOKEN[0]) {
+    snprintf(m_authorization, sizeof(m_authorization), "Token %s", UPLOAD_TOKEN);
+  }
+
+  // Core 0 (with the WiFi stack) - loop() keeps core 1 for sampling and HTTP
+  if (xTaskCreatePinnedToCore(taskEntry, "uploader", UPLOAD_TASK_STACK_SIZE, this, 1, &m_task, 0) != pdPASS) {
+    // Always show configuration errors
+    Serial.println("[ERROR] Upload task could not be started");
+    m_task = nullptr;
+  }
+}
+
+// Copy sample into the backlog, dropping the oldest when full
+void Uploader::enqueue(const SensorData& data, uint32_t sequence, uint32_t timestamp) {
+  portENTER_CRITICAL(&m_lock);
+  if (m_tail - m_head >= UPLOAD_BACKLOG_SIZE) {
+    m_head++;
+    m_dropped++;
+  }
+  Record& record = m_backlog[m_tail % UPLOAD_BACKLOG_SIZE];
+  record.data = data;
+  record.sequence = sequence;
+  record.timestamp = timestamp;
+  m_tail++;
+  portEXIT_CRITICAL(&m_lock);
+
+  if (m_task) {
+    xTaskNotifyGive(m_task);
+  }
+}
+
+// Samples in backlog
+uint16_t Uploader::getQueued() const {
+  portENTER_CRITICAL(&m_lock);
+  const uint32_t queued = m_tail - m_head;
+  portEXIT_CRITICAL(&m_lock);
+  return queued;
+}
+
+// Serialize uploader state
+void Uploader::writeJSON(JsonWriter& json) const {
+  const uint32_t now = millis();
+
+  json.addBool("online", hasClock() && !m_failing);
+  json.addBool("clockSynced", hasClock());
+  json.addUInt("queued", getQueued());
+  json.addUInt("capacity", UPLOAD_BACKLOG_SIZE);
+  json.addUInt("sent", m_sent);
+  json.addUInt("batches", m_batches);
+  json.addUInt("dropped", m_dropped);
+  json.addUInt("rejected", m_rejected);
+  json.addUInt("failures", m_failures);
+  json.addInt("lastStatus", m_lastStatus);
+  json.addUInt("lastPostMs", m_lastPostMs);
+  json.addUInt("retryInMs", (int32_t)(m_nextAttempt - now) > 0 ? m_nextAttempt - now : 0);
+  if (hasClock()) {
+    json.addUInt("epoch", toEpoch(now));
+  } else {
+    json.addNull("epoch");
+  }
+}
+
+// FreeRTOS entry point
+void Uploader::taskEntry(void* parameter) {
+  static_cast<Uploader*>(parameter)->run();
+}
+
+// Sleep until a batch is due (or a sample arrives), then try to send it
+void Uploader::run() {
+  m_http.setReuse(true);
+  m_http.setTimeout(UPLOAD_TIMEOUT_MS);
+
+  static const char* HEADER_KEYS[] = {"Date"};
+  m_http.collectHeaders(HEADER_KEYS, 1);
+
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(getWaitTime(millis())));
+
+    const uint32_t now = millis();
+    if (getWaitTime(now) > 0) {
+      continue;  // Woken by a sample, batch not due yet
+    }
+
+    if (WiFi.status() != WL_CONNECTED) {
+      m_nextAttempt = now + UPLOAD_RETRY_MIN_MS;
+      continue;
+    }
+
+    attempt(now);
+  }
+}
+
+// Batch is due when full or when its oldest sample waited the flush interval,
+// but never before the retry / drain pacing allows
+uint32_t Uploader::getWaitTime(uint32_t now) const {
+  Record oldest;
+  const uint32_t queued = getQueued();
+
+  if (queued == 0 || !peek(m_head, oldest)) {
+    return UPLOAD_FLUSH_INTERVAL_MS;
+  }
+
+  uint32_t due = queued >= UPLOAD_BATCH_SIZE ? now : oldest.timestamp + UPLOAD_FLUSH_INTERVAL_MS;
+  if ((int32_t)(m_nextAttempt - due) > 0) {
+    due = m_nextAttempt;
+  }
+
+  return (int32_t)(due - now) > 0 ? due - now : 0;
+}
+
+// Send one batch and schedule the next attempt
+void Uploader::attempt(uint32_t now) {
+  int status;
+  uint16_t count = 0;
+  uint32_t first = 0;
+
+  if (!hasClock()) {
+    // Samples need absolute time - nothing is sent before SNTP or a Date header sets the clock
+    status = request(m_pingUrl, nullptr, 0);
+    m_lastStatus = constrain(status, INT16_MIN, INT16_MAX);
+    if (m_clockSynced) {
+      return;  // First batch goes out on the next wake-up
+    }
+  } else {
+    const size_t length = buildBatch(first, count);
+    if (count == 0) {
+      return;
+    }
+    status = request(UPLOAD_URL, s_batchBuffer, length);
+    m_lastStatus = constrain(status, INT16_MIN, INT16_MAX);
+  }
+
+  const bool delivered = count > 0 && status >= 200 && status < 300;
+
+  // Client errors other than timeout / throttling will never succeed - drop the batch
+  const bool rejected = count > 0 && status >= 400 && status < 500 && status != 408 && status != 429;
+
+  if (delivered || rejected) {
+    commit(first, count);
+
+    if (delivered) {
+      m_sent += count;
+      m_batches++;
+    } else {
+      m_rejected += count;
+      Serial.printf("[ERROR] Upload rejected with HTTP %d - %u samples dropped\n", status, count);
+    }
+
+    if (m_failing) {
+      m_failing = false;
+      eventLog.log(EventCode::UPLOAD_RESUMED, getQueued());
+    }
+
+    // Drain rate limit - a backlog goes out one batch per interval
+    m_retryDelay = UPLOAD_RETRY_MIN_MS;
+    m_nextAttempt = now + UPLOAD_DRAIN_INTERVAL_MS;
+    return;
+  }
+
+  // Backend unreachable or failing - reconnect with exponential backoff
+  m_failures++;
+  m_client.stop();
+
+  if (!m_failing) {
+    m_failing = true;
+    eventLog.log(EventCode::UPLOAD_FAILED, status, getQueued());
+  }
+
+  #if DEBUG_SERIAL_ENABLED
+  Serial.printf("[UPLOAD] Failed (%d), retry in %lu ms\n", status, (unsigned long)m_retryDelay);
+  #endif
+
+  m_nextAttempt = now + m_retryDelay;
+  m_retryDelay = min(m_retryDelay * 2, UPLOAD_RETRY_MAX_MS);
+}
+
+// Format oldest queued samples as line protocol
+size_t Uploader::buildBatch(uint32_t& first, uint16_t& count) {
+  static char series[64];
+  if (!series[0]) {
+    snprintf(series, sizeof(series), "%s,station=%s", UPLOAD_MEASUREMENT, UPLOAD_STATION);
+  }
+
+  LineWriter line(s_batchBuffer, sizeof(s_batchBuffer));
+
+  portENTER_CRITICAL(&m_lock);
+  first = m_head;
+  const uint32_t queued = m_tail - m_head;
+  portEXIT_CRITICAL(&m_lock);
+
+  count = 0;
+  while (count < queued && count < UPLOAD_BATCH_SIZE) {
+    Record record;
+    if (!peek(first + count, record)) {
+      break;  // Dropped by enqueue while formatting
+    }
+
+    const size_t mark = line.length();
+    line.beginLine(series);
+    SensorRegistry::writeLine(record.data, line);
+    line.addInt("seq", record.sequence);
+    line.addBool("valid", record.data.isValid);
+    line.endLine(toEpoch(record.timestamp));
+
+    if (line.overflowed()) {
+      line.rewind(mark);  // Rest goes into the next batch
+      break;
+    }
+    count++;
+  }
+
+  return line.length();
+}
+
+// Advance head past delivered samples
+void Uploader::commit(uint32_t first, uint16_t count) {
+  portENTER_CRITICAL(&m_lock);
+  if ((int32_t)(first + count - m_head) > 0) {
+    m_head = first + count;
+  }
+  portEXIT_CRITICAL(&m_lock);
+}
+
+// Copy sample if it is still queued
+bool Uploader::peek(uint32_t index, Record& record) const {
+  portENTER_CRITICAL(&m_lock);
+  const bool queued = index - m_head < m_tail - m_head;
+  if (queued) {
+    record = m_backlog[index % UPLOAD_BACKLOG_SIZE];
+  }
+  portEXIT_CRITICAL(&m_lock);
+  return queued;
+}
+
+// One request on the kept-alive connection
+int Uploader::request(const char* url, const char* body, size_t length) {
+  const uint32_t start = millis();
+
+  if (!m_http.begin(m_client, url)) {
+    return HTTPC_ERROR_CONNECTION_REFUSED;
+  }
+
+  if (m_authorization[0]) {
+    m_http.addHeader("Authorization", m_authorization);
+  }
+
+  int status;
+  if (body) {
+    m_http.addHeader("Content-Type", "text/plain; charset=utf-8");
+    status = m_http.POST((uint8_t*)body, length);
+  } else {
+    status = m_http.GET();
+  }
+
+  // Every answer re-anchors the epoch mapping, so millis() drift never accumulates
+  uint32_t epoch;
+  if (status > 0 && parseHttpDate(m_http.header("Date").c_str(), epoch)) {
+    m_syncEpoch = epoch;
+    m_syncMillis = millis();
+    m_clockSynced = true;
+  }
+
+  // Keeps the connection open when the server allows keep-alive
+  m_http.end();
+
+  const uint32_t elapsed = millis() - start;
+  m_lastPostMs = elapsed > UINT16_MAX ? UINT16_MAX : elapsed;
+  return status;
+}
+
+// SNTP fix or at least one Date header
+bool Uploader::hasClock() const {
+  #if TIME_SYNC_ENABLED
+  if (timeSync.isSynced()) {
+    return true;
+  }
+  #endif
+  return m_clockSynced;
+}
+
+// SNTP mapping (drift corrected) first, Date header mapping as fallback
+uint32_t Uploader::toEpoch(uint32_t timestamp) const {
+  #if TIME_SYNC_ENABLED
+  uint64_t utcMs;
+  if (timeSync.toUtcMs(timestamp, utcMs)) {
+    return utcMs / 1000;
+  }
+  #endif
+  return m_syncEpoch + (int32_t)(timestamp - m_syncMillis) / 1000;
+}
@@ -0,0 +1,112 @@
+/*
+ * Batched Uploader for ESP32 Weather Station
+ * Pushes published readings to a time-series backend (InfluxDB line protocol)
+ * from its own FreeRTOS task over a kept-alive HTTP connection. loop() only
+ * copies a record into a bounded RAM backlog (oldest dropped when full), so
+ * network stalls and outages never delay sampling. The backlog is drained
+ * in batches at a limited rate once the backend answers again.
+ *
+ * Sample timestamps are mapped to epoch seconds by TimeSync (SNTP) when it
+ * has a fix, otherwise from the Date header of the backend's responses
+ */
+
+#ifndef UPLOADER_H
+#define UPLOADER_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include "Config.h"
+#include "SensorManager.h"
+#include "JsonWriter.h"
+#include "LineWriter.h"
+
+class Uploader {
+public:
+  // Constructor
+  Uploader();
+
+  // Start the upload task (call from setup())
+  void begin();
+
+  // Queue published readings (loop task, O(1), never blocks on the network)
+  void enqueue(const SensorData& data, uint32_t sequence, uint32_t timestamp);
+
+  // Samples waiting to be sent
+  uint16_t getQueued() const;
+
+  // Serialize backlog, delivery and clock state
+  void writeJSON(JsonWriter& json) const;
+
+private:
+  // Queued sample (published data + when it was taken)
+  struct Record {
+    SensorData data;
+    uint32_t sequence;
+    uint32_t timestamp;  // millis()
+  };
+
+  // Backlog ring - m_head/m_tail are running counters (index = counter % size)
+  Record m_backlog[UPLOAD_BACKLOG_SIZE];
+  uint32_t m_head;
+  uint32_t m_tail;
+  mutable portMUX_TYPE m_lock;
+
+  // Upload task and its connection (touched by the upload task only)
+  TaskHandle_t m_task;
+  WiFiClient m_client;
+  HTTPClient m_http;
+  char m_pingUrl[96];
+  char m_authorization[128];
+
+  // Epoch mapping from the last Date header (seconds at millis())
+  bool m_clockSynced;
+  uint32_t m_syncEpoch;
+  uint32_t m_syncMillis;
+
+  // Retry / drain pacing
+  uint32_t m_nextAttempt;
+  uint32_t m_retryDelay;
+  bool m_failing;
+
+  // Statistics
+  uint32_t m_sent;
+  uint32_t m_batches;
+  uint32_t m_dropped;
+  uint32_t m_rejected;
+  uint32_t m_failures;
+  int16_t m_lastStatus;
+  uint16_t m_lastPostMs;
+
+  // Task body
+  static void taskEntry(void* parameter);
+  void run();
+
+  // Milliseconds until the next batch is due
+  uint32_t getWaitTime(uint32_t now) const;
+
+  // Send one batch (sync clock first if needed) and pace the next attempt
+  void attempt(uint32_t now);
+
+  // Format up to UPLOAD_BATCH_SIZE queued samples starting at the oldest
+  // Returns body length, first/count identify the formatted samples
+  size_t buildBatch(uint32_t& first, uint16_t& count);
+
+  // Remove samples after delivery (skips ones already dropped by enqueue)
+  void commit(uint32_t first, uint16_t count);
+
+  // Copy queued sample under lock - false if it was dropped meanwhile
+  bool peek(uint32_t index, Record& record) const;
+
+  // GET (body == nullptr) or POST to url, updates clock from Date header
+  // Returns HTTP status or negative HTTPClient error
+  int request(const char* url, const char* body, size_t length);
+
+  // Either clock source has a fix
+  bool hasClock() const;
+
+  // Epoch seconds of a millis() timestamp
+  uint32_t toEpoch(uint32_t timestamp) const;
+};
+
+#endif // UPLOADER_H
@@ -0,0 +1,40 @@
+/*
+ * Varint Encoding for ESP32 Weather Station
+ * Unsigned LEB128: 7 bits per byte, least significant group first, high bit
+ * set on every byte but the last. Deltas below 128 take one byte, a full
+ * 32-bit value five. Used by the I2C trace and the binary chart format.
+ */
+
+#ifndef VARINT_H
+#define VARINT_H
+
+#include <Arduino.h>
+
+constexpr uint8_t VARINT_MAX_SIZE = 5;  // uint32_t
+
+// Encode value into out (at least VARINT_MAX_SIZE bytes), returns bytes written
+inline size_t writeVarint(uint8_t* out, uint32_t value) {
+  size_t size = 0;
+  do {
+    const uint8_t bits = value & 0x7F;
+    value >>= 7;
+    out[size++] = bits | (value ? 0x80 : 0);
+  } while (value);
+  return size;
+}
+
+// Decode value at data[offset] and advance offset
+// Returns false if the encoding runs past length or exceeds 32 bits
+inline bool readVarint(const uint8_t* data, size_t length, size_t& offset, uint32_t& value) {
+  value = 0;
+  for (uint8_t shift = 0; offset < length && shift < 7 * VARINT_MAX_SIZE; shift += 7) {
+    const uint8_t bits = data[offset++];
+    value |= (uint32_t)(bits & 0x7F) << shift;
+    if (!(bits & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+#endif // VARINT_H
@@ -3,12 +3,15 @@
 
 #include <Arduino.h>
 
-const char HTML_DASHBOARD[] PROGMEM = R"rawliteral(<!DOCTYPE html>
+// constexpr (not just const) so WEB_CONTENT_VERSION can hash the assets at compile time
+constexpr char HTML_DASHBOARD[] PROGMEM = R"rawliteral(<!DOCTYPE html>
 <html lang="en">
 <head>
   <meta charset="UTF-8">
   <meta name="viewport" content="width=device-width, initial-scale=1.0">
+  <meta name="theme-color" content="#0f3460">
   <title>ESP32 Weather Station</title>
+  <link rel="manifest" href="/manifest.json">
   <style>
     * { margin: 0; padding: 0; box-sizing: border-box; }
     body {
@@ -65,6 +68,10 @@ const char HTML_DASHBOARD[] PROGMEM = R"rawliteral(<!DOCTYPE html>
       color: white;
       box-shadow: 0 4px 20px rgba(255, 65, 108, 0.4);
     }
+    .status.offline {
+      background: linear-gradient(135deg, #f59e0b 0%, #d97706 100%);
+      box-shadow: 0 4px 20px rgba(245, 158, 11, 0.4);
+    }
     .sensor-grid {
       display: grid;
       grid-template-columns: repeat(auto-fit, minmax(160px, 1fr));
@@ -233,6 +240,31 @@ const char HTML_DASHBOARD[] PROGMEM = R"rawliteral(<!DOCTYPE html>
       font-weight: bold;
       text-shadow: 0 0 8px rgba(100, 255, 218, 0.4);
     }
+    .chart-controls {
+      display: flex;
+      flex-wrap: wrap;
+      gap: 10px;
+      align-items: center;
+      margin-bottom: 12px;
+    }
+    .chart-controls select {
+      background: rgba(26, 26, 46, 0.9);
+      color: #64ffda;
+      border: 1px solid rgba(100, 255, 218, 0.35);
+      border-radius: 8px;
+      padding: 6px 10px;
+      font-size: 13px;
+    }
+    .chart-info {
+      color: #8892b0;
+      font-size: 12px;
+      margin-left: auto;
+    }
+    .chart {
+      display: block;
+      width: 100%;
+      height: 220px;
+    }
     .footer {
       text-align: center;
       margin-top: 30px;
@@ -311,6 +343,10 @@ const char HTML_DASHBOARD[] PROGMEM = R"rawliteral(<!DOCTYPE html>
         <div class="info-label">Next Update</div>
         <div class="info-value" id="nextUpdate">--s</div>
       </div>
+      <div class="info-card">
+        <div class="info-label">Script Time</div>
+        <div class="info-value" id="perf">-- ms</div>
+      </div>
     </div>
 
     <div class="sensor-grid">
@@ -382,8 +418,27 @@ const char HTML_DASHBOARD[] PROGMEM = R"rawliteral(<!DOCTYPE html>
       </div>
     </div>
 
+    <div class="metrics-section">
+      <h3 class="metrics-title">History</h3>
+      <div class="chart-controls">
+        <select id="chartChannel">
+          <option value="temperature">Temperature (°C)</option>
+          <option value="humidity">Humidity (%)</option>
+          <option value="pressure">Pressure (hPa)</option>
+          <option value="light">Light (lx)</option>
+        </select>
+        <select id="chartRange">
+          <option value="3600000">1 h</option>
+          <option value="21600000" selected>6 h</option>
+          <option value="86400000">24 h</option>
+        </select>
+        <span class="chart-info" id="chartInfo">--</span>
+      </div>
+      <canvas class="chart" id="chart"></canvas>
+    </div>
+
     <div class="footer">
-      Auto-refresh every 5 seconds.<br>
+      Auto-refresh every 5 seconds (paused while the tab is hidden).<br>
       Copyright (c) 2025-2026 Sefinek. Licensed under MIT.
     </div>
   </div>
@@ -403,54 +458,21 @@ const char HTML_DASHBOARD[] PROGMEM = R"rawliteral(<!DOCTYPE html>
       return result.join(' ');
     };
 
-    const calculateDewPoint = (temp, humidity) => {
-      if (temp === undefined || temp === null || isNaN(temp)) return 'N/A';
-      if (!humidity || isNaN(humidity)) return 'N/A';
-      const a = 17.27;
-      const b = 237.7;
-      const alpha = ((a * temp) / (b + temp)) + Math.log(humidity / 100);
-      const dewPoint = (b * alpha) / (a - alpha);
-      return `${dewPoint.toFixed(1)}°C`;
-    };
+    const formatTemperature = value => (value === undefined || value === null) ? 'N/A' : `${value.toFixed(1)}°C`;
 
-    const calculateFeelsLike = (temp, humidity) => {
-      if (temp === undefined || temp === null || isNaN(temp)) return 'N/A';
-      if (!humidity || isNaN(humidity)) return `${temp.toFixed(1)}°C`;
-      if (temp >= 27) {
-        const hi = -8.78469475556 + 1.61139411 * temp + 2.33854883889 * humidity +
-                    -0.14611605 * temp * humidity + -0.012308094 * temp * temp +
-                    -0.0164248277778 * humidity * humidity + 0.002211732 * temp * temp * humidity +
-                    0.00072546 * temp * humidity * humidity + -0.000003582 * temp * temp * humidity * humidity;
-        return `${hi.toFixed(1)}°C`;
-      }
-      if (temp <= 10) {
-        const windChill = temp - 2;
-        return `${windChill.toFixed(1)}°C`;
-      }
-      return `${temp.toFixed(1)}°C`;
-    };
+    const formatAbsoluteHumidity = value => (value === undefined || value === null) ? 'N/A' : `${value.toFixed(1)} g/m³`;
 
-    const calculateAbsoluteHumidity = (temp, humidity) => {
-      if (temp === undefined || temp === null || isNaN(temp)) return 'N/A';
-      if (!humidity || isNaN(humidity)) return 'N/A';
-      const absHumidity = (6.112 * Math.exp((17.67 * temp) / (temp + 243.5)) * humidity * 2.1674) / (273.15 + temp);
-      return `${absHumidity.toFixed(1)} g/m³`;
+    const COMFORT_LABELS = {
+      comfortable: '😊 Comfortable',
+      cold: '🥶 Cold',
+      hot: '🥵 Hot',
+      dry: '🏜️ Dry',
+      humid: '💧 Humid',
+      moderate: '😐 Moderate',
+      ok: '😊 OK'
     };
 
-    const getComfortLevel = (temp, humidity) => {
-      if (temp === undefined || temp === null || isNaN(temp)) return 'N/A';
-      if (!humidity || isNaN(humidity)) {
-        if (temp < 15) return '🥶 Cold';
-        if (temp > 25) return '🥵 Hot';
-        return '😊 OK';
-      }
-      if (temp >= 20 && temp <= 26 && humidity >= 40 && humidity <= 60) return '😊 Comfortable';
-      if (temp < 15) return '🥶 Cold';
-      if (temp > 30) return '🥵 Hot';
-      if (humidity < 30) return '🏜️ Dry';
-      if (humidity > 70) return '💧 Humid';
-      return '😐 Moderate';
-    };
+    const formatComfort = comfort => COMFORT_LABELS[comfort] || 'N/A';
 
     const getAirQuality = humidity => {
       if (!humidity || isNaN(humidity)) return 'N/A';
@@ -460,25 +482,21 @@ const char HTML_DASHBOARD[] PROGMEM = R"rawliteral(<!DOCTYPE html>
       return '~ Fair';
     };
 
-    const getPressureTrend = currentPressure => {
-      const history = JSON.parse(localStorage.getItem('pressureHistory') || '[]');
-      history.push({ p: currentPressure, t: Date.now() });
-      const cutoff = Date.now() - 3 * 60 * 60 * 1000;
-      const filtered = history.filter(h => h.t > cutoff);
-      localStorage.setItem('pressureHistory', JSON.stringify(filtered.slice(-50)));
-      if (filtered.length < 2) return '− Stable';
-      const oldest = filtered[0].p;
-      const diff = currentPressure - oldest;
-      if (diff > 300) return '↗ Rising';
-      if (diff < -300) return '↘ Falling';
-      return '− Stable';
+    const TENDENCY_LABELS = {
+      falling_rapidly: '⇊ Falling fast',
+      falling_quickly: '↓ Falling quickly',
+      falling: '↘ Falling',
+      falling_slowly: '↘ Falling slowly',
+      steady: '− Stable',
+      rising_slowly: '↗ Rising slowly',
+      rising: '↗ Rising',
+      rising_quickly: '↑ Rising quickly',
+      rising_rapidly: '⇈ Rising fast'
     };
 
-    const getForecast = (pressureTrend) => {
-      if (pressureTrend.includes('Rising')) return '☀️ Improving';
-      if (pressureTrend.includes('Falling')) return '🌧️ Worsening';
-      return '− Stable';
-    };
+    const formatPressureTrend = tendency => TENDENCY_LABELS[tendency] || '… Collecting';
+
+    const formatForecast = forecast => forecast || '… Collecting';
 
     let moonPhaseCache = null;
     let moonPhaseCacheDay = -1;
@@ -532,112 +550,386 @@ const char HTML_DASHBOARD[] PROGMEM = R"rawliteral(<!DOCTYPE html>
 
     const getCountdownColor = s => s <= 0 ? colors.red : s <= 2 ? colors.yellow : colors.green;
 
-    const applyColor = (el, c) => {
-      el.style.color = c.c;
-      el.style.textShadow = `0 0 12px ${c.s}`;
+    // ------------------------------------------------------------------------
+    // Update engine: element refs are looked up once, an update only builds
+    // plain view objects, and changed text/class/color is written to the DOM
+    // in one requestAnimationFrame. Polling stops while the tab is hidden.
+    // ------------------------------------------------------------------------
+    const REFRESH_SECONDS = 5;
+
+    const el = {};
+    ['status', 'uptime', 'wifiSignal', 'latency', 'lastUpdate', 'nextUpdate', 'perf',
+     'temp', 'hum', 'press', 'light', 'dewPoint', 'feelsLike', 'absHumidity', 'comfort',
+     'airQuality', 'pressureTrend', 'forecast', 'moonPhase'].forEach(id => {
+      el[id] = document.getElementById(id);
+    });
+
+    // Last value written per element, writes staged for the next frame
+    const written = {};
+    let staged = {};
+    let frameRequested = false;
+
+    // Scripting time of the last data update (ms), applied with its frame
+    let updateScriptTime = null;
+    let averageScriptTime = 0;
+
+    // view = { text, className, color } - missing keys are left untouched
+    const stage = (id, view) => {
+      staged[id] = Object.assign(staged[id] || {}, view);
+      if (!frameRequested) {
+        frameRequested = true;
+        requestAnimationFrame(flush);
+      }
+    };
+
+    const flush = () => {
+      const start = performance.now();
+      frameRequested = false;
+
+      for (const id in staged) {
+        const view = staged[id];
+        const last = written[id] || (written[id] = {});
+        const node = el[id];
+
+        if (view.text !== undefined && view.text !== last.text) {
+          node.textContent = last.text = view.text;
+        }
+        if (view.className !== undefined && view.className !== last.className) {
+          node.className = last.className = view.className;
+        }
+        if (view.color !== undefined && view.color !== last.color) {
+          node.style.color = view.color ? view.color.c : '';
+          node.style.textShadow = view.color ? `0 0 12px ${view.color.s}` : '';
+          last.color = view.color;
+        }
+      }
+      staged = {};
+
+      if (updateScriptTime !== null) {
+        const total = updateScriptTime + performance.now() - start;
+        averageScriptTime = averageScriptTime ? averageScriptTime * 0.9 + total * 0.1 : total;
+        el.perf.textContent = `${total.toFixed(2)} ms (avg ${averageScriptTime.toFixed(2)})`;
+        updateScriptTime = null;
+      }
+    };
+
+    const reading = (value, digits, colorOf) => (value === undefined || value === null)
+      ? { text: 'N/A', color: null }
+      : { text: value.toFixed(digits), color: colorOf(value) };
+
+    // Sensor-derived fields change only with a new publish (seq)
+    let lastSeq = -1;
+
+    const stageReadings = data => {
+      const pressure = (data.pressure === undefined || data.pressure === null) ? null : data.pressure / 100;
+
+      stage('temp', reading(data.temperature, 2, getTempColor));
+      stage('hum', reading(data.humidity, 2, getHumidityColor));
+      stage('press', reading(pressure, 2, getPressureColor));
+      stage('light', reading(data.light, 2, getLightColor));
+
+      stage('dewPoint', { text: formatTemperature(data.dewPoint) });
+      stage('feelsLike', { text: formatTemperature(data.feelsLike) });
+      stage('absHumidity', { text: formatAbsoluteHumidity(data.absHumidity) });
+      stage('comfort', { text: formatComfort(data.comfort) });
+      stage('airQuality', { text: getAirQuality(data.humidity) });
+      stage('pressureTrend', { text: formatPressureTrend(data.pressureTrend) });
+      stage('forecast', { text: formatForecast(data.forecast) });
+    };
+
+    const render = (data, latency) => {
+      const start = performance.now();
+
+      if (data.seq !== lastSeq) {
+        lastSeq = data.seq;
+        stageReadings(data);
+      }
+
+      stage('uptime', { text: formatUptime(data.uptime), color: getUptimeColor(data.uptime) });
+      stage('wifiSignal', { text: `${data.rssi} dBm`, className: `info-value ${getSignalQuality(data.rssi)}` });
+      stage('latency', {
+        text: `${latency} ms`,
+        className: `info-value ${latency < 80 ? 'latency-good' : latency < 180 ? 'latency-medium' : 'latency-bad'}`
+      });
+      stage('lastUpdate', { text: new Date().toLocaleTimeString() });
+      stage('moonPhase', { text: getMoonPhase() });
+      stage('status', { text: '✅ System Online', className: 'status' });
+
+      chart.uptimeMs = data.uptime * 1000;
+      if (Date.now() - chart.fetchedAt >= CHART_REFRESH_MS) {
+        loadChart();
+      }
+
+      updateScriptTime = performance.now() - start;
+    };
+
+    // ------------------------------------------------------------------------
+    // History chart: the device downsamples the window (/api/v1/chart, LTTB)
+    // to about one point per 4 px, the page only draws it on a canvas.
+    // Fetched on control change and once per minute while updates run.
+    // ------------------------------------------------------------------------
+    const CHART_REFRESH_MS = 60000;
+    const CHART_MAX_POINTS = 150;
+    const CHART_SCALE = { pressure: 0.01 };  // Pa -> hPa
+
+    const chart = {
+      canvas: document.getElementById('chart'),
+      channel: document.getElementById('chartChannel'),
+      range: document.getElementById('chartRange'),
+      info: document.getElementById('chartInfo'),
+      fetchedAt: 0,
+      pending: false,
+      uptimeMs: null
+    };
+
+    const drawChart = result => {
+      const { canvas } = chart;
+      const ctx = canvas.getContext('2d');
+      const ratio = window.devicePixelRatio || 1;
+      const width = canvas.clientWidth;
+      const height = canvas.clientHeight;
+
+      if (canvas.width !== Math.round(width * ratio) || canvas.height !== Math.round(height * ratio)) {
+        canvas.width = Math.round(width * ratio);
+        canvas.height = Math.round(height * ratio);
+      }
+      ctx.setTransform(ratio, 0, 0, ratio, 0, 0);
+      ctx.clearRect(0, 0, width, height);
+      ctx.font = '11px sans-serif';
+      ctx.fillStyle = '#8892b0';
+
+      // Points carry [dt, value] - rebuild absolute times from the t0 base
+      const scale = CHART_SCALE[result.channel] || 1;
+      let t = result.t0;
+      const points = result.points.map(([dt, value]) => [t += dt, value]);
+      chart.info.textContent = `${points.length} of ${result.samples} samples`;
+
+      if (points.length < 2) {
+        ctx.fillText('Not enough history yet', 10, height / 2);
+        return;
+      }
+
+      let min = Infinity;
+      let max = -Infinity;
+      for (const point of points) {
+        min = Math.min(min, point[1] * scale);
+        max = Math.max(max, point[1] * scale);
+      }
+      if (max - min < 0.1) {
+        min -= 0.05;
+        max += 0.05;
+      }
+
+      const left = 48;
+      const top = 10;
+      const plotWidth = width - left - 10;
+      const plotHeight = height - top - 20;
+      const span = Math.max(result.to - result.from, 1);
+      const toX = t => left + (t - result.from) / span * plotWidth;
+      const toY = v => top + (max - v) / (max - min) * plotHeight;
+
+      ctx.fillText(max.toFixed(1), 4, top + 4);
+      ctx.fillText(min.toFixed(1), 4, top + plotHeight);
+      ctx.fillText(`-${Math.round(span / 3600000)} h`, left, height - 4);
+      ctx.fillText('now', width - 30, height - 4);
+
+      ctx.strokeStyle = 'rgba(255, 255, 255, 0.1)';
+      ctx.lineWidth = 1;
+      ctx.strokeRect(left, top, plotWidth, plotHeight);
+
+      // Break the line where the device had no valid samples (no spanning of gaps)
+      const maxGap = 3 * result.intervalMs * Math.max(result.samples / points.length, 1);
+      ctx.strokeStyle = '#00d4ff';
+      ctx.lineWidth = 2;
+      ctx.beginPath();
+      points.forEach((point, i) => {
+        const x = toX(point[0]);
+        const y = toY(point[1] * scale);
+        if (i === 0 || point[0] - points[i - 1][0] > maxGap) {
+          ctx.moveTo(x, y);
+        } else {
+          ctx.lineTo(x, y);
+        }
+      });
+      ctx.stroke();
+    };
+
+    const loadChart = () => {
+      if (chart.pending || chart.uptimeMs === null) {
+        return;
+      }
+
+      const to = chart.uptimeMs;
+      const from = Math.max(to - Number(chart.range.value), 0);
+      const points = Math.min(Math.round(chart.canvas.clientWidth / 4), CHART_MAX_POINTS);
+
+      chart.pending = true;
+      chart.fetchedAt = Date.now();
+      fetch(`/api/v1/chart?channel=${chart.channel.value}&from=${from}&to=${to}&points=${points}`)
+        .then(res => res.json())
+        .then(result => requestAnimationFrame(() => drawChart(result)))
+        .catch(() => {
+          chart.info.textContent = 'Chart unavailable';
+        })
+        .finally(() => {
+          chart.pending = false;
+        });
+    };
+
+    chart.channel.addEventListener('change', loadChart);
+    chart.range.addEventListener('change', loadChart);
+
+    // Last-known values kept by the service worker while the station is unreachable
+    const renderCached = (data, cachedAt) => {
+      if (data.seq !== lastSeq) {
+        lastSeq = data.seq;
+        stageReadings(data);
+      }
+      stage('status', {
+        text: `📴 Offline - last values from ${new Date(cachedAt).toLocaleTimeString()}`,
+        className: 'status offline'
+      });
+      stage('latency', { text: '-- ms', className: 'info-value' });
+    };
+
+    const renderError = () => {
+      stage('status', { text: '❌ Connection Error', className: 'status error' });
+      stage('latency', { text: '-- ms', className: 'info-value' });
     };
 
-    let countdown = 5;
+    let countdown = 0;
+    let requestPending = false;
+    let ticker = null;
 
     const updateData = () => {
-      const statusEl = document.getElementById('status');
-      const latencyEl = document.getElementById('latency');
-      const startTime = performance.now();
+      const requestStart = performance.now();
+      requestPending = true;
+      countdown = REFRESH_SECONDS;
 
       fetch('/api/v1/sensors')
         .then(res => {
-          const latency = Math.round(performance.now() - startTime);
-          return res.json().then(data => ({ data, latency }));
+          const latency = Math.round(performance.now() - requestStart);
+          // X-Cached-At: answered by the service worker from its last copy
+          const cachedAt = Number(res.headers.get('X-Cached-At'));
+          return res.json().then(data => cachedAt ? renderCached(data, cachedAt) : render(data, latency));
         })
-        .then(({ data, latency }) => {
-          const temp = data.temperature;
-          const hum = data.humidity;
-          const press = data.pressure;
-          const rssi = data.rssi;
-
-          const tempEl = document.getElementById('temp');
-          const humEl = document.getElementById('hum');
-          const pressEl = document.getElementById('press');
-          const lightEl = document.getElementById('light');
-
-          if (temp !== undefined && temp !== null) {
-            tempEl.textContent = temp.toFixed(2);
-            applyColor(tempEl, getTempColor(temp));
-          } else {
-            tempEl.textContent = 'N/A';
-          }
-
-          if (hum !== undefined && hum !== null) {
-            humEl.textContent = hum.toFixed(2);
-            applyColor(humEl, getHumidityColor(hum));
-          } else {
-            humEl.textContent = 'N/A';
-          }
-
-          if (press !== undefined && press !== null) {
-            const pressHpa = press / 100;
-            pressEl.textContent = pressHpa.toFixed(2);
-            applyColor(pressEl, getPressureColor(pressHpa));
-          } else {
-            pressEl.textContent = 'N/A';
-          }
-
-          if (data.light !== undefined && data.light !== null) {
-            lightEl.textContent = data.light.toFixed(2);
-            applyColor(lightEl, getLightColor(data.light));
-          } else {
-            lightEl.textContent = 'N/A';
-          }
-
-          const uptimeEl = document.getElementById('uptime');
-          uptimeEl.textContent = formatUptime(data.uptime);
-          applyColor(uptimeEl, getUptimeColor(data.uptime));
-
-          const wifiSignalEl = document.getElementById('wifiSignal');
-          wifiSignalEl.textContent = `${rssi} dBm`;
-          wifiSignalEl.className = `info-value ${getSignalQuality(rssi)}`;
-
-          latencyEl.textContent = `${latency} ms`;
-          latencyEl.className = `info-value ${latency < 80 ? 'latency-good' : latency < 180 ? 'latency-medium' : 'latency-bad'}`;
-
-          document.getElementById('lastUpdate').textContent = new Date().toLocaleTimeString();
-
-          const pressureTrend = (press !== undefined && press !== null) ? getPressureTrend(press) : '− N/A';
-          document.getElementById('dewPoint').textContent = calculateDewPoint(temp, hum);
-          document.getElementById('feelsLike').textContent = calculateFeelsLike(temp, hum);
-          document.getElementById('absHumidity').textContent = calculateAbsoluteHumidity(temp, hum);
-          document.getElementById('comfort').textContent = getComfortLevel(temp, hum);
-          document.getElementById('airQuality').textContent = getAirQuality(hum);
-          document.getElementById('pressureTrend').textContent = pressureTrend;
-          document.getElementById('forecast').textContent = getForecast(pressureTrend);
-          document.getElementById('moonPhase').textContent = getMoonPhase();
-
-          countdown = 5;
-
-          statusEl.textContent = '✅ System Online';
-          statusEl.className = 'status';
-        })
-        .catch(() => {
-          statusEl.textContent = '❌ Connection Error';
-          statusEl.className = 'status error';
-          latencyEl.textContent = '-- ms';
-          latencyEl.className = 'info-value';
+        .catch(renderError)
+        .finally(() => {
+          requestPending = false;
         });
     };
 
-    setInterval(() => {
-      countdown--;
-      if (countdown < 0) countdown = 0;
-      const nextUpdateEl = document.getElementById('nextUpdate');
-      nextUpdateEl.textContent = `${countdown}s`;
-      applyColor(nextUpdateEl, getCountdownColor(countdown));
-    }, 1000);
+    // Single 1 s tick drives the countdown and the next request (never overlapping)
+    const tick = () => {
+      if (countdown <= 0 && !requestPending) {
+        updateData();
+      }
+      stage('nextUpdate', { text: `${countdown}s`, color: getCountdownColor(countdown) });
+      countdown = Math.max(countdown - 1, 0);
+    };
+
+    const startUpdates = () => {
+      if (!ticker) {
+        countdown = 0;
+        tick();
+        ticker = setInterval(tick, 1000);
+      }
+    };
+
+    const stopUpdates = () => {
+      clearInterval(ticker);
+      ticker = null;
+    };
+
+    document.addEventListener('visibilitychange', () => document.hidden ? stopUpdates() : startUpdates());
 
-    updateData();
-    setInterval(updateData, 5000);
+    if (!document.hidden) {
+      startUpdates();
+    }
+
+    // Shell caching (secure contexts only - HTTPS proxy or localhost)
+    if ('serviceWorker' in navigator) {
+      navigator.serviceWorker.register('/sw.js').catch(() => {});
+    }
   </script>
 </body>
 </html>
 )rawliteral";
 
+// Service worker, served as /sw.js behind a "const VERSION = '<hash>';" line.
+// A new version makes the browser install it again, which re-caches the
+// shell and drops the old cache - the device only serves / once per version
+constexpr char SERVICE_WORKER_JS[] PROGMEM = R"rawliteral(
+const SHELL_CACHE = `shell-${VERSION}`;
+const DATA_CACHE = 'data';
+const SHELL = ['/', '/manifest.json'];
+const READINGS = '/api/v1/sensors';
+
+self.addEventListener('install', event => {
+  event.waitUntil(caches.open(SHELL_CACHE)
+    .then(cache => cache.addAll(SHELL))
+    .then(() => self.skipWaiting()));
+});
+
+self.addEventListener('activate', event => {
+  event.waitUntil(caches.keys()
+    .then(keys => Promise.all(keys
+      .filter(key => key !== SHELL_CACHE && key !== DATA_CACHE)
+      .map(key => caches.delete(key))))
+    .then(() => self.clients.claim()));
+});
+
+self.addEventListener('fetch', event => {
+  const url = new URL(event.request.url);
+  if (event.request.method !== 'GET' || url.origin !== location.origin) {
+    return;
+  }
+
+  // Shell from the cache, network only if it is missing
+  if (SHELL.includes(url.pathname) && !url.search) {
+    event.respondWith(caches.match(url.pathname).then(cached => cached || fetch(event.request)));
+    return;
+  }
+
+  // Readings from the network; the last good answer is kept (stamped with
+  // X-Cached-At) and served while the station is unreachable
+  if (url.pathname === READINGS) {
+    event.respondWith(fetch(event.request)
+      .then(response => {
+        if (response.ok) {
+          const copy = response.clone();
+          event.waitUntil(copy.text().then(body => caches.open(DATA_CACHE).then(cache => cache.put(READINGS,
+            new Response(body, { headers: { 'Content-Type': 'application/json', 'X-Cached-At': String(Date.now()) } })))));
+        }
+        return response;
+      })
+      .catch(() => caches.match(READINGS).then(cached => cached || Response.error())));
+  }
+});
+)rawliteral";
+
+constexpr char WEB_MANIFEST[] PROGMEM = R"rawliteral({
+  "name": "ESP32 Weather Station",
+  "short_name": "Weather",
+  "start_url": "/",
+  "scope": "/",
+  "display": "standalone",
+  "background_color": "#1a1a2e",
+  "theme_color": "#0f3460"
+})rawliteral";
+
+// FNV-1a of a string (constexpr loop - the dashboard stays well below
+// GCC's 262144 iteration limit for constant evaluation)
+constexpr uint32_t webContentHash(const char* text, uint32_t hash = 2166136261UL) {
+  while (*text) {
+    hash = (hash ^ (uint8_t)*text++) * 16777619UL;
+  }
+  return hash;
+}
+
+// Content version of all served assets - ETag and service worker cache name.
+// Editing anything above changes it, no manual version bump needed
+constexpr uint32_t WEB_CONTENT_VERSION =
+  webContentHash(WEB_MANIFEST, webContentHash(SERVICE_WORKER_JS, webContentHash(HTML_DASHBOARD)));
+
 #endif
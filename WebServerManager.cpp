@@ -4,37 +4,294 @@
 
 #include "WebServerManager.h"
 #include "WebContent.h"
+#include "JsonWriter.h"
+#include "EventLog.h"
+#include "SamplingProfiles.h"
+#include "I2CTrace.h"
+#include "TimeSync.h"
+
+// Static response arena shared by all JSON handlers (requests are served one
+// at a time from loop(), so a single buffer is enough and nothing hits the heap)
+static char s_responseArena[RESPONSE_ARENA_SIZE];
+
+// Quoted ETag of the WebContent.h assets and the cache headers sent with them
+// (no-cache: browsers revalidate on every use, an unchanged asset costs a 304)
+static char s_contentETag[12];
+static char s_assetHeaders[64];
+
+static_assert(sizeof(SERVICE_WORKER_JS) + 32 <= RESPONSE_ARENA_SIZE, "Service worker is built in the response arena");
 
 // Constructor
-WebServerManager::WebServerManager(const SensorManager& sensorManager)
+WebServerManager::WebServerManager(const SensorManager& sensorManager, const SampleHistory& history,
+                                   const LoopGuard& loopGuard, const Scheduler& scheduler)
   : m_server(HTTP_SERVER_PORT),
-    m_sensorManager(sensorManager) {
+    m_sensorManager(sensorManager),
+    m_history(history),
+    m_loopGuard(loopGuard),
+    m_scheduler(scheduler) {
 }
 
 // Initialize HTTP server
 void WebServerManager::begin() {
-  // Setup HTTP routes using lambda functions to access member methods
-  m_server.on("/", [this]() { this->handleRoot(); });
-  m_server.on("/api/v1/sensors", [this]() { this->handleAPI(); });
-  m_server.onNotFound([this]() { this->handleNotFound(); });
+  snprintf(s_contentETag, sizeof(s_contentETag), "\"%08lx\"", (unsigned long)WEB_CONTENT_VERSION);
+  snprintf(s_assetHeaders, sizeof(s_assetHeaders), "ETag: %s\r\nCache-Control: no-cache\r\n", s_contentETag);
+
+  // Setup HTTP routes (each handler is wrapped with heap accounting)
+  addRoute("/", &WebServerManager::handleRoot);
+  addRoute("/sw.js", &WebServerManager::handleServiceWorker);
+  addRoute("/manifest.json", &WebServerManager::handleManifest);
+  addRoute("/api/v1/sensors", &WebServerManager::handleAPI);
+  addRoute("/api/v1/sensors/raw", &WebServerManager::handleRawAPI);
+  addRoute("/api/v1/events", &WebServerManager::handleEvents);
+  addRoute("/api/v1/forecast", &WebServerManager::handleForecast);
+  addRoute("/api/v1/chart", &WebServerManager::handleChart);
+  addRoute("/api/v1/sampling", &WebServerManager::handleSampling);
+  #if I2C_TRACE_ENABLED
+  addRoute("/api/v1/debug", &WebServerManager::handleDebug);
+  addRoute("/api/v1/debug/trace", &WebServerManager::handleDebugTrace);
+  #endif
+  addRoute("/api/v1/system/heap", &WebServerManager::handleHeap);
+  addRoute("/api/v1/system/stalls", &WebServerManager::handleStalls);
+  addRoute("/api/v1/system/scheduler", &WebServerManager::handleScheduler);
+
+  const uint8_t notFoundRoute = m_heapMonitor.registerRoute("(not found)");
+  m_server.onNotFound([this, notFoundRoute]() {
+    m_heapMonitor.beginRequest();
+    this->handleNotFound();
+    m_heapMonitor.endRequest(notFoundRoute);
+  });
 
   // Start the server
   m_server.begin();
 }
 
+// Register route using lambda to access member method
+void WebServerManager::addRoute(const char* path, void (WebServerManager::*handler)()) {
+  const uint8_t route = m_heapMonitor.registerRoute(path);
+
+  m_server.on(path, [this, route, handler]() {
+    m_heapMonitor.beginRequest();
+    (this->*handler)();
+    m_heapMonitor.endRequest(route);
+  });
+}
+
+// Register module status route with heap accounting
+void WebServerManager::addJSONRoute(const char* path, std::function<void(JsonWriter&)> writer) {
+  const uint8_t route = m_heapMonitor.registerRoute(path);
+
+  m_server.on(path, [this, route, writer]() {
+    m_heapMonitor.beginRequest();
+
+    JsonWriter json(s_responseArena, RESPONSE_ARENA_SIZE);
+    json.beginObject();
+    writer(json);
+    json.endObject();
+    sendJSON(s_responseArena, json.length());
+
+    m_heapMonitor.endRequest(route);
+  });
+}
+
+// Register pre-rendered document route with heap accounting
+void WebServerManager::addBufferRoute(const char* path, std::function<void(const JsonSender&)> source) {
+  const uint8_t route = m_heapMonitor.registerRoute(path);
+
+  m_server.on(path, [this, route, source]() {
+    m_heapMonitor.beginRequest();
+    source([this](const char* body, size_t length) {
+      sendJSON(body, length);
+    });
+    m_heapMonitor.endRequest(route);
+  });
+}
+
 // Handle root path - serve HTML dashboard
 void WebServerManager::handleRoot() {
-  m_server.send_P(200, "text/html", HTML_DASHBOARD);
+  sendAsset("text/html", HTML_DASHBOARD, sizeof(HTML_DASHBOARD) - 1);
+}
+
+// Handle service worker - script behind its version line (a changed version
+// is a changed script, which makes browsers install it and re-cache the shell)
+void WebServerManager::handleServiceWorker() {
+  const int length = snprintf(s_responseArena, RESPONSE_ARENA_SIZE, "const VERSION = '%08lx';\n%s",
+                              (unsigned long)WEB_CONTENT_VERSION, SERVICE_WORKER_JS);
+  sendAsset("application/javascript", s_responseArena, min<size_t>(length, RESPONSE_ARENA_SIZE - 1U));
+}
+
+// Handle web manifest
+void WebServerManager::handleManifest() {
+  sendAsset("application/manifest+json", WEB_MANIFEST, sizeof(WEB_MANIFEST) - 1);
 }
 
-// Handle API endpoint - serve JSON sensor data
+// Handle API endpoint - serve JSON sensor data (zero-heap response path)
 void WebServerManager::handleAPI() {
-  // Use static buffer to avoid heap fragmentation (performance optimization)
-  static char jsonBuffer[JSON_BUFFER_SIZE];
+  const size_t length = buildJSONResponse(s_responseArena, RESPONSE_ARENA_SIZE);
+
+  sendJSON(s_responseArena, length);
+}
+
+// Handle raw API endpoint - every physical sensor with unfused values
+void WebServerManager::handleRawAPI() {
+  JsonWriter json(s_responseArena, RESPONSE_ARENA_SIZE);
+  json.beginObject();
+  json.addUInt("sweepUs", m_sensorManager.getLastSweepTime());
+  json.addUInt("derivedCycles", m_sensorManager.getDerivedCycles());
+  json.addUInt("samples", m_sensorManager.getSampleCount());
+  json.addUInt("seq", m_sensorManager.getSequence());
+  json.beginObject("intervalsMs");
+  m_sensorManager.writeIntervalJSON(json);
+  json.endObject();
+  json.beginObject("detectors");
+  m_sensorManager.writeDetectorJSON(json);
+  json.endObject();
+  json.beginArray("sensors");
+  m_sensorManager.writeRawJSON(json);
+  json.endArray();
+  json.endObject();
+
+  sendJSON(s_responseArena, json.length());
+}
+
+// Handle events endpoint - journal entries newer than ?since=<seq>
+void WebServerManager::handleEvents() {
+  const uint32_t since = m_server.hasArg("since") ? strtoul(m_server.arg("since"), nullptr, 10) : 0;
+
+  JsonWriter json(s_responseArena, RESPONSE_ARENA_SIZE);
+  json.beginObject();
+  json.addUInt("boot", eventLog.getBootCount());
+  json.addUInt("next", eventLog.getNextSequence());
+  json.beginArray("events");
+  eventLog.writeJSON(json, since, EVENT_JSON_MAX_EVENTS);
+  json.endArray();
+  json.endObject();
+
+  sendJSON(s_responseArena, json.length());
+}
+
+// Handle forecast endpoint - pressure tendency and Zambretti forecast
+void WebServerManager::handleForecast() {
+  JsonWriter json(s_responseArena, RESPONSE_ARENA_SIZE);
+  json.beginObject();
+  m_sensorManager.getPressureTrend().writeJSON(json);
+  json.endObject();
+
+  sendJSON(s_responseArena, json.length());
+}
+
+// Handle chart endpoint - ?channel=&from=&to=&points=&format= (ms since boot),
+// history window downsampled on the device to at most 'points' pairs
+// (format=bin: base + varint deltas, see SampleHistory::writeChartBinary)
+void WebServerManager::handleChart() {
+  const uint32_t now = millis();
+  const uint32_t from = m_server.hasArg("from") ? strtoul(m_server.arg("from"), nullptr, 10) : 0;
+  const uint32_t to = m_server.hasArg("to") ? strtoul(m_server.arg("to"), nullptr, 10) : now;
+  const uint32_t points = m_server.hasArg("points") ? strtoul(m_server.arg("points"), nullptr, 10)
+                                                    : CHART_DEFAULT_POINTS;
+  if (points < 1) {
+    m_server.send(400, "text/plain", "400: points must be at least 1");
+    return;
+  }
+
+  if (strcmp(m_server.arg("format"), "bin") == 0) {
+    const size_t length = m_history.writeChartBinary((uint8_t*)s_responseArena, RESPONSE_ARENA_SIZE,
+                                                     m_server.arg("channel"), from, to,
+                                                     min<uint32_t>(points, CHART_MAX_POINTS));
+    if (length == 0) {
+      m_server.send(400, "text/plain", "400: Unknown channel");
+      return;
+    }
+    sendBody("application/octet-stream", (const uint8_t*)s_responseArena, length);
+    return;
+  }
+
+  JsonWriter json(s_responseArena, RESPONSE_ARENA_SIZE);
+  json.beginObject();
+  json.addUInt("now", now);
+  if (!m_history.writeChartJSON(json, m_server.arg("channel"), from, to,
+                                min<uint32_t>(points, CHART_MAX_POINTS))) {
+    m_server.send(400, "text/plain", "400: Unknown channel");
+    return;
+  }
+  json.endObject();
+
+  // Truncated JSON is never sent
+  if (json.overflowed()) {
+    m_server.send(500, "text/plain", "500: Response too large");
+    return;
+  }
+  sendJSON(s_responseArena, json.length());
+}
+
+// Handle sampling endpoint - GET lists profiles, POST ?profile=<name> selects
+// one (basic auth). The sensor manager applies it with the next read
+void WebServerManager::handleSampling() {
+  if (m_server.method() == HttpMethod::POST) {
+    if (!m_server.authenticate(API_USERNAME, API_PASSWORD)) {
+      m_server.requestAuthentication();
+      return;
+    }
+    if (!samplingProfiles.select(m_server.arg("profile"))) {
+      m_server.send(400, "text/plain", "400: Unknown profile");
+      return;
+    }
+  }
+
+  JsonWriter json(s_responseArena, RESPONSE_ARENA_SIZE);
+  json.beginObject();
+  samplingProfiles.writeJSON(json);
+  json.endObject();
+
+  sendJSON(s_responseArena, json.length());
+}
+
+#if I2C_TRACE_ENABLED
+// Handle debug endpoint - I2C trace recording state
+void WebServerManager::handleDebug() {
+  JsonWriter json(s_responseArena, RESPONSE_ARENA_SIZE);
+  json.beginObject();
+  json.beginObject("i2cTrace");
+  i2cTrace.writeJSON(json);
+  json.endObject();
+  json.endObject();
+
+  sendJSON(s_responseArena, json.length());
+}
+
+// Handle trace download - binary trace straight from the recording buffer
+void WebServerManager::handleDebugTrace() {
+  sendBody("application/octet-stream", i2cTrace.getData(), i2cTrace.getLength());
+}
+#endif
+
+// Handle heap endpoint - global heap state and per-route accounting
+void WebServerManager::handleHeap() {
+  JsonWriter json(s_responseArena, RESPONSE_ARENA_SIZE);
+  json.beginObject();
+  m_heapMonitor.writeJSON(json);
+  json.endObject();
+
+  sendJSON(s_responseArena, json.length());
+}
 
-  buildJSONResponse(jsonBuffer, JSON_BUFFER_SIZE);
+// Handle stalls endpoint - loop stage latency and watchdog attribution
+void WebServerManager::handleStalls() {
+  JsonWriter json(s_responseArena, RESPONSE_ARENA_SIZE);
+  json.beginObject();
+  m_loopGuard.writeJSON(json);
+  json.endObject();
 
-  m_server.send(200, "application/json", jsonBuffer);
+  sendJSON(s_responseArena, json.length());
+}
+
+// Handle scheduler endpoint - job timing and CPU idle percentage
+void WebServerManager::handleScheduler() {
+  JsonWriter json(s_responseArena, RESPONSE_ARENA_SIZE);
+  json.beginObject();
+  m_scheduler.writeJSON(json);
+  json.endObject();
+
+  sendJSON(s_responseArena, json.length());
 }
 
 // Handle 404 - Not Found
@@ -42,8 +299,24 @@ void WebServerManager::handleNotFound() {
   m_server.send(404, "text/plain", "404: Not Found");
 }
 
-// Build JSON response using snprintf (faster than String concatenation)
-void WebServerManager::buildJSONResponse(char* buffer, size_t bufferSize) const {
+// Header and body go straight to the socket from fixed buffers
+void WebServerManager::sendBody(const char* contentType, const uint8_t* body, size_t length,
+                                const char* extraHeaders) {
+  m_server.send(200, contentType, body, length, extraHeaders);
+}
+
+// Versioned asset - the body only goes out when the client's copy is stale
+void WebServerManager::sendAsset(const char* contentType, const char* body, size_t length) {
+  if (strcmp(m_server.header("If-None-Match"), s_contentETag) == 0) {
+    m_server.send(304, nullptr, nullptr, 0, s_assetHeaders);
+    return;
+  }
+
+  sendBody(contentType, (const uint8_t*)body, length, s_assetHeaders);
+}
+
+// Build JSON response with JsonWriter in the caller's buffer (no heap)
+size_t WebServerManager::buildJSONResponse(char* buffer, size_t bufferSize) const {
   const SensorData& data = m_sensorManager.getSensorData();
 
   // Calculate uptime in seconds
@@ -52,48 +325,42 @@ void WebServerManager::buildJSONResponse(char* buffer, size_t bufferSize) const
   // Get WiFi signal strength (RSSI) - only if connected
   const int8_t rssi = (WiFi.status() == WL_CONNECTED) ? WiFi.RSSI() : -100;
 
-  // Build JSON dynamically based on enabled sensors
-  size_t offset = 0;
+  JsonWriter json(buffer, bufferSize);
+  json.beginObject();
 
-  // Start JSON object
-  offset += snprintf(buffer + offset, bufferSize - offset, "{");
+  // Sensor channels - generated from the sensor registry (enabled sensors only)
+  m_sensorManager.writeJSON(json);
 
-  #if SENSOR_BME280_ENABLED
-  // Add BME280 sensor data (temperature, humidity, pressure)
-  if (isfinite(data.humidity)) {
-    offset += snprintf(buffer + offset, bufferSize - offset,
-                      "\"temperature\":%.2f,\"humidity\":%.2f,\"pressure\":%.2f",
-                      data.temperature, data.humidity, data.pressure);
-  } else {
-    // BMP280 variant - no humidity sensor
-    offset += snprintf(buffer + offset, bufferSize - offset,
-                      "\"temperature\":%.2f,\"humidity\":null,\"pressure\":%.2f",
-                      data.temperature, data.pressure);
-  }
-  #endif
+  // Channels rejected or flagged by anomaly detection
+  json.beginObject("anomalies");
+  m_sensorManager.writeAnomalyJSON(json);
+  json.endObject();
 
-  #if SENSOR_BH1750_ENABLED
-  // Add comma separator if BME280 data was added
   #if SENSOR_BME280_ENABLED
-  offset += snprintf(buffer + offset, bufferSize - offset, ",");
+  // Derived from temperature/humidity once per measurement
+  m_sensorManager.getDerivedMetrics().writeJSON(json);
+  m_sensorManager.getPressureTrend().writeSummaryJSON(json);
   #endif
 
-  // Add BH1750 light sensor data
-  if (isfinite(data.lightLevel)) {
-    offset += snprintf(buffer + offset, bufferSize - offset,
-                      "\"light\":%.2f", data.lightLevel);
+  // Add system info (always present)
+  json.addUInt("uptime", uptimeSeconds);
+  json.addInt("rssi", rssi);
+  json.addBool("valid", data.isValid);
+  json.addUInt("seq", m_sensorManager.getSequence());
+
+  // UTC milliseconds at acquisition (null until the first time sync)
+  #if TIME_SYNC_ENABLED
+  uint64_t sampleUtc;
+  if (timeSync.toUtcMs(m_sensorManager.getSampleTime(), sampleUtc)) {
+    json.addUInt64("time", sampleUtc);
   } else {
-    offset += snprintf(buffer + offset, bufferSize - offset,
-                      "\"light\":null");
+    json.addNull("time");
   }
+  #else
+  json.addNull("time");
   #endif
 
-  // Add system info (always present)
-  #if SENSOR_BME280_ENABLED || SENSOR_BH1750_ENABLED
-  offset += snprintf(buffer + offset, bufferSize - offset, ",");
-  #endif
+  json.endObject();
 
-  offset += snprintf(buffer + offset, bufferSize - offset,
-                    "\"uptime\":%lu,\"rssi\":%d,\"valid\":%s}",
-                    uptimeSeconds, rssi, data.isValid ? "true" : "false");
+  return json.length();
 }
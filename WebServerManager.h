@@ -7,37 +7,95 @@
 #define WEB_SERVER_MANAGER_H
 
 #include <WiFi.h>
-#include <WebServer.h>
+#include <functional>
 #include "Config.h"
+#include "HttpServer.h"
 #include "SensorManager.h"
+#include "SampleHistory.h"
+#include "HeapMonitor.h"
+#include "LoopGuard.h"
+#include "Scheduler.h"
 
 class WebServerManager {
 public:
-  // Constructor - takes reference to SensorManager for data access
-  WebServerManager(const SensorManager& sensorManager);
+  // Constructor - takes references to SensorManager, SampleHistory, LoopGuard and Scheduler for data access
+  WebServerManager(const SensorManager& sensorManager, const SampleHistory& history,
+                   const LoopGuard& loopGuard, const Scheduler& scheduler);
 
   // Initialize and start HTTP server
   void begin();
 
+  // Register a JSON status route for an optional module (body object is
+  // opened/closed around writer, response goes through the shared arena)
+  void addJSONRoute(const char* path, std::function<void(JsonWriter&)> writer);
+
+  // Register a route serving a pre-rendered JSON document - source calls
+  // send(body, length) with its buffer, nothing is copied into the arena
+  using JsonSender = std::function<void(const char* body, size_t length)>;
+  void addBufferRoute(const char* path, std::function<void(const JsonSender&)> source);
+
   // Handle incoming HTTP requests (call in loop)
   inline void handleClient() {
     m_server.handleClient();
   }
 
 private:
-  // HTTP server object
-  WebServer m_server;
+  // HTTP server object (fixed-buffer request parsing)
+  HttpServer m_server;
 
   // Reference to sensor manager for reading data
   const SensorManager& m_sensorManager;
 
+  // Reference to sample history for chart queries
+  const SampleHistory& m_history;
+
+  // Reference to loop guard for stall statistics
+  const LoopGuard& m_loopGuard;
+
+  // Reference to scheduler for job and idle statistics
+  const Scheduler& m_scheduler;
+
+  // Per-route heap accounting
+  HeapMonitor m_heapMonitor;
+
+  // Register route with heap accounting around its handler
+  void addRoute(const char* path, void (WebServerManager::*handler)());
+
   // HTTP route handlers
   void handleRoot();
+  void handleServiceWorker();
+  void handleManifest();
   void handleAPI();
+  void handleRawAPI();
+  void handleEvents();
+  void handleForecast();
+  void handleChart();
+  void handleSampling();
+  #if I2C_TRACE_ENABLED
+  void handleDebug();
+  void handleDebugTrace();
+  #endif
+  void handleHeap();
+  void handleStalls();
+  void handleScheduler();
   void handleNotFound();
 
+  // Write 200 JSON response directly to the client socket
+  inline void sendJSON(const char* body, size_t length) {
+    sendBody("application/json", (const uint8_t*)body, length);
+  }
+
+  // Write 200 response of any content type directly to the client socket
+  // (extraHeaders: complete header lines, each ending in "\r\n")
+  void sendBody(const char* contentType, const uint8_t* body, size_t length, const char* extraHeaders = "");
+
+  // Serve a WebContent.h asset with the content version as ETag - a
+  // matching If-None-Match gets a bodiless 304
+  void sendAsset(const char* contentType, const char* body, size_t length);
+
   // Helper method to build JSON response (optimized with static buffer)
-  void buildJSONResponse(char* buffer, size_t bufferSize) const;
+  // Returns response length
+  size_t buildJSONResponse(char* buffer, size_t bufferSize) const;
 };
 
 #endif // WEB_SERVER_MANAGER_H
@@ -0,0 +1,64 @@
+/*
+ * Host Environment for ESP32 Weather Station host tests
+ * Controls what the stubbed Arduino core sees: the clock, GPIO, reset
+ * reason, watchdog feeds and heap allocations.
+ *
+ * The clock is virtual by default: it only moves when a test advances it or
+ * firmware code calls delay()/vTaskDelay() or blocks on a task notification,
+ * and events queued with at() fire on the way. Tests that talk to sockets
+ * switch to real-time mode, where the clock follows the host's monotonic
+ * clock (plus any virtual offset) and tasks really sleep.
+ */
+
+#ifndef HOST_H
+#define HOST_H
+
+#include <Arduino.h>
+#include <esp_system.h>
+#include <functional>
+
+namespace host {
+
+// Current time (µs since boot)
+uint64_t now();
+
+// Move the virtual clock forward, firing due events in order
+void advance(uint64_t us);
+
+// Jump the clock (virtual: to an absolute time, real-time: shift the offset)
+void setTime(uint64_t us);
+
+// Follow the host's monotonic clock (tasks sleep for real)
+void useRealTime(bool enabled);
+
+// Queue a callback for a virtual time (runs inside advance())
+void at(uint64_t us, std::function<void()> callback);
+
+// Drop all queued events (between scenarios)
+void clearEvents();
+
+// GPIO hooks (default: pins read back the last written level, inputs read HIGH)
+using PinWriteHook = std::function<void(uint8_t pin, uint8_t mode, uint8_t value)>;
+using PinReadHook = std::function<int(uint8_t pin)>;
+void setPinHooks(PinWriteHook write, PinReadHook read);
+uint8_t getPinLevel(uint8_t pin);
+
+// Reason returned by esp_reset_reason()
+void setResetReason(esp_reset_reason_t reason);
+
+// Task watchdog feeds since start
+uint32_t getWatchdogFeeds();
+
+// operator new calls since start / bytes currently allocated through it
+uint64_t getAllocationCount();
+size_t getAllocatedBytes();
+
+// Host CPU cycle counter (TSC on x86, ns elsewhere) - ESP.getCycleCount() is its low word
+uint64_t cycles();
+
+// Flush output and end the process (leaves detached task threads behind)
+[[noreturn]] void exit(int status);
+
+}  // namespace host
+
+#endif // HOST_H
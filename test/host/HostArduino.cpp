@@ -0,0 +1,645 @@
+/*
+ * Host Environment Implementation
+ * Arduino core, FreeRTOS, esp_timer/esp_system/heap stand-ins on top of the
+ * host clock (virtual or real time) and std::thread.
+ */
+
+#include "Host.h"
+#include <Preferences.h>
+#include <esp_heap_caps.h>
+#include <esp_task_wdt.h>
+#include <esp_timer.h>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <malloc.h>
+#include <stdarg.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+constexpr size_t HOST_HEAP_SIZE = 300 * 1024;  // Modelled ESP32 DRAM heap
+
+// ============================================================================
+// Clock and events
+// ============================================================================
+static std::atomic<uint64_t> s_virtualUs(0);
+static std::atomic<bool> s_realTime(false);
+static std::atomic<int64_t> s_realOffsetUs(0);
+static const std::chrono::steady_clock::time_point s_realStart = std::chrono::steady_clock::now();
+
+static std::recursive_mutex s_eventLock;
+static std::multimap<uint64_t, std::function<void()>> s_events;
+
+static int64_t realElapsedUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - s_realStart).count();
+}
+
+uint64_t host::now() {
+  if (s_realTime) {
+    return s_realOffsetUs + realElapsedUs();
+  }
+  return s_virtualUs;
+}
+
+// Earliest queued event time (UINT64_MAX if none)
+static uint64_t nextEventTime() {
+  std::lock_guard<std::recursive_mutex> guard(s_eventLock);
+  return s_events.empty() ? UINT64_MAX : s_events.begin()->first;
+}
+
+void host::advance(uint64_t us) {
+  if (s_realTime) {
+    s_realOffsetUs += us;
+    return;
+  }
+
+  const uint64_t target = s_virtualUs + us;
+  for (;;) {
+    std::function<void()> callback;
+    {
+      std::lock_guard<std::recursive_mutex> guard(s_eventLock);
+      if (s_events.empty() || s_events.begin()->first > target) {
+        break;
+      }
+      if (s_events.begin()->first > s_virtualUs) {
+        s_virtualUs = s_events.begin()->first;
+      }
+      callback = std::move(s_events.begin()->second);
+      s_events.erase(s_events.begin());
+    }
+    callback();
+  }
+
+  // A callback may have moved the clock further (nested delay)
+  if (s_virtualUs < target) {
+    s_virtualUs = target;
+  }
+}
+
+void host::setTime(uint64_t us) {
+  if (s_realTime) {
+    s_realOffsetUs = (int64_t)us - realElapsedUs();
+  } else {
+    s_virtualUs = us;
+  }
+}
+
+void host::useRealTime(bool enabled) {
+  const uint64_t current = now();
+  s_realTime = enabled;
+  setTime(current);
+}
+
+void host::at(uint64_t us, std::function<void()> callback) {
+  std::lock_guard<std::recursive_mutex> guard(s_eventLock);
+  s_events.emplace(us, std::move(callback));
+}
+
+void host::clearEvents() {
+  std::lock_guard<std::recursive_mutex> guard(s_eventLock);
+  s_events.clear();
+}
+
+uint64_t host::cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+void host::exit(int status) {
+  fflush(stdout);
+  fflush(stderr);
+  std::_Exit(status);
+}
+
+uint32_t millis() {
+  return (uint32_t)(host::now() / 1000);
+}
+
+uint32_t micros() {
+  return (uint32_t)host::now();
+}
+
+static void sleepFor(uint64_t us) {
+  if (s_realTime) {
+    std::this_thread::sleep_for(std::chrono::microseconds(us));
+  } else {
+    host::advance(us);
+  }
+}
+
+void delay(uint32_t ms) {
+  sleepFor(ms * 1000ULL);
+}
+
+void delayMicroseconds(uint32_t us) {
+  sleepFor(us);
+}
+
+int64_t esp_timer_get_time() {
+  return (int64_t)host::now();
+}
+
+// ============================================================================
+// GPIO
+// ============================================================================
+constexpr uint8_t HOST_PIN_COUNT = 64;
+
+static uint8_t s_pinLevel[HOST_PIN_COUNT];
+static uint8_t s_pinMode[HOST_PIN_COUNT];
+static host::PinWriteHook s_pinWriteHook;
+static host::PinReadHook s_pinReadHook;
+
+void host::setPinHooks(PinWriteHook write, PinReadHook read) {
+  s_pinWriteHook = std::move(write);
+  s_pinReadHook = std::move(read);
+}
+
+uint8_t host::getPinLevel(uint8_t pin) {
+  return pin < HOST_PIN_COUNT ? s_pinLevel[pin] : LOW;
+}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (pin >= HOST_PIN_COUNT) {
+    return;
+  }
+  s_pinMode[pin] = mode;
+  if (s_pinWriteHook) {
+    s_pinWriteHook(pin, mode, s_pinLevel[pin]);
+  }
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if (pin >= HOST_PIN_COUNT) {
+    return;
+  }
+  s_pinLevel[pin] = value ? HIGH : LOW;
+  if (s_pinWriteHook) {
+    s_pinWriteHook(pin, s_pinMode[pin], s_pinLevel[pin]);
+  }
+}
+
+int digitalRead(uint8_t pin) {
+  if (s_pinReadHook) {
+    const int level = s_pinReadHook(pin);
+    if (level >= 0) {
+      return level;
+    }
+  }
+  if (pin >= HOST_PIN_COUNT) {
+    return LOW;
+  }
+  return s_pinMode[pin] == OUTPUT ? s_pinLevel[pin] : HIGH;
+}
+
+// ============================================================================
+// Serial / Print
+// ============================================================================
+HardwareSerial Serial;
+
+static bool serialEcho() {
+  static const bool echo = getenv("HOST_SERIAL") && strcmp(getenv("HOST_SERIAL"), "1") == 0;
+  return echo;
+}
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    write(buffer[i]);
+  }
+  return size;
+}
+
+size_t Print::print(const char* text) {
+  return write((const uint8_t*)text, strlen(text));
+}
+
+size_t Print::println(const char* text) {
+  return print(text) + print("\r\n");
+}
+
+size_t Print::printf(const char* format, ...) {
+  char buffer[512];
+  va_list args;
+  va_start(args, format);
+  const int length = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (length <= 0) {
+    return 0;
+  }
+  return write((const uint8_t*)buffer, min((size_t)length, sizeof(buffer) - 1));
+}
+
+size_t HardwareSerial::write(uint8_t value) {
+  return write(&value, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  if (serialEcho()) {
+    fwrite(buffer, 1, size, stdout);
+  }
+  return size;
+}
+
+size_t strlcpy(char* destination, const char* source, size_t size) {
+  const size_t length = strlen(source);
+  if (size > 0) {
+    const size_t copied = length < size - 1 ? length : size - 1;
+    memcpy(destination, source, copied);
+    destination[copied] = '\0';
+  }
+  return length;
+}
+
+String IPAddress::toString() const {
+  char text[16];
+  snprintf(text, sizeof(text), "%u.%u.%u.%u", m_address & 0xFF, (m_address >> 8) & 0xFF,
+           (m_address >> 16) & 0xFF, m_address >> 24);
+  return String(text);
+}
+
+// ============================================================================
+// Critical sections and FreeRTOS
+// ============================================================================
+void hostEnterCritical(portMUX_TYPE* mux) {
+  while (mux->locked.exchange(true, std::memory_order_acquire)) {
+    std::this_thread::yield();
+  }
+}
+
+void hostExitCritical(portMUX_TYPE* mux) {
+  mux->locked.store(false, std::memory_order_release);
+}
+
+struct HostTask {
+  std::mutex lock;
+  std::condition_variable wake;
+  uint32_t notifications = 0;
+};
+
+static HostTask s_mainTask;
+static thread_local HostTask* t_currentTask = &s_mainTask;
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+  return t_currentTask;
+}
+
+BaseType_t xTaskCreatePinnedToCore(void (*function)(void*), const char* name, uint32_t stackDepth,
+                                   void* parameter, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core) {
+  (void)name;
+  (void)stackDepth;
+  (void)priority;
+  (void)core;
+
+  HostTask* task = new HostTask();
+  if (handle) {
+    *handle = task;
+  }
+  std::thread([function, parameter, task]() {
+    t_currentTask = task;
+    function(parameter);
+  }).detach();
+  return pdPASS;
+}
+
+// Take pending notifications (caller holds the task lock)
+static uint32_t takeNotifications(HostTask& task, BaseType_t clearOnExit) {
+  const uint32_t count = task.notifications;
+  if (count > 0) {
+    task.notifications = clearOnExit ? 0 : count - 1;
+  }
+  return count;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait) {
+  HostTask& task = *t_currentTask;
+
+  if (s_realTime) {
+    std::unique_lock<std::mutex> guard(task.lock);
+    auto notified = [&task]() { return task.notifications > 0; };
+    if (ticksToWait == portMAX_DELAY) {
+      task.wake.wait(guard, notified);
+    } else {
+      task.wake.wait_for(guard, std::chrono::milliseconds(ticksToWait), notified);
+    }
+    return takeNotifications(task, clearOnExit);
+  }
+
+  // Virtual time: fire events up to the timeout, stop early once notified
+  const uint64_t deadline = ticksToWait == portMAX_DELAY ? UINT64_MAX : host::now() + ticksToWait * 1000ULL;
+  for (;;) {
+    {
+      std::lock_guard<std::mutex> guard(task.lock);
+      if (task.notifications > 0) {
+        return takeNotifications(task, clearOnExit);
+      }
+    }
+    const uint64_t next = nextEventTime();
+    if (next > deadline || next == UINT64_MAX) {
+      if (deadline != UINT64_MAX) {
+        host::advance(deadline - host::now());
+      }
+      return 0;
+    }
+    host::advance(next > host::now() ? next - host::now() : 0);
+  }
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t handle) {
+  HostTask& task = *static_cast<HostTask*>(handle);
+  {
+    std::lock_guard<std::mutex> guard(task.lock);
+    task.notifications++;
+  }
+  task.wake.notify_one();
+  return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  sleepFor(ticks * 1000ULL);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+  return new std::timed_mutex();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait) {
+  auto& mutex = *static_cast<std::timed_mutex*>(semaphore);
+  if (ticksToWait == portMAX_DELAY) {
+    mutex.lock();
+    return pdTRUE;
+  }
+  return mutex.try_lock_for(std::chrono::milliseconds(ticksToWait)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore) {
+  static_cast<std::timed_mutex*>(semaphore)->unlock();
+  return pdTRUE;
+}
+
+// ============================================================================
+// esp_timer (periodic timers fire from the virtual clock)
+// ============================================================================
+struct esp_timer {
+  esp_timer_cb_t callback;
+  void* arg;
+  uint64_t period;
+  uint32_t generation;
+};
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* args, esp_timer_handle_t* handle) {
+  *handle = new esp_timer{args->callback, args->arg, 0, 0};
+  return ESP_OK;
+}
+
+// Queue the next expiry (dropped when the timer was stopped or restarted)
+static void armTimer(esp_timer_handle_t timer, uint64_t due, uint32_t generation) {
+  host::at(due, [timer, due, generation]() {
+    if (timer->generation != generation) {
+      return;
+    }
+    timer->callback(timer->arg);
+    armTimer(timer, due + timer->period, generation);
+  });
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+  timer->period = period;
+  armTimer(timer, host::now() + period, ++timer->generation);
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  timer->generation++;
+  return ESP_OK;
+}
+
+// ============================================================================
+// esp_system / task watchdog
+// ============================================================================
+static esp_reset_reason_t s_resetReason = ESP_RST_POWERON;
+static std::atomic<uint32_t> s_watchdogFeeds(0);
+
+void host::setResetReason(esp_reset_reason_t reason) {
+  s_resetReason = reason;
+}
+
+esp_reset_reason_t esp_reset_reason(void) {
+  return s_resetReason;
+}
+
+uint32_t host::getWatchdogFeeds() {
+  return s_watchdogFeeds;
+}
+
+esp_err_t esp_task_wdt_init(const esp_task_wdt_config_t* config) {
+  (void)config;
+  return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_reconfigure(const esp_task_wdt_config_t* config) {
+  (void)config;
+  return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_add(void* task) {
+  (void)task;
+  return ESP_OK;
+}
+
+esp_err_t esp_task_wdt_reset(void) {
+  s_watchdogFeeds++;
+  return ESP_OK;
+}
+
+// ============================================================================
+// Heap accounting (operator new of the whole process)
+// ============================================================================
+static std::atomic<uint64_t> s_allocations(0);
+static std::atomic<size_t> s_allocatedBytes(0);
+static std::atomic<size_t> s_allocatedBlocks(0);
+static std::atomic<size_t> s_peakAllocatedBytes(0);
+static std::atomic<size_t> s_localPeakAllocatedBytes(0);
+static std::atomic<bool> s_localMinimum(false);
+
+static void raisePeak(std::atomic<size_t>& peak, size_t allocated) {
+  size_t current = peak;
+  while (allocated > current && !peak.compare_exchange_weak(current, allocated)) {
+  }
+}
+
+static void* countedAlloc(size_t size) {
+  void* block = malloc(size ? size : 1);
+  if (!block) {
+    throw std::bad_alloc();
+  }
+  s_allocations++;
+  s_allocatedBlocks++;
+  const size_t allocated = s_allocatedBytes += malloc_usable_size(block);
+  raisePeak(s_peakAllocatedBytes, allocated);
+  raisePeak(s_localPeakAllocatedBytes, allocated);
+  if (esp_heap_trace_alloc_hook) {
+    esp_heap_trace_alloc_hook(block, size, MALLOC_CAP_8BIT);
+  }
+  return block;
+}
+
+static void countedFree(void* block) {
+  if (block) {
+    s_allocatedBytes -= malloc_usable_size(block);
+    s_allocatedBlocks--;
+    free(block);
+  }
+}
+
+void* operator new(size_t size) {
+  return countedAlloc(size);
+}
+
+void* operator new[](size_t size) {
+  return countedAlloc(size);
+}
+
+void operator delete(void* block) noexcept {
+  countedFree(block);
+}
+
+void operator delete[](void* block) noexcept {
+  countedFree(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+  countedFree(block);
+}
+
+void operator delete[](void* block, size_t) noexcept {
+  countedFree(block);
+}
+
+uint64_t host::getAllocationCount() {
+  return s_allocations;
+}
+
+size_t host::getAllocatedBytes() {
+  return s_allocatedBytes;
+}
+
+void heap_caps_get_info(multi_heap_info_t* info, uint32_t caps) {
+  (void)caps;
+  const size_t allocated = min((size_t)s_allocatedBytes, HOST_HEAP_SIZE);
+  memset(info, 0, sizeof(*info));
+  info->total_free_bytes = HOST_HEAP_SIZE - allocated;
+  info->total_allocated_bytes = allocated;
+  info->largest_free_block = info->total_free_bytes;
+  info->minimum_free_bytes = HOST_HEAP_SIZE - min((size_t)s_peakAllocatedBytes, HOST_HEAP_SIZE);
+  info->allocated_blocks = s_allocatedBlocks;
+  info->free_blocks = 1;
+  info->total_blocks = 1;
+}
+
+size_t heap_caps_get_minimum_free_size(uint32_t caps) {
+  (void)caps;
+  const size_t peak = s_localMinimum ? s_localPeakAllocatedBytes : s_peakAllocatedBytes;
+  return HOST_HEAP_SIZE - min(peak, HOST_HEAP_SIZE);
+}
+
+esp_err_t heap_caps_monitor_local_minimum_free_size_start(void) {
+  if (s_localMinimum) {
+    return ESP_FAIL;
+  }
+  s_localPeakAllocatedBytes = (size_t)s_allocatedBytes;
+  s_localMinimum = true;
+  return ESP_OK;
+}
+
+esp_err_t heap_caps_monitor_local_minimum_free_size_stop(void) {
+  if (!s_localMinimum) {
+    return ESP_FAIL;
+  }
+  s_localMinimum = false;
+  return ESP_OK;
+}
+
+EspClass ESP;
+
+void EspClass::restart() {
+  Serial.println("[HOST] ESP.restart()");
+  host::exit(3);
+}
+
+uint32_t EspClass::getFreeHeap() {
+  return HOST_HEAP_SIZE - min((size_t)s_allocatedBytes, HOST_HEAP_SIZE);
+}
+
+uint32_t EspClass::getMinFreeHeap() {
+  return heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+}
+
+uint32_t EspClass::getMaxAllocHeap() {
+  return getFreeHeap();
+}
+
+uint32_t EspClass::getHeapSize() {
+  return HOST_HEAP_SIZE;
+}
+
+uint32_t EspClass::getCycleCount() {
+  return (uint32_t)host::cycles();
+}
+
+// ============================================================================
+// Preferences (in-memory, lives as long as the process)
+// ============================================================================
+static std::map<std::string, std::string>& preferenceStore() {
+  static std::map<std::string, std::string> store;
+  return store;
+}
+
+bool Preferences::begin(const char* name, bool readOnly, const char* partition) {
+  (void)partition;
+  m_namespace = name;
+  m_readOnly = readOnly;
+  return true;
+}
+
+void Preferences::end() {
+  m_namespace.clear();
+}
+
+size_t Preferences::getString(const char* key, char* value, size_t maxLength) {
+  const auto entry = preferenceStore().find(m_namespace + "/" + key);
+  if (entry == preferenceStore().end() || entry->second.size() + 1 > maxLength) {
+    return 0;
+  }
+  strlcpy(value, entry->second.c_str(), maxLength);
+  return entry->second.size() + 1;
+}
+
+size_t Preferences::putString(const char* key, const char* value) {
+  if (m_readOnly || m_namespace.empty()) {
+    return 0;
+  }
+  preferenceStore()[m_namespace + "/" + key] = value;
+  return strlen(value);
+}
+
+uint8_t Preferences::getUChar(const char* key, uint8_t defaultValue) {
+  const auto entry = preferenceStore().find(m_namespace + "/" + key);
+  return entry == preferenceStore().end() || entry->second.empty() ? defaultValue : (uint8_t)entry->second[0];
+}
+
+size_t Preferences::putUChar(const char* key, uint8_t value) {
+  if (m_readOnly || m_namespace.empty()) {
+    return 0;
+  }
+  preferenceStore()[m_namespace + "/" + key] = std::string(1, (char)value);
+  return 1;
+}
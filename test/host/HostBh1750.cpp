@@ -0,0 +1,87 @@
+/*
+ * BH1750 Model Implementation
+ */
+
+#include "HostBh1750.h"
+#include "Host.h"
+#include <math.h>
+
+namespace host {
+
+constexpr uint8_t OPCODE_POWER_DOWN = 0x00;
+constexpr uint8_t OPCODE_RESET = 0x07;
+constexpr uint8_t OPCODE_ONE_TIME_H = 0x20;
+constexpr uint8_t OPCODE_ONE_TIME_H2 = 0x21;
+constexpr uint8_t OPCODE_ONE_TIME_L = 0x23;
+
+// Datasheet typical: H modes 120 ms at MTreg 69 (scales with MTreg), L mode 16 ms
+constexpr uint32_t H_CONVERSION_US = 120000;
+constexpr uint32_t L_CONVERSION_US = 16000;
+constexpr double COUNTS_PER_LUX = 1.2;
+
+Bh1750Model::Bh1750Model() {
+  reset();
+}
+
+void Bh1750Model::reset() {
+  m_mtreg = BH1750_MTREG_DEFAULT;
+  m_mtregHigh = BH1750_MTREG_DEFAULT >> 5;
+  m_mode = 0;
+  m_readyAt = 0;
+  m_latchedLux = 0;
+  m_result = 0;
+  m_conversions = 0;
+}
+
+void Bh1750Model::command(uint8_t opcode) {
+  if ((opcode & 0xF8) == 0x40) {
+    m_mtregHigh = opcode & 0x07;
+  } else if ((opcode & 0xE0) == 0x60) {
+    m_mtreg = (m_mtregHigh << 5) | (opcode & 0x1F);
+  } else if (opcode == OPCODE_ONE_TIME_H || opcode == OPCODE_ONE_TIME_H2 || opcode == OPCODE_ONE_TIME_L) {
+    m_mode = opcode;
+    m_latchedLux = lux;
+    m_readyAt = now() + (opcode == OPCODE_ONE_TIME_L
+                           ? L_CONVERSION_US
+                           : ((uint64_t)H_CONVERSION_US * m_mtreg + BH1750_MTREG_DEFAULT - 1) / BH1750_MTREG_DEFAULT);
+  } else if (opcode == OPCODE_RESET) {
+    m_result = 0;
+  } else if (opcode == OPCODE_POWER_DOWN) {
+    m_mode = 0;
+  }
+}
+
+// Finish the conversion in progress once its time is up
+void Bh1750Model::update() {
+  if (m_mode == 0 || now() < m_readyAt) {
+    return;
+  }
+
+  double counts = m_latchedLux * COUNTS_PER_LUX * m_mtreg / BH1750_MTREG_DEFAULT;
+  if (m_mode == OPCODE_ONE_TIME_H2) {
+    counts *= 2;  // Half a lux per count
+  } else if (m_mode == OPCODE_ONE_TIME_L) {
+    counts = floor(counts / 4) * 4;  // 4 lx steps
+  }
+  m_result = counts >= UINT16_MAX ? UINT16_MAX : (uint16_t)floor(counts);
+  m_mode = 0;  // One-time modes power down afterwards
+  m_conversions++;
+}
+
+bool Bh1750Model::write(const uint8_t* data, size_t length) {
+  update();
+  for (size_t i = 0; i < length; i++) {
+    command(data[i]);
+  }
+  return true;
+}
+
+// Result register, big endian (repeats after two bytes)
+void Bh1750Model::read(uint8_t* data, size_t length) {
+  update();
+  for (size_t i = 0; i < length; i++) {
+    data[i] = (i % 2 == 0) ? m_result >> 8 : m_result;
+  }
+}
+
+}  // namespace host
@@ -0,0 +1,53 @@
+/*
+ * BH1750 Model for ESP32 Weather Station host tests
+ * Opcode-level light sensor on a host I2C bus: power down/on, reset, the
+ * one-time H, H2 and L modes with their typical conversion times, and the
+ * measurement time register (MTreg) that scales sensitivity and conversion
+ * time. Reading the result returns the last finished conversion, so a read
+ * during a conversion gets the previous value like the real chip.
+ */
+
+#ifndef HOST_BH1750_H
+#define HOST_BH1750_H
+
+#include "HostI2C.h"
+
+namespace host {
+
+constexpr uint8_t BH1750_MTREG_DEFAULT = 69;
+
+class Bh1750Model : public I2CDevice {
+public:
+  Bh1750Model();
+
+  // Illuminance seen by the chip (change at any time)
+  double lux = 100.0;
+
+  inline uint8_t getMtreg() const {
+    return m_mtreg;
+  }
+
+  inline uint32_t getConversions() const {
+    return m_conversions;
+  }
+
+  bool write(const uint8_t* data, size_t length) override;
+  void read(uint8_t* data, size_t length) override;
+  void reset() override;
+
+private:
+  uint8_t m_mtreg;
+  uint8_t m_mtregHigh;  // MT[7:5] written first, applied with MT[4:0]
+  uint8_t m_mode;       // One-time mode in progress (0 = none)
+  uint64_t m_readyAt;   // End of the conversion in progress
+  double m_latchedLux;  // Light integrated by the conversion in progress
+  uint16_t m_result;
+  uint32_t m_conversions;
+
+  void command(uint8_t opcode);
+  void update();
+};
+
+}  // namespace host
+
+#endif // HOST_BH1750_H
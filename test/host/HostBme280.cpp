@@ -0,0 +1,267 @@
+/*
+ * BME280 Model and Adafruit_BME280 stand-in
+ */
+
+#include "HostBme280.h"
+#include "Host.h"
+#include <Adafruit_BME280.h>
+
+namespace host {
+
+constexpr uint8_t REG_CHIP_ID = 0xD0;
+constexpr uint8_t REG_RESET = 0xE0;
+constexpr uint8_t REG_CTRL_HUM = 0xF2;
+constexpr uint8_t REG_STATUS = 0xF3;
+constexpr uint8_t REG_CTRL_MEAS = 0xF4;
+constexpr uint8_t REG_CONFIG = 0xF5;
+constexpr uint8_t REG_PRESS = 0xF7;
+constexpr uint8_t REG_TEMP = 0xFA;
+constexpr uint8_t REG_HUM = 0xFD;
+constexpr uint8_t RESET_WORD = 0xB6;
+
+// Standby time per config t_sb (µs)
+static const uint32_t STANDBY_US[8] = { 500, 62500, 125000, 250000, 500000, 1000000, 10000, 20000 };
+
+// Oversampling setting -> samples (0 = skipped)
+static uint32_t samples(uint8_t osrs) {
+  return osrs == 0 ? 0 : 1U << (min<uint8_t>(osrs, 5) - 1);
+}
+
+Bme280Model::Bme280Model(uint32_t seed)
+  : m_random(seed) {
+  reset();
+}
+
+void Bme280Model::reset() {
+  memset(m_registers, 0, sizeof(m_registers));
+  m_registers[REG_CHIP_ID] = BME280_CHIP_ID;
+
+  // Calibration area (content is not interpreted by the stand-in library)
+  for (uint8_t reg = 0x88; reg < 0xA2; reg++) {
+    m_registers[reg] = reg;
+  }
+  for (uint8_t reg = 0xE1; reg < 0xE8; reg++) {
+    m_registers[reg] = reg;
+  }
+
+  // Skipped-channel patterns until the first conversion
+  m_registers[REG_PRESS] = 0x80;
+  m_registers[REG_TEMP] = 0x80;
+  m_registers[REG_HUM] = 0x80;
+
+  m_pointer = 0;
+  m_busyUntil = 0;
+  m_normalStart = 0;
+  m_latchedCycle = -1;
+  m_conversions = 0;
+}
+
+// Datasheet 9.1 typical: 1 + 2 T + (2 P + 0.5) + (2 H + 0.5) ms
+uint32_t Bme280Model::getConversionTimeUs() const {
+  const uint32_t t = samples(m_registers[REG_CTRL_MEAS] >> 5);
+  const uint32_t p = samples((m_registers[REG_CTRL_MEAS] >> 2) & 0x07);
+  const uint32_t h = samples(m_registers[REG_CTRL_HUM] & 0x07);
+  return 1000 + 2000 * t + (p ? 2000 * p + 500 : 0) + (h ? 2000 * h + 500 : 0);
+}
+
+void Bme280Model::startConversion(uint64_t time) {
+  m_busyUntil = time + getConversionTimeUs();
+}
+
+// Conversion finished - load data registers
+void Bme280Model::latch() {
+  std::normal_distribution<double> noise(0.0, 1.0);
+  const uint8_t ctrlMeas = m_registers[REG_CTRL_MEAS];
+
+  auto put24 = [this](uint8_t reg, uint32_t value) {
+    m_registers[reg] = value >> 16;
+    m_registers[reg + 1] = value >> 8;
+    m_registers[reg + 2] = value;
+  };
+
+  if (ctrlMeas >> 5) {
+    const double t = temperature + temperatureNoise * noise(m_random);
+    put24(REG_TEMP, (uint32_t)lround((t + BME280_TEMPERATURE_OFFSET) * BME280_TEMPERATURE_SCALE));
+  } else {
+    put24(REG_TEMP, 0x800000);
+  }
+
+  if ((ctrlMeas >> 2) & 0x07) {
+    const double p = pressure + pressureNoise * noise(m_random);
+    put24(REG_PRESS, (uint32_t)lround(p * BME280_PRESSURE_SCALE));
+  } else {
+    put24(REG_PRESS, 0x800000);
+  }
+
+  if (m_registers[REG_CTRL_HUM] & 0x07) {
+    const double h = constrain(humidity + humidityNoise * noise(m_random), 0.0, 100.0);
+    const uint32_t raw = (uint32_t)lround(h * BME280_HUMIDITY_SCALE);
+    m_registers[REG_HUM] = raw >> 8;
+    m_registers[REG_HUM + 1] = raw;
+  } else {
+    m_registers[REG_HUM] = 0x80;
+    m_registers[REG_HUM + 1] = 0x00;
+  }
+
+  m_conversions++;
+}
+
+// Bring conversions up to the current time
+void Bme280Model::update() {
+  const uint64_t time = now();
+  const uint8_t mode = m_registers[REG_CTRL_MEAS] & 0x03;
+
+  if (mode == 0x03) {
+    // Normal mode: conversions start every conversion + standby time,
+    // the data registers hold the last completed one
+    const uint64_t conversion = getConversionTimeUs();
+    const uint64_t cycle = conversion + STANDBY_US[m_registers[REG_CONFIG] >> 5];
+    const uint64_t elapsed = time - m_normalStart;
+    const int64_t current = elapsed / cycle;
+    const bool measuring = elapsed % cycle < conversion;
+    const int64_t completed = measuring ? current - 1 : current;
+    if (completed > m_latchedCycle) {
+      latch();
+      m_latchedCycle = completed;
+    }
+    m_busyUntil = measuring ? m_normalStart + current * cycle + conversion : 0;
+    return;
+  }
+
+  if (m_busyUntil != 0 && time >= m_busyUntil) {
+    latch();
+    m_busyUntil = 0;
+    m_registers[REG_CTRL_MEAS] &= ~0x03;  // Forced mode returns to sleep
+  }
+}
+
+void Bme280Model::writeRegister(uint8_t reg, uint8_t value) {
+  writes.push_back({ reg, value, now() });
+
+  if (reg == REG_RESET) {
+    if (value == RESET_WORD) {
+      reset();
+    }
+    return;
+  }
+  if (reg != REG_CTRL_HUM && reg != REG_CTRL_MEAS && reg != REG_CONFIG) {
+    return;  // Read-only
+  }
+
+  m_registers[reg] = value;
+  if (reg == REG_CTRL_MEAS) {
+    const uint8_t mode = value & 0x03;
+    if (mode == 0x01 || mode == 0x02) {
+      startConversion(now());
+    } else if (mode == 0x03) {
+      m_normalStart = now();
+      m_latchedCycle = -1;
+    } else {
+      m_busyUntil = 0;
+    }
+  }
+}
+
+// First byte sets the register pointer, then (register, value) pairs
+bool Bme280Model::write(const uint8_t* data, size_t length) {
+  update();
+  m_pointer = data[0];
+  if (length >= 2) {
+    writeRegister(data[0], data[1]);
+    for (size_t i = 2; i + 1 < length; i += 2) {
+      writeRegister(data[i], data[i + 1]);
+    }
+  }
+  return true;
+}
+
+// Burst read with auto-increment
+void Bme280Model::read(uint8_t* data, size_t length) {
+  update();
+  for (size_t i = 0; i < length; i++) {
+    const uint8_t reg = m_pointer + i;
+    if (reg == REG_STATUS) {
+      data[i] = m_busyUntil != 0 ? 0x08 : 0x00;
+    } else {
+      data[i] = m_registers[reg];
+    }
+  }
+}
+
+}  // namespace host
+
+// ============================================================================
+// Adafruit_BME280 stand-in (register reads through the given TwoWire)
+// ============================================================================
+bool Adafruit_BME280::readRegisters(uint8_t reg, uint8_t* data, uint8_t length) {
+  m_wire->beginTransmission(m_address);
+  m_wire->write(reg);
+  if (m_wire->endTransmission() != 0 || m_wire->requestFrom(m_address, length) != length) {
+    return false;
+  }
+  for (uint8_t i = 0; i < length; i++) {
+    data[i] = (uint8_t)m_wire->read();
+  }
+  return true;
+}
+
+// Like the library: check chip id, soft reset, wait for the NVM copy, read calibration
+bool Adafruit_BME280::begin(uint8_t address, TwoWire* wire) {
+  m_address = address;
+  m_wire = wire;
+
+  if (!readRegisters(0xD0, &m_chipId, 1) || m_chipId != host::BME280_CHIP_ID) {
+    return false;
+  }
+
+  m_wire->beginTransmission(m_address);
+  m_wire->write(0xE0);
+  m_wire->write(0xB6);
+  if (m_wire->endTransmission() != 0) {
+    return false;
+  }
+  delay(10);
+
+  uint8_t calibration[26];
+  return readRegisters(0x88, calibration, sizeof(calibration));
+}
+
+float Adafruit_BME280::readTemperature() {
+  uint8_t data[3];
+  if (!readRegisters(0xFA, data, 3)) {
+    return NAN;
+  }
+  const uint32_t raw = ((uint32_t)data[0] << 16) | (data[1] << 8) | data[2];
+  if (raw == 0x800000) {
+    return NAN;
+  }
+  return (float)(raw / host::BME280_TEMPERATURE_SCALE - host::BME280_TEMPERATURE_OFFSET);
+}
+
+float Adafruit_BME280::readPressure() {
+  if (isnan(readTemperature())) {
+    return NAN;  // Library needs t_fine first
+  }
+  uint8_t data[3];
+  if (!readRegisters(0xF7, data, 3)) {
+    return NAN;
+  }
+  const uint32_t raw = ((uint32_t)data[0] << 16) | (data[1] << 8) | data[2];
+  return raw == 0x800000 ? NAN : (float)(raw / host::BME280_PRESSURE_SCALE);
+}
+
+float Adafruit_BME280::readHumidity() {
+  if (isnan(readTemperature())) {
+    return NAN;
+  }
+  uint8_t data[2];
+  if (!readRegisters(0xFD, data, 2)) {
+    return NAN;
+  }
+  const uint32_t raw = ((uint32_t)data[0] << 8) | data[1];
+  return raw == 0x8000 ? NAN : (float)(raw / host::BME280_HUMIDITY_SCALE);
+}
+
+uint32_t Adafruit_BME280::sensorID() {
+  return m_chipId;
+}
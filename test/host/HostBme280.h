@@ -0,0 +1,87 @@
+/*
+ * BME280 Model for ESP32 Weather Station host tests
+ * Register-level chip on a host I2C bus: chip id, soft reset, ctrl_hum,
+ * ctrl_meas, config, status (measuring bit for the datasheet's typical
+ * conversion time) and data registers latched at the end of each forced or
+ * normal-mode conversion. Measured values come from the environment fields
+ * plus Gaussian noise.
+ *
+ * Data registers use a host encoding shared with the Adafruit_BME280
+ * stand-in instead of the Bosch compensation formulas:
+ *   press (0xF7, 24 bit) = Pa x 100, temp (0xFA, 24 bit) = (°C + 100) x 10000,
+ *   hum (0xFD, 16 bit) = %RH x 500
+ */
+
+#ifndef HOST_BME280_H
+#define HOST_BME280_H
+
+#include "HostI2C.h"
+#include <random>
+
+namespace host {
+
+constexpr uint8_t BME280_CHIP_ID = 0x60;
+constexpr double BME280_TEMPERATURE_SCALE = 10000.0;
+constexpr double BME280_TEMPERATURE_OFFSET = 100.0;
+constexpr double BME280_PRESSURE_SCALE = 100.0;
+constexpr double BME280_HUMIDITY_SCALE = 500.0;
+
+class Bme280Model : public I2CDevice {
+public:
+  explicit Bme280Model(uint32_t seed = 1);
+
+  // Environment seen by the chip (change at any time)
+  double temperature = 21.5;  // °C
+  double humidity = 45.0;     // %RH
+  double pressure = 101325.0; // Pa
+
+  // Noise (standard deviation) added per conversion
+  double temperatureNoise = 0.01;
+  double humidityNoise = 0.05;
+  double pressureNoise = 2.0;
+
+  // Register write log (register, value) since the last clearLog()
+  struct RegisterWrite {
+    uint8_t reg;
+    uint8_t value;
+    uint64_t time;
+  };
+  std::vector<RegisterWrite> writes;
+
+  inline void clearLog() {
+    writes.clear();
+  }
+
+  inline uint8_t getRegister(uint8_t reg) const {
+    return m_registers[reg];
+  }
+
+  inline uint32_t getConversions() const {
+    return m_conversions;
+  }
+
+  // Typical conversion time of the current ctrl_meas/ctrl_hum (µs)
+  uint32_t getConversionTimeUs() const;
+
+  bool write(const uint8_t* data, size_t length) override;
+  void read(uint8_t* data, size_t length) override;
+  void reset() override;
+
+private:
+  uint8_t m_registers[256];
+  uint8_t m_pointer;
+  uint64_t m_busyUntil;    // End of the running conversion (0 = idle)
+  uint64_t m_normalStart;  // Normal mode: start of the first conversion
+  int64_t m_latchedCycle;  // Normal mode: last conversion in the data registers
+  uint32_t m_conversions;
+  std::mt19937 m_random;
+
+  void writeRegister(uint8_t reg, uint8_t value);
+  void startConversion(uint64_t time);
+  void latch();
+  void update();
+};
+
+}  // namespace host
+
+#endif // HOST_BME280_H
@@ -0,0 +1,269 @@
+/*
+ * Host I2C Buses Implementation
+ */
+
+#include "HostI2C.h"
+#include "Host.h"
+
+namespace host {
+
+static I2CBus s_buses[2];
+
+I2CBus& i2cBus(uint8_t busNumber) {
+  return s_buses[busNumber == 2 ? 1 : 0];
+}
+
+void I2CBus::attach(uint8_t address, I2CDevice& device) {
+  detach(address);
+  m_devices.push_back({ address, &device });
+}
+
+void I2CBus::detach(uint8_t address) {
+  for (size_t i = 0; i < m_devices.size(); i++) {
+    if (m_devices[i].address == address) {
+      m_devices.erase(m_devices.begin() + i);
+      return;
+    }
+  }
+}
+
+void I2CBus::holdSda(uint8_t clocks) {
+  m_sdaHeld = true;
+  m_clocksToRelease = clocks;
+}
+
+void I2CBus::nackUntil(uint64_t time) {
+  m_nackUntil = time;
+}
+
+void I2CBus::powerCycle() {
+  m_sdaHeld = false;
+  m_clocksToRelease = 0;
+  for (const Slot& slot : m_devices) {
+    slot.device->reset();
+  }
+}
+
+void I2CBus::resetStatistics() {
+  m_transactions = 0;
+  m_failed = 0;
+  m_clears = 0;
+  m_busyUs = 0;
+}
+
+void I2CBus::reset() {
+  m_devices.clear();
+  m_running = false;
+  m_sdaHeld = false;
+  m_clocksToRelease = 0;
+  m_nackUntil = 0;
+  resetStatistics();
+}
+
+I2CDevice* I2CBus::find(uint8_t address) const {
+  for (const Slot& slot : m_devices) {
+    if (slot.address == address) {
+      return slot.device;
+    }
+  }
+  return nullptr;
+}
+
+// START + address + data bytes (9 clocks each) + STOP
+void I2CBus::charge(size_t bytes) {
+  const uint64_t us = ((bytes + 1) * 9 + 2) * 1000000ULL / m_frequency;
+  m_busyUs += us;
+  m_transactions++;
+  advance(us);
+}
+
+uint8_t I2CBus::address(uint8_t address, I2CDevice*& device) {
+  device = nullptr;
+
+  // Peripheral detached (after a bus clear without begin()) or SDA stuck low:
+  // the ESP32 driver reports a bus error / arbitration loss
+  if (!m_running || m_sdaHeld) {
+    m_failed++;
+    return 4;
+  }
+
+  device = find(address);
+  if (!device || now() < m_nackUntil) {
+    device = nullptr;
+    m_failed++;
+    return 2;
+  }
+  return 0;
+}
+
+// Open-drain line model behind digitalRead()/digitalWrite() of the bus pins
+void installPinHooks() {
+  setPinHooks(
+    [](uint8_t pin, uint8_t mode, uint8_t value) {
+      for (I2CBus& bus : s_buses) {
+        const uint8_t level = (mode == OUTPUT_OPEN_DRAIN || mode == OUTPUT) ? value : HIGH;
+        if (pin == bus.m_sclPin) {
+          // A held slave shifts out one bit per SCL pulse (rising edge)
+          if (bus.m_sclLevel == LOW && level == HIGH && bus.m_sdaHeld && bus.m_clocksToRelease > 0 &&
+              --bus.m_clocksToRelease == 0) {
+            bus.m_sdaHeld = false;
+          }
+          bus.m_sclLevel = level;
+          bus.m_clearing = true;
+        } else if (pin == bus.m_sdaPin) {
+          bus.m_sdaLevel = level;
+        }
+      }
+    },
+    [](uint8_t pin) -> int {
+      for (const I2CBus& bus : s_buses) {
+        if (pin == bus.m_sdaPin) {
+          return (bus.m_sdaLevel == HIGH && !bus.m_sdaHeld) ? HIGH : LOW;
+        }
+        if (pin == bus.m_sclPin) {
+          return bus.m_sclLevel;
+        }
+      }
+      return -1;
+    });
+}
+
+}  // namespace host
+
+using host::I2CBus;
+
+TwoWire Wire(0);
+TwoWire Wire1(1);
+
+TwoWire::TwoWire(uint8_t busNumber)
+  : m_busNumber(busNumber),
+    m_address(0),
+    m_txLength(0),
+    m_rxLength(0),
+    m_rxOffset(0) {
+}
+
+// Bus number as used by the firmware (1 or 2)
+static I2CBus& busOf(uint8_t busNumber) {
+  return host::i2cBus(busNumber + 1);
+}
+
+bool TwoWire::begin(int sda, int scl, uint32_t frequency) {
+  static bool hooksInstalled = false;
+  if (!hooksInstalled) {
+    host::installPinHooks();
+    hooksInstalled = true;
+  }
+
+  I2CBus& bus = busOf(m_busNumber);
+  if (bus.m_running) {
+    return true;  // Like the ESP32 core: an initialized bus is kept as is
+  }
+  bus.m_sdaPin = sda;
+  bus.m_sclPin = scl;
+  if (frequency) {
+    bus.m_frequency = frequency;
+  }
+  bus.m_running = true;
+  if (bus.m_clearing) {
+    bus.m_clears++;
+    bus.m_clearing = false;
+  }
+  return true;
+}
+
+bool TwoWire::end() {
+  busOf(m_busNumber).m_running = false;
+  return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency) {
+  busOf(m_busNumber).m_frequency = frequency;
+  return true;
+}
+
+void TwoWire::setTimeOut(uint16_t timeoutMs) {
+  (void)timeoutMs;
+}
+
+uint16_t TwoWire::getTimeOut() {
+  return 50;
+}
+
+void TwoWire::beginTransmission(uint16_t address) {
+  m_address = address;
+  m_txLength = 0;
+}
+
+size_t TwoWire::write(uint8_t value) {
+  if (m_txLength >= sizeof(m_tx)) {
+    return 0;
+  }
+  m_tx[m_txLength++] = value;
+  return 1;
+}
+
+// Virtual write(uint8_t) per byte, like the ESP32 core (subclasses see every byte)
+size_t TwoWire::write(const uint8_t* buffer, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    if (!write(buffer[i])) {
+      return i;
+    }
+  }
+  return size;
+}
+
+uint8_t TwoWire::endTransmission(bool sendStop) {
+  (void)sendStop;
+  I2CBus& bus = busOf(m_busNumber);
+  host::I2CDevice* device;
+
+  bus.charge(m_txLength);
+  const uint8_t result = bus.address(m_address, device);
+  if (result != 0) {
+    return result;
+  }
+  if (m_txLength > 0 && !device->write(m_tx, m_txLength)) {
+    bus.m_failed++;
+    return 3;  // Data NACK
+  }
+  return 0;
+}
+
+uint8_t TwoWire::endTransmission() {
+  return endTransmission(true);
+}
+
+size_t TwoWire::requestFrom(uint16_t address, size_t length, bool sendStop) {
+  (void)sendStop;
+  I2CBus& bus = busOf(m_busNumber);
+  host::I2CDevice* device;
+
+  m_rxLength = 0;
+  m_rxOffset = 0;
+  length = min(length, sizeof(m_rx));
+
+  bus.charge(length);
+  if (bus.address(address, device) != 0) {
+    return 0;
+  }
+  device->read(m_rx, length);
+  m_rxLength = length;
+  return length;
+}
+
+size_t TwoWire::requestFrom(uint16_t address, size_t length) {
+  return requestFrom(address, length, true);
+}
+
+int TwoWire::available() {
+  return (int)(m_rxLength - m_rxOffset);
+}
+
+int TwoWire::read() {
+  return m_rxOffset < m_rxLength ? m_rx[m_rxOffset++] : -1;
+}
+
+int TwoWire::peek() {
+  return m_rxOffset < m_rxLength ? m_rx[m_rxOffset] : -1;
+}
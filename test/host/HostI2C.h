@@ -0,0 +1,129 @@
+/*
+ * Host I2C Buses for ESP32 Weather Station host tests
+ * Wire / Wire1 stand-ins that route transactions to modelled devices on two
+ * buses, charge the bus time to the host clock and inject faults:
+ *  - stuck SDA: a slave holds SDA low (mid-byte) until it sees enough SCL
+ *    clocks from a bus clear - or forever, until the bus is power cycled
+ *  - NACK storm: every address is NACKed for a while (EMI, brown-out)
+ * The SDA/SCL pins given to TwoWire::begin() are modelled as open-drain
+ * lines, so clearI2CBus() bit-bangs against the same fault state.
+ */
+
+#ifndef HOST_I2C_H
+#define HOST_I2C_H
+
+#include <Wire.h>
+#include <stdint.h>
+#include <vector>
+
+namespace host {
+
+// Device on a modelled bus (address ACK is implied by attaching it)
+class I2CDevice {
+public:
+  virtual ~I2CDevice() {}
+
+  // Master wrote data after the address - return false to NACK
+  virtual bool write(const uint8_t* data, size_t length) = 0;
+
+  // Master reads length bytes
+  virtual void read(uint8_t* data, size_t length) = 0;
+
+  // Power cycle (supply switched off and on)
+  virtual void reset() {}
+};
+
+class I2CBus {
+public:
+  // Attach / remove a device (not owned)
+  void attach(uint8_t address, I2CDevice& device);
+  void detach(uint8_t address);
+
+  // A slave holds SDA low until 'clocks' SCL pulses (0 = until powerCycle())
+  void holdSda(uint8_t clocks);
+
+  // NACK every address until the given host time (µs)
+  void nackUntil(uint64_t time);
+
+  // Switch the bus supply off and on: releases SDA, resets all devices
+  void powerCycle();
+
+  inline bool isSdaHeld() const {
+    return m_sdaHeld;
+  }
+
+  // Master is attached (begin() called and not ended)
+  inline bool isRunning() const {
+    return m_running;
+  }
+
+  // Statistics
+  inline uint32_t getTransactions() const {
+    return m_transactions;
+  }
+
+  inline uint32_t getFailedTransactions() const {
+    return m_failed;
+  }
+
+  inline uint32_t getClears() const {
+    return m_clears;
+  }
+
+  inline uint64_t getBusyTimeUs() const {
+    return m_busyUs;
+  }
+
+  void resetStatistics();
+
+  // Remove devices and faults (between scenarios)
+  void reset();
+
+private:
+  friend class ::TwoWire;
+  friend void installPinHooks();
+
+  struct Slot {
+    uint8_t address;
+    I2CDevice* device;
+  };
+
+  std::vector<Slot> m_devices;
+  bool m_running = false;
+  uint32_t m_frequency = 100000;
+  int m_sdaPin = -1;
+  int m_sclPin = -1;
+
+  // Fault state
+  bool m_sdaHeld = false;
+  uint8_t m_clocksToRelease = 0;  // 0 while held = never
+  uint64_t m_nackUntil = 0;
+
+  // Master side of the lines while bit-banged as GPIO
+  uint8_t m_sclLevel = 1;
+  uint8_t m_sdaLevel = 1;
+  bool m_clearing = false;
+
+  uint32_t m_transactions = 0;
+  uint32_t m_failed = 0;
+  uint32_t m_clears = 0;
+  uint64_t m_busyUs = 0;
+
+  I2CDevice* find(uint8_t address) const;
+
+  // Bus time of a transaction with 'bytes' data bytes, charged to the clock
+  void charge(size_t bytes);
+
+  // Result of addressing a device (0 ok, 2 address NACK, 4 bus error)
+  uint8_t address(uint8_t address, I2CDevice*& device);
+};
+
+// Bus behind Wire (1) / Wire1 (2)
+I2CBus& i2cBus(uint8_t busNumber);
+
+// Route the bus pins to the line model (done by the first TwoWire::begin())
+void installPinHooks();
+
+}  // namespace host
+
+#endif // HOST_I2C_H
@@ -0,0 +1,373 @@
+/*
+ * Host Network for ESP32 Weather Station host tests
+ * WiFi link state, WiFiClient on host TCP sockets and the HTTPClient
+ * stand-in (see stubs/WiFi.h, stubs/HTTPClient.h)
+ */
+
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <lwip/sockets.h>
+#include <lwip/netdb.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+
+// ============================================================================
+// WiFi link
+// ============================================================================
+WiFiClass WiFi;
+
+static wl_status_t s_status = WL_CONNECTED;
+static int8_t s_rssi = -60;
+
+void host::setWiFiStatus(wl_status_t status) {
+  s_status = status;
+}
+
+void host::setRssi(int8_t rssi) {
+  s_rssi = rssi;
+}
+
+bool WiFiClass::mode(wifi_mode_t mode) {
+  (void)mode;
+  return true;
+}
+
+wl_status_t WiFiClass::begin(const char* ssid, const char* password) {
+  (void)ssid;
+  (void)password;
+  m_connectAttempts++;
+  return s_status;
+}
+
+bool WiFiClass::reconnect() {
+  m_connectAttempts++;
+  return true;
+}
+
+bool WiFiClass::disconnect() {
+  return true;
+}
+
+bool WiFiClass::setSleep(bool enabled) {
+  (void)enabled;
+  return true;
+}
+
+wl_status_t WiFiClass::status() {
+  return s_status;
+}
+
+int8_t WiFiClass::RSSI() {
+  return s_status == WL_CONNECTED ? s_rssi : 0;
+}
+
+IPAddress WiFiClass::localIP() {
+  return s_status == WL_CONNECTED ? IPAddress(127, 0, 0, 1) : IPAddress();
+}
+
+// ============================================================================
+// WiFiClient
+// ============================================================================
+WiFiClient::~WiFiClient() {
+  stop();
+}
+
+int WiFiClient::connect(const char* host, uint16_t port, int32_t timeoutMs) {
+  stop();
+
+  addrinfo hints = {};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* result = nullptr;
+  char service[8];
+  snprintf(service, sizeof(service), "%u", port);
+  if (getaddrinfo(host, service, &hints, &result) != 0 || !result) {
+    return 0;
+  }
+
+  const int fd = socket(AF_INET, SOCK_STREAM, 0);
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  int rc = ::connect(fd, result->ai_addr, result->ai_addrlen);
+  freeaddrinfo(result);
+  if (rc != 0 && errno == EINPROGRESS) {
+    pollfd waiting = { fd, POLLOUT, 0 };
+    int error = ETIMEDOUT;
+    socklen_t length = sizeof(error);
+    if (poll(&waiting, 1, timeoutMs) == 1) {
+      getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &length);
+    }
+    rc = error == 0 ? 0 : -1;
+  }
+  if (rc != 0) {
+    close(fd);
+    return 0;
+  }
+
+  fcntl(fd, F_SETFL, 0);
+  attach(fd);
+  return 1;
+}
+
+void WiFiClient::attach(int fd) {
+  stop();
+  m_fd = fd;
+  const int one = 1;
+  setsockopt(m_fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+}
+
+size_t WiFiClient::write(uint8_t value) {
+  return write(&value, 1);
+}
+
+size_t WiFiClient::write(const uint8_t* buffer, size_t size) {
+  size_t written = 0;
+  while (m_fd >= 0 && written < size) {
+    pollfd waiting = { m_fd, POLLOUT, 0 };
+    if (poll(&waiting, 1, m_timeoutMs) != 1) {
+      break;
+    }
+    const ssize_t count = send(m_fd, buffer + written, size - written, MSG_NOSIGNAL);
+    if (count <= 0) {
+      break;
+    }
+    written += count;
+  }
+  return written;
+}
+
+int WiFiClient::available() {
+  int count = 0;
+  if (m_fd < 0 || ioctl(m_fd, FIONREAD, &count) != 0) {
+    return 0;
+  }
+  return count;
+}
+
+int WiFiClient::read() {
+  uint8_t value;
+  return read(&value, 1) == 1 ? value : -1;
+}
+
+int WiFiClient::read(uint8_t* buffer, size_t size) {
+  if (m_fd < 0) {
+    return -1;
+  }
+  const ssize_t count = recv(m_fd, buffer, size, MSG_DONTWAIT);
+  return count > 0 ? (int)count : -1;
+}
+
+int WiFiClient::peek() {
+  uint8_t value;
+  if (m_fd < 0 || recv(m_fd, &value, 1, MSG_DONTWAIT | MSG_PEEK) != 1) {
+    return -1;
+  }
+  return value;
+}
+
+uint8_t WiFiClient::connected() {
+  if (m_fd < 0) {
+    return 0;
+  }
+  uint8_t value;
+  const ssize_t count = recv(m_fd, &value, 1, MSG_DONTWAIT | MSG_PEEK);
+  if (count == 0 || (count < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+    // Peer closed: still "connected" while unread data is buffered
+    return available() > 0;
+  }
+  return 1;
+}
+
+void WiFiClient::stop() {
+  if (m_fd >= 0) {
+    close(m_fd);
+    m_fd = -1;
+  }
+}
+
+void WiFiClient::setNoDelay(bool enabled) {
+  const int value = enabled;
+  if (m_fd >= 0) {
+    setsockopt(m_fd, IPPROTO_TCP, TCP_NODELAY, &value, sizeof(value));
+  }
+}
+
+// ============================================================================
+// HTTPClient
+// ============================================================================
+
+// "http://host[:port]/path"
+bool HTTPClient::begin(WiFiClient& client, const String& url) {
+  const char* text = url.c_str();
+  if (strncmp(text, "http://", 7) != 0) {
+    return false;
+  }
+  text += 7;
+  const char* path = strchr(text, '/');
+  const std::string authority = path ? std::string(text, path - text) : std::string(text);
+  const size_t colon = authority.find(':');
+
+  const std::string host = authority.substr(0, colon);
+  const uint16_t port = colon == std::string::npos ? 80 : (uint16_t)atoi(authority.c_str() + colon + 1);
+
+  // A kept-alive connection only serves the same origin
+  if (m_client != &client || host != m_host || port != m_port) {
+    client.stop();
+  }
+  m_client = &client;
+  m_host = host;
+  m_port = port;
+  m_path = path ? path : "/";
+  m_requestHeaders.clear();
+  m_headers.clear();
+  return true;
+}
+
+void HTTPClient::end() {
+  if (m_client && (!m_reuse || !m_canReuse)) {
+    m_client->stop();
+  }
+}
+
+void HTTPClient::addHeader(const char* name, const char* value) {
+  m_requestHeaders += name;
+  m_requestHeaders += ": ";
+  m_requestHeaders += value;
+  m_requestHeaders += "\r\n";
+}
+
+void HTTPClient::collectHeaders(const char* headerKeys[], size_t count) {
+  m_headerKeys.assign(headerKeys, headerKeys + count);
+}
+
+String HTTPClient::header(const char* name) {
+  for (const auto& header : m_headers) {
+    if (!strcasecmp(header.first.c_str(), name)) {
+      return String(header.second);
+    }
+  }
+  return String("");
+}
+
+int HTTPClient::GET() {
+  return sendRequest("GET", nullptr, 0);
+}
+
+int HTTPClient::POST(uint8_t* payload, size_t size) {
+  return sendRequest("POST", payload, size);
+}
+
+// One line of the response, waiting up to the timeout for each byte
+bool HTTPClient::readLine(std::string& line) {
+  line.clear();
+  for (uint32_t idle = 0; idle < m_timeoutMs * 10U;) {
+    const int value = m_client->read();
+    if (value < 0) {
+      if (!m_client->connected()) {
+        return false;
+      }
+      usleep(100);
+      idle++;
+      continue;
+    }
+    idle = 0;
+    if (value == '\n') {
+      return true;
+    }
+    if (value != '\r') {
+      line += (char)value;
+    }
+  }
+  return false;
+}
+
+int HTTPClient::sendRequest(const char* method, const uint8_t* payload, size_t size) {
+  m_headers.clear();
+  m_canReuse = false;
+  if (!m_client) {
+    return HTTPC_ERROR_NOT_CONNECTED;
+  }
+
+  if (!m_client->connected()) {
+    m_client->stop();
+    if (!m_client->connect(m_host.c_str(), m_port, m_timeoutMs)) {
+      return HTTPC_ERROR_CONNECTION_REFUSED;
+    }
+    m_connects++;
+  }
+  m_client->setTimeout(m_timeoutMs);
+
+  char head[512];
+  const int length = snprintf(head, sizeof(head),
+                              "%s %s HTTP/1.1\r\n"
+                              "Host: %s\r\n"
+                              "Connection: %s\r\n"
+                              "Content-Length: %zu\r\n"
+                              "%s\r\n",
+                              method, m_path.c_str(), m_host.c_str(), m_reuse ? "keep-alive" : "close", size,
+                              m_requestHeaders.c_str());
+  if (m_client->write((const uint8_t*)head, length) != (size_t)length) {
+    m_client->stop();
+    return HTTPC_ERROR_SEND_HEADER_FAILED;
+  }
+  if (size > 0 && m_client->write(payload, size) != size) {
+    m_client->stop();
+    return HTTPC_ERROR_SEND_PAYLOAD_FAILED;
+  }
+
+  // Status line and headers
+  std::string line;
+  if (!readLine(line)) {
+    const bool lost = !m_client->connected();
+    m_client->stop();
+    return lost ? HTTPC_ERROR_CONNECTION_LOST : HTTPC_ERROR_READ_TIMEOUT;
+  }
+  int status = 0;
+  if (sscanf(line.c_str(), "HTTP/1.%*d %d", &status) != 1) {
+    m_client->stop();
+    return HTTPC_ERROR_CONNECTION_LOST;
+  }
+
+  size_t contentLength = 0;
+  bool keepAlive = true;
+  while (readLine(line) && !line.empty()) {
+    const size_t colon = line.find(':');
+    if (colon == std::string::npos) {
+      continue;
+    }
+    size_t start = colon + 1;
+    while (start < line.size() && line[start] == ' ') {
+      start++;
+    }
+    const std::string name = line.substr(0, colon);
+    const std::string value = line.substr(start);
+    if (!strcasecmp(name.c_str(), "Content-Length")) {
+      contentLength = strtoul(value.c_str(), nullptr, 10);
+    } else if (!strcasecmp(name.c_str(), "Connection")) {
+      keepAlive = strcasecmp(value.c_str(), "close") != 0;
+    }
+    for (const std::string& key : m_headerKeys) {
+      if (!strcasecmp(name.c_str(), key.c_str())) {
+        m_headers.emplace_back(key, value);
+      }
+    }
+  }
+
+  // Body (discarded)
+  for (uint32_t idle = 0; contentLength > 0 && idle < m_timeoutMs * 10U;) {
+    uint8_t buffer[256];
+    const int count = m_client->read(buffer, min(contentLength, sizeof(buffer)));
+    if (count <= 0) {
+      if (!m_client->connected()) {
+        break;
+      }
+      usleep(100);
+      idle++;
+      continue;
+    }
+    contentLength -= count;
+  }
+
+  m_canReuse = keepAlive && contentLength == 0;
+  return status;
+}
@@ -0,0 +1,60 @@
+/*
+ * Host Test Helpers for ESP32 Weather Station host tests
+ * CHECK() counts failures without stopping the test, report() prints
+ * measurements, finish() prints the verdict and ends the process.
+ */
+
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+#include "Host.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <chrono>
+
+namespace host {
+
+inline int& failures() {
+  static int count = 0;
+  return count;
+}
+
+// Measurement line (indented under the test name)
+inline void report(const char* format, ...) __attribute__((format(printf, 1, 2)));
+inline void report(const char* format, ...) {
+  va_list args;
+  va_start(args, format);
+  printf("  ");
+  vprintf(format, args);
+  printf("\n");
+  va_end(args);
+}
+
+// Host time of a callable in ns (steady clock) - benchmarks run with the virtual clock
+template <class Function>
+double measureNs(Function&& function) {
+  const auto start = std::chrono::steady_clock::now();
+  function();
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+[[noreturn]] inline void finish(const char* name) {
+  if (failures() == 0) {
+    printf("%s: ALL PASSED\n", name);
+  } else {
+    printf("%s: FAILED (%d)\n", name, failures());
+  }
+  exit(failures() == 0 ? 0 : 1);
+}
+
+}  // namespace host
+
+#define CHECK(condition)                                                         \
+  do {                                                                           \
+    if (!(condition)) {                                                          \
+      printf("  FAIL %s:%d: %s\n", __FILE__, __LINE__, #condition);              \
+      host::failures()++;                                                        \
+    }                                                                            \
+  } while (0)
+
+#endif // HOST_TEST_H
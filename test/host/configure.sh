@@ -0,0 +1,30 @@
+#!/bin/sh
+# Generate a host test Config.h from Config.example.h
+# Usage: configure.sh <Config.example.h> <Config.h> [NAME=value ...]
+# Each override replaces the value of a '#define NAME' or 'constexpr ... NAME ='
+# line (array initializers spanning several lines included); an override that
+# matches nothing is an error (the option was renamed)
+set -e
+
+input=$1
+output=$2
+shift 2
+
+cp "$input" "$output.tmp"
+for override in "$@"; do
+  name=${override%%=*}
+  value=${override#*=}
+  awk -v name="$name" -v value="$value" '
+    skip { skip = $0 !~ /;/; next }
+    $0 ~ "^#define " name "[ \t]" { print "#define " name " " value; found = 1; next }
+    $0 ~ "^constexpr[^=]*[ \t*]" name "(\\[\\])?[ \t]*=" {
+      found = 1
+      if ($0 !~ /;/) { sub(/=.*$/, "= " value ";"); print; skip = 1; next }
+      sub(/=[^;]*;/, "= " value ";")
+    }
+    { print }
+    END { if (!found) exit 1 }
+  ' "$output.tmp" > "$output.next" || { echo "configure.sh: no option $name in $input" >&2; rm -f "$output.tmp" "$output.next"; exit 1; }
+  mv "$output.next" "$output.tmp"
+done
+mv "$output.tmp" "$output"
@@ -0,0 +1,67 @@
+/*
+ * Host build of the station's HTTP routes for tools/http_bench.py --loopback
+ *
+ * WebServerManager is served by HttpServer on the host's sockets
+ * (HTTP_SERVER_PORT, see the Makefile) while SensorManager reads a modelled
+ * BME280 and SampleHistory records, like loop() does. The history is filled
+ * with 24 h of readings on the virtual clock first, so chart queries cover
+ * a full window; then the clock follows the host's and the server runs until
+ * it is killed. The origin is printed as the first line on stdout.
+ * Not a test - built with 'make http-server', never run by 'make'.
+ */
+
+#include "Host.h"
+#include "HostI2C.h"
+#include "HostBme280.h"
+#include "WebServerManager.h"
+#include "EventLog.h"
+#include <memory>
+#include <unistd.h>
+
+constexpr useconds_t IDLE_POLL_US = 100;  // Between handleClient() calls, like a busy loop()
+
+static host::Bme280Model s_bme(48);
+static uint32_t s_step = 0;
+
+// Read when due and record, with slowly changing weather
+static void readSensors(SensorManager& sensorManager, SampleHistory& history) {
+  if ((int32_t)(sensorManager.getNextReadTime(millis()) - millis()) > 0) {
+    return;
+  }
+  s_bme.temperature = 15.0 + 8.0 * sin(s_step * 6.2832 / 1440);
+  s_bme.pressure = 101000.0 + 300.0 * sin(s_step * 6.2832 / 4000);
+  s_step++;
+  if (sensorManager.readSensors()) {
+    history.record(sensorManager.getSensorData(), millis());
+  }
+}
+
+int main() {
+  eventLog.begin();
+  host::i2cBus(1).attach(BME_I2C_ADDR, s_bme);
+
+  // Leaked: the server runs until the process is killed
+  SensorManager* sensorManager = new SensorManager();
+  SampleHistory* history = new SampleHistory();
+  LoopGuard* loopGuard = new LoopGuard();
+  Scheduler* scheduler = new Scheduler();
+  sensorManager->begin();
+
+  // 24 h of history on the virtual clock
+  while (history->getCount() < HISTORY_CAPACITY) {
+    host::advance(HISTORY_INTERVAL_MS * 1000ULL);
+    readSensors(*sensorManager, *history);
+  }
+
+  WebServerManager* server = new WebServerManager(*sensorManager, *history, *loopGuard, *scheduler);
+  server->begin();
+  host::useRealTime(true);
+  printf("http://127.0.0.1:%u\n", HTTP_SERVER_PORT);
+  fflush(stdout);
+
+  for (;;) {
+    readSensors(*sensorManager, *history);
+    server->handleClient();
+    usleep(IDLE_POLL_US);
+  }
+}
@@ -0,0 +1,36 @@
+/*
+ * Host stand-in for the Adafruit BME280 library
+ * Reads the raw data registers of the modelled chip (HostBme280.h) through
+ * the TwoWire it was given, so every access is a real bus transaction.
+ */
+
+#ifndef HOST_ADAFRUIT_BME280_H
+#define HOST_ADAFRUIT_BME280_H
+
+#include <Wire.h>
+
+class Adafruit_BME280 {
+public:
+  enum sensor_sampling { SAMPLING_NONE = 0, SAMPLING_X1, SAMPLING_X2, SAMPLING_X4, SAMPLING_X8, SAMPLING_X16 };
+  enum sensor_mode { MODE_SLEEP = 0, MODE_FORCED = 1, MODE_NORMAL = 3 };
+  enum sensor_filter { FILTER_OFF = 0, FILTER_X2, FILTER_X4, FILTER_X8, FILTER_X16 };
+  enum standby_duration {
+    STANDBY_MS_0_5 = 0, STANDBY_MS_62_5 = 1, STANDBY_MS_125 = 2, STANDBY_MS_250 = 3,
+    STANDBY_MS_500 = 4, STANDBY_MS_1000 = 5, STANDBY_MS_10 = 6, STANDBY_MS_20 = 7
+  };
+
+  bool begin(uint8_t address, TwoWire* wire);
+  float readTemperature();
+  float readPressure();
+  float readHumidity();
+  uint32_t sensorID();
+
+private:
+  uint8_t m_address = 0;
+  TwoWire* m_wire = nullptr;
+  uint8_t m_chipId = 0;
+
+  bool readRegisters(uint8_t reg, uint8_t* data, uint8_t length);
+};
+
+#endif // HOST_ADAFRUIT_BME280_H
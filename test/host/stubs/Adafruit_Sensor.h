@@ -0,0 +1,8 @@
+/*
+ * Host stand-in for Adafruit_Sensor.h (nothing used directly)
+ */
+
+#ifndef HOST_ADAFRUIT_SENSOR_H
+#define HOST_ADAFRUIT_SENSOR_H
+
+#endif // HOST_ADAFRUIT_SENSOR_H
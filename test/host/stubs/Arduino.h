@@ -0,0 +1,182 @@
+/*
+ * Host stand-in for the ESP32 Arduino core (Arduino.h + FreeRTOS basics)
+ * Declares the subset of the core API the firmware uses. Implemented in
+ * HostArduino.cpp on top of the host clock and threads (see Host.h).
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <type_traits>
+
+#define PROGMEM
+#define PGM_P const char*
+#define IRAM_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define OUTPUT_OPEN_DRAIN 0x13
+
+typedef bool boolean;
+
+// Time (host clock, see Host.h)
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+// GPIO (routed to the pin hooks of the host environment)
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+
+size_t strlcpy(char* destination, const char* source, size_t size);
+
+template <class T, class U>
+auto min(T a, U b) -> typename std::decay<decltype(a < b ? a : b)>::type {
+  return a < b ? a : b;
+}
+
+template <class T, class U>
+auto max(T a, U b) -> typename std::decay<decltype(a > b ? a : b)>::type {
+  return a > b ? a : b;
+}
+
+#define constrain(amount, low, high) ((amount) < (low) ? (low) : ((amount) > (high) ? (high) : (amount)))
+
+// Minimal String (std::string backed)
+class String {
+public:
+  String(const char* text = "") : m_text(text ? text : "") {}
+  String(const std::string& text) : m_text(text) {}
+  explicit String(int value) : m_text(std::to_string(value)) {}
+
+  const char* c_str() const { return m_text.c_str(); }
+  size_t length() const { return m_text.length(); }
+  bool isEmpty() const { return m_text.empty(); }
+  bool operator==(const char* text) const { return m_text == text; }
+  bool operator==(const String& other) const { return m_text == other.m_text; }
+  bool operator!=(const char* text) const { return m_text != text; }
+  String& operator+=(const char* text) { m_text += text; return *this; }
+  String& operator+=(const String& other) { m_text += other.m_text; return *this; }
+
+private:
+  std::string m_text;
+};
+
+class Print {
+public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t value) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+  size_t print(const char* text);
+  size_t println(const char* text = "");
+  size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+  virtual void flush() {}
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+};
+
+// Serial port - output goes to stdout when HOST_SERIAL=1 is set in the environment
+class HardwareSerial : public Stream {
+public:
+  void begin(uint32_t baud) { (void)baud; }
+  explicit operator bool() const { return true; }
+  using Print::write;
+  size_t write(uint8_t value) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+};
+
+extern HardwareSerial Serial;
+
+class EspClass {
+public:
+  void restart();
+  uint32_t getFreeHeap();
+  uint32_t getMinFreeHeap();
+  uint32_t getMaxAllocHeap();
+  uint32_t getHeapSize();
+  uint32_t getCycleCount();
+};
+
+extern EspClass ESP;
+
+class IPAddress {
+public:
+  IPAddress() : m_address(0) {}
+  IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d)
+    : m_address(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+  String toString() const;
+  operator uint32_t() const { return m_address; }
+
+private:
+  uint32_t m_address;
+};
+
+// Critical sections - a spinlock per mux (interrupts cannot be masked on the host)
+struct portMUX_TYPE {
+  std::atomic<bool> locked;
+  portMUX_TYPE() : locked(false) {}
+  portMUX_TYPE(const portMUX_TYPE&) : locked(false) {}
+};
+
+#define portMUX_INITIALIZER_UNLOCKED portMUX_TYPE()
+
+void hostEnterCritical(portMUX_TYPE* mux);
+void hostExitCritical(portMUX_TYPE* mux);
+
+#define portENTER_CRITICAL(mux) hostEnterCritical(mux)
+#define portEXIT_CRITICAL(mux) hostExitCritical(mux)
+#define portENTER_CRITICAL_SAFE(mux) hostEnterCritical(mux)
+#define portEXIT_CRITICAL_SAFE(mux) hostExitCritical(mux)
+
+// FreeRTOS (pulled in by Arduino.h on ESP32) - tasks are host threads
+typedef void* TaskHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+BaseType_t xTaskCreatePinnedToCore(void (*function)(void*), const char* name, uint32_t stackDepth,
+                                   void* parameter, UBaseType_t priority, TaskHandle_t* handle,
+                                   BaseType_t core);
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticksToWait);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t semaphore, TickType_t ticksToWait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t semaphore);
+
+#endif // HOST_ARDUINO_H
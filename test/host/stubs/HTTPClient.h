@@ -0,0 +1,64 @@
+/*
+ * Host stand-in for HTTPClient.h (ESP32 HTTPClient subset)
+ * HTTP/1.1 over a WiFiClient with keep-alive reuse, request headers,
+ * collected response headers and a response timeout. Response bodies are
+ * read and discarded. Implemented in HostNetwork.cpp.
+ */
+
+#ifndef HOST_HTTP_CLIENT_H
+#define HOST_HTTP_CLIENT_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <string>
+#include <vector>
+
+#define HTTPC_ERROR_CONNECTION_REFUSED (-1)
+#define HTTPC_ERROR_SEND_HEADER_FAILED (-2)
+#define HTTPC_ERROR_SEND_PAYLOAD_FAILED (-3)
+#define HTTPC_ERROR_NOT_CONNECTED (-4)
+#define HTTPC_ERROR_CONNECTION_LOST (-5)
+#define HTTPC_ERROR_READ_TIMEOUT (-11)
+
+class HTTPClient {
+public:
+  bool begin(WiFiClient& client, const String& url);
+  void end();
+
+  void setReuse(bool reuse) {
+    m_reuse = reuse;
+  }
+  void setTimeout(uint16_t timeoutMs) {
+    m_timeoutMs = timeoutMs;
+  }
+
+  void addHeader(const char* name, const char* value);
+  void collectHeaders(const char* headerKeys[], size_t count);
+  String header(const char* name);
+
+  int GET();
+  int POST(uint8_t* payload, size_t size);
+
+  // TCP connections opened (host statistics)
+  uint32_t getConnects() const {
+    return m_connects;
+  }
+
+private:
+  WiFiClient* m_client = nullptr;
+  std::string m_host;
+  uint16_t m_port = 80;
+  std::string m_path;
+  std::string m_requestHeaders;
+  std::vector<std::string> m_headerKeys;
+  std::vector<std::pair<std::string, std::string>> m_headers;
+  bool m_reuse = true;
+  bool m_canReuse = false;
+  uint16_t m_timeoutMs = 5000;
+  uint32_t m_connects = 0;
+
+  int sendRequest(const char* method, const uint8_t* payload, size_t size);
+  bool readLine(std::string& line);
+};
+
+#endif // HOST_HTTP_CLIENT_H
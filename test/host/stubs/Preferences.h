@@ -0,0 +1,24 @@
+/*
+ * Host stand-in for the ESP32 Preferences library (in-memory NVS)
+ */
+
+#ifndef HOST_PREFERENCES_H
+#define HOST_PREFERENCES_H
+
+#include <Arduino.h>
+
+class Preferences {
+public:
+  bool begin(const char* name, bool readOnly = false, const char* partition = nullptr);
+  void end();
+  size_t getString(const char* key, char* value, size_t maxLength);
+  size_t putString(const char* key, const char* value);
+  uint8_t getUChar(const char* key, uint8_t defaultValue = 0);
+  size_t putUChar(const char* key, uint8_t value);
+
+private:
+  std::string m_namespace;
+  bool m_readOnly = false;
+};
+
+#endif // HOST_PREFERENCES_H
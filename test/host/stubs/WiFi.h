@@ -0,0 +1,94 @@
+/*
+ * Host stand-in for WiFi.h (station interface + WiFiClient)
+ * The link state is set by the test (host::setWiFiStatus / setRssi);
+ * WiFiClient is a blocking TCP socket of the host. Implemented in
+ * HostNetwork.cpp.
+ */
+
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+#include <Arduino.h>
+
+typedef enum {
+  WL_IDLE_STATUS = 0,
+  WL_NO_SSID_AVAIL = 1,
+  WL_CONNECTED = 3,
+  WL_CONNECT_FAILED = 4,
+  WL_CONNECTION_LOST = 5,
+  WL_DISCONNECTED = 6,
+} wl_status_t;
+
+typedef enum {
+  WIFI_OFF = 0,
+  WIFI_STA = 1,
+} wifi_mode_t;
+
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t mode);
+  wl_status_t begin(const char* ssid, const char* password);
+  bool reconnect();
+  bool disconnect();
+  bool setSleep(bool enabled);
+  wl_status_t status();
+  int8_t RSSI();
+  IPAddress localIP();
+
+  // Calls to begin()/reconnect() (host statistics)
+  uint32_t getConnectAttempts() const {
+    return m_connectAttempts;
+  }
+
+private:
+  uint32_t m_connectAttempts = 0;
+};
+
+extern WiFiClass WiFi;
+
+class WiFiClient : public Stream {
+public:
+  WiFiClient() {}
+  ~WiFiClient();
+  WiFiClient(const WiFiClient&) = delete;
+  WiFiClient& operator=(const WiFiClient&) = delete;
+
+  // Blocking connect with timeout (ms), returns 1 on success
+  int connect(const char* host, uint16_t port, int32_t timeoutMs = 3000);
+
+  // Take over a connected socket
+  void attach(int fd);
+
+  using Print::write;
+  size_t write(uint8_t value) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  int available() override;
+  int read() override;
+  int read(uint8_t* buffer, size_t size);
+  int peek() override;
+  uint8_t connected();
+  void stop();
+  void setNoDelay(bool enabled);
+  void setTimeout(uint32_t timeoutMs) {
+    m_timeoutMs = timeoutMs;
+  }
+  explicit operator bool() {
+    return connected();
+  }
+
+private:
+  int m_fd = -1;
+  uint32_t m_timeoutMs = 3000;
+};
+
+namespace host {
+
+// Link state reported by WiFi.status() (default WL_CONNECTED)
+void setWiFiStatus(wl_status_t status);
+
+// Signal strength reported by WiFi.RSSI() (default -60 dBm)
+void setRssi(int8_t rssi);
+
+}  // namespace host
+
+#endif // HOST_WIFI_H
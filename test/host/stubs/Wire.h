@@ -0,0 +1,71 @@
+/*
+ * Host stand-in for the ESP32 Wire library
+ * Mirrors core 3.x: HardwareI2C virtuals plus non-virtual convenience
+ * overloads. Transactions go to the modelled buses of HostI2C.cpp.
+ */
+
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+
+class HardwareI2C : public Stream {
+public:
+  virtual bool end() = 0;
+  virtual bool setClock(uint32_t frequency) = 0;
+  virtual void beginTransmission(uint16_t address) = 0;
+  virtual uint8_t endTransmission(bool sendStop) = 0;
+  virtual uint8_t endTransmission(void) = 0;
+  virtual size_t requestFrom(uint16_t address, size_t length, bool sendStop) = 0;
+  virtual size_t requestFrom(uint16_t address, size_t length) = 0;
+};
+
+class TwoWire : public HardwareI2C {
+public:
+  explicit TwoWire(uint8_t busNumber);
+
+  bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+  bool end() override;
+  bool setClock(uint32_t frequency) override;
+  void setTimeOut(uint16_t timeoutMs);
+  uint16_t getTimeOut();
+
+  void beginTransmission(uint16_t address) override;
+  void beginTransmission(uint8_t address) { beginTransmission((uint16_t)address); }
+  void beginTransmission(int address) { beginTransmission((uint16_t)address); }
+  uint8_t endTransmission(bool sendStop) override;
+  uint8_t endTransmission(void) override;
+
+  size_t requestFrom(uint16_t address, size_t length, bool sendStop) override;
+  size_t requestFrom(uint16_t address, size_t length) override;
+  uint8_t requestFrom(uint8_t address, uint8_t length) { return requestFrom((uint16_t)address, (size_t)length, true); }
+  uint8_t requestFrom(uint8_t address, uint8_t length, uint8_t sendStop) {
+    return requestFrom((uint16_t)address, (size_t)length, (bool)sendStop);
+  }
+  uint8_t requestFrom(int address, int length) { return requestFrom((uint16_t)address, (size_t)length, true); }
+
+  using Print::write;
+  size_t write(uint8_t value) override;
+  size_t write(const uint8_t* buffer, size_t size) override;
+  int available() override;
+  int read() override;
+  int peek() override;
+
+  inline uint8_t getBusNumber() const {
+    return m_busNumber;
+  }
+
+private:
+  uint8_t m_busNumber;
+  uint16_t m_address;
+  uint8_t m_tx[128];
+  size_t m_txLength;
+  uint8_t m_rx[128];
+  size_t m_rxLength;
+  size_t m_rxOffset;
+};
+
+extern TwoWire Wire;
+extern TwoWire Wire1;
+
+#endif // HOST_WIRE_H
@@ -0,0 +1,38 @@
+/*
+ * Host stand-in for esp_heap_caps.h
+ * Reports a modelled 300 KB heap minus the live operator new allocations
+ * of the host process (counted in HostArduino.cpp). operator new calls the
+ * allocation hook like heap_caps_malloc() does with CONFIG_HEAP_USE_HOOKS.
+ */
+
+#ifndef HOST_ESP_HEAP_CAPS_H
+#define HOST_ESP_HEAP_CAPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <esp_timer.h>
+
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_DEFAULT (1 << 12)
+
+typedef struct {
+  size_t total_free_bytes;
+  size_t total_allocated_bytes;
+  size_t largest_free_block;
+  size_t minimum_free_bytes;
+  size_t allocated_blocks;
+  size_t free_blocks;
+  size_t total_blocks;
+} multi_heap_info_t;
+
+void heap_caps_get_info(multi_heap_info_t* info, uint32_t caps);
+size_t heap_caps_get_minimum_free_size(uint32_t caps);
+
+// Until stop, the minimum free size is the one since start
+esp_err_t heap_caps_monitor_local_minimum_free_size_start(void);
+esp_err_t heap_caps_monitor_local_minimum_free_size_stop(void);
+
+// Defined by the application, if at all
+__attribute__((weak)) void esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps);
+
+#endif // HOST_ESP_HEAP_CAPS_H
@@ -0,0 +1,22 @@
+/*
+ * Host stand-in for esp_task_wdt.h (feeds are counted, see Host.h)
+ */
+
+#ifndef HOST_ESP_TASK_WDT_H
+#define HOST_ESP_TASK_WDT_H
+
+#include <stdint.h>
+#include <esp_timer.h>
+
+typedef struct {
+  uint32_t timeout_ms;
+  uint32_t idle_core_mask;
+  bool trigger_panic;
+} esp_task_wdt_config_t;
+
+esp_err_t esp_task_wdt_init(const esp_task_wdt_config_t* config);
+esp_err_t esp_task_wdt_reconfigure(const esp_task_wdt_config_t* config);
+esp_err_t esp_task_wdt_add(void* task);
+esp_err_t esp_task_wdt_reset(void);
+
+#endif // HOST_ESP_TASK_WDT_H
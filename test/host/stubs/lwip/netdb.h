@@ -0,0 +1,10 @@
+/*
+ * Host stand-in for lwip/netdb.h (resolver of the host)
+ */
+
+#ifndef HOST_LWIP_NETDB_H
+#define HOST_LWIP_NETDB_H
+
+#include <netdb.h>
+
+#endif // HOST_LWIP_NETDB_H
@@ -0,0 +1,16 @@
+/*
+ * Host stand-in for lwip/sockets.h (BSD sockets of the host)
+ */
+
+#ifndef HOST_LWIP_SOCKETS_H
+#define HOST_LWIP_SOCKETS_H
+
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#endif // HOST_LWIP_SOCKETS_H
@@ -0,0 +1,211 @@
+/*
+ * Adaptive sampling: samples saved and reconstruction error on a day trace
+ *
+ * A synthetic 24 h trace (diurnal temperature and humidity, a cold front
+ * with a pressure drop at 15:00, sunrise/sunset light with passing clouds)
+ * drives the BME280 and BH1750 models. SensorManager runs with adaptive
+ * sampling; every second the published values (held between publishes, as
+ * a client sees them) are compared with the trace. Reported per sensor:
+ * reads against fixed 1 s and 5 s sampling, and the largest and mean
+ * reconstruction error - also for fixed-interval sampling with the same read
+ * budget, held the same way.
+ */
+
+#include "HostTest.h"
+#include "HostI2C.h"
+#include "HostBme280.h"
+#include "HostBh1750.h"
+#include "SensorManager.h"
+#include "EventLog.h"
+#include <memory>
+#include <random>
+
+constexpr uint64_t MS = 1000;
+constexpr uint32_t DAY_S = 24 * 3600;
+
+struct Environment {
+  double temperature;
+  double humidity;
+  double pressure;
+  double light;
+};
+
+// Cloud cover: random dips of the daylight, changing every few minutes
+static double s_cloudFactor[DAY_S / 300 + 1];
+
+static double logistic(double x) {
+  return 1.0 / (1.0 + exp(-x));
+}
+
+static Environment trace(double t) {
+  const double hour = t / 3600.0;
+  const double front = logistic((hour - 15.0) * 6.0);  // ~20 min transition
+
+  Environment env;
+  env.temperature = 12.0 + 6.0 * sin(2 * M_PI * (hour - 9.0) / 24.0) - 4.0 * front;
+  env.humidity = 70.0 - 2.0 * (env.temperature - 12.0) + 10.0 * front;
+  env.pressure = 101300.0 + 40.0 * sin(2 * M_PI * hour / 12.0) - 300.0 * logistic((hour - 14.0) * 1.5);
+
+  const double sun = sin(M_PI * (hour - 6.0) / 13.0);  // 06:00 - 19:00
+  const double cloud = s_cloudFactor[(uint32_t)t / 300];
+  env.light = sun > 0 ? 60000.0 * pow(sun, 1.5) * cloud : 0.0;
+  return env;
+}
+
+// Channel error in deadband units (light: relative, with the darkness floor)
+// Seconds with a rejected (NaN) published value are counted apart
+struct Error {
+  double max = 0;
+  double sum = 0;
+  uint32_t count = 0;
+  uint32_t rejected = 0;
+
+  void add(double error) {
+    if (isnan(error)) {
+      rejected++;
+      return;
+    }
+    max = ::max(max, error);
+    sum += error;
+    count++;
+  }
+
+  double mean() const {
+    return count ? sum / count : 0;
+  }
+};
+
+struct Errors {
+  Error temperature;
+  Error humidity;
+  Error pressure;
+  Error light;
+
+  void add(const Environment& truth, const Environment& held) {
+    temperature.add(fabs(held.temperature - truth.temperature) / ADAPTIVE_DEADBAND_TEMPERATURE);
+    humidity.add(fabs(held.humidity - truth.humidity) / ADAPTIVE_DEADBAND_HUMIDITY);
+    pressure.add(fabs(held.pressure - truth.pressure) / ADAPTIVE_DEADBAND_PRESSURE);
+    const double deadband = ::max(truth.light * ADAPTIVE_DEADBAND_LIGHT, (double)ADAPTIVE_DEADBAND_LIGHT_MIN);
+    light.add(fabs(held.light - truth.light) / deadband);
+  }
+};
+
+// Fixed-interval sample-and-hold of the trace with the given period (s)
+static Errors fixedInterval(double period, bool lightOnly) {
+  Errors errors;
+  Environment held = trace(0);
+  double nextSample = period;
+  for (uint32_t s = 1; s < DAY_S; s++) {
+    if (s >= nextSample) {
+      held = trace(s);
+      nextSample += period;
+    }
+    Environment truth = trace(s);
+    if (lightOnly) {
+      truth.temperature = held.temperature;
+      truth.humidity = held.humidity;
+      truth.pressure = held.pressure;
+    } else {
+      truth.light = held.light;
+    }
+    errors.add(truth, held);
+  }
+  return errors;
+}
+
+int main() {
+  eventLog.begin();
+  std::mt19937 random(30);
+  std::uniform_real_distribution<double> cover(0.25, 1.0);
+  for (double& factor : s_cloudFactor) {
+    factor = random() % 3 == 0 ? cover(random) : 1.0;
+  }
+
+  host::Bme280Model bme(30);
+  host::Bh1750Model bh1750;
+  host::i2cBus(1).attach(BME_I2C_ADDR, bme);
+  host::i2cBus(2).attach(BH1750_I2C_ADDR, bh1750);
+
+  auto setEnvironment = [&](double t) {
+    const Environment env = trace(t);
+    bme.temperature = env.temperature;
+    bme.humidity = env.humidity;
+    bme.pressure = env.pressure;
+    bh1750.lux = env.light;
+  };
+
+  setEnvironment(0);
+  auto manager = std::make_unique<SensorManager>();
+  CHECK(manager->begin());
+
+  // Settle for a few minutes before measuring
+  const uint64_t start = host::now();
+  for (uint32_t s = 1; s <= 600; s++) {
+    host::advance(start + s * 1000 * MS - host::now());
+    setEnvironment(0);
+    if ((int32_t)(millis() - manager->getNextReadTime(millis())) >= 0) {
+      manager->readSensors();
+    }
+  }
+
+  const uint32_t bmeBefore = bme.getConversions();
+  const uint32_t bh1750Before = bh1750.getConversions();
+  const uint32_t publishesBefore = manager->getSequence();
+  const uint64_t dayStart = host::now();
+  Errors adaptive;
+
+  for (uint32_t s = 1; s < DAY_S; s++) {
+    host::advance(dayStart + s * 1000 * MS - host::now());
+    setEnvironment(s);
+    if ((int32_t)(millis() - manager->getNextReadTime(millis())) >= 0) {
+      manager->readSensors();
+    }
+
+    const SensorData& data = manager->getSensorData();
+    CHECK(isfinite(data.temperature) && isfinite(data.lightLevel));
+    const Environment held = { data.temperature, data.humidity, data.pressure, data.lightLevel };
+    adaptive.add(trace(s), held);
+  }
+
+  const uint32_t bmeReads = bme.getConversions() - bmeBefore;
+  const uint32_t bh1750Reads = bh1750.getConversions() - bh1750Before;
+  const uint32_t publishes = manager->getSequence() - publishesBefore;
+
+  // Same number of reads, spread evenly
+  const Errors bmeFixed = fixedInterval((double)DAY_S / bmeReads, false);
+  const Errors lightFixed = fixedInterval((double)DAY_S / bh1750Reads, true);
+
+  host::report("BME280: %u reads (%.1f%% of 1 s, %.1f%% of 5 s sampling), %u publishes", bmeReads,
+               100.0 * bmeReads / DAY_S, 100.0 * bmeReads / (DAY_S / 5), publishes);
+  host::report("BH1750: %u reads (%.1f%% of 1 s, %.1f%% of 5 s sampling)", bh1750Reads, 100.0 * bh1750Reads / DAY_S,
+               100.0 * bh1750Reads / (DAY_S / 5));
+  host::report("error in deadbands  adaptive max / mean (s rejected)   fixed (same reads) max / mean");
+  const struct {
+    const char* name;
+    const Error& adaptive;
+    const Error& fixed;
+  } rows[] = {
+    { "temperature", adaptive.temperature, bmeFixed.temperature },
+    { "humidity", adaptive.humidity, bmeFixed.humidity },
+    { "pressure", adaptive.pressure, bmeFixed.pressure },
+    { "light", adaptive.light, lightFixed.light },
+  };
+  for (const auto& row : rows) {
+    host::report("  %-12s %12.2f / %.2f (%u) %26.2f / %.2f", row.name, row.adaptive.max, row.adaptive.mean(),
+                 row.adaptive.rejected, row.fixed.max, row.fixed.mean());
+  }
+
+  // Fewer reads than the default 5 s profile
+  CHECK(bmeReads < DAY_S / 5 / 2);
+  CHECK(bh1750Reads < DAY_S / 5);
+
+  // Held values stay within the deadband plus the drift of one read interval
+  CHECK(adaptive.temperature.max < 1.5);
+  CHECK(adaptive.humidity.max < 1.5);
+  CHECK(adaptive.pressure.max < 1.5);
+
+  // Anomaly rejections during the front are rare and short
+  CHECK(adaptive.temperature.rejected + adaptive.humidity.rejected + adaptive.pressure.rejected < 60);
+
+  host::finish("adaptive_interval");
+}
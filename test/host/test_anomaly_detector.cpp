@@ -0,0 +1,223 @@
+/*
+ * AnomalyDetector: injected faults and false positives on clean traces
+ *
+ * Clean 30-day traces at the 5 s publish rate (diurnal temperature and
+ * humidity, pressure random walk with fronts, sensor noise and output
+ * resolution) run through detectors with the BME280 channel limits; every
+ * flag there is a false positive and the rate per channel is reported and
+ * bounded. Then faults are injected into clean temperature, humidity and
+ * pressure series: out-of-range readings (the BME280's -145 °C / 0 Pa reset
+ * values), spikes above the threshold, deviations just below it, a genuine
+ * step change and a frozen value. Checked are the flags, that rejected
+ * values become NAN, the counters in writeJSON() and the cost of check().
+ */
+
+#include "HostTest.h"
+#include "AnomalyDetector.h"
+#include <random>
+
+constexpr uint32_t PUBLISH_MS = 5000;
+constexpr uint32_t DAY_SAMPLES = 24 * 3600000 / PUBLISH_MS;
+constexpr uint32_t CLEAN_DAYS = 30;
+
+// Channel limits as Bme280Sensor sets them
+static const AnomalyLimits TEMPERATURE_LIMITS = {
+  -40.0f, 85.0f, ANOMALY_MIN_SPREAD_TEMPERATURE, true, ANOMALY_STUCK_MS
+};
+static const AnomalyLimits HUMIDITY_LIMITS = {
+  0.0f, 100.0f, ANOMALY_MIN_SPREAD_HUMIDITY, true, ANOMALY_STUCK_MS
+};
+static const AnomalyLimits PRESSURE_LIMITS = {
+  30000.0f, 110000.0f, ANOMALY_MIN_SPREAD_PRESSURE, true, ANOMALY_STUCK_MS
+};
+
+struct Counters {
+  unsigned ranges;
+  unsigned spikes;
+  unsigned stuck;
+};
+
+// Flag counters from writeJSON()
+static Counters counters(const AnomalyDetector& detector) {
+  char buffer[256];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginObject();
+  detector.writeJSON(json, "channel");
+  json.endObject();
+  Counters result = { UINT32_MAX, UINT32_MAX, UINT32_MAX };
+  const char* field = strstr(buffer, "\"ranges\":");
+  if (field) {
+    sscanf(field, "\"ranges\":%u,\"spikes\":%u,\"stuck\":%u", &result.ranges, &result.spikes, &result.stuck);
+  }
+  return result;
+}
+
+struct Channel {
+  const char* name;
+  const AnomalyLimits& limits;
+  float noise;       // Sensor noise (1 sigma)
+  float resolution;  // Published resolution
+  float spike;       // Injected spike, above the threshold
+  float belowSpike;  // Injected deviation under the threshold
+  float outOfRange;  // Reading of a sensor that lost its calibration / reset
+};
+
+static const Channel CHANNELS[] = {
+  { "temperature", TEMPERATURE_LIMITS, 0.01f, 0.01f, 3.0f, 0.5f, -145.0f },
+  { "humidity", HUMIDITY_LIMITS, 0.3f, 0.01f, 15.0f, 3.0f, 100.5f },
+  { "pressure", PRESSURE_LIMITS, 1.5f, 1.0f, 500.0f, 60.0f, 0.0f },
+};
+
+// Clean value of a channel at a sample index
+static float cleanValue(int channel, uint32_t i, float& walk, std::mt19937& random) {
+  std::normal_distribution<float> gauss(0.0f, 1.0f);
+  const float day = (float)i / DAY_SAMPLES;
+  const Channel& c = CHANNELS[channel];
+  float value;
+  if (channel == 0) {
+    value = 15.0f + 8.0f * sinf(day * 6.2832f) + 3.0f * sinf(day * 0.7f);
+  } else if (channel == 1) {
+    value = 60.0f - 20.0f * sinf(day * 6.2832f);
+  } else {
+    walk += 0.4f * gauss(random);
+    value = walk + 300.0f * sinf(day * 1.1f);
+  }
+  value += c.noise * gauss(random);
+  return roundf(value / c.resolution) * c.resolution;
+}
+
+int main() {
+  std::mt19937 random(38);
+
+  // Clean traces: every flag is a false positive
+  for (int channel = 0; channel < 3; channel++) {
+    AnomalyDetector detector(CHANNELS[channel].limits);
+    float walk = 101325.0f;
+    uint32_t flagged = 0;
+    uint32_t samples = 0;
+    for (uint32_t i = 0; i < CLEAN_DAYS * DAY_SAMPLES; i++) {
+      float value = cleanValue(channel, i, walk, random);
+      flagged += detector.check(value, i * PUBLISH_MS) != ANOMALY_NONE;
+      samples++;
+    }
+    const Counters counted = counters(detector);
+    CHECK(counted.ranges == 0 && counted.stuck == 0);
+    CHECK(counted.spikes == flagged);
+    CHECK(flagged * 10000 < samples);  // Below 0.01 %
+    host::report("clean %-11s %u days: %u / %u samples flagged (%.4f %%)", CHANNELS[channel].name, CLEAN_DAYS,
+                 flagged, samples, 100.0 * flagged / samples);
+  }
+
+  // Injected faults: range and spike rejected, sub-threshold deviations kept
+  for (int channel = 0; channel < 3; channel++) {
+    const Channel& c = CHANNELS[channel];
+    AnomalyDetector detector(c.limits);
+    float walk = 101325.0f;
+    uint32_t injected = 0;
+    uint32_t detected = 0;
+    uint32_t wrongFlag = 0;
+    uint32_t notRejected = 0;
+    uint32_t belowFlagged = 0;
+    uint32_t cleanFlagged = 0;
+    for (uint32_t i = 0; i < 20000; i++) {
+      float value = cleanValue(channel, i, walk, random);
+      uint8_t expected = ANOMALY_NONE;
+      bool below = false;
+      switch (i % 500) {
+        case 100: value -= c.spike; expected = ANOMALY_SPIKE; break;
+        case 250: value = c.outOfRange; expected = ANOMALY_RANGE; break;
+        case 400: value += c.spike; expected = ANOMALY_SPIKE; break;
+        case 450: value += c.belowSpike; below = true; break;
+      }
+      const uint8_t flags = detector.check(value, i * PUBLISH_MS);
+      if (expected != ANOMALY_NONE) {
+        injected++;
+        detected += flags == expected;
+        wrongFlag += flags != expected;
+        notRejected += !isnan(value);
+      } else if (below) {
+        belowFlagged += flags != ANOMALY_NONE;
+      } else {
+        cleanFlagged += flags != ANOMALY_NONE;
+      }
+    }
+    const Counters counted = counters(detector);
+    CHECK(detected == injected && wrongFlag == 0 && notRejected == 0);
+    CHECK(belowFlagged == 0);
+    CHECK(counted.ranges == injected / 3);
+    CHECK(counted.spikes == 2 * injected / 3 + cleanFlagged);
+    host::report("%-11s faults: %u / %u detected and rejected, %u sub-threshold deviations flagged, "
+                 "%u false positives",
+                 c.name, detected, injected, belowFlagged, cleanFlagged);
+  }
+
+  // Genuine step change: accepted once it is the window majority
+  {
+    AnomalyDetector detector(TEMPERATURE_LIMITS);
+    uint32_t rejected = 0;
+    uint32_t acceptedAfter = 0;
+    for (uint32_t i = 0; i < 100; i++) {
+      float value = i < 50 ? 20.0f : 25.0f;
+      const uint8_t flags = detector.check(value, i * PUBLISH_MS);
+      rejected += flags != ANOMALY_NONE;
+      if (i >= 50 && flags == ANOMALY_NONE && !acceptedAfter) {
+        acceptedAfter = i - 50 + 1;
+      }
+    }
+    CHECK(acceptedAfter == (ANOMALY_WINDOW + 1) / 2 + 1);
+    CHECK(rejected == (ANOMALY_WINDOW + 1) / 2);
+    host::report("step of 5 C: %u samples rejected, accepted from sample %u", rejected, acceptedAfter);
+  }
+
+  // Frozen value: flagged after ANOMALY_STUCK_MS, once per episode; rails are legitimate
+  {
+    AnomalyDetector detector(TEMPERATURE_LIMITS);
+    uint32_t firstStuck = 0;
+    for (uint32_t now = PUBLISH_MS; now <= 2 * ANOMALY_STUCK_MS; now += PUBLISH_MS) {
+      float value = 21.37f;
+      if ((detector.check(value, now) & ANOMALY_STUCK) && !firstStuck) {
+        firstStuck = now;
+      }
+    }
+    CHECK(firstStuck == PUBLISH_MS + ANOMALY_STUCK_MS);
+    float value = 21.38f;
+    CHECK(detector.check(value, 2 * ANOMALY_STUCK_MS + PUBLISH_MS) == ANOMALY_NONE);
+    CHECK(counters(detector).stuck == 1);
+
+    AnomalyDetector rail(HUMIDITY_LIMITS);
+    uint8_t railFlags = ANOMALY_NONE;
+    for (uint32_t now = 0; now <= 2 * ANOMALY_STUCK_MS; now += PUBLISH_MS) {
+      float saturated = 100.0f;
+      railFlags |= rail.check(saturated, now);
+    }
+    CHECK(railFlags == ANOMALY_NONE);
+    host::report("frozen value flagged after %u min, 100 %%RH rail not flagged",
+                 (firstStuck - PUBLISH_MS) / 60000);
+  }
+
+  // Missing readings pass through unflagged
+  {
+    AnomalyDetector detector(PRESSURE_LIMITS);
+    float value = NAN;
+    CHECK(detector.check(value, 0) == ANOMALY_NONE && isnan(value));
+  }
+
+  // Cost of check() with a full window
+  AnomalyDetector detector(TEMPERATURE_LIMITS);
+  float walk = 0;
+  constexpr int CHECKS = 2000000;
+  volatile uint32_t sink = 0;
+  float values[1024];
+  for (uint32_t i = 0; i < 1024; i++) {
+    values[i] = cleanValue(0, i, walk, random);
+  }
+  const double ns = host::measureNs([&]() {
+    for (int i = 0; i < CHECKS; i++) {
+      float value = values[i & 1023];
+      sink = sink + detector.check(value, i * PUBLISH_MS);
+    }
+  }) / CHECKS;
+  host::report("check(): %.0f ns per sample (host)", ns);
+
+  host::finish("anomaly_detector");
+}
@@ -0,0 +1,164 @@
+/*
+ * BH1750 driver: auto-ranging from 0.1 lux to 100 klux, non-blocking reads
+ *
+ * Bh1750Sensor runs against the modelled BH1750 (one-time modes, MTreg,
+ * conversion times, 16-bit saturation) with start() and collect() called
+ * every 10 ms of virtual time. Checked over a sweep of 0.1 lux to 100 klux: the reading
+ * is the light level quantized to the resolution of the range the driver
+ * settled in, that range keeps the reading below BH1750_RANGE_UP_FRACTION of
+ * its full scale, and from 10 lux up a count is at most 1.2 % of the reading.
+ * Direct sun beyond full scale must report the widest range's full scale.
+ * Reported are the settle time after light steps (dusk to sun and back),
+ * range changes while the light hovers at a range boundary, and the
+ * longest start() + collect() - bus transfers only, never the conversion
+ * time. A collect scheduled getConversionTime() after start() must return
+ * the light of that conversion, not the previous one.
+ */
+
+#include "HostTest.h"
+#include "HostI2C.h"
+#include "HostBh1750.h"
+#include "Bh1750Sensor.h"
+
+constexpr uint64_t TICK_US = 10000;
+constexpr uint32_t SENSITIVE_CONVERSION_MS = 663;  // Driver's wait at MTreg 254
+constexpr uint32_t WIDEST_CONVERSION_MS = 81;      // and at MTreg 31
+
+static host::Bh1750Model s_model;
+static uint64_t s_maxCollectUs = 0;
+
+// One start() and collect(), timed on the virtual clock (advances only by bus time)
+static bool collect(Bh1750Sensor& sensor, Bh1750Sensor::Channels& channels) {
+  const uint64_t start = host::now();
+  const bool valid = sensor.start() && sensor.collect(channels);
+  s_maxCollectUs = max(s_maxCollectUs, host::now() - start);
+  return valid;
+}
+
+// Run until the reading is within one resolution step of the light level (ms, 0 = never)
+static uint32_t settle(Bh1750Sensor& sensor, double lux, uint32_t limitMs, Bh1750Sensor::Channels& channels) {
+  s_model.lux = lux;
+  const uint64_t start = host::now();
+  uint32_t settledMs = 0;
+  bool stable = false;
+  while (host::now() - start < (uint64_t)limitMs * 1000) {
+    host::advance(TICK_US);
+    const float range = sensor.getRangeLux();
+    const bool valid = collect(sensor, channels);
+    const bool within = valid && fabs(channels.lightLevel - lux) <= sensor.getResolution() + lux * 1e-6;
+    if (within && !stable) {
+      settledMs = (host::now() - start) / 1000;
+    }
+    stable = within && range == sensor.getRangeLux();
+    if (!within) {
+      settledMs = 0;
+    }
+  }
+  return settledMs;
+}
+
+int main() {
+  host::i2cBus(2).attach(BH1750_I2C_ADDR, s_model);
+
+  Bh1750Sensor sensor;
+  s_model.lux = 350.0;
+  CHECK(sensor.begin());
+
+  // Sweep 0.1 lux to 100 klux, 4 levels per decade
+  uint32_t wrong = 0;
+  uint32_t nearFullScale = 0;
+  float worstRelative = 0.0f;
+  float previousRange = 0.0f;
+  for (double lux = 0.1; lux <= 100000.0 * 1.001; lux *= pow(10.0, 0.25)) {
+    Bh1750Sensor::Channels channels;
+    settle(sensor, lux, 3000, channels);
+    const float resolution = sensor.getResolution();
+    const float range = sensor.getRangeLux();
+    const float error = lux - channels.lightLevel;  // Counts are truncated
+    wrong += !(error >= -lux * 1e-6 && error <= resolution + lux * 1e-6);
+    nearFullScale += lux >= BH1750_RANGE_UP_FRACTION * range;
+    if (lux >= 10.0) {
+      worstRelative = max(worstRelative, resolution / (float)lux);
+    }
+    if (range != previousRange) {
+      host::report("%9.1f lux: range %6.0f lux, %.3f lux per count, MTreg %u, read %.2f lux", lux, range,
+                   resolution, s_model.getMtreg(), channels.lightLevel);
+      previousRange = range;
+    }
+  }
+  CHECK(wrong == 0 && nearFullScale == 0);
+  CHECK(worstRelative < 0.012f);
+  host::report("sweep 0.1 lux - 100 klux: %u readings off by more than one count, resolution <= %.2f %% "
+               "of the reading from 10 lux up",
+               wrong, worstRelative * 100);
+
+  // Direct sun beyond full scale: widest range, its full scale reported
+  {
+    Bh1750Sensor::Channels channels;
+    settle(sensor, 150000.0, 2000, channels);
+    const float fullScale = sensor.getRangeLux();
+    CHECK(fabsf(channels.lightLevel - fullScale) <= sensor.getResolution());
+    CHECK(s_model.getMtreg() == 31);
+    host::report("150 klux: %.0f lux (full scale of the widest range)", channels.lightLevel);
+  }
+
+  // Light steps: the conversion in flight still sees the old light, the next one
+  // (same range) sees the new light, then one in the range that reading calls for
+  {
+    Bh1750Sensor::Channels channels;
+    settle(sensor, 5.0, 3000, channels);
+    const uint32_t upMs = settle(sensor, 50000.0, 3000, channels);
+    const uint32_t downMs = settle(sensor, 5.0, 5000, channels);
+    CHECK(upMs > 0 && upMs <= 2 * SENSITIVE_CONVERSION_MS + WIDEST_CONVERSION_MS + 20);
+    CHECK(downMs > 0 && downMs <= 2 * WIDEST_CONVERSION_MS + SENSITIVE_CONVERSION_MS + 20);
+    host::report("step 5 lux -> 50 klux settled in %u ms, 50 klux -> 5 lux in %u ms", upMs, downMs);
+  }
+
+  // Hysteresis: light hovering around a range boundary does not flip the range
+  {
+    Bh1750Sensor::Channels channels;
+    const float boundary = BH1750_RANGE_DOWN_FRACTION * 7400.0f;
+    settle(sensor, boundary, 3000, channels);
+    uint32_t changes = 0;
+    float range = sensor.getRangeLux();
+    for (int i = 0; i < 400; i++) {
+      s_model.lux = boundary * (i % 20 < 10 ? 0.95 : 1.05);
+      host::advance(TICK_US);
+      collect(sensor, channels);
+      changes += sensor.getRangeLux() != range;
+      range = sensor.getRangeLux();
+    }
+    CHECK(changes <= 1);
+    host::report("light +-5 %% around %.0f lux for 4 s: %u range changes", boundary, changes);
+  }
+
+  // Scheduled collect: the reading is the conversion just started, not the one before
+  {
+    Bh1750Sensor::Channels channels;
+    settle(sensor, 800.0, 3000, channels);
+    uint32_t stale = 0;
+    uint32_t longestMs = 0;
+    for (double lux : { 820.0, 790.0, 1000.0, 300.0, 120.0 }) {
+      s_model.lux = lux;
+      host::advance(1000000);
+      CHECK(sensor.start());
+      const uint32_t conversionMs = sensor.getConversionTime();
+      CHECK(conversionMs > 0 && conversionMs <= SENSITIVE_CONVERSION_MS);
+      host::advance(conversionMs * 1000ULL);
+      CHECK(sensor.getConversionTime() == 0);
+      const uint64_t start = host::now();
+      CHECK(sensor.collect(channels));
+      s_maxCollectUs = max(s_maxCollectUs, host::now() - start);
+      stale += !(fabs(channels.lightLevel - lux) <= sensor.getResolution() + lux * 1e-6);
+      longestMs = max(longestMs, conversionMs);
+    }
+    CHECK(stale == 0);
+    host::report("collect scheduled after the conversion (<= %u ms): %u stale readings of 5", longestMs, stale);
+  }
+
+  // Never blocks for a conversion
+  CHECK(s_maxCollectUs < 2000);
+  host::report("longest start() + collect(): %.2f ms (bus transfers at 100 kHz only)", s_maxCollectUs / 1000.0);
+
+  host::finish("bh1750");
+}
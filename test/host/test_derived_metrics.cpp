@@ -0,0 +1,139 @@
+/*
+ * DerivedMetrics: accuracy against double precision, cost per measurement
+ *
+ * fastLog/fastExp are swept against libm in double precision (geometric
+ * sweep over all positive normal floats, |x| < 80), and dew point / absolute
+ * humidity over T = -40..85 °C, RH = 1..100 % against the same formulas in
+ * double precision. The bounds checked are the ones stated in
+ * DerivedMetrics.h. Heat index and comfort classes are checked at their
+ * boundaries. Reports host cycles per compute(), and for the same formulas
+ * with libm logf/expf.
+ */
+
+#include "HostTest.h"
+#include "DerivedMetrics.h"
+
+constexpr int BENCH_MEASUREMENTS = 2000000;
+
+// Double-precision reference of DerivedMetrics::compute()
+static double referenceDewPoint(double t, double h) {
+  const double alpha = 17.27 * t / (237.7 + t) + log(h / 100.0);
+  return 237.7 * alpha / (17.27 - alpha);
+}
+
+static double referenceAbsoluteHumidity(double t, double h) {
+  return 6.112 * exp(17.67 * t / (t + 243.5)) * h * 2.1674 / (273.15 + t);
+}
+
+static double referenceHeatIndex(double t, double h) {
+  return -8.78469475556 + 1.61139411 * t + 2.33854883889 * h - 0.14611605 * t * h - 0.012308094 * t * t -
+         0.0164248277778 * h * h + 0.002211732 * t * t * h + 0.00072546 * t * h * h - 0.000003582 * t * t * h * h;
+}
+
+// The same formulas on libm (benchmark baseline)
+__attribute__((noinline)) static float libmDewPoint(float t, float h, float& absoluteHumidity) {
+  const float alpha = 17.27f * t / (237.7f + t) + logf(h / 100.0f);
+  absoluteHumidity = 6.112f * expf(17.67f * t / (t + 243.5f)) * h * 2.1674f / (273.15f + t);
+  return 237.7f * alpha / (17.27f - alpha);
+}
+
+int main() {
+  // fastLog over every binade, fastExp over |x| < 80
+  double logError = 0;
+  for (double x = 1.2e-38; x < 3.4e38; x *= 1.00007) {
+    const float f = (float)x;
+    logError = max(logError, fabs(fastLog(f) - log((double)f)));
+  }
+  double expError = 0;
+  for (double x = -80; x < 80; x += 0.00007) {
+    const float f = (float)x;
+    expError = max(expError, fabs(fastExp(f) / exp((double)f) - 1));
+  }
+  CHECK(logError < 8e-6);
+  CHECK(expError < 5e-6);
+  CHECK(isnan(fastLog(-1.0f)) && isnan(fastLog(NAN)) && fastLog(0.0f) == -INFINITY);
+  CHECK(fastLog(1.0f) == 0.0f);
+  CHECK(fastExp(100.0f) == INFINITY && fastExp(-100.0f) == 0.0f && isnan(fastExp(NAN)));
+  host::report("fastLog max |error| %.2g (bound 8e-6), fastExp max relative error %.2g (bound 5e-6)", logError,
+               expError);
+
+  // Dew point and absolute humidity over the sensor range
+  double dewError = 0;
+  double absoluteError = 0;
+  uint32_t points = 0;
+  for (double t = -40; t <= 85.0001; t += 0.05) {
+    for (double h = 1; h <= 100.0001; h += 0.25) {
+      DerivedMetrics metrics;
+      metrics.compute((float)t, (float)h);
+      const double tf = (float)t;
+      const double hf = (float)h;
+      dewError = max(dewError, fabs(metrics.dewPoint - referenceDewPoint(tf, hf)));
+      absoluteError = max(absoluteError, fabs(metrics.absoluteHumidity - referenceAbsoluteHumidity(tf, hf)));
+      points++;
+    }
+  }
+  CHECK(dewError < 0.0001);
+  CHECK(absoluteError < 0.001);
+  host::report("%u points T -40..85 C x RH 1..100 %%: dew point max error %.2g C, absolute humidity %.2g g/m3",
+               points, dewError, absoluteError);
+
+  // Feels like: heat index from 27 C, -2 C at or below 10 C, the temperature in between
+  double heatIndexError = 0;
+  for (double t = 27; t <= 45; t += 0.5) {
+    for (double h = 40; h <= 100; h += 1) {
+      DerivedMetrics metrics;
+      metrics.compute((float)t, (float)h);
+      heatIndexError = max(heatIndexError, fabs(metrics.feelsLike - referenceHeatIndex(t, h)));
+    }
+  }
+  CHECK(heatIndexError < 0.01);
+  DerivedMetrics metrics;
+  metrics.compute(26.9f, 80.0f);
+  CHECK(metrics.feelsLike == 26.9f);
+  metrics.compute(10.0f, 50.0f);
+  CHECK(metrics.feelsLike == 8.0f);
+
+  // Comfort classes and missing inputs
+  const struct {
+    float t, h;
+    ComfortLevel level;
+  } comfort[] = {
+    { 20.0f, 40.0f, ComfortLevel::COMFORTABLE }, { 26.0f, 60.0f, ComfortLevel::COMFORTABLE },
+    { 14.9f, 50.0f, ComfortLevel::COLD },         { 30.1f, 50.0f, ComfortLevel::HOT },
+    { 27.0f, 29.9f, ComfortLevel::DRY },          { 27.0f, 70.1f, ComfortLevel::HUMID },
+    { 27.0f, 50.0f, ComfortLevel::MODERATE },     { 14.9f, NAN, ComfortLevel::COLD },
+    { 25.1f, NAN, ComfortLevel::HOT },            { 20.0f, NAN, ComfortLevel::OK },
+  };
+  bool classesMatch = true;
+  for (const auto& point : comfort) {
+    metrics.compute(point.t, point.h);
+    classesMatch &= metrics.comfort == point.level;
+  }
+  CHECK(classesMatch);
+  metrics.compute(20.0f, NAN);
+  CHECK(isnan(metrics.dewPoint) && isnan(metrics.absoluteHumidity) && metrics.feelsLike == 20.0f);
+  metrics.compute(NAN, 50.0f);
+  CHECK(isnan(metrics.feelsLike) && metrics.comfort == ComfortLevel::UNKNOWN);
+  host::report("heat index max error %.2g C, %zu comfort boundary cases", heatIndexError,
+               sizeof(comfort) / sizeof(comfort[0]));
+
+  // Cost per measurement (inputs vary so nothing is hoisted)
+  volatile float sink = 0;
+  uint64_t start = host::cycles();
+  for (int i = 0; i < BENCH_MEASUREMENTS; i++) {
+    metrics.compute(-20.0f + (i % 1000) * 0.1f, 5.0f + (i % 90));
+    sink = sink + metrics.dewPoint + metrics.absoluteHumidity;
+  }
+  const double fastCycles = (double)(host::cycles() - start) / BENCH_MEASUREMENTS;
+
+  start = host::cycles();
+  for (int i = 0; i < BENCH_MEASUREMENTS; i++) {
+    float absoluteHumidity;
+    sink = sink + libmDewPoint(-20.0f + (i % 1000) * 0.1f, 5.0f + (i % 90), absoluteHumidity) + absoluteHumidity;
+  }
+  const double libmCycles = (double)(host::cycles() - start) / BENCH_MEASUREMENTS;
+  host::report("compute(): %.0f host cycles per measurement (dew point + absolute humidity with libm: %.0f)",
+               fastCycles, libmCycles);
+
+  host::finish("derived_metrics");
+}
@@ -0,0 +1,155 @@
+/*
+ * ErrorIndicator / LedSequencer on the virtual clock
+ *
+ * The LED pin is recorded through the GPIO hook while the clock is advanced
+ * in large steps (loop() blocked by HTTP or a sensor read), so every edge
+ * comes from the esp_timer callback. Checked: phase lengths of single and
+ * combined error patterns, the dark gap between bursts, clearing an error,
+ * and the sequencer's resync after a starved timer. The same patterns are
+ * then driven from a simulated loop() that blocks 0-300 ms per iteration
+ * (how the LED was updated before the timer) to report the timing error the
+ * timer removes.
+ */
+
+#include "HostTest.h"
+#include "ErrorIndicator.h"
+#include <random>
+#include <vector>
+
+constexpr uint64_t MS = 1000;
+
+struct Edge {
+  uint32_t time;  // ms
+  bool on;
+};
+
+static std::vector<Edge> s_edges;
+
+static void recordLed() {
+  host::setPinHooks(
+    [](uint8_t pin, uint8_t, uint8_t value) {
+      if (pin == LED_PIN && (s_edges.empty() || s_edges.back().on != (value == HIGH))) {
+        s_edges.push_back({ millis(), value == HIGH });
+      }
+    },
+    [](uint8_t) { return -1; });
+}
+
+// Phase lengths (ms) between recorded edges
+static std::vector<uint32_t> phases() {
+  std::vector<uint32_t> lengths;
+  for (size_t i = 1; i < s_edges.size(); i++) {
+    lengths.push_back(s_edges[i].time - s_edges[i - 1].time);
+  }
+  return lengths;
+}
+
+// loop() blocked for a long time: only the timer runs
+static void busyLoop(uint32_t ms) {
+  host::advance(ms * MS);
+}
+
+int main() {
+  recordLed();
+  ErrorIndicator indicator;
+  indicator.begin();
+
+  // Idle: LED stays off
+  busyLoop(2000);
+  CHECK(s_edges.size() <= 1 && host::getPinLevel(LED_PIN) == LOW);
+
+  // Single WiFi error: 100/100 ms while loop() blocks for 2.5 s at a time
+  s_edges.clear();
+  indicator.raiseError(ErrorType::WIFI_ERROR);
+  busyLoop(2500);
+  busyLoop(2500);
+  std::vector<uint32_t> lengths = phases();
+  CHECK(lengths.size() >= 45);
+  for (uint32_t length : lengths) {
+    CHECK(length == LED_BLINK_WIFI_ERROR_ON);
+  }
+  // First edge within one tick of raising the error
+  CHECK(!s_edges.empty() && s_edges.front().on && s_edges.front().time <= 2000 + LED_TICK_MS);
+
+  // Cleared: dark within one tick
+  indicator.clearError(ErrorType::WIFI_ERROR);
+  const size_t edgesBefore = s_edges.size();
+  busyLoop(LED_TICK_MS);
+  CHECK(host::getPinLevel(LED_PIN) == LOW);
+  busyLoop(1000);
+  CHECK(s_edges.size() <= edgesBefore + 1 && !s_edges.back().on);
+
+  // WiFi + sensor: 3 WiFi blinks, gap, 3 sensor blinks, gap, ...
+  s_edges.clear();
+  indicator.raiseError(ErrorType::WIFI_ERROR);
+  indicator.raiseError(ErrorType::SENSOR_ERROR);
+  busyLoop(20000);
+  std::vector<uint32_t> expected;
+  for (int cycle = 0; cycle < 3; cycle++) {
+    for (uint16_t on : { LED_BLINK_WIFI_ERROR_ON, LED_BLINK_SENSOR_ERROR_ON }) {
+      for (int blink = 0; blink < LED_PATTERN_BLINKS; blink++) {
+        expected.push_back(on);
+        expected.push_back(blink + 1 < LED_PATTERN_BLINKS ? on : LED_PATTERN_GAP_MS);  // Same on/off times
+      }
+    }
+  }
+  lengths = phases();
+  CHECK(lengths.size() >= expected.size());
+  bool sequenceMatches = lengths.size() >= expected.size();
+  for (size_t i = 0; i < expected.size() && i < lengths.size(); i++) {
+    sequenceMatches &= lengths[i] == expected[i];
+  }
+  CHECK(sequenceMatches);
+  host::report("WiFi + sensor error: %zu phases in 20 s, %s", lengths.size(),
+               sequenceMatches ? "burst / gap sequence exact" : "sequence differs");
+  indicator.clearError(ErrorType::WIFI_ERROR);
+  indicator.clearError(ErrorType::SENSOR_ERROR);
+  busyLoop(100);
+
+  // Starved timer: the sequencer resyncs instead of replaying missed phases
+  {
+    LedSequencer sequencer;
+    const uint8_t errors = errorBit(ErrorType::SENSOR_ERROR);
+    sequencer.tick(0, errors);
+    sequencer.tick(5000, errors);  // 5 s without a tick
+    uint32_t toggles = 0;
+    bool state = sequencer.tick(5010, errors);
+    for (uint32_t t = 5020; t < 5000 + LED_BLINK_SENSOR_ERROR_ON; t += LED_TICK_MS) {
+      const bool next = sequencer.tick(t, errors);
+      toggles += next != state;
+      state = next;
+    }
+    CHECK(toggles == 0);
+  }
+
+  // Former loop()-driven LED: the sequencer only runs between blocking calls
+  {
+    std::mt19937 random(31);
+    LedSequencer sequencer;
+    const uint8_t errors = errorBit(ErrorType::WIFI_ERROR);
+    bool state = false;
+    uint32_t lastEdge = 0;
+    uint32_t worst = 0;
+    double sumError = 0;
+    uint32_t count = 0;
+    for (uint32_t t = 0; t < 600000; t += 1 + random() % 300) {
+      const bool next = sequencer.tick(t, errors);
+      if (next != state) {
+        if (lastEdge) {
+          const uint32_t error = (uint32_t)abs((int32_t)(t - lastEdge) - (int32_t)LED_BLINK_WIFI_ERROR_ON);
+          worst = max(worst, error);
+          sumError += error;
+          count++;
+        }
+        lastEdge = t;
+        state = next;
+      }
+    }
+    host::report("WiFi blink (100 ms phases): timer-driven 0 ms error | loop-driven with 0-300 ms blocking: "
+                 "mean %.0f ms, worst %u ms",
+                 sumError / count, worst);
+    CHECK(worst > 100);
+  }
+
+  host::finish("error_indicator");
+}
@@ -0,0 +1,197 @@
+/*
+ * EventLog: ring wraparound, reset persistence and concurrent writers
+ *
+ * - wraparound: after several laps of the ring, writeJSON() returns the
+ *   last EVENT_LOG_CAPACITY events in order, honours 'since' and maxEvents
+ * - persistence: a software reset keeps the journal and counts the boot,
+ *   power-on clears it, a corrupted header is rejected
+ * - concurrency: writer threads log self-checking records (arg1 is derived
+ *   from the writer and arg0) while a reader serializes the ring; no torn
+ *   or out-of-order record may show up, no sequence may be lost
+ * Reports the cost of log() alone and with all writers contending.
+ */
+
+#include "HostTest.h"
+#include "EventLog.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr int WRITERS = 4;
+constexpr int EVENTS_PER_WRITER = 20000;
+
+// Writer w logs code WRITER_CODES[w], arg0 = counter, arg1 = check(w, arg0)
+static const EventCode WRITER_CODES[WRITERS] = { EventCode::SENSOR_OFFLINE, EventCode::SENSOR_RECOVERED,
+                                                 EventCode::UPLOAD_FAILED, EventCode::MQTT_CONNECTED };
+
+static int32_t checkArg(int writer, int32_t arg0) {
+  return (arg0 * 3 + writer * 7919) % 30000;
+}
+
+struct Event {
+  uint32_t seq;
+  uint32_t boot;
+  uint32_t t;
+  std::string code;
+  int32_t arg0;
+  int32_t arg1;
+};
+
+// Serialize and parse the journal
+static std::vector<Event> read(uint32_t since, uint16_t maxEvents = EVENT_LOG_CAPACITY) {
+  static char buffer[EVENT_LOG_CAPACITY * 96 + 16];
+  JsonWriter writer(buffer, sizeof(buffer));
+  writer.beginArray();
+  eventLog.writeJSON(writer, since, maxEvents);
+  writer.endArray();
+
+  std::vector<Event> events;
+  const char* cursor = buffer;
+  while ((cursor = strchr(cursor, '{')) != nullptr) {
+    Event event;
+    char code[32];
+    if (sscanf(cursor, "{\"seq\":%u,\"boot\":%u,\"t\":%u,\"code\":\"%31[^\"]\",\"arg0\":%d,\"arg1\":%d}", &event.seq,
+               &event.boot, &event.t, code, &event.arg0, &event.arg1) == 6) {
+      event.code = code;
+      events.push_back(event);
+    }
+    cursor++;
+  }
+  return events;
+}
+
+static int writerOf(const Event& event) {
+  for (int writer = 0; writer < WRITERS; writer++) {
+    if (event.code == EventLog::getCodeName((uint16_t)WRITER_CODES[writer])) {
+      return writer;
+    }
+  }
+  return -1;
+}
+
+int main() {
+  host::setResetReason(ESP_RST_POWERON);
+  eventLog.begin();
+  CHECK(eventLog.getBootCount() == 1);
+
+  // Wraparound: 3 laps plus a few
+  const uint32_t first = eventLog.getNextSequence();
+  const uint32_t total = 3 * EVENT_LOG_CAPACITY + 5;
+  for (uint32_t i = 0; i < total; i++) {
+    eventLog.log(EventCode::LOOP_STALL, i % 1000, i);
+  }
+  const uint32_t next = eventLog.getNextSequence();
+  CHECK(next == first + total);
+
+  std::vector<Event> events = read(0);
+  CHECK(events.size() == EVENT_LOG_CAPACITY);
+  bool ordered = !events.empty() && events.front().seq == next - EVENT_LOG_CAPACITY;
+  for (size_t i = 0; i < events.size(); i++) {
+    ordered &= events[i].seq == next - EVENT_LOG_CAPACITY + i;
+    ordered &= events[i].arg1 == (int32_t)(events[i].seq - first);
+  }
+  CHECK(ordered);
+
+  // 'since' inside the ring, and maxEvents
+  events = read(next - 10);
+  CHECK(events.size() == 9 && events.front().seq == next - 9);
+  events = read(next - 50, 5);
+  CHECK(events.size() == 5 && events.front().seq == next - 49 && events.back().seq == next - 45);
+  CHECK(read(next - 1).empty());
+
+  // Arguments saturate at the int16 range
+  eventLog.log(EventCode::LOOP_STALL, 100000, -100000);
+  events = read(eventLog.getNextSequence() - 2);
+  CHECK(events.size() == 1 && events[0].arg0 == INT16_MAX && events[0].arg1 == INT16_MIN);
+  host::report("wraparound: %u events logged, last %zu kept in order", total, (size_t)EVENT_LOG_CAPACITY);
+
+  // Software reset keeps the journal
+  const uint32_t beforeReset = eventLog.getNextSequence();
+  host::setResetReason(ESP_RST_SW);
+  eventLog.begin();
+  CHECK(eventLog.getBootCount() == 2);
+  CHECK(eventLog.getNextSequence() == beforeReset + 1);
+  events = read(beforeReset - 1);
+  CHECK(events.size() == 1 && events[0].code == "boot" && events[0].boot == 2);
+
+  // Power-on clears it
+  host::setResetReason(ESP_RST_POWERON);
+  eventLog.begin();
+  CHECK(eventLog.getBootCount() == 1);
+  CHECK(eventLog.getNextSequence() == 2);
+  CHECK(read(0).size() == 1);
+
+  // Concurrent writers with a reader serializing the ring
+  const uint32_t concurrentFirst = eventLog.getNextSequence();
+  std::atomic<bool> writing(true);
+  std::atomic<uint32_t> torn(0), disordered(0), reads(0);
+
+  std::thread reader([&]() {
+    while (writing) {
+      const std::vector<Event> snapshot = read(0);
+      for (size_t i = 0; i < snapshot.size(); i++) {
+        const int writer = writerOf(snapshot[i]);
+        if (writer >= 0 && snapshot[i].arg1 != checkArg(writer, snapshot[i].arg0)) {
+          torn++;
+        }
+        if (i > 0 && snapshot[i].seq <= snapshot[i - 1].seq) {
+          disordered++;
+        }
+      }
+      reads++;
+    }
+  });
+
+  std::vector<std::thread> writers;
+  const auto start = std::chrono::steady_clock::now();
+  for (int writer = 0; writer < WRITERS; writer++) {
+    writers.emplace_back([writer]() {
+      for (int32_t i = 0; i < EVENTS_PER_WRITER; i++) {
+        eventLog.log(WRITER_CODES[writer], i, checkArg(writer, i));
+      }
+    });
+  }
+  for (std::thread& thread : writers) {
+    thread.join();
+  }
+  const double contendedNs =
+    std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+    (WRITERS * EVENTS_PER_WRITER);
+  writing = false;
+  reader.join();
+
+  CHECK(eventLog.getNextSequence() == concurrentFirst + WRITERS * EVENTS_PER_WRITER);
+  CHECK(torn == 0);
+  CHECK(disordered == 0);
+
+  // Final ring: consecutive sequences, every writer's counter increasing
+  events = read(0);
+  CHECK(events.size() == EVENT_LOG_CAPACITY);
+  int32_t lastCounter[WRITERS] = { -1, -1, -1, -1 };
+  bool consistent = true;
+  for (size_t i = 0; i < events.size(); i++) {
+    const int writer = writerOf(events[i]);
+    consistent &= writer >= 0 && events[i].arg1 == checkArg(writer, events[i].arg0);
+    consistent &= i == 0 || events[i].seq == events[i - 1].seq + 1;
+    if (writer >= 0) {
+      consistent &= events[i].arg0 > lastCounter[writer];
+      lastCounter[writer] = events[i].arg0;
+    }
+  }
+  CHECK(consistent);
+  host::report("%d writers x %d events with a concurrent reader (%u ring reads): %u torn, %u out of order",
+               WRITERS, EVENTS_PER_WRITER, reads.load(), torn.load(), disordered.load());
+
+  // Cost of log() without contention
+  constexpr int SINGLE = 1000000;
+  const double singleNs = host::measureNs([]() {
+    for (int i = 0; i < SINGLE; i++) {
+      eventLog.log(EventCode::LOOP_STALL, i, 0);
+    }
+  }) / SINGLE;
+  host::report("log(): %.0f ns alone, %.0f ns with %d writers and a reader contending", singleNs, contendedNs,
+               WRITERS);
+
+  host::finish("event_log");
+}
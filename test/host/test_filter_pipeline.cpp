@@ -0,0 +1,142 @@
+/*
+ * FilterPipeline: response and cost per sample
+ *
+ * Publishes at 25 samples per decimate() (5 Hz sampling, 5 s interval) and
+ * checks the chain against its analytic response:
+ *  - constant input, positive and negative, comes back within one fixed
+ *    point step
+ *  - a step follows the EMA (alpha = 2^-HIGH_RATE_EMA_SHIFT), one sample
+ *    late through the median
+ *  - a single-sample spike per block is dropped by the median-of-3
+ *  - Gaussian noise is reduced by the boxcar (1/sqrt(N)) and the EMA
+ *    (sqrt(alpha / (2 - alpha)))
+ *  - non-finite samples are ignored, an empty block publishes NaN
+ * and reports host cycles per push() and per decimate().
+ */
+
+#include "HostTest.h"
+#include "FilterPipeline.h"
+#include <random>
+
+constexpr int BLOCK = 25;            // Samples per published value
+constexpr float SCALE = 100.0f;      // 0.01 units
+constexpr float STEP = 1.0f / SCALE;
+constexpr double ALPHA = 1.0 / (1 << HIGH_RATE_EMA_SHIFT);
+
+static float publishConstant(FilterPipeline& filter, float value) {
+  for (int i = 0; i < BLOCK; i++) {
+    filter.push(value);
+  }
+  return filter.decimate();
+}
+
+int main() {
+  // Constant input (accumulator below zero for negative values)
+  for (float value : { 21.37f, 0.0f, -0.01f, -12.34f, -40.0f, 1013.25f }) {
+    FilterPipeline filter(SCALE);
+    float output = NAN;
+    for (int k = 0; k < 10; k++) {
+      output = publishConstant(filter, value);
+      CHECK(fabsf(output - value) <= STEP);
+    }
+    host::report("constant %8.2f -> %8.3f", value, output);
+  }
+
+  // Step from -5 to +5: EMA response per published value
+  {
+    FilterPipeline filter(SCALE);
+    for (int k = 0; k < 5; k++) {
+      publishConstant(filter, -5.0f);
+    }
+    // The median holds the first sample after the step back, so the first
+    // block averages one -5 in: x1 = 5 - 10 / BLOCK, then x = 5
+    double expected = -5.0;
+    double worst = 0;
+    for (int k = 1; k <= 12; k++) {
+      const float output = publishConstant(filter, 5.0f);
+      expected += ALPHA * ((k == 1 ? 5.0 - 10.0 / BLOCK : 5.0) - expected);
+      worst = max(worst, fabs(output - expected));
+    }
+    host::report("step -5 -> +5: worst deviation from the analytic EMA %.4f over 12 publishes", worst);
+    CHECK(worst <= 2 * STEP);
+  }
+
+  // One spike per block, at any position, never reaches the output
+  {
+    FilterPipeline filter(SCALE);
+    publishConstant(filter, 20.0f);
+    for (int position = 0; position < BLOCK; position++) {
+      for (int i = 0; i < BLOCK; i++) {
+        filter.push(i == position ? (position % 2 ? 85.0f : -145.0f) : 20.0f);
+      }
+      CHECK(fabsf(filter.decimate() - 20.0f) <= STEP);
+    }
+  }
+
+  // Noise reduction on a Gaussian trace
+  {
+    std::mt19937 random(29);
+    std::normal_distribution<float> noise(0.0f, 0.5f);
+    FilterPipeline filter(SCALE);
+    double sum = 0, sumSquares = 0;
+    constexpr int PUBLISHES = 4000;
+    for (int k = 0; k < PUBLISHES + 20; k++) {
+      for (int i = 0; i < BLOCK; i++) {
+        filter.push(10.0f + noise(random));
+      }
+      const double output = filter.decimate() - 10.0;
+      if (k >= 20) {
+        sum += output;
+        sumSquares += output * output;
+      }
+    }
+    const double mean = sum / PUBLISHES;
+    const double sigma = sqrt(sumSquares / PUBLISHES - mean * mean);
+    // Median-of-3 costs some efficiency against plain averaging (~1.2x on Gaussian noise)
+    const double ideal = 0.5 / sqrt((double)BLOCK) * sqrt(ALPHA / (2 - ALPHA));
+    host::report("noise sigma 0.5 -> %.4f (boxcar + EMA alone: %.4f), bias %+.4f", sigma, ideal, mean);
+    CHECK(sigma < 1.5 * ideal);
+    CHECK(fabs(mean) < STEP);
+  }
+
+  // Non-finite samples are ignored, nothing pushed publishes NaN
+  {
+    FilterPipeline filter(SCALE);
+    CHECK(isnan(filter.decimate()));
+    filter.push(NAN);
+    filter.push(INFINITY);
+    CHECK(isnan(filter.decimate()));
+    filter.push(3.0f);
+    filter.push(NAN);
+    CHECK(fabsf(filter.decimate() - 3.0f) <= STEP);
+    filter.reset();
+    CHECK(isnan(filter.decimate()));
+  }
+
+  // Cost per sample and per publish
+  {
+    FilterPipeline filter(SCALE);
+    constexpr int BLOCKS = 100000;
+    float samples[BLOCK];
+    for (int i = 0; i < BLOCK; i++) {
+      samples[i] = 20.0f + 0.01f * i;
+    }
+    volatile float sink = 0;
+    uint64_t pushCycles = 0, decimateCycles = 0;
+    for (int k = 0; k < BLOCKS; k++) {
+      uint64_t start = host::cycles();
+      for (int i = 0; i < BLOCK; i++) {
+        filter.push(samples[i]);
+      }
+      pushCycles += host::cycles() - start;
+      start = host::cycles();
+      sink = filter.decimate();
+      decimateCycles += host::cycles() - start;
+    }
+    (void)sink;
+    host::report("host cycles: %.1f per push(), %.1f per decimate()", (double)pushCycles / BLOCKS / BLOCK,
+                 (double)decimateCycles / BLOCKS);
+  }
+
+  host::finish("filter_pipeline");
+}
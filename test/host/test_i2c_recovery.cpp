@@ -0,0 +1,279 @@
+/*
+ * I2C recovery: fault injection and MTTR against the reboot path
+ *
+ * A BME280 on bus #1 is hit by three kinds of faults at random times:
+ *  - stuck SDA: the slave holds SDA mid-byte until clocked out (1-9 clocks)
+ *  - NACK storm: every address NACKs for 1-30 s, then the bus works again
+ *  - power glitch: the sensor NACKs for 1-30 s and comes back reset (sleep,
+ *    default registers - it has to be configured again)
+ * and the time from the fault becoming repairable (onset for stuck SDA, end
+ * of the storm / glitch otherwise) to the next valid published reading is
+ * measured for
+ *  - in place: SensorManager with bus clear, re-init and backoff
+ *  - reboot path: the firmware before in-place recovery - readings turn
+ *    invalid and stay so until a reset; modelled as a reset on the first
+ *    invalid reading (boot + WiFi time), begin() without a bus clear, and
+ *    the 60 s wait + ESP.restart() loop when begin() fails
+ */
+
+#include "HostTest.h"
+#include "HostI2C.h"
+#include "HostBme280.h"
+#include "SensorManager.h"
+#include "EventLog.h"
+#include <Adafruit_BME280.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+constexpr uint64_t MS = 1000;
+constexpr uint64_t HORIZON_US = 15 * 60 * 1000 * MS;  // Give up on a trial after 15 min
+constexpr uint64_t REBOOT_BOOT_US = 4000 * MS;         // Boot + WiFi association before setup() reads
+constexpr uint64_t REBOOT_WAIT_US = 60000 * MS;        // Former begin() failure wait before ESP.restart()
+constexpr int TRIALS = 40;
+
+// Read interval of the active sampling profile (µs)
+static uint64_t intervalUs() {
+  return samplingProfiles.getActive().intervalMs * MS;
+}
+
+enum class Fault { STUCK_SDA, NACK_STORM, POWER_GLITCH };
+
+static const char* faultName(Fault fault) {
+  switch (fault) {
+    case Fault::STUCK_SDA:
+      return "stuck SDA";
+    case Fault::NACK_STORM:
+      return "NACK storm";
+    default:
+      return "power glitch";
+  }
+}
+
+struct Trial {
+  Fault fault;
+  uint64_t onset;      // µs after the station is up
+  uint64_t duration;   // NACK storm / glitch length (µs)
+  uint8_t clocks;      // Stuck SDA: clocks to release
+};
+
+static host::Bme280Model s_bme(7);
+static uint32_t s_inPlaceClears = 0;  // Bus clears done by in-place recovery
+
+// Fresh bus with one BME280 at 0x76 on bus #1
+static void resetBus() {
+  host::clearEvents();
+  host::i2cBus(1).reset();
+  host::i2cBus(2).reset();
+  Wire.end();
+  Wire1.end();
+  s_bme.reset();
+  host::i2cBus(1).attach(BME_I2C_ADDR, s_bme);
+}
+
+// Schedule the fault relative to now, returns the time it becomes repairable
+static uint64_t injectFault(const Trial& trial) {
+  const uint64_t onset = host::now() + trial.onset;
+  host::I2CBus& bus = host::i2cBus(1);
+
+  switch (trial.fault) {
+    case Fault::STUCK_SDA:
+      host::at(onset, [&bus, trial]() { bus.holdSda(trial.clocks); });
+      return onset;
+    case Fault::NACK_STORM:
+      host::at(onset, [&bus, onset, trial]() { bus.nackUntil(onset + trial.duration); });
+      return onset + trial.duration;
+    default:
+      host::at(onset, [&bus, onset, trial]() { bus.nackUntil(onset + trial.duration); });
+      host::at(onset + trial.duration, []() { s_bme.reset(); });
+      return onset + trial.duration;
+  }
+}
+
+static bool isCorrect(float temperature) {
+  return isfinite(temperature) && fabs(temperature - s_bme.temperature) < 0.5;
+}
+
+// In-place recovery: measurement job of the firmware at getNextReadTime()
+// Returns µs from 'repairable' to the first valid reading at or after it
+// (a storm between two reads costs nothing beyond the wait for the next read;
+// UINT64_MAX = never)
+static uint64_t runInPlace(const Trial& trial) {
+  resetBus();
+  auto manager = std::make_unique<SensorManager>();
+  CHECK(manager->begin());
+
+  const uint64_t start = host::now();
+  const uint64_t repairable = injectFault(trial);
+
+  while (host::now() - start < HORIZON_US) {
+    const uint32_t next = manager->getNextReadTime(millis());
+    if ((int32_t)(next - millis()) > 0) {
+      host::advance((uint64_t)(next - millis()) * MS);
+    }
+    manager->readSensors();
+
+    const SensorData& data = manager->getSensorData();
+    if (data.isValid && isCorrect(data.temperature) && host::now() >= repairable) {
+      s_inPlaceClears += host::i2cBus(1).getClears();
+      return host::now() - repairable;
+    }
+  }
+  return UINT64_MAX;
+}
+
+// Firmware before in-place recovery (begin/read of the former SensorManager)
+class RebootPathStation {
+public:
+  bool begin() {
+    Wire.begin(I2C1_SDA_PIN, I2C1_SCL_PIN);
+    Wire.setClock(I2C_CLOCK_SPEED);
+    if (!m_bme.begin(BME_I2C_ADDR, &Wire)) {
+      return false;
+    }
+    // Library default setSampling(): normal mode, x16, standby 0.5 ms
+    const uint8_t writes[][2] = { { 0xF4, 0x00 }, { 0xF2, 0x05 }, { 0xF5, 0x00 }, { 0xF4, 0xB7 } };
+    for (const auto& write : writes) {
+      Wire.beginTransmission(BME_I2C_ADDR);
+      Wire.write(write[0]);
+      Wire.write(write[1]);
+      if (Wire.endTransmission() != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool read() {
+    return isCorrect(m_bme.readTemperature()) && isfinite(m_bme.readPressure());
+  }
+
+private:
+  Adafruit_BME280 m_bme;
+};
+
+static uint64_t runRebootPath(const Trial& trial) {
+  resetBus();
+  RebootPathStation station;
+  CHECK(station.begin());
+
+  const uint64_t start = host::now();
+  const uint64_t repairable = injectFault(trial);
+
+  while (host::now() - start < HORIZON_US) {
+    host::advance(intervalUs());
+    if (station.read()) {
+      if (host::now() >= repairable) {
+        return host::now() - repairable;
+      }
+      continue;
+    }
+
+    // Reset on the first invalid reading (sensor keeps power, bus is not clocked)
+    do {
+      Wire.end();
+      host::advance(REBOOT_BOOT_US);
+      station = RebootPathStation();
+      if (station.begin()) {
+        break;
+      }
+      host::advance(REBOOT_WAIT_US);
+    } while (host::now() - start < HORIZON_US);
+  }
+  return UINT64_MAX;
+}
+
+struct Summary {
+  double sumUs = 0;
+  uint64_t worstUs = 0;
+  int recovered = 0;
+
+  void add(uint64_t us) {
+    if (us != UINT64_MAX) {
+      sumUs += us;
+      worstUs = max(worstUs, us);
+      recovered++;
+    }
+  }
+
+  double meanSeconds() const {
+    return recovered ? sumUs / recovered / 1e6 : NAN;
+  }
+};
+
+int main() {
+  eventLog.begin();
+  std::mt19937 random(26);
+
+  for (Fault fault : { Fault::STUCK_SDA, Fault::NACK_STORM, Fault::POWER_GLITCH }) {
+    Summary inPlace, rebootPath;
+    const uint32_t recoveredBefore = eventLog.getNextSequence();
+
+    for (int i = 0; i < TRIALS; i++) {
+      Trial trial;
+      trial.fault = fault;
+      trial.onset = (10000 + random() % 60000) * MS;
+      trial.duration = (1000 + random() % 29000) * MS;
+      trial.clocks = 1 + random() % 9;
+
+      inPlace.add(runInPlace(trial));
+      rebootPath.add(runRebootPath(trial));
+    }
+
+    host::report("%-12s in place: %2d/%d recovered, MTTR %6.1f s (worst %5.1f s) | "
+                 "reboot path: %2d/%d recovered, MTTR %6.1f s",
+                 faultName(fault), inPlace.recovered, TRIALS, inPlace.meanSeconds(), inPlace.worstUs / 1e6,
+                 rebootPath.recovered, TRIALS, rebootPath.meanSeconds());
+
+    // Every fault is repaired in place within the backoff cap plus one read interval
+    CHECK(inPlace.recovered == TRIALS);
+    CHECK(inPlace.worstUs <= I2C_RECOVERY_MAX_BACKOFF_MS * MS + 2 * intervalUs());
+    CHECK(eventLog.getNextSequence() > recoveredBefore);
+
+    if (fault == Fault::STUCK_SDA) {
+      // A reset does not clock the bus - the former firmware never gets the sensor back
+      CHECK(rebootPath.recovered == 0);
+      // Offline after the failure threshold, cleared and re-initialized on the next read
+      CHECK(inPlace.worstUs <= (I2C_RECOVERY_FAILURE_THRESHOLD + 1) * intervalUs() + 100 * MS);
+      CHECK(s_inPlaceClears >= (uint32_t)TRIALS);
+    } else {
+      CHECK(rebootPath.recovered == TRIALS);
+      CHECK(inPlace.meanSeconds() < rebootPath.meanSeconds());
+    }
+  }
+
+  // Latched slave that never lets go: recovery keeps retrying with capped backoff
+  resetBus();
+  auto manager = std::make_unique<SensorManager>();
+  CHECK(manager->begin());
+  host::i2cBus(1).holdSda(0);
+  uint32_t attempts = 0;
+  uint32_t lastFailures = 0;
+  for (int minute = 0; minute < 30; minute++) {
+    const uint64_t end = host::now() + 60000 * MS;
+    while (host::now() < end) {
+      host::advance((uint64_t)(manager->getNextReadTime(millis()) - millis()) * MS);
+      manager->readSensors();
+    }
+    attempts = host::i2cBus(1).getClears();
+    lastFailures = host::i2cBus(1).getFailedTransactions();
+  }
+  CHECK(!manager->getSensorData().isValid);
+  CHECK(manager->getSensor<Bme280Sensor>().state().retryDelayMs == I2C_RECOVERY_MAX_BACKOFF_MS);
+  host::report("latched SDA: %u bus clears, %u failed transactions in 30 min (backoff capped at %lu s)",
+               attempts, lastFailures, (unsigned long)(I2C_RECOVERY_MAX_BACKOFF_MS / 1000));
+  CHECK(attempts < 30 + 10);
+
+  // Released by a power cycle: back within one backoff period
+  const uint64_t released = host::now();
+  host::i2cBus(1).powerCycle();
+  while (!manager->getSensorData().isValid && host::now() - released < HORIZON_US) {
+    host::advance((uint64_t)(manager->getNextReadTime(millis()) - millis()) * MS);
+    manager->readSensors();
+  }
+  CHECK(manager->getSensorData().isValid);
+  CHECK(host::now() - released <= I2C_RECOVERY_MAX_BACKOFF_MS * MS + intervalUs());
+  host::report("after power cycle: valid again in %.1f s", (host::now() - released) / 1e6);
+
+  host::finish("i2c_recovery");
+}
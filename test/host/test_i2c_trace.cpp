@@ -0,0 +1,151 @@
+/*
+ * I2C trace: record a field run, replay it into SensorManager
+ *
+ * SensorManager reads a modelled BME280 (Bus #1) and BH1750 (Bus #2) through
+ * the TracedWire buses while the trace records, with a NACK storm on Bus #1
+ * in the middle of the run (the kind of field glitch a trace is downloaded
+ * for). The devices are then removed and a fresh SensorManager is fed from
+ * the trace alone: it must see every transaction in the recorded order
+ * (zero divergences) and publish bit-identical readings, failures and the
+ * recovery included. A changed sampling profile must show up as divergences,
+ * a truncated or corrupt trace must be handled. Reported are the trace size
+ * per measurement cycle and the host cost of a replayed cycle against one
+ * on the modelled bus.
+ */
+
+#include "HostTest.h"
+#include "HostI2C.h"
+#include "HostBme280.h"
+#include "HostBh1750.h"
+#include "SensorManager.h"
+#include "I2CTrace.h"
+#include "EventLog.h"
+#include <memory>
+#include <vector>
+
+constexpr int CYCLES = 60;
+constexpr int STORM_CYCLE = 20;          // NACK storm starts before this cycle
+constexpr uint64_t STORM_US = 12000000;  // and lasts 12 s
+
+static host::Bme280Model s_bme(45);
+static host::Bh1750Model s_bh1750;
+
+// Published readings of one cycle, compared bit for bit
+struct Reading {
+  float temperature;
+  float humidity;
+  float pressure;
+  float lightLevel;
+  bool valid;
+
+  bool operator==(const Reading& other) const {
+    return memcmp(&temperature, &other.temperature, 4 * sizeof(float)) == 0 && valid == other.valid;
+  }
+};
+
+// Wait for the next scheduled read and do it; in replay the clock never runs behind the trace
+static Reading readNext(SensorManager& manager) {
+  const uint32_t next = manager.getNextReadTime(millis());
+  if ((int32_t)(next - millis()) > 0) {
+    host::advance((uint64_t)(next - millis()) * 1000);
+  }
+  if (i2cTrace.isReplaying() && (int32_t)(i2cTrace.getReplayMicros() - micros()) > 0) {
+    host::advance(i2cTrace.getReplayMicros() - micros());
+  }
+  manager.readSensors();
+  const SensorData& data = manager.getSensorData();
+  return { data.temperature, data.humidity, data.pressure, data.lightLevel, data.isValid };
+}
+
+// Measurement cycles from boot (trace time base) - storm on Bus #1 when 'storm' is set
+static std::vector<Reading> run(uint64_t bootUs, int cycles, bool storm) {
+  host::setTime(bootUs);
+  auto manager = std::make_unique<SensorManager>();
+  manager->begin();
+  std::vector<Reading> readings;
+  for (int cycle = 0; cycle < cycles; cycle++) {
+    if (storm && cycle == STORM_CYCLE) {
+      host::i2cBus(1).nackUntil(host::now() + STORM_US);
+    }
+    s_bme.temperature = 20.0 + cycle * 0.05;
+    s_bh1750.lux = 300.0 + cycle * 7.0;
+    readings.push_back(readNext(*manager));
+  }
+  return readings;
+}
+
+int main() {
+  eventLog.begin();
+  host::i2cBus(1).attach(BME_I2C_ADDR, s_bme);
+  host::i2cBus(2).attach(BH1750_I2C_ADDR, s_bh1750);
+  const uint64_t bootUs = host::now();
+
+  // Record
+  std::vector<Reading> recorded;
+  const double recordNs = host::measureNs([&]() { recorded = run(bootUs, CYCLES, true); });
+  const uint64_t busUs = host::i2cBus(1).getBusyTimeUs() + host::i2cBus(2).getBusyTimeUs();
+  const std::vector<uint8_t> trace(i2cTrace.getData(), i2cTrace.getData() + i2cTrace.getLength());
+  uint32_t failedCycles = 0;
+  for (const Reading& reading : recorded) {
+    failedCycles += isnan(reading.temperature);
+  }
+  CHECK(trace.size() > I2C_TRACE_HEADER_SIZE && trace.size() < I2C_TRACE_BUFFER_SIZE);
+  CHECK(failedCycles > 0 && !isnan(recorded.back().temperature));
+  host::report("recorded %d cycles (%u without BME280 during the NACK storm): %zu bytes, %.0f bytes per cycle",
+               CYCLES, failedCycles, trace.size(), (double)trace.size() / CYCLES);
+
+  // Replay without devices: same transactions, same readings
+  host::i2cBus(1).reset();
+  host::i2cBus(2).reset();
+  CHECK(i2cTrace.beginReplay(trace.data(), trace.size()));
+  const std::vector<Reading> replayed = run(bootUs, CYCLES, false);
+  uint32_t identical = 0;
+  for (int cycle = 0; cycle < CYCLES; cycle++) {
+    identical += replayed[cycle] == recorded[cycle];
+  }
+  uint8_t flags, address, result, length;
+  const uint8_t* data;
+  const bool exhausted = !i2cTrace.next(flags, address, result, data, length);
+  CHECK(i2cTrace.getDivergences() == 0);
+  CHECK(identical == CYCLES);
+  CHECK(exhausted);
+  host::report("replay: %u divergences, %u / %d cycles bit-identical, trace fully consumed: %s",
+               i2cTrace.getDivergences(), identical, CYCLES, exhausted ? "yes" : "no");
+
+  // Changed firmware behaviour is caught (other ctrl_meas / config writes)
+  {
+    CHECK(samplingProfiles.select("high-precision"));
+    CHECK(i2cTrace.beginReplay(trace.data(), trace.size()));
+    run(bootUs, 3, false);
+    const uint32_t divergences = i2cTrace.getDivergences();
+    CHECK(divergences > 0);
+    CHECK(samplingProfiles.select(SAMPLING_DEFAULT_PROFILE));
+    host::report("replay with the high-precision profile: %u divergences in 3 cycles", divergences);
+  }
+
+  // Truncated trace: readings fail once it runs out, no crash; corrupt header is rejected
+  {
+    CHECK(i2cTrace.beginReplay(trace.data(), trace.size() / 2));
+    const std::vector<Reading> truncated = run(bootUs, CYCLES, false);
+    CHECK(i2cTrace.getDivergences() > 0);
+    CHECK(truncated.front() == recorded.front());
+    CHECK(!truncated.back().valid);
+
+    std::vector<uint8_t> corrupt = trace;
+    corrupt[0] = 'X';
+    CHECK(!i2cTrace.beginReplay(corrupt.data(), corrupt.size()));
+  }
+
+  // Benchmark: the sensor path on recorded data, free of bus timing
+  constexpr int ROUNDS = 50;
+  const double replayNs = host::measureNs([&]() {
+    for (int round = 0; round < ROUNDS; round++) {
+      i2cTrace.beginReplay(trace.data(), trace.size());
+      run(bootUs, CYCLES, false);
+    }
+  }) / ROUNDS;
+  host::report("host time per cycle: %.1f us replayed, %.1f us on the modelled bus (%.1f ms bus time per cycle)",
+               replayNs / CYCLES / 1000, recordNs / CYCLES / 1000, busUs / 1000.0 / CYCLES);
+
+  host::finish("i2c_trace");
+}
@@ -0,0 +1,189 @@
+/*
+ * LoopGuard: stall injection and watchdog attribution
+ *
+ * A simulated loop() runs its stages on the virtual clock; a seeded
+ * schedule makes some stages block for 20 ms - 2 s. Checked against the
+ * injected schedule: stall counts and worst durations per stage, one
+ * LOOP_STALL event per stall with stage and duration, one watchdog feed per
+ * iteration. Then a stage hangs past TASK_WATCHDOG_TIMEOUT_MS: the test's
+ * watchdog model resets the station and the next begin() must blame that
+ * stage (for every stage), keep the counters over the reset and log
+ * WATCHDOG_RESET. Power-on clears the statistics.
+ */
+
+#include "HostTest.h"
+#include "LoopGuard.h"
+#include "EventLog.h"
+#include <random>
+
+constexpr uint64_t MS = 1000;
+constexpr uint8_t STAGES = (uint8_t)LoopStage::COUNT;
+constexpr int ITERATIONS = 20000;
+
+struct StageStats {
+  uint32_t stalls;
+  uint32_t worstUs;
+  uint32_t watchdogResets;
+};
+
+static char s_json[2048];
+
+static const char* stallsJSON(const LoopGuard& guard) {
+  JsonWriter json(s_json, sizeof(s_json));
+  json.beginObject();
+  guard.writeJSON(json);
+  json.endObject();
+  return s_json;
+}
+
+static StageStats stageStats(const LoopGuard& guard, LoopStage stage) {
+  StageStats stats = { UINT32_MAX, UINT32_MAX, UINT32_MAX };
+  char key[48];
+  snprintf(key, sizeof(key), "{\"stage\":\"%s\",", LoopGuard::getStageName(stage));
+  const char* entry = strstr(stallsJSON(guard), key);
+  if (entry) {
+    sscanf(entry + strlen(key), "\"stalls\":%u,\"worstUs\":%u,\"watchdogResets\":%u", &stats.stalls, &stats.worstUs,
+           &stats.watchdogResets);
+  }
+  return stats;
+}
+
+// Events of one code since a sequence number: count, arg0/arg1 of each via callback
+template <class Callback>
+static uint32_t events(uint32_t since, EventCode code, Callback&& callback) {
+  static char buffer[EVENT_LOG_CAPACITY * 96 + 16];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginArray();
+  eventLog.writeJSON(json, since, EVENT_LOG_CAPACITY);
+  json.endArray();
+
+  char pattern[48];
+  snprintf(pattern, sizeof(pattern), "\"code\":\"%s\"", EventLog::getCodeName((uint16_t)code));
+  uint32_t count = 0;
+  for (const char* cursor = buffer; (cursor = strstr(cursor, pattern)) != nullptr; cursor++) {
+    int arg0 = 0, arg1 = 0;
+    const char* args = strstr(cursor, "\"arg0\":");
+    if (args && sscanf(args, "\"arg0\":%d,\"arg1\":%d", &arg0, &arg1) == 2) {
+      callback(arg0, arg1);
+    }
+    count++;
+  }
+  return count;
+}
+
+// Reset as the ESP32 does: RTC RAM survives, the next boot runs begin()
+static void reset(LoopGuard& guard, esp_reset_reason_t reason) {
+  host::setResetReason(reason);
+  eventLog.begin();
+  guard = LoopGuard();
+  guard.begin();
+}
+
+int main() {
+  host::setResetReason(ESP_RST_POWERON);
+  eventLog.begin();
+  LoopGuard guard;
+  guard.begin();
+
+  // Stall injection: ~2% of stages block, a third of those stay under budget
+  std::mt19937 random(34);
+  static const uint32_t BLOCKS_MS[] = { 20, LOOP_STAGE_BUDGET_MS, LOOP_STAGE_BUDGET_MS + 1, 250, 800, 2000 };
+  uint32_t expectedStalls[STAGES] = {};
+  uint32_t expectedWorstUs[STAGES] = {};
+  uint32_t injected = 0;
+  uint32_t eventsLost = 0;
+  const uint32_t feedsBefore = host::getWatchdogFeeds();
+  uint32_t since = eventLog.getNextSequence() - 1;
+  uint32_t stallEvents = 0;
+  uint32_t eventMismatches = 0;
+
+  for (int i = 0; i < ITERATIONS; i++) {
+    host::advance(5 * MS);  // Idle wait of the scheduler
+    guard.beginIteration();
+    for (uint8_t stage = 1; stage < STAGES; stage++) {
+      guard.enterStage((LoopStage)stage);
+      uint32_t durationUs = 200 + random() % 800;  // Normal stage: 0.2-1 ms
+      if (random() % 50 == 0) {
+        durationUs = BLOCKS_MS[random() % (sizeof(BLOCKS_MS) / sizeof(BLOCKS_MS[0]))] * 1000;
+        injected++;
+      }
+      host::advance(durationUs);
+      expectedStalls[stage] += durationUs > LOOP_STAGE_BUDGET_MS * 1000;
+      expectedWorstUs[stage] = max(expectedWorstUs[stage], durationUs);
+    }
+    guard.endIteration();
+
+    // Drain the journal before it wraps: every stall logged with stage and duration
+    if (i % 8 == 7) {
+      const uint32_t next = eventLog.getNextSequence();
+      eventsLost += next - 1 - since > EVENT_LOG_CAPACITY;
+      stallEvents += events(since, EventCode::LOOP_STALL, [&](int stage, int ms) {
+        bool valid = false;
+        for (uint32_t block : BLOCKS_MS) {
+          valid |= (uint32_t)ms == block;
+        }
+        eventMismatches += stage < 1 || stage >= STAGES || !valid || (uint32_t)ms <= LOOP_STAGE_BUDGET_MS;
+      });
+      since = next - 1;
+    }
+  }
+  stallEvents += events(since, EventCode::LOOP_STALL, [](int, int) {});
+
+  uint32_t totalStalls = 0;
+  bool countsMatch = true;
+  for (uint8_t stage = 1; stage < STAGES; stage++) {
+    const StageStats stats = stageStats(guard, (LoopStage)stage);
+    countsMatch &= stats.stalls == expectedStalls[stage] && stats.worstUs == expectedWorstUs[stage];
+    totalStalls += expectedStalls[stage];
+    host::report("%-14s %4u stalls, worst %4u ms", LoopGuard::getStageName((LoopStage)stage), stats.stalls,
+                 stats.worstUs / 1000);
+  }
+  CHECK(countsMatch);
+  CHECK(eventsLost == 0);
+  CHECK(stallEvents == totalStalls);
+  CHECK(eventMismatches == 0);
+  CHECK(host::getWatchdogFeeds() - feedsBefore == ITERATIONS);
+  host::report("%d iterations, %u blocking stages injected: %u over the %u ms budget, all counted and logged",
+               ITERATIONS, injected, totalStalls, LOOP_STAGE_BUDGET_MS);
+
+  // Hang in each stage: the watchdog (modelled here) fires, the next boot blames the stage
+  for (uint8_t stage = 1; stage < STAGES; stage++) {
+    const StageStats before = stageStats(guard, (LoopStage)stage);
+    const uint32_t feeds = host::getWatchdogFeeds();
+    const uint64_t hangStart = host::now();
+
+    guard.beginIteration();
+    guard.enterStage((LoopStage)stage);
+    while (host::getWatchdogFeeds() == feeds && host::now() - hangStart <= TASK_WATCHDOG_TIMEOUT_MS * MS) {
+      host::advance(100 * MS);
+    }
+    CHECK(host::getWatchdogFeeds() == feeds);
+
+    const uint32_t eventsSince = eventLog.getNextSequence() - 1;
+    reset(guard, ESP_RST_TASK_WDT);
+
+    const StageStats after = stageStats(guard, (LoopStage)stage);
+    CHECK(after.watchdogResets == before.watchdogResets + 1);
+    CHECK(after.stalls == before.stalls);  // Hung stage never closed: no stall, statistics kept
+    char expected[64];
+    snprintf(expected, sizeof(expected), "\"lastWatchdogStage\":\"%s\"", LoopGuard::getStageName((LoopStage)stage));
+    CHECK(strstr(stallsJSON(guard), expected) != nullptr);
+
+    int blamed = -1;
+    CHECK(events(eventsSince, EventCode::WATCHDOG_RESET, [&](int arg0, int) { blamed = arg0; }) == 1);
+    CHECK(blamed == stage);
+  }
+  host::report("watchdog hang injected in each of %d stages: reset attributed to the hung stage every time",
+               STAGES - 1);
+
+  // Software reset keeps the counters, power-on clears them
+  const StageStats kept = stageStats(guard, LoopStage::READ_SENSORS);
+  reset(guard, ESP_RST_SW);
+  CHECK(stageStats(guard, LoopStage::READ_SENSORS).stalls == kept.stalls);
+  reset(guard, ESP_RST_POWERON);
+  const StageStats cleared = stageStats(guard, LoopStage::READ_SENSORS);
+  CHECK(cleared.stalls == 0 && cleared.worstUs == 0 && cleared.watchdogResets == 0);
+  CHECK(strstr(stallsJSON(guard), "\"lastWatchdogStage\":\"idle\"") != nullptr);
+
+  host::finish("loop_guard");
+}
@@ -0,0 +1,300 @@
+/*
+ * LTTB downsampling: reference comparison and throughput
+ *
+ * lttbDownsample() (Lttb.h) runs over synthetic day and week series (diurnal
+ * sine with noise, random walk, steps, isolated spikes) and is compared with
+ * a textbook array implementation of Largest-Triangle-Three-Buckets in double
+ * precision: every selected point must be the reference's choice or form a
+ * triangle that ties with it within float rounding (values are quantized to
+ * 0.01 on a minute grid, so exact ties are common). Series with gaps must
+ * never emit a gap and keep the output ordered and within the point budget,
+ * also below 3 points (first point only for 1, first and last for 2).
+ * Reported are the throughput per input point and the cost of a full
+ * /api/v1/chart query through SampleHistory.
+ */
+
+#include "HostTest.h"
+#include "Lttb.h"
+#include "SampleHistory.h"
+#include <memory>
+#include <random>
+#include <vector>
+
+constexpr uint32_t MINUTE_MS = 60000;
+
+struct Point {
+  uint32_t x;
+  float y;
+};
+
+// Textbook LTTB over an array in double precision. Bucket bounds are
+// floor(b * (count - 2) / (threshold - 2)) + 1 computed exactly: with the
+// width as a double, floor() lands one point short where the bound is integer
+static uint32_t referenceBound(uint32_t bucket, uint32_t count, uint32_t threshold) {
+  return (uint32_t)((uint64_t)bucket * (count - 2) / (threshold - 2)) + 1;
+}
+
+// With 'follow' (a selection of the same length), point A of each bucket is
+// taken from it instead, and 'shortfall' receives the largest relative
+// amount by which a followed point's triangle is smaller than the best one
+static std::vector<uint32_t> referenceLttb(const std::vector<Point>& data, uint32_t threshold,
+                                           const std::vector<uint32_t>* follow = nullptr,
+                                           double* shortfall = nullptr) {
+  std::vector<uint32_t> sampled;
+  const uint32_t count = data.size();
+  if (threshold >= count || threshold < 3) {
+    for (uint32_t i = 0; i < count; i++) {
+      sampled.push_back(i);
+    }
+    return sampled;
+  }
+
+  uint32_t a = 0;
+  sampled.push_back(0);
+  for (uint32_t bucket = 0; bucket < threshold - 2; bucket++) {
+    const bool last = bucket + 1 == threshold - 2;
+    const uint32_t averageStart = last ? count - 1 : referenceBound(bucket + 1, count, threshold);
+    const uint32_t averageEnd = last ? count : referenceBound(bucket + 2, count, threshold);
+    double averageX = 0.0;
+    double averageY = 0.0;
+    for (uint32_t i = averageStart; i < averageEnd; i++) {
+      averageX += data[i].x;
+      averageY += data[i].y;
+    }
+    averageX /= averageEnd - averageStart;
+    averageY /= averageEnd - averageStart;
+
+    auto area = [&](uint32_t i) {
+      return fabs(((double)data[a].x - averageX) * ((double)data[i].y - data[a].y) -
+                  ((double)data[a].x - data[i].x) * (averageY - data[a].y));
+    };
+    const uint32_t start = referenceBound(bucket, count, threshold);
+    const uint32_t end = referenceBound(bucket + 1, count, threshold);
+    double maxArea = -1.0;
+    uint32_t next = start;
+    for (uint32_t i = start; i < end; i++) {
+      if (area(i) > maxArea) {
+        maxArea = area(i);
+        next = i;
+      }
+    }
+    sampled.push_back(next);
+
+    if (follow) {
+      const uint32_t followed = (*follow)[bucket + 1];
+      const double missing = followed >= start && followed < end ? maxArea - area(followed) : maxArea;
+      *shortfall = max(*shortfall, maxArea > 0.0 ? missing / maxArea : 0.0);
+      next = followed;
+    }
+    a = next;
+  }
+  sampled.push_back(count - 1);
+  return sampled;
+}
+
+static std::vector<uint32_t> deviceLttb(const std::vector<Point>& data, uint32_t threshold) {
+  std::vector<uint32_t> sampled;
+  lttbDownsample(data.size(), threshold,
+    [&data](uint32_t i, uint32_t& x, float& y) {
+      x = data[i].x;
+      y = data[i].y;
+      return isfinite(y);
+    },
+    [&sampled](uint32_t i, uint32_t, float) { sampled.push_back(i); });
+  return sampled;
+}
+
+enum class Shape { DIURNAL, WALK, STEPS, SPIKES };
+
+static const char* const SHAPE_NAMES[] = { "diurnal", "walk", "steps", "spikes" };
+
+// One sample per minute, values in the range of a temperature channel
+static std::vector<Point> series(Shape shape, uint32_t count, std::mt19937& random) {
+  std::normal_distribution<float> gauss(0.0f, 1.0f);
+  std::vector<Point> data(count);
+  float walk = 15.0f;
+  for (uint32_t i = 0; i < count; i++) {
+    const float day = (float)i / 1440;
+    float y = 15.0f + 8.0f * sinf(day * 6.2832f);
+    switch (shape) {
+      case Shape::DIURNAL: y += 0.1f * gauss(random); break;
+      case Shape::WALK: walk += 0.05f * gauss(random); y = walk; break;
+      case Shape::STEPS: y = 10.0f + 5.0f * ((i / 97) % 3) + 0.02f * gauss(random); break;
+      case Shape::SPIKES: y += 0.05f * gauss(random) + (i % 211 == 105 ? 12.0f : 0.0f); break;
+    }
+    data[i] = { i * MINUTE_MS, roundf(y * 100.0f) / 100.0f };
+  }
+  return data;
+}
+
+int main() {
+  std::mt19937 random(43);
+
+  // Same points as the reference, apart from triangles that tie within float rounding
+  static const uint32_t COUNTS[] = { 1440, 10080 };
+  static const uint32_t THRESHOLDS[] = { 3, 50, 200, 500, 1440 };
+  uint32_t compared = 0;
+  uint32_t identical = 0;
+  uint32_t wrongLength = 0;
+  double worstShortfall = 0.0;
+  for (int shape = 0; shape < 4; shape++) {
+    for (uint32_t count : COUNTS) {
+      const std::vector<Point> data = series((Shape)shape, count, random);
+      for (uint32_t threshold : THRESHOLDS) {
+        const std::vector<uint32_t> device = deviceLttb(data, threshold);
+        const std::vector<uint32_t> reference = referenceLttb(data, threshold);
+        compared++;
+        identical += device == reference;
+        if (device.size() != reference.size()) {
+          wrongLength++;
+          host::report("%s %u -> %u: %zu points, reference %zu", SHAPE_NAMES[shape], count, threshold,
+                       device.size(), reference.size());
+        } else if (device != reference) {
+          referenceLttb(data, threshold, &device, &worstShortfall);
+        }
+      }
+    }
+  }
+  CHECK(wrongLength == 0);
+  CHECK(worstShortfall < 1e-4);
+  host::report("%u series (4 shapes, 1 day and 1 week, 3-1440 points): %u identical to the reference, "
+               "the rest differ by ties (triangle at most %.1e smaller)",
+               compared, identical, worstShortfall);
+
+  // Spikes are kept: one per 211 minutes, one bucket each at 50 points per day
+  {
+    const std::vector<Point> data = series(Shape::SPIKES, 1440, random);
+    uint32_t spikes = 0;
+    uint32_t kept = 0;
+    for (uint32_t i : deviceLttb(data, 50)) {
+      kept += i % 211 == 105;
+    }
+    for (uint32_t i = 0; i < data.size(); i++) {
+      spikes += i % 211 == 105;
+    }
+    CHECK(kept == spikes);
+    host::report("1 day -> 50 points: %u / %u spikes kept", kept, spikes);
+  }
+
+  // Gaps: never emitted, output ordered and within the budget
+  {
+    uint32_t gapsEmitted = 0;
+    uint32_t unordered = 0;
+    uint32_t overBudget = 0;
+    for (int trial = 0; trial < 200; trial++) {
+      std::vector<Point> data = series(Shape::DIURNAL, 1440, random);
+      const uint32_t gaps = random() % 8;
+      for (uint32_t g = 0; g < gaps; g++) {
+        const uint32_t start = random() % data.size();
+        const uint32_t length = 1 + random() % 120;
+        for (uint32_t i = start; i < min<uint32_t>(start + length, data.size()); i++) {
+          data[i].y = NAN;
+        }
+      }
+      const uint32_t threshold = random() % 300;
+      const std::vector<uint32_t> sampled = deviceLttb(data, threshold);
+      overBudget += sampled.size() > threshold;
+      for (size_t i = 0; i < sampled.size(); i++) {
+        gapsEmitted += isnan(data[sampled[i]].y);
+        unordered += i > 0 && sampled[i] <= sampled[i - 1];
+      }
+    }
+    CHECK(gapsEmitted == 0 && unordered == 0 && overBudget == 0);
+    host::report("200 series with gaps, 0-299 points: %u gaps emitted, %u out of order, %u over the point budget",
+                 gapsEmitted, unordered, overBudget);
+  }
+
+  // Degenerate inputs
+  {
+    const std::vector<Point> empty;
+    CHECK(deviceLttb(empty, 50).empty());
+    const std::vector<Point> two = { { 0, 1.0f }, { MINUTE_MS, 2.0f } };
+    CHECK(deviceLttb(two, 3).size() == 2);
+  }
+
+  // Budgets below 3: the first (valid) point, and the last for 2
+  {
+    std::vector<Point> data = series(Shape::DIURNAL, 1440, random);
+    CHECK(deviceLttb(data, 0).empty());
+    CHECK(deviceLttb(data, 1) == std::vector<uint32_t>({ 0 }));
+    CHECK(deviceLttb(data, 2) == std::vector<uint32_t>({ 0, 1439 }));
+    for (uint32_t i = 0; i < 10; i++) {
+      data[i].y = NAN;
+      data[1439 - i].y = NAN;
+    }
+    CHECK(deviceLttb(data, 1) == std::vector<uint32_t>({ 10 }));
+    CHECK(deviceLttb(data, 2) == std::vector<uint32_t>({ 10, 1429 }));
+    for (Point& point : data) {
+      point.y = NAN;
+    }
+    CHECK(deviceLttb(data, 1).empty() && deviceLttb(data, 2).empty());
+  }
+
+  // Throughput over a week of samples
+  {
+    const std::vector<Point> data = series(Shape::WALK, 10080, random);
+    constexpr int RUNS = 200;
+    volatile uint32_t sink = 0;
+    const double ns = host::measureNs([&]() {
+      for (int run = 0; run < RUNS; run++) {
+        lttbDownsample(data.size(), 500,
+          [&data](uint32_t i, uint32_t& x, float& y) {
+            x = data[i].x;
+            y = data[i].y;
+            return isfinite(y);
+          },
+          [&sink](uint32_t i, uint32_t, float) { sink = sink + i; });
+      }
+    }) / RUNS;
+    host::report("10080 -> 500 points: %.1f ns per input point, %.0f us per run (host)", ns / data.size(),
+                 ns / 1000);
+  }
+
+  // Full chart query: 24 h of history to the most points the route sends
+  {
+    auto history = std::make_unique<SampleHistory>();
+    const std::vector<Point> data = series(Shape::DIURNAL, HISTORY_CAPACITY, random);
+    SensorData sample;
+    sample.isValid = true;
+    for (const Point& point : data) {
+      sample.temperature = point.y;
+      history->record(sample, point.x + 1);
+    }
+    CHECK(history->getCount() == HISTORY_CAPACITY);
+
+    static char buffer[32768];
+    size_t length = 0;
+    uint32_t points = 0;
+    constexpr int QUERIES = 200;
+    const double ns = host::measureNs([&]() {
+      for (int query = 0; query < QUERIES; query++) {
+        JsonWriter json(buffer, sizeof(buffer));
+        json.beginObject();
+        history->writeChartJSON(json, "temperature", 0, UINT32_MAX / 2, 150);
+        json.endObject();
+        length = json.length();
+      }
+    }) / QUERIES;
+    for (const char* point = strstr(buffer, "\"points\":[") + 10; (point = strchr(point, '[')); point++) {
+      points++;
+    }
+    CHECK(points <= 150 && points >= 145);
+    host::report("chart query over %u records -> %u points: %zu bytes, %.0f us (host)", HISTORY_CAPACITY, points,
+                 length, ns / 1000);
+
+    // One and two points: within the budget, the arena never overflows
+    for (uint16_t budget = 1; budget <= 2; budget++) {
+      JsonWriter json(buffer, RESPONSE_ARENA_SIZE);
+      json.beginObject();
+      history->writeChartJSON(json, "temperature", 0, UINT32_MAX / 2, budget);
+      json.endObject();
+      uint32_t sent = 0;
+      for (const char* point = strstr(buffer, "\"points\":[") + 10; (point = strchr(point, '[')); point++) {
+        sent++;
+      }
+      CHECK(sent == budget && !json.overflowed());
+    }
+  }
+
+  host::finish("lttb");
+}
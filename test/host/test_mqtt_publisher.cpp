@@ -0,0 +1,452 @@
+/*
+ * MqttPublisher: broker stand-in with latency and queue metrics under stalls
+ *
+ * A minimal MQTT 3.1.1 broker on a loopback socket answers CONNECT,
+ * PUBLISH (QoS 1 acknowledgements after a configurable delay) and PINGREQ,
+ * and records every packet with its arrival time. The publisher task runs
+ * on the real clock with its timeouts scaled down (see the Makefile) while
+ * the test publishes a reading every 10 ms. Phases: normal, slow broker
+ * (acknowledgements late but within MQTT_ACK_TIMEOUT_MS), stalled broker
+ * (no acknowledgement - reconnect and DUP resend), broker down, idle
+ * (keep-alive). Reported per phase: publish-to-broker latency and the
+ * queue counters; checked are the CONNECT flags and last will, the "online"
+ * state, that the broker always ends with the newest reading, that every
+ * reading is delivered or coalesced, DUP resends and that publish() never
+ * waits for the network.
+ */
+
+#include "HostTest.h"
+#include "MqttPublisher.h"
+#include "EventLog.h"
+#include <lwip/sockets.h>
+#include <poll.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr uint32_t PUBLISH_MS = 10;
+
+struct Packet {
+  std::string topic;
+  std::string payload;
+  uint8_t qos;
+  bool duplicate;
+  bool retain;
+  uint16_t packetId;
+  uint64_t at;  // host::now() on arrival
+};
+
+// MQTT 3.1.1 broker stand-in (one client at a time, a new connection takes over)
+class Broker {
+public:
+  std::atomic<uint32_t> ackDelayMs{ 0 };
+  std::atomic<bool> down{ false };
+
+  void start() {
+    std::thread([this]() { serve(); }).detach();
+  }
+
+  std::vector<Packet> publishes() {
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_publishes;
+  }
+
+  uint32_t connects() const {
+    return m_connects;
+  }
+  uint32_t pings() const {
+    return m_pings;
+  }
+  uint8_t connectFlags() const {
+    return m_connectFlags;
+  }
+  std::string will() {
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_will;
+  }
+
+private:
+  std::mutex m_lock;
+  std::vector<Packet> m_publishes;
+  std::string m_will;
+  std::atomic<uint32_t> m_connects{ 0 };
+  std::atomic<uint32_t> m_pings{ 0 };
+  std::atomic<uint8_t> m_connectFlags{ 0 };
+
+  int m_fd = -1;
+  std::string m_buffer;
+  std::multimap<uint64_t, uint16_t> m_pendingAcks;  // Due time -> packet id
+
+  static std::string readString(const std::string& body, size_t& position) {
+    const size_t length = ((uint8_t)body[position] << 8) | (uint8_t)body[position + 1];
+    const std::string text = body.substr(position + 2, length);
+    position += 2 + length;
+    return text;
+  }
+
+  void send(const uint8_t* packet, size_t length) {
+    ::send(m_fd, packet, length, MSG_NOSIGNAL);
+  }
+
+  void handle(uint8_t header, const std::string& body) {
+    const uint8_t type = header >> 4;
+    if (type == 1) {
+      // CONNECT: protocol name, level, flags, keep-alive, client id, will topic/message
+      size_t position = 0;
+      readString(body, position);
+      position++;
+      const uint8_t flags = body[position];
+      position += 3;
+      m_connectFlags = flags;
+      readString(body, position);
+      if (flags & 0x04) {
+        const std::string topic = readString(body, position);
+        const std::string message = readString(body, position);
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_will = topic + "=" + message;
+      }
+      m_connects++;
+      const uint8_t connack[] = { 0x20, 2, 0, 0 };
+      send(connack, sizeof(connack));
+    } else if (type == 3) {
+      Packet packet;
+      size_t position = 0;
+      packet.topic = readString(body, position);
+      packet.qos = (header >> 1) & 3;
+      packet.duplicate = header & 0x08;
+      packet.retain = header & 0x01;
+      packet.packetId = 0;
+      if (packet.qos) {
+        packet.packetId = ((uint8_t)body[position] << 8) | (uint8_t)body[position + 1];
+        position += 2;
+        m_pendingAcks.emplace(host::now() + ackDelayMs * 1000ULL, packet.packetId);
+      }
+      packet.payload = body.substr(position);
+      packet.at = host::now();
+      std::lock_guard<std::mutex> guard(m_lock);
+      m_publishes.push_back(packet);
+    } else if (type == 12) {
+      m_pings++;
+      const uint8_t pingresp[] = { 0xD0, 0 };
+      send(pingresp, sizeof(pingresp));
+    }
+  }
+
+  // Complete packets in the buffer
+  void process() {
+    for (;;) {
+      size_t length = 0;
+      size_t position = 1;
+      uint32_t multiplier = 1;
+      bool complete = false;
+      while (position < m_buffer.size() && position < 5) {
+        const uint8_t byte = m_buffer[position++];
+        length += (byte & 0x7F) * multiplier;
+        multiplier *= 128;
+        if (!(byte & 0x80)) {
+          complete = true;
+          break;
+        }
+      }
+      if (!complete || m_buffer.size() < position + length) {
+        return;
+      }
+      const uint8_t header = m_buffer[0];
+      const std::string body = m_buffer.substr(position, length);
+      m_buffer.erase(0, position + length);
+      handle(header, body);
+    }
+  }
+
+  void closeClient() {
+    if (m_fd >= 0) {
+      close(m_fd);
+      m_fd = -1;
+    }
+    m_buffer.clear();
+    m_pendingAcks.clear();
+  }
+
+  void serve() {
+    int listenFd = -1;
+    for (;;) {
+      if (down) {
+        closeClient();
+        if (listenFd >= 0) {
+          close(listenFd);
+          listenFd = -1;
+        }
+        usleep(1000);
+        continue;
+      }
+      if (listenFd < 0) {
+        listenFd = socket(AF_INET, SOCK_STREAM, 0);
+        const int one = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(MQTT_PORT);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(listenFd, (sockaddr*)&address, sizeof(address)) != 0 || listen(listenFd, 4) != 0) {
+          close(listenFd);
+          listenFd = -1;
+          usleep(1000);
+          continue;
+        }
+      }
+
+      // Acknowledgements that are due (only while the delay allows them at all)
+      while (!m_pendingAcks.empty() && m_pendingAcks.begin()->first <= host::now()) {
+        const uint16_t id = m_pendingAcks.begin()->second;
+        m_pendingAcks.erase(m_pendingAcks.begin());
+        const uint8_t puback[] = { 0x40, 2, (uint8_t)(id >> 8), (uint8_t)(id & 0xFF) };
+        send(puback, sizeof(puback));
+      }
+
+      pollfd waiting[2] = { { listenFd, POLLIN, 0 }, { m_fd, POLLIN, 0 } };
+      if (poll(waiting, m_fd >= 0 ? 2 : 1, 1) <= 0) {
+        continue;
+      }
+      if (waiting[0].revents & POLLIN) {
+        const int fd = accept(listenFd, nullptr, nullptr);
+        if (fd >= 0) {
+          closeClient();  // Session takeover
+          m_fd = fd;
+          continue;
+        }
+      }
+      if (m_fd >= 0 && (waiting[1].revents & (POLLIN | POLLHUP | POLLERR))) {
+        char buffer[2048];
+        const ssize_t count = recv(m_fd, buffer, sizeof(buffer), 0);
+        if (count <= 0) {
+          closeClient();
+          continue;
+        }
+        m_buffer.append(buffer, count);
+        process();
+      }
+    }
+  }
+};
+
+static Broker s_broker;
+static MqttPublisher* s_publisher = nullptr;
+static uint32_t s_sequence = 0;
+static std::vector<uint64_t> s_publishedAt;  // host::now() of publish() per sequence (index = seq)
+static uint32_t s_maxPublishUs = 0;
+
+static void sleepMs(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// Publish readings at the publish rate, as the publish job does
+static void produce(uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    SensorData data;
+    data.temperature = 20.0f + (s_sequence % 100) * 0.01f;
+    data.humidity = 50.0f;
+    data.pressure = 101325.0f;
+    data.isValid = true;
+    const uint64_t start = host::now();
+    s_publishedAt.push_back(start);
+    s_publisher->publish(data, ++s_sequence);
+    s_maxPublishUs = max(s_maxPublishUs, (uint32_t)(host::now() - start));
+    sleepMs(PUBLISH_MS);
+  }
+}
+
+// Publisher JSON field
+static long publisherStat(const char* name) {
+  char buffer[1024];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginObject();
+  s_publisher->writeJSON(json);
+  json.endObject();
+  char key[48];
+  snprintf(key, sizeof(key), "\"%s\":", name);
+  const char* field = strstr(buffer, key);
+  return field ? strtol(field + strlen(key), nullptr, 10) : -1;
+}
+
+// Sequence number of a state message (-1 for other topics)
+static long sequenceOf(const Packet& packet) {
+  const size_t field = packet.payload.find("\"seq\":");
+  if (packet.topic != std::string(MQTT_TOPIC_PREFIX) + "/state" || field == std::string::npos) {
+    return -1;
+  }
+  return strtol(packet.payload.c_str() + field + 6, nullptr, 10);
+}
+
+// Wait until the broker has the newest reading and nothing is in flight
+static bool settle(uint32_t limitMs) {
+  const uint32_t start = millis();
+  while (millis() - start < limitMs) {
+    const auto publishes = s_broker.publishes();
+    if (!publishes.empty() && sequenceOf(publishes.back()) == (long)s_sequence && publisherStat("queued") == 0 &&
+        publisherStat("inflight") == 0) {
+      return true;
+    }
+    sleepMs(1);
+  }
+  return false;
+}
+
+struct Phase {
+  uint32_t readings;
+  uint32_t delivered;   // State messages the broker got (incl. resends)
+  uint32_t resends;     // With DUP
+  uint32_t coalesced;
+  uint32_t dropped;
+  uint32_t reconnects;
+  double medianMs;      // publish() to broker arrival, newest value of each message
+  double maxMs;
+};
+
+static Phase runPhase(uint32_t readings) {
+  const size_t before = s_broker.publishes().size();
+  const long coalescedBefore = publisherStat("coalesced");
+  const long droppedBefore = publisherStat("dropped");
+  const long reconnectsBefore = publisherStat("reconnects");
+
+  produce(readings);
+  Phase phase = {};
+  phase.readings = readings;
+  CHECK(settle(3000));
+
+  std::vector<double> latencies;
+  const auto publishes = s_broker.publishes();
+  for (size_t i = before; i < publishes.size(); i++) {
+    const long sequence = sequenceOf(publishes[i]);
+    if (sequence <= 0) {
+      continue;
+    }
+    phase.delivered++;
+    phase.resends += publishes[i].duplicate;
+    latencies.push_back((publishes[i].at - s_publishedAt[sequence - 1]) / 1000.0);
+  }
+  std::sort(latencies.begin(), latencies.end());
+  phase.medianMs = latencies.empty() ? 0 : latencies[latencies.size() / 2];
+  phase.maxMs = latencies.empty() ? 0 : latencies.back();
+  phase.coalesced = publisherStat("coalesced") - coalescedBefore;
+  phase.dropped = publisherStat("dropped") - droppedBefore;
+  phase.reconnects = publisherStat("reconnects") - reconnectsBefore;
+  return phase;
+}
+
+static void reportPhase(const char* name, const Phase& phase) {
+  host::report("%-15s %3u readings: %3u delivered (%u DUP), %3u coalesced, %u dropped, %u reconnects, "
+               "latency median %.1f ms, max %.1f ms",
+               name, phase.readings, phase.delivered, phase.resends, phase.coalesced, phase.dropped,
+               phase.reconnects, phase.medianMs, phase.maxMs);
+}
+
+int main() {
+  host::useRealTime(true);
+  eventLog.begin();
+  s_broker.start();
+  sleepMs(50);
+
+  s_publisher = new MqttPublisher();  // Never destroyed - its task outlives main()
+  s_publisher->begin();
+  const uint32_t start = millis();
+  while (s_broker.connects() == 0 && millis() - start < 2000) {
+    sleepMs(1);
+  }
+
+  // Clean session with a retained "offline" last will, then retained "online"
+  CHECK(s_broker.connects() == 1);
+  CHECK((s_broker.connectFlags() & 0x26) == 0x26);
+  CHECK(s_broker.will() == std::string(MQTT_TOPIC_PREFIX) + "/status=offline");
+  sleepMs(20);
+  const auto first = s_broker.publishes();
+  CHECK(!first.empty() && first[0].topic == std::string(MQTT_TOPIC_PREFIX) + "/status" &&
+        first[0].payload == "online" && first[0].retain && first[0].qos == 0);
+
+  // Normal: acknowledged before the next reading, so (almost) every reading is delivered
+  const Phase normal = runPhase(100);
+  CHECK(normal.delivered + normal.coalesced == normal.readings && normal.resends == 0);
+  CHECK(normal.coalesced <= normal.readings / 5);  // Host scheduling stalls only (a few readings)
+  CHECK(normal.reconnects == 0);
+  reportPhase("normal", normal);
+
+  // Slow broker: acknowledgements take 4 publish intervals - readings coalesce, latency stays bounded
+  s_broker.ackDelayMs = 4 * PUBLISH_MS;
+  const Phase slow = runPhase(100);
+  s_broker.ackDelayMs = 0;
+  CHECK(slow.delivered + slow.coalesced == slow.readings);
+  CHECK(slow.coalesced > slow.readings / 2);
+  CHECK(slow.reconnects == 0 && slow.dropped == 0);
+  CHECK(slow.maxMs < 3 * (4 * PUBLISH_MS) + 20);
+  reportPhase("slow broker", slow);
+
+  // Stalled broker: no acknowledgement - reconnect after MQTT_ACK_TIMEOUT_MS, resend with DUP
+  {
+    const uint32_t since = eventLog.getNextSequence() - 1;
+    s_broker.ackDelayMs = 60000;
+    produce(3 * MQTT_ACK_TIMEOUT_MS / PUBLISH_MS);
+    s_broker.ackDelayMs = 0;
+    const Phase stalled = runPhase(10);
+    const auto publishes = s_broker.publishes();
+    bool duplicatesMatch = true;
+    for (size_t i = 1; i < publishes.size(); i++) {
+      if (publishes[i].duplicate) {
+        // Same message and packet id as the last unacknowledged state message
+        size_t original = i;
+        while (original-- > 0 && publishes[original].topic != publishes[i].topic) {
+        }
+        duplicatesMatch &= original < i && publishes[original].packetId == publishes[i].packetId &&
+                           publishes[original].payload == publishes[i].payload;
+      }
+    }
+    CHECK(duplicatesMatch);
+    CHECK(publisherStat("retransmits") > 0);
+
+    // Journal: disconnected for the acknowledgement timeout, connected again
+    char buffer[EVENT_LOG_CAPACITY * 96 + 16];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginArray();
+    eventLog.writeJSON(json, since, EVENT_LOG_CAPACITY);
+    json.endArray();
+    CHECK(strstr(buffer, "\"code\":\"mqtt_disconnected\",\"arg0\":-3") != nullptr);
+    CHECK(strstr(buffer, "\"code\":\"mqtt_connected\"") != nullptr);
+    host::report("stalled broker  %u readings: %ld reconnects, %ld DUP resends, newest reading delivered "
+                 "after recovery",
+                 3 * MQTT_ACK_TIMEOUT_MS / PUBLISH_MS + stalled.readings, publisherStat("reconnects") - 1,
+                 publisherStat("retransmits"));
+  }
+
+  // Broker down: queue coalesces to the newest value, delivered once it is back
+  {
+    s_broker.down = true;
+    produce(50);
+    s_broker.down = false;
+    const Phase recovered = runPhase(1);
+    CHECK(recovered.delivered >= 1);
+    CHECK(publisherStat("dropped") == 0);
+    reportPhase("broker down", recovered);
+  }
+
+  // Idle: keep-alive PINGREQ after half the interval
+  {
+    const uint32_t pings = s_broker.pings();
+    sleepMs(MQTT_KEEPALIVE_S * 1500);
+    CHECK(s_broker.pings() > pings);
+  }
+
+  // Totals: every reading delivered or coalesced, publish() never waits for the network
+  const long published = publisherStat("published");
+  const long coalesced = publisherStat("coalesced");
+  const long dropped = publisherStat("dropped");
+  CHECK(published + coalesced + dropped == (long)s_sequence);
+  CHECK(s_maxPublishUs < MQTT_ACK_TIMEOUT_MS * 1000 / 10);
+  host::report("%u readings: %ld acknowledged, %ld coalesced, %ld dropped; %u broker connects, %u pings, "
+               "publish() <= %u us",
+               s_sequence, published, coalesced, dropped, s_broker.connects(), s_broker.pings(), s_maxPublishUs);
+
+  host::finish("mqtt_publisher");
+}
@@ -0,0 +1,199 @@
+/*
+ * PressureTrend: synthetic falling / rising / steady series
+ *
+ * Pressure is published every 5 s as a linear ramp (-8..+8 hPa / 3 h) with
+ * sensor noise. After the 6 h window has filled, the 3 h and 6 h changes
+ * must match the ramp, the tendency the WMO class of the ramp and the
+ * Zambretti letter the table entry for the band. A week-long noisy series
+ * checks the incremental O(1) sums against a least-squares fit recomputed
+ * from scratch (no drift), a falling-then-rising front reports how long the
+ * tendency takes to turn, and a gap longer than the window resets history.
+ */
+
+#include "HostTest.h"
+#include "PressureTrend.h"
+#include <deque>
+#include <random>
+
+constexpr uint32_t PUBLISH_MS = 5000;
+constexpr uint32_t HOUR_MS = 3600000;
+
+// Expected class of a change per 3 h (Pa), thresholds as documented in the README
+static PressureTendency expectedTendency(double change) {
+  const double magnitude = fabs(change);
+  if (magnitude < 10) {
+    return PressureTendency::STEADY;
+  }
+  const int level = magnitude < 160 ? 0 : magnitude < 360 ? 1 : magnitude < 600 ? 2 : 3;
+  static const PressureTendency FALLING[] = { PressureTendency::FALLING_SLOWLY, PressureTendency::FALLING,
+                                              PressureTendency::FALLING_QUICKLY, PressureTendency::FALLING_RAPIDLY };
+  static const PressureTendency RISING[] = { PressureTendency::RISING_SLOWLY, PressureTendency::RISING,
+                                             PressureTendency::RISING_QUICKLY, PressureTendency::RISING_RAPIDLY };
+  return change < 0 ? FALLING[level] : RISING[level];
+}
+
+// Bucket averages as the firmware forms them (0.1 Pa, truncated mean)
+struct ReferenceBuckets {
+  std::deque<int64_t> values;
+  int64_t sum = 0;
+  uint32_t samples = 0;
+  uint32_t bucketStart = 0;
+  bool started = false;
+
+  void add(float pressure, uint32_t now) {
+    if (!started) {
+      started = true;
+      bucketStart = now;
+    }
+    while (now - bucketStart >= PRESSURE_TREND_BUCKET_MS) {
+      values.push_back(sum / samples);
+      if (values.size() > PRESSURE_TREND_BUCKETS) {
+        values.pop_front();
+      }
+      sum = 0;
+      samples = 0;
+      bucketStart += PRESSURE_TREND_BUCKET_MS;
+    }
+    sum += lroundf(pressure * 10.0f);
+    samples++;
+  }
+
+  // Least-squares change per 3 h (Pa) over the newest n buckets, in double
+  double change3h(size_t n) const {
+    n = min(n, values.size());
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (size_t i = 0; i < n; i++) {
+      const double y = values[values.size() - n + i];
+      sx += i;
+      sy += y;
+      sxx += (double)i * i;
+      sxy += i * y;
+    }
+    const double slope = (n * sxy - sx * sy) / (n * sxx - sx * sx);
+    return slope * (3.0 * HOUR_MS / PRESSURE_TREND_BUCKET_MS) / 10.0;
+  }
+};
+
+int main() {
+  std::mt19937 random(37);
+  std::normal_distribution<float> noise(0.0f, 2.0f);  // BME280 x2 oversampling: ~2 Pa rms
+
+  // Ramps: change per 3 h (Pa) at a base pressure (station at sea level, 15 °C)
+  const struct {
+    double change;
+    float base;
+    char letter;  // Zambretti table entry for the band and direction
+  } ramps[] = {
+    { -800, 99500, 0 }, { -450, 100000, 0 }, { -250, 101325, 0 }, { -100, 101325, 0 }, { 0, 103000, 'A' },
+    { 5, 101325, 0 },   { 100, 101325, 0 },  { 250, 101325, 0 },  { 450, 100200, 'G' }, { 800, 99000, 0 },
+    { -250, 99000, 'X' },
+  };
+
+  uint32_t classesRight = 0;
+  double worstChangeError = 0;
+  for (const auto& ramp : ramps) {
+    PressureTrend trend;
+    uint32_t now = 1000;
+    const uint32_t end = now + 7 * HOUR_MS;
+    bool readyTooEarly = false;
+    float pressure = ramp.base;
+    for (; now < end; now += PUBLISH_MS) {
+      const double hours = (now - 1000) / (double)HOUR_MS;
+      pressure = ramp.base + (float)(ramp.change * (hours - 7) / 3.0) + noise(random);  // Ends at base
+      trend.update(pressure, 15.0f, now);
+      readyTooEarly |= now - 1000 < (PRESSURE_TREND_MIN_BUCKETS - 1) * PRESSURE_TREND_BUCKET_MS &&
+                       trend.getTendency() != PressureTendency::UNKNOWN;
+    }
+    CHECK(!readyTooEarly);
+
+    const double error3h = fabs(trend.getChange3h() - ramp.change);
+    const double error6h = fabs(trend.getChange6h() - ramp.change);
+    worstChangeError = max(worstChangeError, max(error3h, error6h));
+    CHECK(error3h < 3.0 && error6h < 2.0);
+
+    const bool classRight = trend.getTendency() == expectedTendency(ramp.change);
+    classesRight += classRight;
+    CHECK(classRight);
+    if (ramp.letter) {
+      CHECK(trend.getZambrettiLetter() == ramp.letter);
+    }
+    host::report("%+5.0f Pa/3h at %6.0f Pa: change3h %+7.1f, change6h %+7.1f, %-16s Zambretti %c (%s)",
+                 ramp.change, ramp.base, trend.getChange3h(), trend.getChange6h(),
+                 PressureTrend::getTendencyName(trend.getTendency()), trend.getZambrettiLetter(),
+                 trend.getForecastText());
+  }
+  host::report("%u / %zu ramps classified as expected, worst change error %.2f Pa / 3 h", classesRight,
+               sizeof(ramps) / sizeof(ramps[0]), worstChangeError);
+
+  // A week of weather: incremental sums against a fit recomputed from scratch
+  {
+    PressureTrend trend;
+    ReferenceBuckets reference;
+    double worstDrift3h = 0;
+    double worstDrift6h = 0;
+    uint32_t comparisons = 0;
+    for (uint32_t now = 500; now < 7 * 24 * HOUR_MS; now += PUBLISH_MS) {
+      const double hours = now / (double)HOUR_MS;
+      const float pressure = 101325.0f + (float)(1200.0 * sin(hours / 19.0) + 300.0 * sin(hours / 2.7)) +
+                             noise(random);
+      trend.update(pressure, 10.0f, now);
+      reference.add(pressure, now);
+
+      if (reference.values.size() == PRESSURE_TREND_BUCKETS && (now / PUBLISH_MS) % 60 == 0) {
+        worstDrift3h = max(worstDrift3h, fabs(trend.getChange3h() - reference.change3h(PRESSURE_TREND_BUCKETS / 2)));
+        worstDrift6h = max(worstDrift6h, fabs(trend.getChange6h() - reference.change3h(PRESSURE_TREND_BUCKETS)));
+        comparisons++;
+      }
+    }
+    CHECK(comparisons > 1500);
+    CHECK(worstDrift3h < 0.01 && worstDrift6h < 0.01);
+    host::report("7 days, %u comparisons with a from-scratch fit: max difference %.4f / %.4f Pa (3 h / 6 h)",
+                 comparisons, worstDrift3h, worstDrift6h);
+  }
+
+  // Front: falling 3 hPa / 3 h for 6 h, then rising at the same rate
+  {
+    PressureTrend trend;
+    uint32_t turnedAfter = 0;
+    for (uint32_t now = 0; now < 12 * HOUR_MS; now += PUBLISH_MS) {
+      const double hours = now / (double)HOUR_MS;
+      const double offset = hours < 6 ? -100.0 * hours : -600.0 + 100.0 * (hours - 6);
+      trend.update(101325.0f + (float)offset + noise(random), 15.0f, now);
+      if (hours >= 6 && !turnedAfter && trend.getChange3h() > 0) {
+        turnedAfter = now - 6 * HOUR_MS;
+      }
+    }
+    CHECK(turnedAfter > 0 && turnedAfter < 2 * HOUR_MS);
+    CHECK(trend.getTendency() == PressureTendency::RISING);
+    host::report("front: change3h turns positive %.0f min after the minimum", turnedAfter / 60000.0);
+  }
+
+  // Gap longer than the window: history restarts
+  {
+    PressureTrend trend;
+    uint32_t now = 0;
+    for (; now < 2 * HOUR_MS; now += PUBLISH_MS) {
+      trend.update(101325.0f - now / 36000.0f, 15.0f, now);
+    }
+    CHECK(trend.getTendency() != PressureTendency::UNKNOWN);
+    now += PRESSURE_TREND_BUCKETS * PRESSURE_TREND_BUCKET_MS;
+    trend.update(101325.0f, 15.0f, now);
+    CHECK(trend.getWindowMinutes() == 0);
+    CHECK(trend.getTendency() == PressureTendency::UNKNOWN);
+    CHECK(trend.getForecastText() == nullptr);
+  }
+
+  // Cost of update()
+  PressureTrend trend;
+  uint32_t now = 0;
+  constexpr int UPDATES = 2000000;
+  const double ns = host::measureNs([&]() {
+    for (int i = 0; i < UPDATES; i++) {
+      trend.update(101325.0f + (i % 100), 15.0f, now);
+      now += PUBLISH_MS;
+    }
+  }) / UPDATES;
+  host::report("update(): %.0f ns per published sample (host)", ns);
+
+  host::finish("pressure_trend");
+}
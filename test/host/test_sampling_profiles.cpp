@@ -0,0 +1,156 @@
+/*
+ * Sampling profiles: register writes and timings seen on the I2C bus
+ *
+ * SensorManager reads a modelled BME280 while the profile is switched at
+ * runtime (SamplingProfiles::select(), as the API does). For every profile
+ * the BME280's register write log must show the reconfiguration in the
+ * datasheet order (sleep, ctrl_hum, config, ctrl_meas - ctrl_hum only takes
+ * effect with the following ctrl_meas write) before the next forced
+ * conversion, with the oversampling and IIR codes of the profile. The sweep
+ * time on the virtual clock is checked against the conversion time the
+ * profile reports, the read interval against the profile's interval.
+ * Unknown and unchanged selections must not touch the sensor, and the
+ * selection must survive a restart (NVS stand-in).
+ */
+
+#include "HostTest.h"
+#include "HostI2C.h"
+#include "HostBme280.h"
+#include "SensorManager.h"
+#include "EventLog.h"
+#include <memory>
+
+constexpr uint8_t REG_CTRL_HUM = 0xF2;
+constexpr uint8_t REG_CTRL_MEAS = 0xF4;
+constexpr uint8_t REG_CONFIG = 0xF5;
+constexpr uint8_t MODE_FORCED = 0x01;
+
+static const char* const PROFILE_NAMES[] = { "low-power", "balanced", "high-precision", "high-rate" };
+
+static host::Bme280Model s_bme(44);
+
+static uint32_t events(uint32_t since, EventCode code) {
+  static char buffer[EVENT_LOG_CAPACITY * 96 + 16];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginArray();
+  eventLog.writeJSON(json, since, EVENT_LOG_CAPACITY);
+  json.endArray();
+  char pattern[48];
+  snprintf(pattern, sizeof(pattern), "\"code\":\"%s\"", EventLog::getCodeName((uint16_t)code));
+  uint32_t count = 0;
+  for (const char* cursor = buffer; (cursor = strstr(cursor, pattern)) != nullptr; cursor++) {
+    count++;
+  }
+  return count;
+}
+
+// Register writes a profile must produce: reconfiguration in sleep mode, then the forced conversion
+static std::vector<std::pair<uint8_t, uint8_t>> expectedWrites(const SamplingProfile& profile) {
+  const uint8_t ctrlMeas = (profile.osrsTemperature << 5) | (profile.osrsPressure << 2);
+  return {
+    { REG_CTRL_MEAS, ctrlMeas },
+    { REG_CTRL_HUM, profile.osrsHumidity },
+    { REG_CONFIG, (uint8_t)((profile.standby << 5) | (profile.filter << 2)) },
+    { REG_CTRL_MEAS, ctrlMeas },
+    { REG_CTRL_MEAS, (uint8_t)(ctrlMeas | MODE_FORCED) },
+  };
+}
+
+static std::vector<std::pair<uint8_t, uint8_t>> loggedWrites() {
+  std::vector<std::pair<uint8_t, uint8_t>> result;
+  for (const host::Bme280Model::RegisterWrite& write : s_bme.writes) {
+    result.push_back({ write.reg, write.value });
+  }
+  return result;
+}
+
+// Wait for the next scheduled read and do it
+static void readNext(SensorManager& manager) {
+  const uint32_t next = manager.getNextReadTime(millis());
+  if ((int32_t)(next - millis()) > 0) {
+    host::advance((uint64_t)(next - millis()) * 1000);
+  }
+  manager.readSensors();
+}
+
+int main() {
+  eventLog.begin();
+  host::i2cBus(1).attach(BME_I2C_ADDR, s_bme);
+  samplingProfiles.begin();
+
+  auto manager = std::make_unique<SensorManager>();
+  CHECK(manager->begin());
+  CHECK(strcmp(samplingProfiles.getActive().name, SAMPLING_DEFAULT_PROFILE) == 0);
+  readNext(*manager);
+
+  // Every profile, switched while running
+  const uint32_t since = eventLog.getNextSequence() - 1;
+  uint32_t changes = 0;
+  uint32_t lowPowerNanoAmps = 0;
+  uint32_t maxNanoAmps = 0;
+  for (const char* name : PROFILE_NAMES) {
+    const uint32_t revision = samplingProfiles.getRevision();
+    const bool change = strcmp(samplingProfiles.getActive().name, name) != 0;
+    CHECK(samplingProfiles.select(name));
+    CHECK(samplingProfiles.getRevision() == revision + change);
+    CHECK(manager->isProfileChanged() == change);
+    changes += change;
+
+    const SamplingProfile& profile = samplingProfiles.getActive();
+    s_bme.clearLog();
+    readNext(*manager);
+    const uint32_t readAt = millis() - manager->getLastSweepTime() / 1000;
+
+    if (change) {
+      CHECK(loggedWrites() == expectedWrites(profile));
+    }
+    CHECK(s_bme.getRegister(REG_CTRL_HUM) == profile.osrsHumidity);
+    CHECK(s_bme.getRegister(REG_CONFIG) == ((profile.standby << 5) | (profile.filter << 2)));
+    CHECK(manager->getSensorData().isValid);
+    CHECK(fabsf(manager->getSensorData().temperature - s_bme.temperature) < 0.1f);
+
+    // Sweep: the reported conversion plus status polls (1 ms) and bus transfers (100 kHz)
+    const uint32_t conversionUs = SamplingProfiles::getConversionTimeUs(profile, false);
+    const uint32_t sweepUs = manager->getLastSweepTime();
+    CHECK(conversionUs == s_bme.getConversionTimeUs());
+    CHECK(sweepUs >= conversionUs && sweepUs <= conversionUs + 5000);
+    CHECK(manager->getNextReadTime(millis()) - readAt <= profile.intervalMs + 1);
+
+    const uint32_t nanoAmps = SamplingProfiles::getCurrentNanoAmps(profile);
+    if (strcmp(name, "low-power") == 0) {
+      lowPowerNanoAmps = nanoAmps;
+    }
+    maxNanoAmps = max(maxNanoAmps, nanoAmps);
+    host::report("%-14s ctrl_meas 0x%02X ctrl_hum 0x%02X config 0x%02X: conversion %.1f ms (max %.1f), "
+                 "sweep %.1f ms, every %u s, %.2f uA",
+                 name, profile.osrsTemperature << 5 | profile.osrsPressure << 2 | MODE_FORCED,
+                 profile.osrsHumidity, (profile.standby << 5) | (profile.filter << 2), conversionUs / 1000.0,
+                 SamplingProfiles::getConversionTimeUs(profile, true) / 1000.0, sweepUs / 1000.0,
+                 profile.intervalMs / 1000, nanoAmps / 1000.0);
+  }
+  CHECK(lowPowerNanoAmps > 0 && lowPowerNanoAmps < maxNanoAmps);
+  CHECK(events(since, EventCode::SAMPLING_PROFILE_CHANGED) == changes);
+
+  // Unknown and unchanged selections leave the sensor alone
+  {
+    const uint32_t revision = samplingProfiles.getRevision();
+    CHECK(!samplingProfiles.select("turbo"));
+    CHECK(samplingProfiles.select(samplingProfiles.getActive().name));
+    CHECK(samplingProfiles.getRevision() == revision);
+    s_bme.clearLog();
+    readNext(*manager);
+    CHECK(s_bme.writes.size() == 1 && s_bme.writes[0].reg == REG_CTRL_MEAS);
+    host::report("unknown / unchanged selection: %zu register write (forced conversion only)", s_bme.writes.size());
+  }
+
+  // Selection persists across a restart
+  {
+    CHECK(samplingProfiles.select("high-precision"));
+    SamplingProfiles restarted;
+    restarted.begin();
+    CHECK(strcmp(restarted.getActive().name, "high-precision") == 0);
+    host::report("after restart: '%s' restored from NVS", restarted.getActive().name);
+  }
+
+  host::finish("sampling_profiles");
+}
@@ -0,0 +1,248 @@
+/*
+ * TimerWheel and Scheduler on the virtual clock
+ *
+ * TimerWheel against a brute-force reference: eight jobs with periods from
+ * 7 ms to several wheel revolutions, random re-arms and cancels, and the
+ * clock stepped exactly to timeUntilNext() - every job must run at its
+ * deadline, never early, and timeUntilNext() must equal the reference.
+ * Then random stalls of up to 3 revolutions: each due job runs once, late
+ * by exactly the stall, and periodic jobs keep their phase (missed runs are
+ * skipped). Both at time 0 and across the millis() wrap.
+ *
+ * Scheduler: loop() (waitForNext + runDue) with jobs that burn virtual CPU
+ * time; checked are the reported idle percentage against the injected busy
+ * time, lateness bounded by the longest job, and a trigger() from a timer
+ * callback waking the loop at once.
+ */
+
+#include "HostTest.h"
+#include "Scheduler.h"
+#include <random>
+#include <vector>
+
+constexpr uint64_t MS = 1000;
+constexpr uint32_t WHEEL_SPAN_MS = SCHEDULER_WHEEL_SLOTS * SCHEDULER_TICK_MS;
+constexpr int JOBS = SCHEDULER_MAX_JOBS;
+
+// ============================================================================
+// TimerWheel against a reference
+// ============================================================================
+struct Run {
+  int job;
+  uint32_t now;
+  uint32_t deadline;
+};
+
+static std::vector<Run> s_runs;
+static TimerJob* s_jobs[JOBS];
+
+template <int N>
+static void record(uint32_t now) {
+  s_runs.push_back({ N, now, s_jobs[N]->deadline });
+}
+
+static const TimerCallback CALLBACKS[JOBS] = { record<0>, record<1>, record<2>, record<3>,
+                                               record<4>, record<5>, record<6>, record<7> };
+static const uint32_t PERIODS[JOBS] = { 7, 10, 25, 333, WHEEL_SPAN_MS, 1000, 5000, 0 };
+
+// Earliest deadline, capped at one revolution
+static uint32_t referenceUntilNext(uint32_t now) {
+  uint32_t earliest = WHEEL_SPAN_MS;
+  for (TimerJob* job : s_jobs) {
+    if (job->scheduled) {
+      const int32_t remaining = (int32_t)(job->deadline - now);
+      earliest = min(earliest, (uint32_t)max<int32_t>(remaining, 0));
+    }
+  }
+  return earliest;
+}
+
+struct WheelResult {
+  uint32_t runs = 0;
+  uint32_t early = 0;          // Run before its deadline
+  uint32_t late = 0;           // Run after its deadline without a stall
+  uint32_t missed = 0;         // Still scheduled and overdue after advance()
+  uint32_t untilNextWrong = 0;
+  uint32_t stalledRuns = 0;
+  uint32_t duplicateRuns = 0;  // Same job twice in one advance()
+  uint32_t phaseWrong = 0;     // Periodic re-arm not at deadline + period (or now + period)
+};
+
+static WheelResult runWheel(uint32_t base, bool stalls, uint32_t seed) {
+  std::mt19937 random(seed);
+  WheelResult result;
+  TimerWheel wheel(base);
+
+  std::vector<TimerJob> jobs;
+  jobs.reserve(JOBS);
+  for (int i = 0; i < JOBS; i++) {
+    jobs.emplace_back("job", CALLBACKS[i], PERIODS[i]);
+    s_jobs[i] = &jobs[i];
+    wheel.schedule(jobs[i], base + 1 + random() % 700);
+  }
+
+  uint32_t now = base;
+  for (int step = 0; step < 200000; step++) {
+    const uint32_t wait = wheel.timeUntilNext(now);
+    result.untilNextWrong += wait != referenceUntilNext(now);
+
+    uint32_t stall = 0;
+    if (stalls && random() % 20 == 0) {
+      stall = 1 + random() % (3 * WHEEL_SPAN_MS);
+    }
+    now += wait + stall;
+
+    s_runs.clear();
+    wheel.advance(now);
+    result.runs += s_runs.size();
+
+    bool ran[JOBS] = {};
+    for (const Run& run : s_runs) {
+      const int32_t lateness = (int32_t)(run.now - run.deadline);
+      result.early += lateness < 0;
+      result.late += stall == 0 && lateness > 0;
+      result.stalledRuns += stall > 0;
+      result.duplicateRuns += ran[run.job];
+      ran[run.job] = true;
+
+      const TimerJob& job = *s_jobs[run.job];
+      if (job.period > 0) {
+        const uint32_t next = (int32_t)(now - (run.deadline + job.period)) >= 0 ? now + job.period
+                                                                               : run.deadline + job.period;
+        result.phaseWrong += !job.scheduled || job.deadline != next;
+      }
+    }
+    for (TimerJob* job : s_jobs) {
+      result.missed += job->scheduled && (int32_t)(job->deadline - now) <= 0;
+    }
+
+    // Random re-arm or cancel between passes
+    const uint32_t op = random() % 16;
+    if (op < JOBS) {
+      TimerJob& job = *s_jobs[op];
+      if (random() % 4 == 0) {
+        wheel.cancel(job);
+      } else {
+        wheel.schedule(job, now + 1 + random() % (4 * WHEEL_SPAN_MS));
+      }
+    }
+    if (!s_jobs[JOBS - 1]->scheduled) {
+      wheel.schedule(*s_jobs[JOBS - 1], now + 1 + random() % 3000);  // One-shot kept going
+    }
+  }
+
+  for (int i = 0; i < JOBS; i++) {
+    s_jobs[i] = nullptr;
+  }
+  return result;
+}
+
+// ============================================================================
+// Scheduler on the virtual clock
+// ============================================================================
+static uint64_t s_busyUs = 0;
+static Scheduler* s_scheduler = nullptr;
+static uint32_t s_wakeRunAt = 0;
+
+static void busy(uint32_t us) {
+  host::advance(us);
+  s_busyUs += us;
+}
+
+static void fastJob(uint32_t now) {
+  (void)now;
+  busy(1000);
+}
+
+static void slowJob(uint32_t now) {
+  (void)now;
+  busy(50 * MS);
+}
+
+static void wakeJob(uint32_t now) {
+  s_wakeRunAt = now;
+}
+
+// Scheduler JSON fields
+static double idlePercent(const Scheduler& scheduler) {
+  char buffer[1024];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginObject();
+  scheduler.writeJSON(json);
+  json.endObject();
+  double idle = -1;
+  const char* field = strstr(buffer, "\"idlePercent\":");
+  if (field) {
+    sscanf(field, "\"idlePercent\":%lf", &idle);
+  }
+  return idle;
+}
+
+int main() {
+  // TimerWheel: exact stepping, then stalls, at 0 and across the wrap
+  for (uint32_t base : { 0u, 0xFFFFF000u }) {
+    for (bool stalls : { false, true }) {
+      const WheelResult result = runWheel(base, stalls, base ^ stalls);
+      CHECK(result.early == 0);
+      CHECK(result.late == 0);
+      CHECK(result.missed == 0);
+      CHECK(result.untilNextWrong == 0);
+      CHECK(result.duplicateRuns == 0);
+      CHECK(result.phaseWrong == 0);
+      CHECK(result.runs > 100000);
+      host::report("wheel from 0x%08x%s: %u runs (%u after a stall), %u early, %u late, %u missed, "
+                   "%u wrong waits, %u phase errors",
+                   base, stalls ? " with stalls" : "", result.runs, result.stalledRuns, result.early, result.late,
+                   result.missed, result.untilNextWrong, result.phaseWrong);
+    }
+  }
+
+  // Scheduler: 1 ms every 10 ms plus 50 ms every second
+  Scheduler scheduler;
+  s_scheduler = &scheduler;
+  host::advance(123 * MS);
+  scheduler.begin();
+  TimerJob fast("fast", fastJob, 10);
+  TimerJob slow("slow", slowJob, 1000);
+  TimerJob wake("wake", wakeJob);
+  CHECK(scheduler.addJob(fast, millis() + 10));
+  CHECK(scheduler.addJob(slow, millis() + 1000));
+  CHECK(scheduler.addJob(wake));
+
+  // Triggers from a timer callback at odd times (not on a tick)
+  std::vector<uint32_t> triggerTimes;
+  for (uint32_t t = 5017; t < 60000; t += 7919) {
+    triggerTimes.push_back(millis() + t);
+    host::at((uint64_t)(millis() + t) * MS, [&wake]() { s_scheduler->trigger(wake); });
+  }
+
+  const uint64_t start = host::now();
+  s_busyUs = 0;
+  uint32_t wakeLatenessMax = 0;
+  size_t nextTrigger = 0;
+  while (host::now() - start < 60000 * MS) {
+    scheduler.waitForNext();
+    scheduler.runDue();
+    if (s_wakeRunAt && nextTrigger < triggerTimes.size()) {
+      wakeLatenessMax = max(wakeLatenessMax, s_wakeRunAt - triggerTimes[nextTrigger]);
+      nextTrigger++;
+      s_wakeRunAt = 0;
+    }
+  }
+
+  const double expectedIdle = 100.0 * (1.0 - (double)s_busyUs / (host::now() - start));
+  const double reportedIdle = idlePercent(scheduler);
+  CHECK(fabs(reportedIdle - expectedIdle) < 1.0);
+  CHECK(fast.runs > 5400 && slow.runs >= 59);
+  CHECK(fast.maxLateness <= 50 + SCHEDULER_TICK_MS);  // Blocked by the slow job only
+  CHECK(slow.maxLateness <= 1 + SCHEDULER_TICK_MS);
+  CHECK(nextTrigger == triggerTimes.size());
+  CHECK(wakeLatenessMax <= 50);  // Waits at most for a running job
+  host::report("scheduler 60 s: fast %u runs (late <= %u ms), slow %u runs (late <= %u ms), "
+               "idle %.1f%% reported / %.1f%% injected",
+               fast.runs, fast.maxLateness, slow.runs, slow.maxLateness, reportedIdle, expectedIdle);
+  host::report("trigger() from a timer callback: %zu wakes, loop ran the job <= %u ms later", triggerTimes.size(),
+               wakeLatenessMax);
+
+  host::finish("scheduler");
+}
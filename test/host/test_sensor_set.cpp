@@ -0,0 +1,410 @@
+/*
+ * SensorSet: generated sweep, recovery bookkeeping and serialization
+ *
+ * Three stand-in drivers (two enabled, one disabled) check what the fold
+ * expressions generate: begin/read order, disabled drivers compiled out,
+ * validate, JSON, findChannel and the offline / backoff / recovery path with
+ * its journal events. The same sweep is then written out by hand (the way
+ * SensorManager read sensors with #if blocks before the registry) and both
+ * versions are compared in code size (symbol sizes of this binary, both
+ * sweeps flattened so helpers count where they are used) and host cycles
+ * per sweep.
+ */
+
+#include "HostTest.h"
+#include "SensorSet.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+
+// Calls into the stand-in drivers, in order ("b0 s1 c0 ...")
+static std::string s_calls;
+
+static void note(char call, int id) {
+  s_calls += call;
+  s_calls += (char)('0' + id);
+  s_calls += ' ';
+}
+
+// Stand-in driver with one channel; methods stay out of line like the real
+// drivers' (separate translation units)
+template <int ID, bool IS_ENABLED>
+class MockSensor {
+public:
+  static constexpr bool ENABLED = IS_ENABLED;
+  static constexpr const char* NAME = ID == 0 ? "A" : ID == 1 ? "B" : "C";
+  static constexpr const char* KEY = ID == 0 ? "a" : ID == 1 ? "b" : "c";
+
+  struct Channels {
+    float value = NAN;
+  };
+
+  struct Filters {
+    void push(const Channels&) {}
+    void decimate(Channels&) {}
+  };
+
+  struct Anomalies {
+    uint8_t valueFlags = ANOMALY_NONE;
+
+    inline uint8_t any() const {
+      return valueFlags;
+    }
+  };
+
+  struct Detectors {
+    uint32_t checks = 0;
+
+    void check(Channels&, Anomalies&, uint32_t) {
+      checks++;
+    }
+    void writeJSON(JsonWriter& json) const {
+      json.addUInt("checks", checks);
+    }
+  };
+
+  // Behaviour
+  bool answers = true;
+  float reading = 20.0f + ID;
+  uint32_t begins = 0;
+  uint32_t recoveries = 0;
+
+  __attribute__((noinline)) bool begin() {
+    note('b', ID);
+    begins++;
+    return answers;
+  }
+
+  __attribute__((noinline)) bool recover() {
+    note('r', ID);
+    recoveries++;
+    return answers;
+  }
+
+  __attribute__((noinline)) bool start() {
+    note('s', ID);
+    return answers;
+  }
+
+  uint32_t getConversionTime() const {
+    return 0;
+  }
+
+  __attribute__((noinline)) bool collect(Channels& channels) {
+    note('c', ID);
+    if (!answers) {
+      return false;
+    }
+    channels.value = reading;
+    return true;
+  }
+
+  static void clear(Channels& channels) {
+    channels.value = NAN;
+  }
+
+  static bool validate(const Channels& channels) {
+    return isfinite(channels.value);
+  }
+
+  static float change(const Channels& from, const Channels& to) {
+    return channelChange(from.value, to.value, 0.1f);
+  }
+
+  static void writeJSON(const Channels& channels, JsonWriter& json) {
+    json.addFloat(KEY, channels.value, 1);
+  }
+
+  static void writeLine(const Channels& channels, LineWriter& line) {
+    line.addFloat(KEY, channels.value, 1);
+  }
+
+  static float Channels::* findChannel(const char* name) {
+    return strcmp(name, KEY) == 0 ? &Channels::value : nullptr;
+  }
+
+  static void writeAnomalyJSON(const Anomalies& anomalies, JsonWriter& json) {
+    ::writeAnomalyJSON(json, KEY, anomalies.valueFlags);
+  }
+
+  void writeRawJSON(JsonWriter& json) const {
+    json.beginObject();
+    json.addString("sensor", NAME);
+    json.endObject();
+  }
+
+  inline BusState& state() {
+    return m_state;
+  }
+
+  inline const BusState& state() const {
+    return m_state;
+  }
+
+private:
+  BusState m_state;
+};
+
+using SensorA = MockSensor<0, true>;
+using SensorB = MockSensor<1, true>;
+using SensorC = MockSensor<2, false>;
+using Registry = SensorSet<SensorA, SensorB, SensorC>;
+using Data = Registry::Data;
+
+// ============================================================================
+// Hand-written sweep: what SensorSet<SensorA, SensorB, SensorC>::read() and
+// validate() expand to, spelled out per sensor
+// ============================================================================
+struct HandStation {
+  SensorA a;
+  SensorB b;
+  SensorA::Detectors detectorsA;
+  SensorB::Detectors detectorsB;
+};
+
+static void handStart(BusState& state, bool (*recover)(HandStation&), bool (*start)(HandStation&),
+                      HandStation& station, uint8_t index, uint32_t currentTime) {
+  if (isRetryDue(state, currentTime)) {
+    if (recover(station)) {
+      markOnline(state);
+      state.recoveryCount++;
+      eventLog.log(EventCode::SENSOR_RECOVERED, index, state.recoveryCount);
+    } else {
+      scheduleRetry(state, currentTime);
+      eventLog.log(EventCode::SENSOR_RECOVERY_FAILED, index, retryDelaySeconds(state, currentTime));
+    }
+  }
+  state.measurementPending = state.online && start(station);
+}
+
+static void handFailure(BusState& state, uint8_t index, uint32_t currentTime) {
+  state.measurementPending = false;
+  if (state.online) {
+    recordFailure(state, currentTime);
+    if (!state.online) {
+      eventLog.log(EventCode::SENSOR_OFFLINE, index, state.failureCount);
+    }
+  }
+}
+
+extern "C" __attribute__((noinline, flatten)) bool handSweep(HandStation& station, Data& data, uint32_t currentTime) {
+  SensorA::Channels& channelsA = data;
+  SensorB::Channels& channelsB = data;
+  SensorC::Channels& channelsC = data;
+
+  handStart(station.a.state(), [](HandStation& s) { return s.a.recover(); },
+            [](HandStation& s) { return s.a.start(); }, station, 0, currentTime);
+  handStart(station.b.state(), [](HandStation& s) { return s.b.recover(); },
+            [](HandStation& s) { return s.b.start(); }, station, 1, currentTime);
+
+  if (station.a.state().measurementPending && station.a.collect(channelsA)) {
+    station.a.state().measurementPending = false;
+    markOnline(station.a.state());
+  } else {
+    handFailure(station.a.state(), 0, currentTime);
+    SensorA::clear(channelsA);
+  }
+  if (station.b.state().measurementPending && station.b.collect(channelsB)) {
+    station.b.state().measurementPending = false;
+    markOnline(station.b.state());
+  } else {
+    handFailure(station.b.state(), 1, currentTime);
+    SensorB::clear(channelsB);
+  }
+  SensorC::clear(channelsC);
+
+  station.detectorsA.check(data, data, currentTime);
+  station.detectorsB.check(data, data, currentTime);
+
+  return SensorA::validate(data) && static_cast<const SensorA::Anomalies&>(data).any() == ANOMALY_NONE &&
+         SensorB::validate(data) && static_cast<const SensorB::Anomalies&>(data).any() == ANOMALY_NONE;
+}
+
+extern "C" __attribute__((noinline, flatten)) bool registrySweep(Registry& registry, Data& data, uint32_t currentTime) {
+  registry.read(data, currentTime);
+  return Registry::validate(data);
+}
+
+// Size of a symbol of this binary (nm), 0 if not found
+static size_t symbolSize(const char* name) {
+  char path[256];
+  const ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+  if (length <= 0) {
+    return 0;
+  }
+  path[length] = '\0';
+
+  char command[320];
+  snprintf(command, sizeof(command), "nm -S --defined-only '%s' 2>/dev/null", path);
+  FILE* pipe = popen(command, "r");
+  if (!pipe) {
+    return 0;
+  }
+  char line[512];
+  size_t size = 0;
+  while (fgets(line, sizeof(line), pipe)) {
+    unsigned long long address, length;
+    char type;
+    char symbol[400];
+    if (sscanf(line, "%llx %llx %c %399s", &address, &length, &type, symbol) == 4 && strcmp(symbol, name) == 0) {
+      size = length;
+    }
+  }
+  pclose(pipe);
+  return size;
+}
+
+static std::string json(const Data& data) {
+  char buffer[256];
+  JsonWriter writer(buffer, sizeof(buffer));
+  writer.beginObject();
+  Registry::writeJSON(data, writer);
+  writer.endObject();
+  return buffer;
+}
+
+static std::string events(uint32_t since) {
+  static char buffer[4096];
+  JsonWriter writer(buffer, sizeof(buffer));
+  writer.beginArray();
+  eventLog.writeJSON(writer, since, 64);
+  writer.endArray();
+  return buffer;
+}
+
+int main() {
+  eventLog.begin();
+
+  // begin(): enabled drivers only, in registry order
+  Registry registry;
+  Data data;
+  s_calls.clear();
+  CHECK(registry.begin(millis()));
+  CHECK(s_calls == "b0 b1 ");
+  CHECK(registry.get<SensorC>().begins == 0);
+
+  // read(): every start before the first collect, disabled channels stay NAN
+  s_calls.clear();
+  registry.read(data, millis());
+  CHECK(s_calls == "s0 s1 c0 c1 ");
+  CHECK(static_cast<SensorA::Channels&>(data).value == 20.0f);
+  CHECK(static_cast<SensorB::Channels&>(data).value == 21.0f);
+  CHECK(isnan(static_cast<SensorC::Channels&>(data).value));
+  CHECK(Registry::validate(data));
+  CHECK(json(data) == "{\"a\":20.0,\"b\":21.0}");
+
+  // findChannel(): enabled keys map into the channel record, disabled ones do not
+  Registry::ChannelData channels;
+  Registry::copyChannels(data, channels);
+  CHECK(Registry::findChannel("b") != nullptr && channels.*Registry::findChannel("b") == 21.0f);
+  CHECK(Registry::findChannel("c") == nullptr);
+  CHECK(Registry::findChannel("x") == nullptr);
+
+  // An anomaly flag invalidates the record
+  static_cast<SensorB::Anomalies&>(data).valueFlags = ANOMALY_SPIKE;
+  CHECK(!Registry::validate(data));
+  static_cast<SensorB::Anomalies&>(data).valueFlags = ANOMALY_NONE;
+
+  // B stops answering: offline after the failure threshold, A unaffected
+  const uint32_t since = eventLog.getNextSequence() - 1;  // Last event before the fault
+  SensorB& b = registry.get<SensorB>();
+  b.answers = false;
+  for (int i = 0; i < I2C_RECOVERY_FAILURE_THRESHOLD; i++) {
+    host::advance(1000000);
+    registry.read(data, millis());
+    CHECK(static_cast<SensorA::Channels&>(data).value == 20.0f);
+    CHECK(isnan(static_cast<SensorB::Channels&>(data).value));
+  }
+  CHECK(!b.state().online);
+  CHECK(!Registry::validate(data));
+  CHECK(json(data) == "{\"a\":20.0,\"b\":null}");
+  CHECK(events(since).find("\"sensor_offline\"") != std::string::npos);
+
+  // Recovery is due on the next read, then backs off exponentially up to the
+  // cap; each failure journals the delay until the next attempt
+  uint32_t attempts = 0;
+  uint32_t lastDelay = 0;
+  int32_t journaledDelay = 0;
+  uint32_t wrongDelays = 0;
+  for (int second = 0; second < 200; second++) {
+    host::advance(1000000);
+    const uint32_t before = b.recoveries;
+    registry.read(data, millis());
+    if (b.recoveries != before) {
+      attempts++;
+      CHECK(b.state().retryDelayMs >= lastDelay);
+      lastDelay = b.state().retryDelayMs;
+      const std::string journal = events(since);
+      const size_t event = journal.rfind("\"sensor_recovery_failed\"");
+      const size_t arg1 = journal.find("\"arg1\":", event);
+      CHECK(event != std::string::npos && arg1 != std::string::npos);
+      journaledDelay = atoi(journal.c_str() + arg1 + 7);
+      wrongDelays += journaledDelay != (int32_t)((b.state().nextRetryTime - millis()) / 1000);
+    }
+  }
+  CHECK(attempts >= 2 && attempts <= 12);
+  CHECK(lastDelay <= I2C_RECOVERY_MAX_BACKOFF_MS);
+  CHECK(wrongDelays == 0 && journaledDelay == (int32_t)(I2C_RECOVERY_MAX_BACKOFF_MS / 1000));
+
+  // Answers again: recovered at the next due attempt
+  b.answers = true;
+  for (int second = 0; second < 70 && !b.state().online; second++) {
+    host::advance(1000000);
+    registry.read(data, millis());
+  }
+  CHECK(b.state().online);
+  CHECK(b.state().recoveryCount == 1);
+  CHECK(b.state().retryDelayMs == I2C_RECOVERY_INITIAL_BACKOFF_MS);
+  host::advance(1000000);
+  registry.read(data, millis());
+  CHECK(Registry::validate(data));
+  CHECK(events(since).find("\"sensor_recovered\"") != std::string::npos);
+  host::report("offline after %d failed reads, %u recovery attempts in 200 s, backoff reached %lu ms, "
+               "journaled %d s",
+               I2C_RECOVERY_FAILURE_THRESHOLD, attempts, (unsigned long)lastDelay, journaledDelay);
+
+  // Hand-written sweep does the same
+  HandStation station;
+  Registry compared;
+  Data handData, registryData;
+  station.a.begin();
+  station.b.begin();
+  markOnline(station.a.state());
+  markOnline(station.b.state());
+  compared.begin(millis());
+  CHECK(handSweep(station, handData, millis()) == registrySweep(compared, registryData, millis()));
+  CHECK(json(handData) == json(registryData));
+
+  // Code size and cycles per sweep
+  const size_t handBytes = symbolSize("handSweep");
+  const size_t registryBytes = symbolSize("registrySweep");
+  constexpr int SWEEPS = 200000;
+  s_calls.reserve(64);
+  uint64_t handCycles = UINT64_MAX, registryCycles = UINT64_MAX;
+  for (int round = 0; round < 5; round++) {
+    uint64_t start = host::cycles();
+    for (int i = 0; i < SWEEPS; i++) {
+      s_calls.clear();
+      handSweep(station, handData, i);
+    }
+    handCycles = min<uint64_t>(handCycles, (host::cycles() - start) / SWEEPS);
+
+    start = host::cycles();
+    for (int i = 0; i < SWEEPS; i++) {
+      s_calls.clear();
+      registrySweep(compared, registryData, i);
+    }
+    registryCycles = min<uint64_t>(registryCycles, (host::cycles() - start) / SWEEPS);
+  }
+  host::report("sweep of 2 enabled + 1 disabled driver: registry %zu bytes, %llu cycles | "
+               "hand-written %zu bytes, %llu cycles",
+               registryBytes, (unsigned long long)registryCycles, handBytes, (unsigned long long)handCycles);
+
+  // No runtime dispatch: within noise of the hand-written code
+  CHECK(handBytes > 0 && registryBytes > 0);
+  CHECK(registryBytes <= handBytes * 5 / 4);
+  CHECK(registryCycles <= handCycles * 3 / 2 + 5);
+
+  host::finish("sensor_set");
+}
@@ -0,0 +1,182 @@
+/*
+ * BME280 array: sweep time against sensor count, shared Bus #2 recovery
+ *
+ * 1-4 modelled BME280s (0x76/0x77 on both buses) plus a BH1750 on Bus #2 are
+ * read by SensorManager. Conversions are triggered together and collected
+ * in one sweep, so the sweep should cost one conversion plus bus time per
+ * sensor, not one conversion per sensor. Reported per count: sweep time
+ * (virtual clock: bus transfers and conversion wait), bus time and host CPU
+ * time of the sweep.
+ *
+ * Scheduled like the station's measure and collect jobs (startSensors(),
+ * collect after the wait it returns), a read must not wait for any
+ * conversion, the light must be that of the conversion just started,
+ * stamped at the collect, and the BME280s, collected long after their
+ * conversion (behind the BH1750), must still read.
+ *
+ * Then a BME280 shares Bus #2 with the BH1750: a BH1750 failure must not
+ * clear the bus under the working BME280, a stuck bus must still be cleared.
+ */
+
+#include "HostTest.h"
+#include "HostI2C.h"
+#include "HostBme280.h"
+#include "HostBh1750.h"
+#include "SensorManager.h"
+#include "EventLog.h"
+#include <memory>
+
+constexpr uint64_t MS = 1000;
+constexpr int SWEEPS = 50;
+
+// Discovery order of Bme280Sensor
+struct Slot {
+  uint8_t bus;
+  uint8_t address;
+};
+
+static const Slot SLOTS[] = {
+  { 1, BME_I2C_ADDR },
+  { 1, BME_I2C_ADDR_ALT },
+  { 2, BME_I2C_ADDR },
+  { 2, BME_I2C_ADDR_ALT },
+};
+
+static host::Bme280Model s_bmes[4] = { host::Bme280Model(1), host::Bme280Model(2), host::Bme280Model(3),
+                                       host::Bme280Model(4) };
+static host::Bh1750Model s_bh1750;
+
+static void resetBuses() {
+  host::clearEvents();
+  host::i2cBus(1).reset();
+  host::i2cBus(2).reset();
+  Wire.end();
+  Wire1.end();
+}
+
+// Attach the first 'count' BME280 slots and the BH1750
+static void attach(int count) {
+  resetBuses();
+  for (int i = 0; i < count; i++) {
+    s_bmes[i].reset();
+    host::i2cBus(SLOTS[i].bus).attach(SLOTS[i].address, s_bmes[i]);
+  }
+  s_bh1750.reset();
+  host::i2cBus(2).attach(BH1750_I2C_ADDR, s_bh1750);
+}
+
+// Wait for the next scheduled read and do it
+static void readNext(SensorManager& manager) {
+  const uint32_t next = manager.getNextReadTime(millis());
+  if ((int32_t)(next - millis()) > 0) {
+    host::advance((uint64_t)(next - millis()) * MS);
+  }
+  manager.readSensors();
+}
+
+int main() {
+  eventLog.begin();
+
+  // Sweep time against sensor count
+  double sweepMs[5] = {};
+  uint32_t conversionUs = 0;
+  for (int count = 1; count <= 4; count++) {
+    attach(count);
+    auto manager = std::make_unique<SensorManager>();
+    CHECK(manager->begin());
+    CHECK(manager->getSensor<Bme280Sensor>().getInstanceCount() == count);
+    readNext(*manager);
+    conversionUs = s_bmes[0].getConversionTimeUs();
+
+    uint64_t sweepUs = 0;
+    uint64_t busUs = 0;
+    double hostNs = 0;
+    for (int i = 0; i < SWEEPS; i++) {
+      const uint64_t busBefore = host::i2cBus(1).getBusyTimeUs() + host::i2cBus(2).getBusyTimeUs();
+      hostNs += host::measureNs([&]() { readNext(*manager); });
+      busUs += host::i2cBus(1).getBusyTimeUs() + host::i2cBus(2).getBusyTimeUs() - busBefore;
+      sweepUs += manager->getLastSweepTime();
+      CHECK(manager->getSensorData().isValid);
+    }
+
+    sweepMs[count] = sweepUs / 1000.0 / SWEEPS;
+    host::report("%d BME280 + BH1750: sweep %5.2f ms (bus %5.2f ms, conversion %.2f ms), host CPU %5.1f us",
+                 count, sweepMs[count], busUs / 1000.0 / SWEEPS, conversionUs / 1000.0, hostNs / 1000 / SWEEPS);
+  }
+
+  // Overlapped conversions: each extra sensor adds bus time, not a conversion
+  CHECK(sweepMs[4] - sweepMs[1] < 3 * conversionUs / 1000.0 / 2);
+  CHECK(sweepMs[4] < 2 * conversionUs / 1000.0 + 10);
+
+  // Scheduled collect: no conversion wait, fresh light stamped at acquisition
+  {
+    attach(2);
+    auto manager = std::make_unique<SensorManager>();
+    CHECK(manager->begin());
+    readNext(*manager);
+
+    uint64_t sweepUs = 0;
+    uint32_t stale = 0;
+    uint32_t longestWaitMs = 0;
+    for (int i = 0; i < SWEEPS; i++) {
+      const uint32_t next = manager->getNextReadTime(millis());
+      host::advance((uint64_t)(next - millis()) * MS);
+      s_bh1750.lux = 100.0 + 20.0 * i;
+      const uint32_t waitMs = manager->startSensors();
+      host::advance((uint64_t)waitMs * MS);
+      const uint32_t collectTime = millis();
+      CHECK(manager->readSensors());
+      CHECK(manager->getSampleTime() == collectTime && manager->getSensorData().isValid);
+      stale += !(fabsf(manager->getSensorData().lightLevel - (float)s_bh1750.lux) <= 2.0f);
+      sweepUs += manager->getLastSweepTime();
+      longestWaitMs = max(longestWaitMs, waitMs);
+    }
+    const double scheduledMs = sweepUs / 1000.0 / SWEEPS;
+    CHECK(stale == 0);
+    CHECK(manager->getSensor<Bme280Sensor>().getInstance(1).state.failureCount == 0);
+    CHECK(longestWaitMs > 0 && scheduledMs < conversionUs / 1000.0);
+    host::report("2 BME280 + BH1750 scheduled: sweep %5.2f ms, collect %u ms after start, %u stale light readings",
+                 scheduledMs, longestWaitMs, stale);
+  }
+
+  // BH1750 fails while a BME280 on the same bus keeps answering
+  attach(3);
+  auto manager = std::make_unique<SensorManager>();
+  CHECK(manager->begin());
+  readNext(*manager);
+  host::i2cBus(2).resetStatistics();
+
+  host::i2cBus(2).detach(BH1750_I2C_ADDR);
+  const Bh1750Sensor& bh1750 = manager->getSensor<Bh1750Sensor>();
+  for (int i = 0; i < 2 * I2C_RECOVERY_FAILURE_THRESHOLD; i++) {
+    readNext(*manager);
+  }
+  CHECK(!bh1750.state().online);
+  host::i2cBus(2).attach(BH1750_I2C_ADDR, s_bh1750);
+  for (int i = 0; i < 20 && !bh1750.state().online; i++) {
+    readNext(*manager);
+  }
+  const Bme280Sensor& bme280 = manager->getSensor<Bme280Sensor>();
+  CHECK(bh1750.state().online);
+  CHECK(bh1750.state().recoveryCount == 1);
+  CHECK(host::i2cBus(2).getClears() == 0);
+  CHECK(bme280.getInstance(2).busNumber == 2 && bme280.getInstance(2).state.online);
+  CHECK(bme280.getInstance(2).state.failureCount == 0 && bme280.getInstance(2).state.recoveryCount == 0);
+  host::report("BH1750 lost on a bus shared with a BME280: re-initialized without a bus clear");
+
+  // Bus #2 stuck: nothing answers there, so the BH1750 recovery clears it
+  host::i2cBus(2).holdSda(5);
+  for (int i = 0; i < 40 && host::i2cBus(2).isSdaHeld(); i++) {
+    readNext(*manager);
+  }
+  CHECK(!host::i2cBus(2).isSdaHeld());
+  CHECK(host::i2cBus(2).getClears() > 0);
+  for (int i = 0; i < 40 && !(bh1750.state().online && manager->getSensorData().isValid); i++) {
+    readNext(*manager);
+  }
+  CHECK(bh1750.state().online);
+  CHECK(manager->getSensorData().isValid);
+  host::report("stuck Bus #2: cleared %u time(s), BH1750 and BME280 back", host::i2cBus(2).getClears());
+
+  host::finish("sensor_sweep");
+}
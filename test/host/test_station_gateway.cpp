@@ -0,0 +1,337 @@
+/*
+ * StationGateway: many-peer fan-in with slow and dead peers
+ *
+ * Sixteen stand-in stations on loopback ports answer GET /api/v1/sensors:
+ * fast (5-50 ms), late (half the peer deadline), slow (twice the deadline),
+ * silent (accept, never answer), dead (nothing listening), HTTP 500 and an
+ * oversized body. The gateway task polls them on the real clock with the
+ * intervals scaled down (see the Makefile). Checked are the status of every
+ * peer in the merged document, that a slow or dead peer costs only its own
+ * deadline (cycle time against the sum of the per-peer latencies a
+ * sequential poll would take), the concurrency limit, that a peer that goes
+ * away keeps its last reading while it is failing, and that serve() always
+ * sends a complete document while the task re-renders.
+ */
+
+#include "HostTest.h"
+#include "StationGateway.h"
+#include <lwip/sockets.h>
+#include <poll.h>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr uint16_t BASE_PORT = 18100;
+constexpr uint8_t PEERS = StationGateway::PEER_COUNT;
+
+enum class Kind { FAST, LATE, SLOW, SILENT, DEAD, ERROR, HUGE };
+
+static const char* const EXPECTED_STATUS[] = { "ok", "ok", "timeout", "timeout", "connect_error", "http_error",
+                                               "bad_response" };
+
+// Stand-in stations, one listener per live peer, all served from one thread
+class Stations {
+public:
+  std::atomic<Kind> kinds[PEERS];
+
+  void start() {
+    std::thread([this]() { serve(); }).detach();
+  }
+
+  uint32_t maxOpen() const {
+    return m_maxOpen;
+  }
+  uint32_t requests() const {
+    return m_requests;
+  }
+
+private:
+  struct Connection {
+    int fd;
+    uint8_t peer;
+    std::string request;
+    uint64_t respondAt;  // 0 = request incomplete, UINT64_MAX = never
+  };
+
+  std::atomic<uint32_t> m_maxOpen{ 0 };
+  std::atomic<uint32_t> m_requests{ 0 };
+
+  static int listenOn(uint16_t port) {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    const int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 16) != 0) {
+      close(fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  // Readings of a station (same shape as /api/v1/sensors)
+  static std::string body(uint8_t peer, bool huge) {
+    char text[512];
+    snprintf(text, sizeof(text),
+             "{\"temperature\":%.1f,\"humidity\":55.2,\"pressure\":101325.0,\"anomalies\":{},\"dewPoint\":11.2,"
+             "\"feelsLike\":20.1,\"absHumidity\":9.7,\"comfort\":\"ok\",\"pressureTrend\":\"steady\","
+             "\"forecast\":\"Fine weather\",\"uptime\":1234,\"rssi\":-61,\"valid\":true,\"seq\":%u%s}",
+             20.0 + peer / 10.0, peer, huge ? ",\"padding\":\"" : "");
+    std::string result(text);
+    if (huge) {
+      result.insert(result.size() - 1, std::string(GATEWAY_PEER_BODY_SIZE * 2, 'x') + "\"");
+    }
+    return result;
+  }
+
+  static void respond(const Connection& connection, Kind kind) {
+    std::string response;
+    if (kind == Kind::ERROR) {
+      response = "HTTP/1.1 500 Internal Server Error\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    } else {
+      const std::string text = body(connection.peer, kind == Kind::HUGE);
+      response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: " +
+                 std::to_string(text.size()) + "\r\nConnection: close\r\n\r\n" + text;
+    }
+    ::send(connection.fd, response.data(), response.size(), MSG_NOSIGNAL);
+  }
+
+  void serve() {
+    std::mt19937 random(41);
+    int listeners[PEERS];
+    for (int& fd : listeners) {
+      fd = -1;
+    }
+    std::vector<Connection> connections;
+
+    for (;;) {
+      const uint64_t now = host::now();
+
+      // Dead peers have no listener
+      for (uint8_t i = 0; i < PEERS; i++) {
+        const bool dead = kinds[i] == Kind::DEAD;
+        if (dead && listeners[i] >= 0) {
+          close(listeners[i]);
+          listeners[i] = -1;
+        } else if (!dead && listeners[i] < 0) {
+          listeners[i] = listenOn(BASE_PORT + i);
+        }
+      }
+
+      // Answers that are due
+      for (Connection& connection : connections) {
+        if (connection.fd >= 0 && connection.respondAt && connection.respondAt <= now) {
+          respond(connection, kinds[connection.peer]);
+          close(connection.fd);
+          connection.fd = -1;
+        }
+      }
+
+      std::vector<pollfd> waiting;
+      std::vector<int> owner;  // Peer of a listener, -1 - index for a connection
+      for (uint8_t i = 0; i < PEERS; i++) {
+        if (listeners[i] >= 0) {
+          waiting.push_back({ listeners[i], POLLIN, 0 });
+          owner.push_back(i);
+        }
+      }
+      for (size_t i = 0; i < connections.size(); i++) {
+        if (connections[i].fd >= 0) {
+          waiting.push_back({ connections[i].fd, POLLIN, 0 });
+          owner.push_back(-1 - (int)i);
+        }
+      }
+      if (poll(waiting.data(), waiting.size(), 1) > 0) {
+        for (size_t i = 0; i < waiting.size(); i++) {
+          if (!(waiting[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+            continue;
+          }
+          if (owner[i] >= 0) {
+            const int fd = accept(waiting[i].fd, nullptr, nullptr);
+            if (fd >= 0) {
+              connections.push_back({ fd, (uint8_t)owner[i], std::string(), 0 });
+            }
+            continue;
+          }
+          Connection& connection = connections[-1 - owner[i]];
+          char buffer[512];
+          const ssize_t count = recv(connection.fd, buffer, sizeof(buffer), 0);
+          if (count <= 0) {
+            close(connection.fd);
+            connection.fd = -1;
+            continue;
+          }
+          connection.request.append(buffer, count);
+          if (!connection.respondAt && connection.request.find("\r\n\r\n") != std::string::npos) {
+            m_requests++;
+            const Kind kind = kinds[connection.peer];
+            const uint64_t delayUs = kind == Kind::SILENT ? UINT64_MAX - host::now()
+                                     : kind == Kind::SLOW ? 2 * GATEWAY_PEER_TIMEOUT_MS * 1000ULL
+                                     : kind == Kind::LATE ? GATEWAY_PEER_TIMEOUT_MS * 500ULL
+                                                          : (5 + random() % 45) * 1000ULL;
+            connection.respondAt = host::now() + delayUs;
+          }
+        }
+      }
+
+      uint32_t open = 0;
+      for (size_t i = connections.size(); i-- > 0;) {
+        if (connections[i].fd < 0) {
+          connections.erase(connections.begin() + i);
+        } else {
+          open++;
+        }
+      }
+      m_maxOpen = max(m_maxOpen.load(), open);
+    }
+  }
+};
+
+static Stations s_stations;
+static StationGateway* s_gateway = nullptr;
+static std::string s_document;
+
+static void sleepMs(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+static const std::string& document() {
+  s_gateway->serve([](const char* body, size_t length) { s_document.assign(body, length); });
+  return s_document;
+}
+
+static long gatewayField(const char* name) {
+  char key[32];
+  snprintf(key, sizeof(key), "\"%s\":", name);
+  const size_t field = document().find(key);
+  return field == std::string::npos ? -1 : strtol(s_document.c_str() + field + strlen(key), nullptr, 10);
+}
+
+struct PeerEntry {
+  std::string status;
+  long latencyMs;
+  bool hasData;
+  long seq;
+};
+
+// Entry of a peer in the merged document
+static PeerEntry peerEntry(uint8_t peer) {
+  PeerEntry entry = { "", -1, false, -1 };
+  char name[48];
+  snprintf(name, sizeof(name), "\"name\":\"%s\"", GATEWAY_PEERS[peer]);
+  const size_t start = s_document.find(name);
+  if (start == std::string::npos) {
+    return entry;
+  }
+  const char* text = s_document.c_str() + start;
+  const char* status = strstr(text, "\"status\":\"");
+  if (status) {
+    entry.status.assign(status + 10, strcspn(status + 10, "\""));
+  }
+  const char* latency = strstr(text, "\"latencyMs\":");
+  entry.latencyMs = latency ? strtol(latency + 12, nullptr, 10) : -1;
+  const char* data = strstr(text, "\"data\":");
+  entry.hasData = data && data[7] == '{';
+  const char* seq = entry.hasData ? strstr(data, "\"seq\":") : nullptr;
+  entry.seq = seq ? strtol(seq + 6, nullptr, 10) : -1;
+  return entry;
+}
+
+static void waitCycles(long cycles) {
+  const uint32_t start = millis();
+  while (gatewayField("cycles") < cycles && millis() - start < 10 * GATEWAY_POLL_INTERVAL_MS) {
+    sleepMs(5);
+  }
+}
+
+int main() {
+  static const Kind LAYOUT[] = { Kind::FAST, Kind::FAST, Kind::FAST,   Kind::SLOW,  Kind::FAST, Kind::LATE,
+                                 Kind::FAST, Kind::SILENT, Kind::FAST, Kind::DEAD,  Kind::FAST, Kind::SLOW,
+                                 Kind::FAST, Kind::ERROR,  Kind::DEAD, Kind::HUGE };
+  static_assert(sizeof(LAYOUT) / sizeof(LAYOUT[0]) == PEERS, "One kind per configured peer");
+
+  host::useRealTime(true);
+  for (uint8_t i = 0; i < PEERS; i++) {
+    s_stations.kinds[i] = LAYOUT[i];
+  }
+  s_stations.start();
+  sleepMs(50);
+
+  s_gateway = new StationGateway();  // Never destroyed - its task outlives main()
+  s_gateway->begin();
+  SensorData local;
+  local.temperature = 21.5f;
+  local.humidity = 40.0f;
+  local.pressure = 100900.0f;
+  local.isValid = true;
+  s_gateway->updateLocal(local, 1);
+
+  // Every peer classified, good ones cached
+  waitCycles(3);
+  uint32_t statusesRight = 0;
+  long sequentialMs = 0;
+  for (uint8_t i = 0; i < PEERS; i++) {
+    const PeerEntry entry = peerEntry(i);
+    const bool ok = LAYOUT[i] == Kind::FAST || LAYOUT[i] == Kind::LATE;
+    const bool right = entry.status == EXPECTED_STATUS[(int)LAYOUT[i]] && entry.hasData == ok &&
+                       (!ok || entry.seq == i);
+    statusesRight += right;
+    sequentialMs += entry.latencyMs;
+    if (!right) {
+      host::report("peer %u: status %s, data %d", i, entry.status.c_str(), entry.hasData);
+    }
+  }
+  CHECK(statusesRight == PEERS);
+  CHECK(gatewayField("online") == 9);
+
+  // Fan-in: slow peers overlap, a cycle costs about one deadline instead of their sum
+  const long cycleMs = gatewayField("cycleMs");
+  CHECK(cycleMs >= (long)GATEWAY_PEER_TIMEOUT_MS);
+  CHECK(cycleMs <= 2 * (long)GATEWAY_PEER_TIMEOUT_MS + 50);
+  CHECK(s_stations.maxOpen() <= GATEWAY_MAX_CONCURRENT);
+  host::report("%u peers (8 fast, 1 late, 2 slow, 1 silent, 2 dead, 1 HTTP 500, 1 oversized): "
+               "%u classified right, %ld online",
+               PEERS, statusesRight, gatewayField("online"));
+  host::report("cycle %ld ms with %u concurrent sockets (deadline %u ms, sequential polling %ld ms), "
+               "at most %u requests open at the stations",
+               cycleMs, GATEWAY_MAX_CONCURRENT, GATEWAY_PEER_TIMEOUT_MS, sequentialMs, s_stations.maxOpen());
+
+  // A peer goes away: failing status, last reading kept; back again: fresh
+  s_stations.kinds[0] = Kind::DEAD;
+  waitCycles(gatewayField("cycles") + 2);
+  PeerEntry gone = peerEntry(0);
+  CHECK(gone.status == "connect_error" && gone.hasData && gone.seq == 0);
+  s_stations.kinds[0] = Kind::FAST;
+  waitCycles(gatewayField("cycles") + 2);
+  CHECK(peerEntry(0).status == "ok");
+  host::report("peer 0 down: status %s, last reading kept; back: %s", gone.status.c_str(),
+               peerEntry(0).status.c_str());
+
+  // Serving while the task renders (cycles and local publishes swap the buffers)
+  uint32_t broken = 0;
+  uint32_t maxServeUs = 0;
+  size_t served = 0;
+  for (int i = 0; i < 2000; i++) {
+    const uint64_t start = host::now();
+    s_gateway->serve([&](const char* body, size_t length) {
+      served += length;
+      broken += length < 2 || body[0] != '{' || body[length - 1] != '}' ||
+                !strstr(body, "\"name\":\"local\"");
+    });
+    maxServeUs = max(maxServeUs, (uint32_t)(host::now() - start));
+    if (i % 20 == 0) {
+      s_gateway->updateLocal(local, 2 + i);
+    }
+    sleepMs(1);
+  }
+  CHECK(broken == 0);
+  host::report("2000 serves during re-renders: %u incomplete, %zu bytes, serve() <= %u us", broken, served,
+               maxServeUs);
+
+  host::finish("station_gateway");
+}
@@ -0,0 +1,248 @@
+/*
+ * TimeSync: SNTP client against an NTP server stand-in
+ *
+ * A minimal SNTP server on a loopback UDP socket answers with a clock that
+ * runs 40 ppm ahead of the station's (plus an offset the test sets), so the
+ * drift correction, slew and step paths all see real exchanges. sync() is
+ * called directly on the real clock; the intervals between syncs are jumped
+ * over (host::setTime). Checked: no mapping before the first fix, the
+ * reply deadline with a silent server, time_synced with the stratum, drift
+ * and continuity across resyncs, small offsets slewed without a step, and
+ * large ones stepped and journaled as time_stepped: seconds plus the
+ * millisecond remainder, minutes plus the flagged seconds remainder beyond
+ * the 16-bit range of seconds. The journaled step is compared as a whole.
+ * Replies that do not answer our request, kiss of death (stratum 0) and
+ * unsynchronized servers are rejected. Both NTP eras are covered (2026 and
+ * 2040).
+ */
+
+#include "HostTest.h"
+#include "TimeSync.h"
+#include "EventLog.h"
+#include <lwip/sockets.h>
+#include <atomic>
+#include <thread>
+
+constexpr double SERVER_DRIFT = 40e-6;
+constexpr uint64_t INTERVAL_US = TIME_SYNC_INTERVAL_MS * 1000ULL;
+
+// NTP server stand-in: UTC = utc0 + now * (1 + drift) + offset
+static std::atomic<int64_t> s_utc0{ 0 };
+static std::atomic<int64_t> s_offsetUs{ 0 };
+static std::atomic<bool> s_silent{ false };
+static std::atomic<bool> s_foreign{ false };     // Originate timestamp not ours
+static std::atomic<uint8_t> s_stratum{ 2 };
+static std::atomic<uint8_t> s_leap{ 0 };          // 3 = unsynchronized
+
+static int64_t serverUtc(uint64_t monotonicUs) {
+  return s_utc0 + (int64_t)llround(monotonicUs * (1.0 + SERVER_DRIFT)) + s_offsetUs;
+}
+
+// 32.32 fixed point since 1900, seconds folded into the current era
+static void putTimestamp(uint8_t* data, int64_t unixUs) {
+  const uint32_t seconds = (uint64_t)(unixUs / 1000000 + 2208988800LL) & 0xFFFFFFFFULL;
+  const uint32_t fraction = ((uint64_t)(unixUs % 1000000) << 32) / 1000000;
+  for (int i = 0; i < 4; i++) {
+    data[i] = seconds >> (24 - 8 * i);
+    data[4 + i] = fraction >> (24 - 8 * i);
+  }
+}
+
+static void serve(int fd) {
+  uint8_t request[48];
+  uint8_t reply[48];
+  for (;;) {
+    sockaddr_in from;
+    socklen_t length = sizeof(from);
+    if (recvfrom(fd, request, sizeof(request), 0, (sockaddr*)&from, &length) != (int)sizeof(request) || s_silent) {
+      continue;
+    }
+    memset(reply, 0, sizeof(reply));
+    reply[0] = (s_leap << 6) | (4 << 3) | 4;  // Version 4, server mode
+    reply[1] = s_stratum;
+    memcpy(reply + 24, request + 40, 8);
+    if (s_foreign) {
+      reply[31] ^= 1;
+    }
+    const int64_t utc = serverUtc(host::now());
+    putTimestamp(reply + 32, utc);
+    putTimestamp(reply + 40, utc);
+    sendto(fd, reply, sizeof(reply), 0, (sockaddr*)&from, length);
+  }
+}
+
+static double field(const TimeSync& timeSync, const char* key) {
+  char buffer[512];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginObject();
+  timeSync.writeJSON(json);
+  json.endObject();
+  char pattern[40];
+  snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+  const char* value = strstr(buffer, pattern);
+  return value ? atof(value + strlen(pattern)) : NAN;
+}
+
+// Events of one code since a sequence number, and the arguments of the last one
+static uint32_t events(uint32_t since, EventCode code, int32_t* arg0 = nullptr, int32_t* arg1 = nullptr) {
+  static char buffer[EVENT_LOG_CAPACITY * 96 + 16];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginArray();
+  eventLog.writeJSON(json, since, EVENT_LOG_CAPACITY);
+  json.endArray();
+  char pattern[48];
+  snprintf(pattern, sizeof(pattern), "\"code\":\"%s\"", EventLog::getCodeName((uint16_t)code));
+  uint32_t count = 0;
+  for (const char* cursor = buffer; (cursor = strstr(cursor, pattern)) != nullptr; cursor++) {
+    count++;
+    if (arg0 && arg1) {
+      *arg0 = atoi(strstr(cursor, "\"arg0\":") + 7);
+      *arg1 = atoi(strstr(cursor, "\"arg1\":") + 7);
+    }
+  }
+  return count;
+}
+
+// Mapping error against the server clock now (µs)
+static int64_t mappingError(const TimeSync& timeSync) {
+  const uint64_t now = host::now();
+  int64_t utc = 0;
+  timeSync.toUtcUs(now, utc);
+  return utc - serverUtc(now);
+}
+
+// Step (ms) from the time_stepped arguments
+static int64_t stepMs(int32_t arg0, int32_t arg1) {
+  if (arg1 >= TIME_STEP_MINUTES_FLAG) {
+    return ((int64_t)arg0 * 60 + (arg0 < 0 ? -1 : 1) * (arg1 - TIME_STEP_MINUTES_FLAG)) * 1000;
+  }
+  return (int64_t)arg0 * 1000 + arg1;
+}
+
+static void skipInterval() {
+  host::setTime(host::now() + INTERVAL_US);
+}
+
+static void scenario(const char* name, int64_t utc0) {
+  host::report("%s:", name);
+  s_utc0 = utc0;
+  s_offsetUs = 0;
+  TimeSync timeSync;
+  const uint32_t since = eventLog.getNextSequence() - 1;
+
+  // Silent server: no mapping, the reply deadline holds
+  {
+    s_silent = true;
+    int64_t utc = 0;
+    CHECK(!timeSync.toUtcUs(host::now(), utc));
+    const uint64_t start = host::now();
+    CHECK(!timeSync.sync());
+    const uint64_t waitedUs = host::now() - start;
+    CHECK(waitedUs >= TIME_SYNC_TIMEOUT_MS * 1000ULL && waitedUs < TIME_SYNC_TIMEOUT_MS * 1000ULL + 50000);
+    CHECK(field(timeSync, "failures") == 1 && !timeSync.isSynced());
+    s_silent = false;
+    host::report("  silent server: gave up after %.1f ms", waitedUs / 1000.0);
+  }
+
+  // First fix
+  int32_t arg0 = 0;
+  int32_t arg1 = 0;
+  CHECK(timeSync.sync() && timeSync.isSynced());
+  CHECK(llabs(mappingError(timeSync)) < 1500);
+  CHECK(events(since, EventCode::TIME_SYNCED, &arg0, &arg1) == 1 && arg0 == 2);
+  host::report("  first sync: error %lld us, time_synced stratum %d, round trip %d ms",
+               (long long)mappingError(timeSync), arg0, arg1);
+
+  // Drift measured and corrected, no jumps at resyncs (undisciplined: 36 ms per interval)
+  int64_t worstJumpUs = 0;
+  int64_t worstErrorUs = 0;
+  for (int i = 0; i < 12; i++) {
+    skipInterval();
+    if (i >= 3) {
+      worstErrorUs = max(worstErrorUs, llabs(mappingError(timeSync)));
+    }
+    const uint64_t at = host::now() + 50000;
+    int64_t before = 0;
+    int64_t after = 0;
+    timeSync.toUtcUs(at, before);
+    CHECK(timeSync.sync());
+    timeSync.toUtcUs(at, after);
+    worstJumpUs = max(worstJumpUs, llabs(after - before));
+  }
+  const double driftPpm = field(timeSync, "driftPpm");
+  CHECK(fabs(driftPpm - SERVER_DRIFT * 1e6) < 1.0);
+  CHECK(worstErrorUs < 2000 && worstJumpUs < 2000);
+  CHECK(field(timeSync, "steps") == 0);
+  host::report("  12 resyncs: drift %.3f ppm, error before resync <= %lld us, jump at resync <= %lld us", driftPpm,
+               (long long)worstErrorUs, (long long)worstJumpUs);
+
+  // 200 ms offset: slewed over one interval, no step
+  s_offsetUs += 200000;
+  skipInterval();
+  CHECK(timeSync.sync());
+  const double slewPpm = field(timeSync, "slewPpm");
+  CHECK(field(timeSync, "steps") == 0);
+  CHECK(fabs(slewPpm - 200000.0 / TIME_SYNC_INTERVAL_MS * 1000) < 3);
+  host::report("  +200 ms: slewed at %.1f ppm, no step", slewPpm);
+
+  // Steps journaled as seconds and ms remainder, beyond 9.1 h as minutes and seconds
+  static const struct {
+    int64_t stepMs;
+    bool minutes;
+  } STEPS[] = {
+    { 40250, false },
+    { -3500, false },
+    { 7200000, false },
+    { -86400123, true },  // A day off: beyond 16-bit seconds
+  };
+  uint32_t steps = 0;
+  for (const auto& step : STEPS) {
+    skipInterval();  // Pending slew worked off
+    s_offsetUs += step.stepMs * 1000;
+    CHECK(timeSync.sync());
+    steps++;
+    CHECK(field(timeSync, "steps") == steps);
+    CHECK(events(since, EventCode::TIME_STEPPED, &arg0, &arg1) == steps);
+    const bool minutes = arg1 >= TIME_STEP_MINUTES_FLAG;
+    const int64_t journaledMs = stepMs(arg0, arg1);
+    CHECK(minutes == step.minutes && abs(arg1) < (minutes ? TIME_STEP_MINUTES_FLAG + 60 : 1000));
+    CHECK(llabs(journaledMs - step.stepMs) <= (minutes ? 1000 : 2));
+    CHECK(llabs(mappingError(timeSync)) < 1500);
+    host::report("  step %+.3f s: time_stepped arg0 %d, arg1 %d (%+.3f s)", step.stepMs / 1000.0, arg0, arg1,
+                 journaledMs / 1000.0);
+  }
+
+  // Replies that must not set the clock
+  {
+    const double failures = field(timeSync, "failures");
+    s_foreign = true;
+    CHECK(!timeSync.sync());
+    s_foreign = false;
+    s_stratum = 0;
+    CHECK(!timeSync.sync());
+    s_stratum = 2;
+    s_leap = 3;
+    CHECK(!timeSync.sync());
+    s_leap = 0;
+    CHECK(field(timeSync, "failures") == failures + 3);
+    CHECK(timeSync.sync() && llabs(mappingError(timeSync)) < 1500);
+  }
+}
+
+int main() {
+  host::useRealTime(true);
+  eventLog.begin();
+
+  const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+  sockaddr_in address = {};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(TIME_NTP_PORT);
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  CHECK(bind(fd, (sockaddr*)&address, sizeof(address)) == 0);
+  std::thread(serve, fd).detach();
+
+  scenario("2026-10-18", 1792281600000000LL);
+  scenario("2040-03-16 (NTP era 1)", 2215468800000000LL);
+
+  host::finish("time_sync");
+}
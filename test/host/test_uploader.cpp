@@ -0,0 +1,391 @@
+/*
+ * Uploader: stand-in collector with outages and reconnects
+ *
+ * A collector on a loopback socket plays the InfluxDB write endpoint
+ * (/ping, /api/v2/write with token check, Date header) and can be switched
+ * to outage modes: down (connection refused), stalled (requests read but
+ * never answered), 503 and 400. The upload task runs as a host thread on the
+ * real clock with the intervals scaled down (see the Makefile), while the
+ * test enqueues samples at a fixed rate like loop() does. Checked are
+ * in-order delivery without duplicates, that every sample is either
+ * delivered, dropped by the bounded backlog or rejected (counted), the
+ * reconnect time after an outage, the UPLOAD_FAILED / UPLOAD_RESUMED
+ * events, keep-alive reuse, epoch timestamps from the Date header and that
+ * enqueue() never waits for the network.
+ */
+
+#include "HostTest.h"
+#include "Uploader.h"
+#include "EventLog.h"
+#include <lwip/sockets.h>
+#include <poll.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+constexpr uint16_t COLLECTOR_PORT = 18039;
+constexpr uint32_t PUBLISH_MS = 10;  // Scaled 5 s publish interval
+
+enum class Mode { UP, DOWN, STALL, UNAVAILABLE, REJECT };
+
+// InfluxDB write endpoint stand-in
+class Collector {
+public:
+  std::atomic<Mode> mode{ Mode::UP };
+
+  void start() {
+    std::thread([this]() { serve(); }).detach();
+  }
+
+  // Received samples (seq, epoch) in arrival order
+  std::vector<std::pair<uint32_t, uint32_t>> samples() {
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_samples;
+  }
+
+  uint32_t connections() const {
+    return m_connections;
+  }
+  uint32_t pings() const {
+    return m_pings;
+  }
+  uint32_t unauthorized() const {
+    return m_unauthorized;
+  }
+
+private:
+  struct Connection {
+    int fd;
+    std::string buffer;
+  };
+
+  std::mutex m_lock;
+  std::vector<std::pair<uint32_t, uint32_t>> m_samples;
+  std::atomic<uint32_t> m_connections{ 0 };
+  std::atomic<uint32_t> m_pings{ 0 };
+  std::atomic<uint32_t> m_unauthorized{ 0 };
+
+  static int listenOn(uint16_t port) {
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    const int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 8) != 0) {
+      close(fd);
+      return -1;
+    }
+    return fd;
+  }
+
+  static void respond(int fd, int status) {
+    char date[64];
+    const time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%a, %d %b %Y %H:%M:%S GMT", gmtime(&now));
+    char response[256];
+    const int length = snprintf(response, sizeof(response),
+                                "HTTP/1.1 %d Status\r\nDate: %s\r\nContent-Length: 0\r\n\r\n", status, date);
+    ::send(fd, response, length, MSG_NOSIGNAL);
+  }
+
+  // Handle every complete request in the connection buffer
+  void process(Connection& connection) {
+    for (;;) {
+      const size_t end = connection.buffer.find("\r\n\r\n");
+      if (end == std::string::npos) {
+        return;
+      }
+      const char* head = connection.buffer.c_str();
+      const char* field = strcasestr(head, "Content-Length:");
+      const size_t bodyLength = field && field < head + end ? strtoul(field + 15, nullptr, 10) : 0;
+      if (connection.buffer.size() < end + 4 + bodyLength) {
+        return;
+      }
+      const std::string request = connection.buffer.substr(0, end);
+      const std::string body = connection.buffer.substr(end + 4, bodyLength);
+      connection.buffer.erase(0, end + 4 + bodyLength);
+
+      const Mode current = mode;
+      if (current == Mode::STALL) {
+        continue;  // Read, never answered
+      }
+      if (current == Mode::UNAVAILABLE || current == Mode::REJECT) {
+        respond(connection.fd, current == Mode::UNAVAILABLE ? 503 : 400);
+        continue;
+      }
+      if (request.compare(0, 10, "GET /ping ") == 0) {
+        m_pings++;
+        respond(connection.fd, 204);
+        continue;
+      }
+      if (request.compare(0, 38, "POST /api/v2/write?precision=s HTTP/1.") != 0 ||
+          request.find("\r\nAuthorization: Token secret\r\n") == std::string::npos) {
+        m_unauthorized++;
+        respond(connection.fd, 401);
+        continue;
+      }
+
+      std::lock_guard<std::mutex> guard(m_lock);
+      for (size_t start = 0; start < body.size();) {
+        size_t newline = body.find('\n', start);
+        if (newline == std::string::npos) {
+          newline = body.size();
+        }
+        const std::string line = body.substr(start, newline - start);
+        const size_t seq = line.find("seq=");
+        const size_t space = line.rfind(' ');
+        if (seq != std::string::npos && space != std::string::npos) {
+          m_samples.emplace_back(strtoul(line.c_str() + seq + 4, nullptr, 10),
+                                 strtoul(line.c_str() + space + 1, nullptr, 10));
+        }
+        start = newline + 1;
+      }
+      respond(connection.fd, 204);
+    }
+  }
+
+  void serve() {
+    int listenFd = -1;
+    std::vector<Connection> connections;
+    for (;;) {
+      if (mode == Mode::DOWN) {
+        for (Connection& connection : connections) {
+          close(connection.fd);
+        }
+        connections.clear();
+        if (listenFd >= 0) {
+          close(listenFd);
+          listenFd = -1;
+        }
+        usleep(1000);
+        continue;
+      }
+      if (listenFd < 0 && (listenFd = listenOn(COLLECTOR_PORT)) < 0) {
+        usleep(1000);
+        continue;
+      }
+
+      std::vector<pollfd> waiting = { { listenFd, POLLIN, 0 } };
+      for (const Connection& connection : connections) {
+        waiting.push_back({ connection.fd, POLLIN, 0 });
+      }
+      if (poll(waiting.data(), waiting.size(), 5) <= 0) {
+        continue;
+      }
+      if (waiting[0].revents & POLLIN) {
+        const int fd = accept(listenFd, nullptr, nullptr);
+        if (fd >= 0) {
+          connections.push_back({ fd, std::string() });
+          m_connections++;
+        }
+      }
+      for (size_t i = 1; i < waiting.size(); i++) {
+        if (!(waiting[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+          continue;
+        }
+        Connection& connection = connections[i - 1];
+        char buffer[4096];
+        const ssize_t count = recv(connection.fd, buffer, sizeof(buffer), 0);
+        if (count <= 0) {
+          close(connection.fd);
+          connection.fd = -1;
+          continue;
+        }
+        connection.buffer.append(buffer, count);
+        process(connection);
+      }
+      for (size_t i = connections.size(); i-- > 0;) {
+        if (connections[i].fd < 0) {
+          connections.erase(connections.begin() + i);
+        }
+      }
+    }
+  }
+};
+
+static Collector s_collector;
+static Uploader* s_uploader = nullptr;
+static uint32_t s_sequence = 0;
+static uint32_t s_maxEnqueueUs = 0;
+
+static void sleepMs(uint32_t ms) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// Enqueue samples at the publish rate, as loop() does
+static void produce(uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    SensorData data;
+    data.temperature = 20.0f + (s_sequence % 100) * 0.01f;
+    data.humidity = 50.0f;
+    data.pressure = 101325.0f;
+    data.isValid = true;
+    const uint64_t start = host::now();
+    s_uploader->enqueue(data, ++s_sequence, millis());
+    s_maxEnqueueUs = max(s_maxEnqueueUs, (uint32_t)(host::now() - start));
+    sleepMs(PUBLISH_MS);
+  }
+}
+
+// Uploader JSON field
+static long uploaderStat(const char* name) {
+  char buffer[1024];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginObject();
+  s_uploader->writeJSON(json);
+  json.endObject();
+  char key[48];
+  snprintf(key, sizeof(key), "\"%s\":", name);
+  const char* field = strstr(buffer, key);
+  return field ? strtol(field + strlen(key), nullptr, 10) : -1;
+}
+
+// Wait until the backlog is delivered, returns ms waited (limit if not drained)
+static uint32_t drain(uint32_t limitMs) {
+  const uint32_t start = millis();
+  while (s_uploader->getQueued() > 0 && millis() - start < limitMs) {
+    sleepMs(1);
+  }
+  return millis() - start;
+}
+
+// Events of a code since a sequence number
+static uint32_t events(uint32_t since, EventCode code) {
+  static char buffer[EVENT_LOG_CAPACITY * 96 + 16];
+  JsonWriter json(buffer, sizeof(buffer));
+  json.beginArray();
+  eventLog.writeJSON(json, since, EVENT_LOG_CAPACITY);
+  json.endArray();
+  char pattern[48];
+  snprintf(pattern, sizeof(pattern), "\"code\":\"%s\"", EventLog::getCodeName((uint16_t)code));
+  uint32_t count = 0;
+  for (const char* cursor = buffer; (cursor = strstr(cursor, pattern)) != nullptr; cursor++) {
+    count++;
+  }
+  return count;
+}
+
+// Outage: samples produced while the collector is in a mode, then ms until the first delivery once it is back
+static uint32_t outage(Mode mode, uint32_t samples, uint32_t& failed, uint32_t& resumed) {
+  const uint32_t since = eventLog.getNextSequence() - 1;
+  s_collector.mode = mode;
+  produce(samples);
+  const size_t before = s_collector.samples().size();
+  s_collector.mode = Mode::UP;
+  const uint32_t start = millis();
+  while (s_collector.samples().size() == before && millis() - start < 5000) {
+    sleepMs(1);
+  }
+  const uint32_t backMs = millis() - start;
+  drain(5000);
+  failed = events(since, EventCode::UPLOAD_FAILED);
+  resumed = events(since, EventCode::UPLOAD_RESUMED);
+  return backMs;
+}
+
+int main() {
+  host::useRealTime(true);
+  eventLog.begin();
+  s_collector.start();
+  sleepMs(50);
+
+  s_uploader = new Uploader();  // Never destroyed - its task outlives main()
+  s_uploader->begin();
+  const uint32_t startEpoch = time(nullptr);
+
+  // Normal operation: clock from /ping, then full batches on one connection
+  produce(5 * UPLOAD_BATCH_SIZE);
+  CHECK(drain(2000) < 2000);
+  CHECK(s_collector.pings() == 1);
+  CHECK(s_collector.samples().size() == 5 * UPLOAD_BATCH_SIZE);
+  CHECK(s_collector.connections() == 1);
+  CHECK(uploaderStat("batches") == 5 && uploaderStat("failures") == 0);
+  host::report("steady: %ld samples in %ld batches over %u connection", uploaderStat("sent"), uploaderStat("batches"),
+               s_collector.connections());
+
+  // Outages shorter than the backlog: nothing lost, reconnect within the backoff
+  const struct {
+    Mode mode;
+    const char* name;
+  } outages[] = {
+    { Mode::DOWN, "collector down" },
+    { Mode::STALL, "collector stalled" },
+    { Mode::UNAVAILABLE, "HTTP 503" },
+  };
+  for (const auto& scenario : outages) {
+    const size_t before = s_collector.samples().size();
+    const uint32_t produced = UPLOAD_BACKLOG_SIZE / 2;
+    uint32_t failed = 0, resumed = 0;
+    const uint32_t backMs = outage(scenario.mode, produced, failed, resumed);
+    const size_t delivered = s_collector.samples().size() - before;
+    CHECK(delivered == produced);
+    CHECK(failed == 1 && resumed == 1);
+    CHECK(backMs <= UPLOAD_RETRY_MAX_MS + UPLOAD_TIMEOUT_MS);  // Next retry at the latest
+    host::report("%-17s %3u samples queued: %zu delivered after recovery, first batch %u ms after it "
+                 "(retry cap %u ms)",
+                 scenario.name, produced, delivered, backMs, UPLOAD_RETRY_MAX_MS);
+  }
+
+  // Outage longer than the backlog: the oldest are dropped and counted, the newest delivered
+  {
+    const size_t before = s_collector.samples().size();
+    const long droppedBefore = uploaderStat("dropped");
+    const uint32_t produced = 2 * UPLOAD_BACKLOG_SIZE;
+    const uint32_t firstSequence = s_sequence + 1;
+    uint32_t failed = 0, resumed = 0;
+    outage(Mode::DOWN, produced, failed, resumed);
+    const auto samples = s_collector.samples();
+    const uint32_t delivered = samples.size() - before;
+    const uint32_t dropped = uploaderStat("dropped") - droppedBefore;
+    CHECK(delivered + dropped == produced);
+    CHECK(delivered >= UPLOAD_BACKLOG_SIZE);
+    CHECK(samples.back().first == s_sequence);
+    CHECK(samples[before].first == firstSequence + dropped);  // Oldest dropped, rest contiguous
+    host::report("backlog overflow: %u samples produced, %u dropped (oldest), %u delivered", produced, dropped,
+                 delivered);
+  }
+
+  // HTTP 400: batch rejected and dropped, not retried
+  {
+    const long rejectedBefore = uploaderStat("rejected");
+    s_collector.mode = Mode::REJECT;
+    produce(UPLOAD_BATCH_SIZE);
+    drain(2000);
+    s_collector.mode = Mode::UP;
+    const long rejected = uploaderStat("rejected") - rejectedBefore;
+    CHECK(rejected == UPLOAD_BATCH_SIZE);
+    CHECK(uploaderStat("lastStatus") == 400);
+    produce(UPLOAD_BATCH_SIZE);
+    CHECK(drain(2000) < 2000);
+    host::report("HTTP 400: %ld samples rejected without retry", rejected);
+  }
+
+  // Whole run: ordered, no duplicates, epoch timestamps from the Date header
+  const auto samples = s_collector.samples();
+  bool ordered = true;
+  bool timestampsValid = true;
+  const uint32_t endEpoch = time(nullptr);
+  for (size_t i = 0; i < samples.size(); i++) {
+    ordered &= i == 0 || samples[i].first > samples[i - 1].first;
+    timestampsValid &= samples[i].second + 2 >= startEpoch && samples[i].second <= endEpoch + 2;
+  }
+  const long sent = uploaderStat("sent");
+  const long dropped = uploaderStat("dropped");
+  const long rejected = uploaderStat("rejected");
+  CHECK(ordered);
+  CHECK(timestampsValid);
+  CHECK((long)samples.size() == sent);
+  CHECK(sent + dropped + rejected == (long)s_sequence);
+  CHECK(s_collector.unauthorized() == 0);
+  CHECK(s_maxEnqueueUs < UPLOAD_TIMEOUT_MS * 1000 / 10);  // Never waits for the network
+  host::report("%u samples: %ld delivered in order without duplicates, %ld dropped, %ld rejected; "
+               "%u connections, enqueue() <= %u us",
+               s_sequence, sent, dropped, rejected, s_collector.connections(), s_maxEnqueueUs);
+
+  host::finish("uploader");
+}
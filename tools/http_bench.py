@@ -0,0 +1,266 @@
+#!/usr/bin/env python3
+"""
+HTTP performance regression suite for ESP32 Weather Station
+Drives a running station (WebServerManager routes) with a weighted request
+mix from N concurrent clients, records per-route latency percentiles,
+throughput and response sizes, and checks them against the budgets in
+http_budgets.json. Results are written as JSON for release-over-release
+tracking; the exit code is 1 when a budget is exceeded.
+
+With --loopback the routes run on the host instead: the host build in
+test/host (http_server.cpp) is built with make, started on a loopback
+socket and checked against http_budgets_host.json.
+
+Usage:
+  tools/http_bench.py http://<station> [--concurrency 4] [--requests 2000]
+                      [--mix "/:1,/api/v1/sensors:8"] [--output result.json]
+  tools/http_bench.py --loopback [...]
+
+Standard library only (Python 3.8+).
+"""
+
+import argparse
+import http.client
+import json
+import os
+import random
+import subprocess
+import sys
+import threading
+import time
+import urllib.parse
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+DEFAULT_BUDGETS = os.path.join(TOOLS_DIR, "http_budgets.json")
+HOST_BUDGETS = os.path.join(TOOLS_DIR, "http_budgets_host.json")
+HOST_DIR = os.path.join(os.path.dirname(TOOLS_DIR), "test", "host")
+HOST_SERVER = os.path.join(HOST_DIR, "build", "http_server", "server")
+RESULT_VERSION = 1
+
+
+def parse_mix(text):
+    """'path:weight,path:weight' -> {path: weight} (weight defaults to 1)"""
+    mix = {}
+    for item in filter(None, (part.strip() for part in text.split(","))):
+        path, separator, weight = item.rpartition(":")
+        if separator and weight.isdigit():
+            mix[path] = int(weight)
+        else:
+            mix[item] = 1
+    return mix
+
+
+def build_schedule(mix, count, seed):
+    """Weighted, shuffled request order - identical for equal seeds"""
+    paths = [path for path, weight in mix.items() for _ in range(weight)]
+    if not paths:
+        raise ValueError("empty request mix")
+    rng = random.Random(seed)
+    schedule = [paths[i % len(paths)] for i in range(count)]
+    rng.shuffle(schedule)
+    return schedule
+
+
+def percentile(sorted_values, fraction):
+    """Nearest-rank percentile (p999 of fewer than 1000 samples is the maximum)"""
+    if not sorted_values:
+        return None
+    rank = max(1, -(-len(sorted_values) * fraction // 1))
+    return sorted_values[min(int(rank), len(sorted_values)) - 1]
+
+
+class Target:
+    """Station origin - the server closes every connection, so each request connects anew"""
+
+    def __init__(self, url, timeout):
+        parsed = urllib.parse.urlsplit(url if "://" in url else "http://" + url)
+        self.host = parsed.hostname
+        self.port = parsed.port or 80
+        self.timeout = timeout
+
+    def fetch(self, path):
+        """One request -> (status, body bytes, latency s); status 0 on connection errors"""
+        start = time.perf_counter()
+        connection = http.client.HTTPConnection(self.host, self.port, timeout=self.timeout)
+        try:
+            connection.request("GET", path, headers={"Connection": "close"})
+            response = connection.getresponse()
+            body = response.read()
+            return response.status, len(body), time.perf_counter() - start
+        except (OSError, http.client.HTTPException):
+            return 0, 0, time.perf_counter() - start
+        finally:
+            connection.close()
+
+
+class LoopbackServer:
+    """Host build of the routes - built and started on demand, prints its origin first"""
+
+    def __init__(self):
+        self.process = None
+
+    def start(self):
+        # Build output to stderr, stdout stays machine-readable
+        subprocess.run(["make", "-s", "-C", HOST_DIR, "http-server"], check=True, stdout=sys.stderr)
+        self.process = subprocess.Popen([HOST_SERVER], stdout=subprocess.PIPE, text=True)
+        origin = self.process.stdout.readline().strip()
+        if not origin:
+            self.stop()
+            raise RuntimeError("host HTTP server did not start")
+        return origin
+
+    def stop(self):
+        if self.process:
+            self.process.terminate()
+            self.process.wait()
+            self.process = None
+
+
+def run(target, schedule, concurrency):
+    """Workers take the next scheduled request until the schedule is drained"""
+    samples = {path: [] for path in set(schedule)}
+    position = iter(schedule)
+    lock = threading.Lock()
+
+    def worker():
+        while True:
+            with lock:
+                path = next(position, None)
+            if path is None:
+                return
+            sample = target.fetch(path)
+            with lock:
+                samples[path].append(sample)
+
+    threads = [threading.Thread(target=worker) for _ in range(concurrency)]
+    start = time.perf_counter()
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    return samples, time.perf_counter() - start
+
+
+def summarize(samples, elapsed):
+    """Per-route statistics (latencies in ms, sizes in bytes)"""
+    routes = {}
+    for path, results in sorted(samples.items()):
+        ok = [r for r in results if 200 <= r[0] < 300]
+        latencies = sorted(r[2] * 1000.0 for r in ok)
+        sizes = [r[1] for r in ok]
+        routes[path] = {
+            "requests": len(results),
+            "errors": len(results) - len(ok),
+            "p50Ms": round(percentile(latencies, 0.50), 3) if latencies else None,
+            "p99Ms": round(percentile(latencies, 0.99), 3) if latencies else None,
+            "p999Ms": round(percentile(latencies, 0.999), 3) if latencies else None,
+            "maxMs": round(latencies[-1], 3) if latencies else None,
+            "meanMs": round(sum(latencies) / len(latencies), 3) if latencies else None,
+            "bytes": round(sum(sizes) / len(sizes)) if sizes else None,
+            "maxBytes": max(sizes) if sizes else None,
+            "throughputRps": round(len(ok) / elapsed, 2) if elapsed > 0 else None,
+        }
+    return routes
+
+
+def check_budgets(routes, total_rps, budgets):
+    """List of violations ('route: metric value > budget')"""
+    violations = []
+    limits = budgets.get("routes", {})
+    for path, stats in routes.items():
+        limit = limits.get(path, {})
+        for metric in ("p50Ms", "p99Ms", "p999Ms", "maxBytes"):
+            if metric in limit and stats[metric] is not None and stats[metric] > limit[metric]:
+                violations.append(f"{path}: {metric} {stats[metric]} > {limit[metric]}")
+        max_errors = limit.get("maxErrors", budgets.get("maxErrors", 0))
+        if stats["errors"] > max_errors:
+            violations.append(f"{path}: errors {stats['errors']} > {max_errors}")
+
+    minimum = budgets.get("minThroughputRps")
+    if minimum is not None and total_rps < minimum:
+        violations.append(f"total: throughputRps {total_rps} < {minimum}")
+    return violations
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmark a station's HTTP routes against latency budgets")
+    parser.add_argument("url", nargs="?", help="station origin, e.g. http://192.168.1.50")
+    parser.add_argument("--loopback", action="store_true",
+                        help="benchmark the host build of the routes on a loopback socket instead")
+    parser.add_argument("--concurrency", type=int, default=None, help="parallel clients (budget file default)")
+    parser.add_argument("--requests", type=int, default=None, help="measured requests (budget file default)")
+    parser.add_argument("--warmup", type=int, default=20, help="unmeasured requests first (default 20)")
+    parser.add_argument("--mix", help="'path:weight,...' (default: route weights of the budget file)")
+    parser.add_argument("--budgets", help="budget file (default tools/http_budgets.json, "
+                        "tools/http_budgets_host.json with --loopback)")
+    parser.add_argument("--no-budgets", action="store_true", help="measure only, never fail")
+    parser.add_argument("--timeout", type=float, default=10.0, help="per-request timeout in seconds")
+    parser.add_argument("--seed", type=int, default=1, help="request order seed")
+    parser.add_argument("--output", help="write the JSON result here instead of stdout")
+    args = parser.parse_args()
+    if bool(args.url) == args.loopback:
+        parser.error("give either a station origin or --loopback")
+
+    budget_file = args.budgets or (HOST_BUDGETS if args.loopback else DEFAULT_BUDGETS)
+    with open(budget_file, encoding="utf-8") as file:
+        budgets = json.load(file)
+
+    mix = parse_mix(args.mix) if args.mix else {
+        path: limit.get("weight", 1) for path, limit in budgets["routes"].items()
+    }
+    concurrency = args.concurrency or budgets.get("concurrency", 4)
+    count = args.requests or budgets.get("requests", 1000)
+    server = LoopbackServer() if args.loopback else None
+    url = server.start() if server else args.url
+    target = Target(url, args.timeout)
+
+    try:
+        # Warm up (DNS, ARP, WiFi power save) outside the measurement
+        for path in build_schedule(mix, args.warmup, args.seed + 1):
+            target.fetch(path)
+
+        samples, elapsed = run(target, build_schedule(mix, count, args.seed), concurrency)
+    finally:
+        if server:
+            server.stop()
+    routes = summarize(samples, elapsed)
+    succeeded = sum(stats["requests"] - stats["errors"] for stats in routes.values())
+    total_rps = round(succeeded / elapsed, 2) if elapsed > 0 else 0.0
+    violations = [] if args.no_budgets else check_budgets(routes, total_rps, budgets)
+
+    result = {
+        "version": RESULT_VERSION,
+        "target": url,
+        "loopback": args.loopback,
+        "timestamp": time.strftime("%Y-%m-%dT%H:%M:%SZ", time.gmtime()),
+        "concurrency": concurrency,
+        "requests": count,
+        "seed": args.seed,
+        "mix": mix,
+        "durationS": round(elapsed, 3),
+        "throughputRps": total_rps,
+        "routes": routes,
+        "violations": violations,
+        "passed": not violations,
+    }
+
+    text = json.dumps(result, indent=2)
+    if args.output:
+        with open(args.output, "w", encoding="utf-8") as file:
+            file.write(text + "\n")
+    else:
+        print(text)
+
+    # Human summary on stderr (stdout stays machine-readable)
+    for path, stats in routes.items():
+        print(f"{path:40} p50 {stats['p50Ms']} ms  p99 {stats['p99Ms']} ms  p999 {stats['p999Ms']} ms  "
+              f"{stats['bytes']} B  {stats['errors']} errors", file=sys.stderr)
+    print(f"{total_rps} req/s over {result['durationS']} s", file=sys.stderr)
+    for violation in violations:
+        print(f"[BUDGET] {violation}", file=sys.stderr)
+
+    return 1 if violations else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())